@@ -46,12 +46,7 @@ void run_multiple_caches(reader_t *reader) {
       LRU_init(cc_params, nullptr),  LFU_init(cc_params, nullptr),
       FIFO_init(cc_params, nullptr), Sieve_init(cc_params, nullptr),
       LHD_init(cc_params, nullptr),  LeCaR_init(cc_params, nullptr),
-      ARC_init(cc_params, nullptr),  NULL};
-
-  // Hyperbolic samples eviction candidates from the cache,
-  // so the hash table needs to be small
-  cc_params.hashpower = 12;
-  caches[7] = Hyperbolic_init(cc_params, nullptr);
+      ARC_init(cc_params, nullptr),  Hyperbolic_init(cc_params, nullptr)};
 
   cache_stat_t *result = simulate_with_multi_caches(
       reader, caches, 8, nullptr, 0.0, 0,
@@ -25,6 +25,27 @@ static inline cache_t *create_cache(const char *trace_path, const char *eviction
   /* the trace provided is small */
   if (trace_path != NULL && strstr(trace_path, "data/trace.") != NULL) cc_params.hashpower -= 8;
 
+#ifdef COMPACT_CACHE_OBJ
+  /* only these algorithms support the compact object layout */
+  if (strcasecmp(eviction_algo, "lru") == 0) {
+    cache = LRU_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "fifo") == 0) {
+    cache = FIFO_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "fifo-reinsertion") == 0 ||
+             strcasecmp(eviction_algo, "clock") == 0 ||
+             strcasecmp(eviction_algo, "second-chance") == 0) {
+    cache = Clock_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "s3fifo") == 0 ||
+             strcasecmp(eviction_algo, "s3-fifo") == 0) {
+    cache = S3FIFO_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "sieve") == 0) {
+    cache = Sieve_init(cc_params, eviction_params);
+  } else {
+    ERROR("do not support algorithm %s with the compact object layout\n",
+          eviction_algo);
+    abort();
+  }
+#else
   if (strcasecmp(eviction_algo, "lru") == 0) {
     cache = LRU_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "fifo") == 0) {
@@ -166,6 +187,10 @@ static inline cache_t *create_cache(const char *trace_path, const char *eviction
     ERROR("do not support algorithm %s\n", eviction_algo);
     abort();
   }
+#endif
+
+  /* allocate objects without the metadata the algorithm does not use */
+  cache_shrink_obj(cache);
 
   return cache;
 }
@@ -23,8 +23,13 @@ static void set_cache_size(struct arguments *args, reader_t *reader);
 
 static int conv_cache_sizes(char *cache_size_str, struct arguments *args);
 
+static void get_working_set_size(struct arguments *args, reader_t *reader,
+                                 int64_t *wss_obj, int64_t *wss_byte);
+
 static void parse_eviction_algo(struct arguments *args, const char *arg);
 
+static void parse_branch_params(struct arguments *args, const char *arg);
+
 const char *argp_program_version = "cachesim 0.0.1";
 const char *argp_program_bug_address =
     "https://groups.google.com/g/libcachesim";
@@ -48,6 +53,12 @@ enum argp_option_short {
   OPTION_PREFETCH_ALGO = 'p',
   OPTION_PREFETCH_PARAMS = 0x109,
   OPTION_PRINT_HEAD_REQ = 0x10a,
+  OPTION_SHARED_DECODE = 0x10b,
+  OPTION_BRANCH_PARAMS = 0x10c,
+  OPTION_CHECKPOINT_EVERY = 0x10d,
+  OPTION_RESUME = 0x10e,
+  OPTION_DENSE_OBJ_ID = 0x10f,
+  OPTION_EXACT_WSS = 0x110,
 };
 
 /*
@@ -77,6 +88,11 @@ static struct argp_option options[] = {
     {"prefetch-params", OPTION_PREFETCH_PARAMS, "\"block-size=65536\"", 0,
      "optional params for each prefetching algorithm, e.g., block-size=65536",
      4},
+    {"branch-params", OPTION_BRANCH_PARAMS, "\"n-bit-counter=1|n-bit-counter=2\"",
+     0,
+     "eviction params variants separated by |, each cache is warmed up once "
+     "and forked into one process per variant",
+     4},
 
     {0, 0, 0, 0, "Other options:"},
     {"ignore-obj-size", OPTION_IGNORE_OBJ_SIZE, "false", 0,
@@ -84,6 +100,14 @@ static struct argp_option options[] = {
     {"output", OPTION_OUTPUT_PATH, "output", 0, "Output path", 6},
     {"num-thread", OPTION_NUM_THREAD, "16", 0,
      "Number of threads if running when using default cache sizes", 6},
+    {"shared-decode", OPTION_SHARED_DECODE, "false", 0,
+     "decode the trace once and share it among all caches", 6},
+    {"checkpoint-every", OPTION_CHECKPOINT_EVERY, "100000000", 0,
+     "checkpoint the cache to <output>.checkpoint every n requests when "
+     "running one cache",
+     6},
+    {"resume", OPTION_RESUME, "result/trace.cachesim.checkpoint", 0,
+     "resume the simulation from a checkpoint", 6},
 
     {0, 0, 0, 0, "Other less common options:"},
     {"report-interval", OPTION_REPORT_INTERVAL, "3600", 0,
@@ -93,6 +117,14 @@ static struct argp_option options[] = {
      10},
     {"consider-obj-metadata", OPTION_CONSIDER_OBJ_METADATA, "false", 0,
      "Whether consider per object metadata size in the simulated cache", 10},
+    {"dense-obj-id", OPTION_DENSE_OBJ_ID, "false", 0,
+     "index the cache by object id, the trace must be converted by traceConv "
+     "with --remap-obj-id",
+     10},
+    {"exact-wss", OPTION_EXACT_WSS, "false", 0,
+     "count the working set size for relative cache sizes with a hash set of "
+     "all objects instead of estimating it",
+     10},
     {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output", 10},
     {"print-head-req", OPTION_PRINT_HEAD_REQ, "false", 0,
      "Print the first few requests", 10},
@@ -164,12 +196,30 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_CONSIDER_OBJ_METADATA:
       arguments->consider_obj_metadata = is_true(arg) ? true : false;
       break;
+    case OPTION_DENSE_OBJ_ID:
+      arguments->dense_obj_id = is_true(arg) ? true : false;
+      break;
+    case OPTION_EXACT_WSS:
+      arguments->exact_wss = is_true(arg) ? true : false;
+      break;
     case OPTION_WARMUP_SEC:
       arguments->warmup_sec = atoi(arg);
       break;
     case OPTION_PRINT_HEAD_REQ:
       arguments->print_head_req = is_true(arg) ? true : false;
       break;
+    case OPTION_SHARED_DECODE:
+      arguments->shared_decode = is_true(arg) ? true : false;
+      break;
+    case OPTION_BRANCH_PARAMS:
+      parse_branch_params(arguments, arg);
+      break;
+    case OPTION_CHECKPOINT_EVERY:
+      arguments->checkpoint_every = atoll(arg);
+      break;
+    case OPTION_RESUME:
+      arguments->resume_path = strdup(arg);
+      break;
     case ARGP_KEY_ARG:
       if (state->arg_num >= N_ARGS) {
         printf("found too many arguments, current %s\n", arg);
@@ -227,6 +277,8 @@ static void init_arg(struct arguments *args) {
   args->use_ttl = false;
   args->ignore_obj_size = false;
   args->consider_obj_metadata = false;
+  args->dense_obj_id = false;
+  args->exact_wss = false;
   args->report_interval = 3600 * 24;
   args->n_thread = n_cores();
   args->warmup_sec = -1;
@@ -234,6 +286,10 @@ static void init_arg(struct arguments *args) {
   args->n_req = -1;
   args->sample_ratio = 1.0;
   args->print_head_req = true;
+  args->shared_decode = false;
+  args->n_branch_params = 0;
+  args->checkpoint_every = 0;
+  args->resume_path = NULL;
 
   for (int i = 0; i < N_MAX_ALGO; i++) {
     args->eviction_algo[i] = NULL;
@@ -258,6 +314,14 @@ void free_arg(struct arguments *args) {
     free(args->eviction_algo[i]);
   }
 
+  for (int i = 0; i < args->n_branch_params; i++) {
+    free(args->branch_params[i]);
+  }
+
+  if (args->resume_path) {
+    free(args->resume_path);
+  }
+
   // free in simulator thread
   // for (int i = 0; i < args->n_eviction_algo * args->n_cache_size; i++) {
   //     args->caches[i]->cache_free(args->caches[i]);
@@ -330,6 +394,12 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
     args->consider_obj_metadata = false;
   }
 
+  if (args->dense_obj_id && args->reader->n_dense_obj == 0) {
+    WARN("the object ids of %s are not remapped, disable dense-obj-id\n",
+         args->trace_path);
+    args->dense_obj_id = false;
+  }
+
   /** convert the cache sizes from string to int,
    * if the user specifies 0 or auto, we use 12 cache sizes as fraction of
    * the working set size
@@ -344,6 +414,10 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
           args->trace_path, args->eviction_algo[i], args->cache_sizes[j],
           args->eviction_params, args->consider_obj_metadata);
 
+      if (args->dense_obj_id) {
+        cache_use_dense_obj_id(args->caches[idx], args->reader->n_dense_obj);
+      }
+
       if (args->admission_algo != NULL) {
         args->caches[idx]->admissioner =
             create_admissioner(args->admission_algo, args->admission_params);
@@ -384,6 +458,43 @@ static void parse_eviction_algo(struct arguments *args, const char *arg) {
 #undef MAX_ALGO_LEN
 }
 
+/**
+ * @brief parse the command line branch-params arguments
+ * the given input is a string, e.g., "n-bit-counter=1|n-bit-counter=2;init-freq=1"
+ * each variant uses the same format as eviction-params
+ */
+static void parse_branch_params(struct arguments *args, const char *arg) {
+  char *data = strdup(arg);
+  char *str = data;
+
+  while (str != NULL && str[0] != '\0') {
+    /* different variants are separated by | */
+    char *variant = strsep(&str, "|");
+    if (args->n_branch_params >= N_MAX_BRANCH_PARAMS) {
+      ERROR("too many branch-params variants, at most %d\n",
+            N_MAX_BRANCH_PARAMS);
+    }
+    char *params = strdup(variant);
+    replace_char(params, ';', ',');
+    replace_char(params, '_', '-');
+    args->branch_params[args->n_branch_params++] = params;
+  }
+  free(data);
+}
+
+/**
+ * @brief the working set size for relative cache sizes, it is estimated in
+ * constant memory unless --exact-wss is given
+ */
+static void get_working_set_size(struct arguments *args, reader_t *reader,
+                                 int64_t *wss_obj, int64_t *wss_byte) {
+  if (args->exact_wss) {
+    cal_working_set_size(reader, wss_obj, wss_byte);
+  } else {
+    estimate_working_set_size(reader, wss_obj, wss_byte);
+  }
+}
+
 /**
  *
  * @brief convert cache size string to byte, e.g., 100MB -> 100 * 1024 * 1024
@@ -440,7 +551,7 @@ static int conv_cache_sizes(char *cache_size_str, struct arguments *args) {
       // input is a float
       if (wss == 0) {
         int64_t wss_obj = 0, wss_byte = 0;
-        cal_working_set_size(args->reader, &wss_obj, &wss_byte);
+        get_working_set_size(args, args->reader, &wss_obj, &wss_byte);
         wss = args->ignore_obj_size ? wss_obj : wss_byte;
       }
       args->cache_sizes[args->n_cache_size++] = (uint64_t)(wss * atof(token));
@@ -468,7 +579,7 @@ static void set_cache_size(struct arguments *args, reader_t *reader) {
   // detect cache size from the trace
   int n_cache_sizes = 0;
   int64_t wss_obj = 0, wss_byte = 0;
-  cal_working_set_size(reader, &wss_obj, &wss_byte);
+  get_working_set_size(args, reader, &wss_obj, &wss_byte);
   int64_t wss = args->ignore_obj_size ? wss_obj : wss_byte;
   double s[N_AUTO_CACHE_SIZE] = {0.001, 0.003, 0.01, 0.03, 0.1, 0.2, 0.4, 0.8};
   for (int i = 0; i < N_AUTO_CACHE_SIZE; i++) {
@@ -548,6 +659,26 @@ void print_parsed_args(struct arguments *args) {
     n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
                   ", consider object metadata");
 
+  if (args->shared_decode)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", shared decode");
+
+  if (args->dense_obj_id)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", dense obj id");
+
+  for (int i = 0; i < args->n_branch_params; i++) {
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, "%s%s",
+                  i == 0 ? ", branch-params: " : " | ", args->branch_params[i]);
+  }
+
+  if (args->checkpoint_every > 0)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", checkpoint every %lld req",
+                  (long long)args->checkpoint_every);
+
+  if (args->resume_path != NULL)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", resume from %s",
+                  args->resume_path);
+
   snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, "\n");
 
   INFO("%s", output_str);
@@ -15,6 +15,7 @@ extern "C" {
 #define N_ARGS 4
 #define N_MAX_ALGO 16
 #define N_MAX_CACHE_SIZE 128
+#define N_MAX_BRANCH_PARAMS 64
 #define OFILEPATH_LEN 128
 
 /* This structure is used to communicate with parse_opt. */
@@ -45,8 +46,19 @@ struct arguments {
   int report_interval;
   bool ignore_obj_size;
   bool consider_obj_metadata;
+  /* index the caches by object id, see cache_use_dense_obj_id */
+  bool dense_obj_id;
+  /* count the working set size exactly instead of estimating it */
+  bool exact_wss;
   bool use_ttl;
   bool print_head_req;
+  bool shared_decode;
+  /* the eviction params variants in warm cache branching mode */
+  char *branch_params[N_MAX_BRANCH_PARAMS];
+  int n_branch_params;
+  /* checkpoint the cache every n requests, 0 to disable */
+  int64_t checkpoint_every;
+  char *resume_path;
 
   /* arguments generated */
   reader_t *reader;
@@ -59,7 +71,8 @@ void free_arg(struct arguments *args);
 
 void simulate(reader_t *reader, cache_t *cache, int report_interval,
               int warmup_sec, char *ofilepath, bool ignore_obj_size,
-              bool print_head_req);
+              bool print_head_req, int64_t checkpoint_every,
+              const char *resume_path);
 
 void print_parsed_args(struct arguments *args);
 
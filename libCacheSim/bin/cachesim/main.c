@@ -19,18 +19,45 @@ int main(int argc, char **argv) {
   if (args.n_cache_size == 0) {
     ERROR("no cache size found\n");
   }
-  if (args.n_cache_size * args.n_eviction_algo == 1) {
+  int n_cache = args.n_cache_size * args.n_eviction_algo;
+  int n_result = n_cache;
+  cache_stat_t *result = NULL;
+
+  if ((args.checkpoint_every > 0 || args.resume_path != NULL) &&
+      (n_cache != 1 || args.n_branch_params > 0)) {
+    ERROR("checkpoint and resume only support simulating one cache\n");
+  }
+
+  if (args.n_branch_params > 0) {
+    /* warm up each cache once and branch into the parameter variants */
+    n_result = n_cache * args.n_branch_params;
+    result = my_malloc_n(cache_stat_t, n_result);
+    for (int i = 0; i < n_cache; i++) {
+      cache_stat_t *res = simulate_with_warm_cache_branching(
+          args.reader, args.caches[i], args.n_branch_params,
+          (const char **)args.branch_params, NULL, 0, args.warmup_sec,
+          args.n_thread, true);
+      for (int j = 0; j < args.n_branch_params; j++) {
+        cache_stat_t *r = &result[i * args.n_branch_params + j];
+        *r = res[j];
+        snprintf(r->cache_name, CACHE_NAME_ARRAY_LEN, "%s(%s)",
+                 res[j].cache_name, args.branch_params[j]);
+      }
+      my_free(sizeof(cache_stat_t) * args.n_branch_params, res);
+      args.caches[i]->cache_free(args.caches[i]);
+    }
+  } else if (n_cache == 1) {
     simulate(args.reader, args.caches[0], args.report_interval, args.warmup_sec, args.ofilepath, args.ignore_obj_size,
-             args.print_head_req);
+             args.print_head_req, args.checkpoint_every, args.resume_path);
 
     free_arg(&args);
     return 0;
+  } else {
+    result = simulate_with_multi_caches(args.reader, args.caches, n_cache, NULL,
+                                        0, args.warmup_sec, args.n_thread, true,
+                                        true, args.shared_decode);
   }
 
-  cache_stat_t *result = simulate_with_multi_caches(
-      args.reader, args.caches, args.n_cache_size * args.n_eviction_algo, NULL,
-      0, args.warmup_sec, args.n_thread, true, true);
-
   // output to file
   char output_str[1024];
   // ensure file path exists
@@ -65,7 +92,7 @@ int main(int argc, char **argv) {
   }
 
   printf("\n");
-  for (int i = 0; i < args.n_cache_size * args.n_eviction_algo; i++) {
+  for (int i = 0; i < n_result; i++) {
     snprintf(output_str, 1024,
              "%s %s cache size %8ld%s, %lld req, miss ratio %.4lf, byte miss "
              "ratio %.4lf\n",
@@ -79,8 +106,7 @@ int main(int argc, char **argv) {
   }
   fclose(output_file);
 
-  if (args.n_cache_size * args.n_eviction_algo > 0)
-    my_free(sizeof(cache_stat_t) * args.n_cache_size * args.n_eviction_algo, result);
+  if (n_result > 0) my_free(sizeof(cache_stat_t) * n_result, result);
 
   free_arg(&args);
 
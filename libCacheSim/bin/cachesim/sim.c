@@ -8,67 +8,240 @@
 extern "C" {
 #endif
 
+/* the number of requests passed to cache->get_batch at a time */
+#define SIM_GET_BATCH_SIZE 64
+
+#define SIM_PROGRESS_MAGIC "LCSSIMP"
+/* version 2 saves the next request with its timestamp in the trace */
+#define SIM_PROGRESS_VERSION 2
+
+/* the simulation progress saved after the cache state in a checkpoint, the
+ * request is saved field by field so that the checkpoint does not depend on
+ * the layout of request_t, the progress has its own version because it
+ * belongs to cachesim rather than the cache library */
+typedef struct {
+  char magic[8];
+  int32_t version;
+  uint64_t start_ts;
+  uint64_t last_report_ts;
+  uint64_t req_cnt, miss_cnt;
+  uint64_t last_req_cnt, last_miss_cnt;
+  uint64_t req_byte, miss_byte;
+  /* the request that has been read but not served, start_ts is not
+   * subtracted from its clock_time */
+  struct {
+    int64_t clock_time;
+    uint64_t obj_id;
+    int64_t obj_size;
+    int64_t next_access_vtime;
+    int32_t ttl;
+    int32_t op;
+    int32_t tenant_id;
+  } __attribute__((packed)) next_req;
+} __attribute__((packed)) sim_progress_t;
+
+static void save_next_req(sim_progress_t *progress, const request_t *req) {
+  progress->next_req.clock_time = req->clock_time;
+  progress->next_req.obj_id = req->obj_id;
+  progress->next_req.obj_size = req->obj_size;
+  progress->next_req.next_access_vtime = req->next_access_vtime;
+  progress->next_req.ttl = req->ttl;
+  progress->next_req.op = (int32_t)req->op;
+  progress->next_req.tenant_id = req->tenant_id;
+}
+
+static void load_next_req(request_t *req, const sim_progress_t *progress) {
+  req->clock_time = progress->next_req.clock_time;
+  req->obj_id = progress->next_req.obj_id;
+  req->obj_size = progress->next_req.obj_size;
+  req->next_access_vtime = progress->next_req.next_access_vtime;
+  req->ttl = progress->next_req.ttl;
+  req->op = (req_op_e)progress->next_req.op;
+  req->tenant_id = progress->next_req.tenant_id;
+  /* the hash value is computed again */
+  req->hv = 0;
+  req->valid = true;
+}
+
 void print_head_requests(request_t *req, uint64_t req_cnt) {
   if (req_cnt < 2) {
     print_request(req);
   }
 }
 
+static void ensure_parent_dir(const char *path) {
+  char *output_dir = rindex(path, '/');
+  if (output_dir != NULL) {
+    size_t dir_length = output_dir - path;
+    char dir_path[1024];
+    snprintf(dir_path, dir_length + 1, "%s", path);
+    create_dir(dir_path);
+  }
+}
+
+/**
+ * @brief write the cache, the reader position and the simulation progress to
+ * the checkpoint, the old checkpoint is replaced only after the new one is
+ * written, a failed checkpoint does not stop the simulation
+ */
+static void dump_checkpoint(const char *checkpoint_path, cache_t *cache, reader_t *reader,
+                            const sim_progress_t *progress) {
+  char tmp_path[1024];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", checkpoint_path);
+  FILE *ofile = fopen(tmp_path, "wb");
+  if (ofile == NULL) {
+    WARN("cannot open checkpoint %s %s\n", tmp_path, strerror(errno));
+    return;
+  }
+
+  bool success = cache_dump_state(cache, reader, ofile) && fwrite(progress, sizeof(*progress), 1, ofile) == 1;
+  success = fclose(ofile) == 0 && success;
+  if (!success || rename(tmp_path, checkpoint_path) != 0) {
+    WARN("fail to write checkpoint %s\n", checkpoint_path);
+    remove(tmp_path);
+    return;
+  }
+
+  INFO("checkpoint %s at %lu requests\n", checkpoint_path, (unsigned long)reader->n_read_req);
+}
+
+static void load_checkpoint(const char *checkpoint_path, cache_t *cache, reader_t *reader, sim_progress_t *progress) {
+  FILE *ifile = fopen(checkpoint_path, "rb");
+  if (ifile == NULL) {
+    ERROR("cannot open checkpoint %s %s\n", checkpoint_path, strerror(errno));
+  }
+
+  if (!cache_load_state(cache, reader, ifile) || fread(progress, sizeof(*progress), 1, ifile) != 1) {
+    ERROR("fail to load checkpoint %s\n", checkpoint_path);
+  }
+  fclose(ifile);
+  if (memcmp(progress->magic, SIM_PROGRESS_MAGIC, sizeof(SIM_PROGRESS_MAGIC)) != 0) {
+    ERROR("checkpoint %s does not have a simulation progress of this cachesim\n", checkpoint_path);
+  }
+  if (progress->version != SIM_PROGRESS_VERSION) {
+    ERROR("checkpoint %s simulation progress version %d, expect %d\n", checkpoint_path, progress->version,
+          SIM_PROGRESS_VERSION);
+  }
+
+  INFO("resume %s from %s at %lu requests\n", cache->cache_name, checkpoint_path, (unsigned long)reader->n_read_req);
+}
+
 void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_sec, char *ofilepath,
-              bool ignore_obj_size, bool print_head_req) {
+              bool ignore_obj_size, bool print_head_req, int64_t checkpoint_every, const char *resume_path) {
   /* random seed */
   srand(time(NULL));
   set_rand_seed(rand());
 
+  char checkpoint_path[1024];
+  snprintf(checkpoint_path, sizeof(checkpoint_path), "%s.checkpoint", ofilepath);
+  if (checkpoint_every > 0) {
+    if (cache->dump_state == NULL) {
+      ERROR("%s does not support checkpointing\n", cache->cache_name);
+    }
+    ensure_parent_dir(checkpoint_path);
+  }
+
   request_t *req = new_request();
   uint64_t req_cnt = 0, miss_cnt = 0;
   uint64_t last_req_cnt = 0, last_miss_cnt = 0;
   uint64_t req_byte = 0, miss_byte = 0;
+  uint64_t start_ts, last_report_ts;
 
-  read_one_req(reader, req);
-  uint64_t start_ts = (uint64_t)req->clock_time;
-  uint64_t last_report_ts = warmup_sec;
+  if (resume_path != NULL) {
+    sim_progress_t progress;
+    load_checkpoint(resume_path, cache, reader, &progress);
+    start_ts = progress.start_ts;
+    last_report_ts = progress.last_report_ts;
+    req_cnt = progress.req_cnt;
+    miss_cnt = progress.miss_cnt;
+    last_req_cnt = progress.last_req_cnt;
+    last_miss_cnt = progress.last_miss_cnt;
+    req_byte = progress.req_byte;
+    miss_byte = progress.miss_byte;
+    load_next_req(req, &progress);
+  } else {
+    read_one_req(reader, req);
+    start_ts = (uint64_t)req->clock_time;
+    last_report_ts = warmup_sec;
+  }
+  uint64_t last_checkpoint_n_read_req = reader->n_read_req;
+
+  /* requests are served in batches so that the cache can prefetch */
+  request_t *reqs = my_malloc_n(request_t, SIM_GET_BATCH_SIZE);
+  bool *hits = my_malloc_n(bool, SIM_GET_BATCH_SIZE);
 
   double start_time = -1;
   while (req->valid) {
-    if (print_head_req) {
-      print_head_requests(req, req_cnt);
-    }
+    int n_req = 0;
+    while (req->valid && n_req < SIM_GET_BATCH_SIZE) {
+      /* req has the timestamp in the trace until it is served, so that the
+       * head requests are printed as they are in the trace */
+      bool is_warmup = (int64_t)(req->clock_time - start_ts) <= warmup_sec;
+      /* serve the batch before the warmup request to keep the order */
+      if (is_warmup && n_req > 0) break;
+      if (print_head_req) {
+        print_head_requests(req, req_cnt + n_req);
+      }
 
-    req->clock_time -= start_ts;
-    if (req->clock_time <= warmup_sec) {
-      cache->get(cache, req);
-      read_one_req(reader, req);
-      continue;
-    } else {
-      if (start_time < 0) {
-        start_time = gettime();
+      req->clock_time -= start_ts;
+      if (is_warmup) {
+        cache->get(cache, req);
+      } else {
+        if (start_time < 0) {
+          start_time = gettime();
+        }
+        copy_request(&reqs[n_req++], req);
       }
+      read_one_req(reader, req);
     }
 
-    req_cnt++;
-    req_byte += req->obj_size;
-    if (cache->get(cache, req) == false) {
-      miss_cnt++;
-      miss_byte += req->obj_size;
-    }
-    if (req->clock_time - last_report_ts >= report_interval &&
-        req->clock_time != 0) {
-      INFO(
-          "%s %s %.2lf hour: %lu requests, miss ratio %.4lf, interval miss "
-          "ratio "
-          "%.4lf\n",
-          mybasename(reader->trace_path), cache->cache_name,
-          (double)req->clock_time / 3600, (unsigned long)req_cnt,
-          (double)miss_cnt / req_cnt,
-          (double)(miss_cnt - last_miss_cnt) / (req_cnt - last_req_cnt));
-      last_miss_cnt = miss_cnt;
-      last_req_cnt = req_cnt;
-      last_report_ts = (int64_t)req->clock_time;
+    cache->get_batch(cache, reqs, n_req, hits);
+
+    for (int i = 0; i < n_req; i++) {
+      req_cnt++;
+      req_byte += reqs[i].obj_size;
+      if (!hits[i]) {
+        miss_cnt++;
+        miss_byte += reqs[i].obj_size;
+      }
+      if (reqs[i].clock_time - last_report_ts >= report_interval &&
+          reqs[i].clock_time != 0) {
+        INFO(
+            "%s %s %.2lf hour: %lu requests, miss ratio %.4lf, interval miss "
+            "ratio "
+            "%.4lf\n",
+            mybasename(reader->trace_path), cache->cache_name,
+            (double)reqs[i].clock_time / 3600, (unsigned long)req_cnt,
+            (double)miss_cnt / req_cnt,
+            (double)(miss_cnt - last_miss_cnt) / (req_cnt - last_req_cnt));
+        last_miss_cnt = miss_cnt;
+        last_req_cnt = req_cnt;
+        last_report_ts = (int64_t)reqs[i].clock_time;
+      }
     }
 
-    read_one_req(reader, req);
+    /* all requests before req have been served */
+    if (checkpoint_every > 0 && req->valid &&
+        reader->n_read_req - last_checkpoint_n_read_req >= (uint64_t)checkpoint_every) {
+      sim_progress_t progress = {
+          .magic = SIM_PROGRESS_MAGIC,
+          .version = SIM_PROGRESS_VERSION,
+          .start_ts = start_ts,
+          .last_report_ts = last_report_ts,
+          .req_cnt = req_cnt,
+          .miss_cnt = miss_cnt,
+          .last_req_cnt = last_req_cnt,
+          .last_miss_cnt = last_miss_cnt,
+          .req_byte = req_byte,
+          .miss_byte = miss_byte,
+      };
+      save_next_req(&progress, req);
+      dump_checkpoint(checkpoint_path, cache, reader, &progress);
+      last_checkpoint_n_read_req = reader->n_read_req;
+    }
   }
+  my_free(sizeof(request_t) * SIM_GET_BATCH_SIZE, reqs);
+  my_free(sizeof(bool) * SIM_GET_BATCH_SIZE, hits);
 
   double runtime = gettime() - start_time;
 
@@ -96,13 +269,7 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
 
 #pragma GCC diagnostic pop
   printf("%s", output_str);
-  char *output_dir = rindex(ofilepath, '/');
-  if (output_dir != NULL) {
-    size_t dir_length = output_dir - ofilepath;
-    char dir_path[1024];
-    snprintf(dir_path, dir_length + 1, "%s", ofilepath);
-    create_dir(dir_path);
-  }
+  ensure_parent_dir(ofilepath);
   FILE *output_file = fopen(ofilepath, "a");
   if (output_file == NULL) {
     ERROR("cannot open file %s %s\n", ofilepath, strerror(errno));
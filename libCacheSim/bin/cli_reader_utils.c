@@ -6,6 +6,7 @@
 #include <assert.h>
 #include <string.h>
 
+#include "../dataStructure/wssSketch.h"
 #include "../include/libCacheSim/reader.h"
 #include "../utils/include/mystr.h"
 
@@ -232,6 +233,10 @@ bool should_disable_obj_metadata(reader_t *reader) {
 }
 #undef N_TEST
 
+/**
+ * @brief count the distinct objects of the trace with a hash set of all
+ * object ids, which can use a lot of memory for large traces
+ */
 void cal_working_set_size(reader_t *reader, int64_t *wss_obj, int64_t *wss_byte) {
   reset_reader(reader);
   request_t *req = new_request();
@@ -239,15 +244,6 @@ void cal_working_set_size(reader_t *reader, int64_t *wss_obj, int64_t *wss_byte)
   *wss_obj = 0;
   *wss_byte = 0;
 
-  // sample the object space in case there are too many objects
-  // which can cause a crash
-  int scaling_factor = 1;
-  if (reader->file_size > 5 * GiB) {
-    scaling_factor = 101;
-  } else if (reader->file_size > 1 * GiB) {
-    scaling_factor = 11;
-  }
-
   int64_t n_req = 0;
   INFO("calculating working set size...\n");
   while (read_one_req(reader, req) == 0) {
@@ -255,9 +251,6 @@ void cal_working_set_size(reader_t *reader, int64_t *wss_obj, int64_t *wss_byte)
     if (n_req % 2000000 == 0) {
       DEBUG("processed %ld requests, %lld objects, %lld bytes\n", (long)n_req, (long long)*wss_obj, (long long)*wss_byte);
     }
-    if (scaling_factor > 1 && req->obj_id % scaling_factor != 0) {
-      continue;
-    }
 
     if (g_hash_table_contains(obj_table, (gconstpointer)req->obj_id)) {
       continue;
@@ -268,16 +261,38 @@ void cal_working_set_size(reader_t *reader, int64_t *wss_obj, int64_t *wss_byte)
     *wss_obj += 1;
     *wss_byte += req->obj_size;
   }
-  *wss_obj *= scaling_factor;
-  *wss_byte *= scaling_factor;
 
-  if (scaling_factor > 1) {
-    INFO("estimated working set size (%.2f sample ratio): %lld object %lld byte\n", 1.0 / scaling_factor, (long long)*wss_obj,
-         (long long)*wss_byte);
-  } else {
-    INFO("working set size: %lld object %lld byte\n", (long long)*wss_obj, (long long)*wss_byte);
+  INFO("working set size: %lld object %lld byte\n", (long long)*wss_obj, (long long)*wss_byte);
+
+  g_hash_table_destroy(obj_table);
+  free_request(req);
+  reset_reader(reader);
+}
+
+/**
+ * @brief estimate the working set size of the trace in constant memory, the
+ * estimate is cached in the trace metadata, see wssSketch.h
+ */
+void estimate_working_set_size(reader_t *reader, int64_t *wss_obj, int64_t *wss_byte) {
+  const trace_meta_t *meta = get_trace_meta(reader);
+  if (meta != NULL) {
+    *wss_obj = meta->n_obj;
+    *wss_byte = meta->wss_byte;
+    INFO("estimated working set size: %lld object %lld byte\n", (long long)*wss_obj, (long long)*wss_byte);
+    return;
+  }
+
+  /* the reader samples or caps the trace */
+  reset_reader(reader);
+  request_t *req = new_request();
+  wss_sketch_t *sketch = create_wss_sketch();
+  while (read_one_req(reader, req) == 0) {
+    wss_sketch_add(sketch, req->obj_id, req->obj_size);
   }
+  wss_sketch_estimate(sketch, wss_obj, wss_byte);
+  INFO("estimated working set size: %lld object %lld byte\n", (long long)*wss_obj, (long long)*wss_byte);
 
+  free_wss_sketch(sketch);
   free_request(req);
   reset_reader(reader);
 }
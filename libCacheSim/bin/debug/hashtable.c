@@ -0,0 +1,91 @@
+//
+// compare the lookup throughput of the hash table backends
+//
+// usage: debug_hashtable [n_obj] [n_lookup]
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "../../dataStructure/hashtable/bulkChainingHashTable.h"
+#include "../../dataStructure/hashtable/chainedHashTableV2.h"
+#include "../../dataStructure/hashtable/cuckooHashTable.h"
+#include "../../include/libCacheSim/request.h"
+#include "../../utils/include/mymath.h"
+
+#define HASHPOWER_INIT 20
+
+typedef struct {
+  const char *name;
+  hashtable_t *(*create)(const uint16_t hashpower);
+  cache_obj_t *(*insert)(hashtable_t *hashtable, const request_t *req);
+  cache_obj_t *(*find_obj_id)(const hashtable_t *hashtable,
+                              const obj_id_t obj_id);
+  void (*free)(hashtable_t *hashtable);
+} hashtable_backend_t;
+
+static const hashtable_backend_t backends[] = {
+    {"chainedHashTableV2", create_chained_hashtable_v2,
+     chained_hashtable_insert_v2, chained_hashtable_find_obj_id_v2,
+     free_chained_hashtable_v2},
+    {"bulkChainingHashTable", create_bulk_chaining_hashtable,
+     bulk_chaining_hashtable_insert, bulk_chaining_hashtable_find_obj_id,
+     free_bulk_chaining_hashtable},
+    {"cuckooHashTable", create_cuckoo_hashtable, cuckoo_hashtable_insert,
+     cuckoo_hashtable_find_obj_id, free_cuckoo_hashtable},
+};
+
+static double now_sec(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t n_obj = argc > 1 ? strtoull(argv[1], NULL, 10) : 4000000;
+  uint64_t n_lookup = argc > 2 ? strtoull(argv[2], NULL, 10) : 40000000;
+
+  /* half of the lookups are misses */
+  obj_id_t *lookup_ids = malloc(sizeof(obj_id_t) * n_lookup);
+  set_rand_seed(42);
+  for (uint64_t i = 0; i < n_lookup; i++) {
+    lookup_ids[i] = next_rand() % (n_obj * 2);
+  }
+
+  request_t *req = new_request();
+  for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+    const hashtable_backend_t *backend = &backends[b];
+    hashtable_t *hashtable = backend->create(HASHPOWER_INIT);
+
+    double start = now_sec();
+    for (uint64_t i = 0; i < n_obj; i++) {
+      req->obj_id = i;
+      backend->insert(hashtable, req);
+    }
+    double insert_time = now_sec() - start;
+
+    uint64_t n_hit = 0;
+    start = now_sec();
+    for (uint64_t i = 0; i < n_lookup; i++) {
+      n_hit += backend->find_obj_id(hashtable, lookup_ids[i]) != NULL;
+    }
+    double lookup_time = now_sec() - start;
+
+    int hashpower = hashtable->hashpower;
+    start = now_sec();
+    backend->free(hashtable);
+    double free_time = now_sec() - start;
+
+    printf(
+        "%-24s hashpower %2d, insert %8.2lf Mops/s, lookup %8.2lf Mops/s, "
+        "hit ratio %.4lf, free %.3lf sec\n",
+        backend->name, hashpower, n_obj / insert_time / 1e6,
+        n_lookup / lookup_time / 1e6, (double)n_hit / n_lookup, free_time);
+  }
+
+  free_request(req);
+  free(lookup_ids);
+  return 0;
+}
@@ -137,8 +137,10 @@ int main(int argc, char **argv) {
 
   if (strcasecmp(eviction_algo, "lru") == 0) {
     cache = LRU_init(cc_params, NULL);
+#ifndef COMPACT_CACHE_OBJ
   } else if (strcasecmp(eviction_algo, "lhd") == 0) {
     cache = LHD_init(cc_params, NULL);
+#endif
   } else if (strcasecmp(eviction_algo, "fifo") == 0) {
     cache = FIFO_init(cc_params, NULL);
   } else {
@@ -8,9 +8,15 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include <thread>
+
 #include "../../include/libCacheSim/const.h"
+#include "../../utils/include/mystr.h"
 #include "../../utils/include/mysys.h"
 #include "../cli_reader_utils.h"
+#ifdef SUPPORT_ZSTD_TRACE
+#include "../../traceReader/generalReader/zstdReader.h"
+#endif
 #include "internal.hpp"
 
 namespace cli {
@@ -28,6 +34,11 @@ enum argp_option_short {
   // trace conv
   OPTION_OUTPUT_TXT = 0x102,
   OPTION_REMOVE_SIZE_CHANGE = 0x103,
+  OPTION_REMAP_OBJ_ID = 0x104,
+  OPTION_OUTPUT_ZSTD = 0x105,
+  OPTION_NUM_THREAD = 0x106,
+  OPTION_MEM_LIMIT = 0x107,
+  OPTION_ZSTD_FRAME_SIZE = 0x108,
 
   // trace print
   OPTION_NUM_REQ = 'n',
@@ -59,13 +70,33 @@ static struct argp_option options[] = {
 
     {0, 0, 0, 0, "traceConv options:"},
     {"output-format", OPTION_OUTPUT_FORMAT, "lcs", 0,
-     "currently support lcs/lcs_v1/lcs_v2/lcs_v3/oracleGeneral", 4},
+     "currently support lcs/lcs_v1/lcs_v2/lcs_v3/lcs_v9/oracleGeneral, "
+     "lcs_v9 is the compressed columnar format", 4},
     {"output-txt", OPTION_OUTPUT_TXT, "false", 0,
      "output trace in txt format in addition to binary format", 4},
     {"remove-size-change", OPTION_REMOVE_SIZE_CHANGE, "false", 0,
      "whether remove object size change, if true, objects with changed size "
      "are updated to the old size",
      4},
+    {"remap-obj-id", OPTION_REMAP_OBJ_ID, "false", 0,
+     "remap object ids to [0, n_obj) in lcs traces, so that cachesim can "
+     "index the cache by object id with --dense-obj-id",
+     4},
+    {"zstd", OPTION_OUTPUT_ZSTD, "false", 0,
+     "also write the trace compressed in the zstd seekable format "
+     "(output.zst), which can be read backward and from any request",
+     4},
+    {"zstd-frame-size", OPTION_ZSTD_FRAME_SIZE, "4MB", 0,
+     "the decompressed size of a frame in the zstd seekable format, at most "
+     "64MB, smaller frames make seeking cheaper and compress worse",
+     4},
+    {"num-thread", OPTION_NUM_THREAD, "n_cores", 0,
+     "the number of threads to parse csv/txt traces", 4},
+    {"mem-limit", OPTION_MEM_LIMIT, "0", 0,
+     "compute the next access time with an external sort on disk using at "
+     "most this much memory, e.g., 4GB, for traces with too many objects to "
+     "fit in memory, 0 computes it in memory",
+     4},
 
     {0, 0, 0, 0, "tracePrint options:"},
     {"print-stat", OPTION_PRINT_STAT, "false", 0,
@@ -114,9 +145,39 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_REMOVE_SIZE_CHANGE:
       arguments->remove_size_change = is_true(arg) ? true : false;
       break;
+    case OPTION_REMAP_OBJ_ID:
+      arguments->remap_obj_id = is_true(arg) ? true : false;
+      break;
     case OPTION_OUTPUT_TXT:
       arguments->output_txt = is_true(arg) ? true : false;
       break;
+    case OPTION_OUTPUT_ZSTD:
+      arguments->output_zstd = is_true(arg) ? true : false;
+      break;
+    case OPTION_ZSTD_FRAME_SIZE:
+      arguments->zstd_frame_size = conv_size_str_to_byte(arg);
+      if (arguments->zstd_frame_size <= 0) {
+        ERROR("zstd frame size should be positive\n");
+      }
+#ifdef SUPPORT_ZSTD_TRACE
+      /* the reader streams a trace with larger frames and cannot seek it */
+      if (arguments->zstd_frame_size > ZSTD_READER_MAX_FRAME_SIZE) {
+        ERROR("zstd frame size should be at most %d MiB\n", ZSTD_READER_MAX_FRAME_SIZE / MiB);
+      }
+#endif
+      break;
+    case OPTION_NUM_THREAD:
+      arguments->n_thread = atoi(arg);
+      if (arguments->n_thread <= 0) {
+        arguments->n_thread = std::thread::hardware_concurrency();
+      }
+      break;
+    case OPTION_MEM_LIMIT:
+      arguments->mem_limit = conv_size_str_to_byte(arg);
+      if (arguments->mem_limit < 0) {
+        ERROR("memory limit should be positive\n");
+      }
+      break;
     case OPTION_OUTPUT_FORMAT:
       arguments->output_format = arg;
       break;
@@ -210,6 +271,19 @@ static void print_parsed_arg(struct arguments *args) {
     n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
                   ", remove size change during traceConv");
 
+  if (args->remap_obj_id)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", remap object id");
+
+  if (args->output_zstd)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", output zstd trace: true, frame size %lld KiB",
+                  (long long)(args->zstd_frame_size / KiB));
+
+  if (args->mem_limit > 0)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", memory limit: %lld MiB", (long long)(args->mem_limit / MiB));
+
   if (args->ignore_obj_size)
     n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
                   ", ignore object size");
@@ -229,6 +303,7 @@ static void print_parsed_arg(struct arguments *args) {
  */
 void parse_cmd(int argc, char *argv[], struct arguments *args) {
   init_arg(args);
+  args->n_thread = std::thread::hardware_concurrency();
 
   static struct argp argp = {options, parse_opt, args_doc, doc};
 
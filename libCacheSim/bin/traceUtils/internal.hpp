@@ -2,11 +2,16 @@
 
 #include <inttypes.h>
 
+#include <fstream>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "../../include/libCacheSim/cache.h"
 #include "../../include/libCacheSim/reader.h"
 
+struct lcs_req_v3;
+
 #define N_ARGS 2
 #define OFILEPATH_LEN 128
 
@@ -28,6 +33,17 @@ struct arguments {
   /* some objects may change size during the trace, this keeps the size as the
    * last size in the trace */
   bool remove_size_change;
+  /* remap the object ids to [0, n_obj) */
+  bool remap_obj_id;
+  /* also write the trace compressed in the zstd seekable format */
+  bool output_zstd;
+  /* the decompressed size of a frame in the zstd seekable format */
+  int64_t zstd_frame_size;
+  /* the number of threads to parse csv/txt traces */
+  int n_thread;
+  /* compute the next access with an external sort using at most this many
+   * bytes of memory, 0 computes it in memory */
+  int64_t mem_limit;
   char *output_format;
 
   /* trace print */
@@ -66,6 +82,11 @@ static void init_arg(struct arguments *args) {
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->output_txt = false;
   args->remove_size_change = false;
+  args->remap_obj_id = false;
+  args->output_zstd = false;
+  args->zstd_frame_size = 4 * MiB;
+  args->n_thread = 1;
+  args->mem_limit = 0;
   args->cache_name = NULL;
   args->output_format = "lcs";
   args->cache_size = 0;
@@ -91,13 +112,180 @@ namespace traceConv {
  * @param remove_size_change whether remove object size change during traceConv
  * @param use_lcs_format whether use lcs format
  */
-void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change);
+void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change,
+                              int n_thread, int64_t mem_limit);
 
 /** convert to lcs format */
-void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change, int lcs_ver);
+void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change, int lcs_ver,
+                    bool remap_obj_id, int n_thread, int64_t mem_limit);
+
+/* the requests of a csv/txt trace parsed by multiple threads, each thread
+ * parses a chunk of lines and writes the requests to a chunk file */
+struct parsed_trace {
+  std::vector<std::string> chunk_paths;
+  std::vector<int64_t> chunk_n_req;
+  int64_t n_req;
+  int n_features;
+  sampler_t *sampler;
+
+  /* the chunk and the position in the chunk of the next backward read */
+  int curr_chunk;
+  char *mapped_chunk;
+  size_t mapped_chunk_size;
+  size_t pos;
+};
+
+/**
+ * @brief split a csv/txt trace at line boundaries and parse the chunks on
+ * n_thread threads, the requests are the same as reading the trace with
+ * read_one_req
+ *
+ * @param reader
+ * @param tmp_path    the prefix of the chunk files
+ * @param n_thread
+ * @param n_features  the number of features to keep for each request
+ * @param trace
+ * @return false if the trace cannot be parsed in chunks, e.g., not a text
+ *        trace, the requests are capped or repeated by a count field, then
+ *        the trace should be read backward with read_one_req_above
+ */
+bool parse_trace_parallel(reader_t *reader, const std::string &tmp_path, int n_thread, int n_features,
+                          struct parsed_trace *trace);
+
+/**
+ * @brief read the parsed trace from the end to the beginning like
+ * read_one_req_above, the first call returns the last request
+ * @return 0 on success, 1 at the beginning of the trace
+ */
+int parsed_trace_read_one_req_above(struct parsed_trace *trace, request_t *req);
+
+/* remove the chunk files */
+void free_parsed_trace(struct parsed_trace *trace);
+
+/* an access in the sorted runs of the external sort */
+typedef struct ext_access {
+  uint64_t obj_id;
+  int64_t vtime;
+  int64_t obj_size;
+} ext_access_t;
+
+/* an object found by the external sort */
+typedef struct ext_obj {
+  uint64_t obj_id;
+  int64_t freq;
+  /* the size of the last request */
+  int64_t last_size;
+  bool size_changed;
+} ext_obj_t;
+
+/* the size of the requests to an object whose size changes */
+typedef enum {
+  KEEP_SIZE_CHANGE,
+  USE_FIRST_SIZE,
+  USE_LAST_SIZE,
+} size_change_policy_e;
+
+/* computes the next access of each request with bounded memory, the
+ * (obj_id, vtime) of the requests are sorted in runs that are spilled to
+ * disk, the merged runs give the next access of each request, which are
+ * spread to vtime buckets that fit in memory and written in vtime order,
+ * the runs are merged in several passes if the runs and the buckets cannot
+ * be open at the same time */
+struct next_access_sorter {
+  std::string tmp_path;
+  int64_t mem_limit;
+  size_change_policy_e size_policy;
+  bool vtime_asc;
+  /* the max number of runs and buckets open at the same time */
+  int64_t max_n_file;
+  /* the number of requests in a vtime bucket */
+  int64_t bucket_span;
+
+  int64_t n_req;
+  size_t run_capacity;
+  std::vector<ext_access_t> buf;
+  std::vector<std::string> run_paths;
+  /* the number of run files created, used to name the runs */
+  int64_t n_run_file;
+
+  std::string next_path;
+  FILE *next_file;
+};
+
+/**
+ * @brief initialize the sorter
+ *
+ * @param tmp_path     the prefix of the temporary files
+ * @param mem_limit
+ * @param size_policy
+ * @param n_req_hint   the number of requests in the trace if known, otherwise
+ *                     0, it is used to fail early if the trace needs more
+ *                     vtime buckets than the files that can be open
+ */
+void init_next_access_sorter(struct next_access_sorter *sorter, const std::string &tmp_path, int64_t mem_limit,
+                             size_change_policy_e size_policy, int64_t n_req_hint);
+
+/* the number of requests the sorter gets from the reader, 0 if it is not
+ * known without reading the trace */
+static inline int64_t next_access_sorter_n_req_hint(const reader_t *reader) {
+  if (reader->sampler != NULL) return 0;
+  int64_t n_req = (int64_t)reader->n_total_req;
+  if (reader->cap_at_n_req > 0 && reader->cap_at_n_req < n_req) n_req = reader->cap_at_n_req;
+  return n_req;
+}
+
+/* add the next request of the trace */
+void next_access_sorter_add(struct next_access_sorter *sorter, uint64_t obj_id, int64_t obj_size);
+
+/**
+ * @brief compute the next access of all the requests added
+ *
+ * @param sorter
+ * @param obj_cb  called once for each object
+ */
+void next_access_sorter_sort(struct next_access_sorter *sorter, const std::function<void(const ext_obj_t &)> &obj_cb);
+
+/**
+ * @brief read the next access of the requests in the order they are added
+ *
+ * @param next_access_vtime the vtime (starting from 0) of the next request to
+ *                          the object, -1 if there is no next request
+ * @param obj_size          the object size after applying the size policy
+ * @return 0 on success, 1 after the last request
+ */
+int next_access_sorter_read(struct next_access_sorter *sorter, int64_t *next_access_vtime, int64_t *obj_size);
+
+/* remove the temporary files */
+void free_next_access_sorter(struct next_access_sorter *sorter);
+
+/* buffers the requests of a lcs v9 trace and writes them in blocks, the
+ * index of the blocks is written when the writer is freed */
+struct lcs_block_writer;
+
+/* the lcs header should be written to ofile before the writer is created */
+struct lcs_block_writer *new_lcs_block_writer(std::ofstream &ofile);
+
+/* add the next request, next_access_vtime is INT64_MAX or -1 if the object
+ * is not requested again */
+void lcs_block_writer_add(struct lcs_block_writer *writer, const struct lcs_req_v3 &req);
+
+/* write the last block and the block index */
+void free_lcs_block_writer(struct lcs_block_writer *writer);
 
 }  // namespace traceConv
 
 namespace utils {
 void *setup_mmap(const std::string &file_path, size_t *size);
+
+/**
+ * @brief compress a trace in the zstd seekable format, the trace is
+ * compressed in independent frames followed by a seek table, so that the
+ * reader can decompress the frames in parallel, jump to any request and read
+ * the trace backward
+ *
+ * @param ifilepath the uncompressed trace
+ * @param ofilepath the compressed trace, should end with .zst
+ * @param frame_size the decompressed size of a frame
+ */
+void compress_to_seekable_zstd(const std::string &ifilepath, const std::string &ofilepath, size_t frame_size);
 }  // namespace utils
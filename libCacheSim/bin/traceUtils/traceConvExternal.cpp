@@ -0,0 +1,338 @@
+/* compute the next access of each request with an external sort for traceConv */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../../include/libCacheSim/logging.h"
+#include "internal.hpp"
+
+namespace traceConv {
+
+/* the next access of a request, written to the vtime buckets */
+typedef struct ext_next_access {
+  int64_t vtime;
+  int64_t next_access_vtime;
+  int64_t obj_size;
+} ext_next_access_t;
+
+/* the next access of a request in the next access file */
+typedef struct ext_next_access_entry {
+  int64_t next_access_vtime;
+  int64_t obj_size;
+} ext_next_access_entry_t;
+
+/* the runs and the buckets open at the same time during the merge, it is
+ * lowered if the limit of open files is smaller */
+#define EXT_SORT_MAX_N_FILE 1000
+/* the files that are open besides the runs and the buckets, e.g., the trace,
+ * the output and the temporary trace */
+#define EXT_SORT_N_RESERVED_FILE 16
+/* the number of records buffered for each run during the merge */
+#define EXT_SORT_MIN_RUN_BUF 4096
+
+static FILE *_open_file(const std::string &path, const char *mode) {
+  FILE *file = fopen(path.c_str(), mode);
+  if (file == nullptr) {
+    ERROR("cannot open %s, %s\n", path.c_str(), strerror(errno));
+  }
+  return file;
+}
+
+/* the number of runs and buckets that can be open at the same time */
+static int64_t _max_n_file(void) {
+  int64_t max_n_file = EXT_SORT_MAX_N_FILE;
+  struct rlimit rlim;
+  if (getrlimit(RLIMIT_NOFILE, &rlim) == 0 && rlim.rlim_cur != RLIM_INFINITY) {
+    max_n_file = std::min(max_n_file, (int64_t)rlim.rlim_cur - EXT_SORT_N_RESERVED_FILE);
+  }
+  /* a merge pass needs at least two input runs and one output */
+  if (max_n_file < 3) {
+    ERROR("the limit of open files is too small for the external sort, please raise it with ulimit -n\n");
+  }
+  return max_n_file;
+}
+
+/* the final merge needs one run and all the vtime buckets open */
+static void _check_n_bucket(const struct next_access_sorter *sorter, int64_t n_req) {
+  int64_t n_bucket = (n_req + sorter->bucket_span - 1) / sorter->bucket_span;
+  if (n_bucket > sorter->max_n_file - 1) {
+    ERROR("too many vtime buckets (%ld), at most %ld files can be open, please increase --mem-limit or ulimit -n\n",
+          (long)n_bucket, (long)sorter->max_n_file);
+  }
+}
+
+/* within an object, the accesses are sorted by vtime in the direction that
+ * reaches the size to keep first */
+static bool _access_less(const ext_access_t &a, const ext_access_t &b, bool vtime_asc) {
+  if (a.obj_id != b.obj_id) return a.obj_id < b.obj_id;
+  return vtime_asc ? a.vtime < b.vtime : a.vtime > b.vtime;
+}
+
+static void _spill_run(struct next_access_sorter *sorter) {
+  if (sorter->buf.empty()) return;
+
+  bool vtime_asc = sorter->vtime_asc;
+  std::sort(sorter->buf.begin(), sorter->buf.end(),
+            [vtime_asc](const ext_access_t &a, const ext_access_t &b) { return _access_less(a, b, vtime_asc); });
+
+  std::string run_path = sorter->tmp_path + ".run" + std::to_string(sorter->n_run_file++);
+  FILE *run_file = _open_file(run_path, "wb");
+  fwrite(sorter->buf.data(), sizeof(ext_access_t), sorter->buf.size(), run_file);
+  fclose(run_file);
+
+  sorter->run_paths.push_back(run_path);
+  sorter->buf.clear();
+}
+
+void init_next_access_sorter(struct next_access_sorter *sorter, const std::string &tmp_path, int64_t mem_limit,
+                             size_change_policy_e size_policy, int64_t n_req_hint) {
+  sorter->tmp_path = tmp_path;
+  sorter->mem_limit = mem_limit;
+  sorter->size_policy = size_policy;
+  /* the first size of an object is reached first in ascending vtime, and the
+   * last size in descending vtime */
+  sorter->vtime_asc = size_policy == USE_FIRST_SIZE;
+  sorter->max_n_file = _max_n_file();
+  /* each bucket fits in memory */
+  sorter->bucket_span =
+      std::max((int64_t)(mem_limit / sizeof(ext_next_access_entry_t)), (int64_t)EXT_SORT_MIN_RUN_BUF);
+  sorter->n_req = 0;
+  sorter->run_capacity = std::max((size_t)mem_limit / sizeof(ext_access_t), (size_t)EXT_SORT_MIN_RUN_BUF);
+  sorter->buf.reserve(sorter->run_capacity);
+  sorter->n_run_file = 0;
+  sorter->next_file = nullptr;
+
+  _check_n_bucket(sorter, n_req_hint);
+}
+
+void next_access_sorter_add(struct next_access_sorter *sorter, uint64_t obj_id, int64_t obj_size) {
+  sorter->buf.push_back({obj_id, sorter->n_req, obj_size});
+  sorter->n_req += 1;
+  if (sorter->n_req % sorter->bucket_span == 1) {
+    /* the request starts a new bucket, fail before spilling more runs */
+    _check_n_bucket(sorter, sorter->n_req);
+  }
+  if (sorter->buf.size() >= sorter->run_capacity) {
+    _spill_run(sorter);
+  }
+}
+
+/* a sorted run read with a buffer during the merge */
+struct run_reader {
+  FILE *file;
+  std::vector<ext_access_t> buf;
+  size_t pos;
+  size_t n;
+
+  bool next(ext_access_t *access) {
+    if (pos == n) {
+      n = fread(buf.data(), sizeof(ext_access_t), buf.size(), file);
+      pos = 0;
+      if (n == 0) return false;
+    }
+    *access = buf[pos++];
+    return true;
+  }
+};
+
+/* merges sorted runs, the runs are removed when the merger is closed */
+struct run_merger {
+  typedef std::pair<ext_access_t, int64_t> heap_item_t;
+
+  std::vector<std::string> paths;
+  std::vector<struct run_reader> runs;
+  std::vector<heap_item_t> heap;
+  std::function<bool(const heap_item_t &, const heap_item_t &)> heap_greater;
+
+  void open(const std::vector<std::string> &run_paths, int64_t mem_limit, bool vtime_asc) {
+    paths = run_paths;
+    int64_t n_run = paths.size();
+    size_t run_buf_size = std::max(mem_limit / 2 / std::max(n_run, (int64_t)1) / sizeof(ext_access_t),
+                                   (size_t)EXT_SORT_MIN_RUN_BUF);
+    heap_greater = [vtime_asc](const heap_item_t &a, const heap_item_t &b) {
+      return _access_less(b.first, a.first, vtime_asc);
+    };
+    runs.resize(n_run);
+    for (int64_t i = 0; i < n_run; i++) {
+      runs[i].file = _open_file(paths[i], "rb");
+      runs[i].buf.resize(run_buf_size);
+      runs[i].pos = runs[i].n = 0;
+      ext_access_t access;
+      if (runs[i].next(&access)) {
+        heap.push_back({access, i});
+        std::push_heap(heap.begin(), heap.end(), heap_greater);
+      }
+    }
+  }
+
+  bool next(ext_access_t *access) {
+    if (heap.empty()) return false;
+    std::pop_heap(heap.begin(), heap.end(), heap_greater);
+    *access = heap.back().first;
+    int64_t run_idx = heap.back().second;
+    heap.pop_back();
+    ext_access_t next_in_run;
+    if (runs[run_idx].next(&next_in_run)) {
+      heap.push_back({next_in_run, run_idx});
+      std::push_heap(heap.begin(), heap.end(), heap_greater);
+    }
+    return true;
+  }
+
+  void close(void) {
+    for (size_t i = 0; i < runs.size(); i++) {
+      fclose(runs[i].file);
+      remove(paths[i].c_str());
+    }
+    std::vector<struct run_reader>().swap(runs);
+  }
+};
+
+/* merge the runs until they can be open together with n_bucket buckets,
+ * each pass merges the first runs into a new run */
+static void _merge_runs(struct next_access_sorter *sorter, int64_t n_bucket) {
+  int64_t max_n_run = sorter->max_n_file - n_bucket;
+  while ((int64_t)sorter->run_paths.size() > max_n_run) {
+    int64_t n_merge = std::min((int64_t)sorter->run_paths.size() - max_n_run + 1, sorter->max_n_file - 1);
+    std::vector<std::string> merge_paths(sorter->run_paths.begin(), sorter->run_paths.begin() + n_merge);
+    sorter->run_paths.erase(sorter->run_paths.begin(), sorter->run_paths.begin() + n_merge);
+
+    struct run_merger merger;
+    merger.open(merge_paths, sorter->mem_limit, sorter->vtime_asc);
+    std::string run_path = sorter->tmp_path + ".run" + std::to_string(sorter->n_run_file++);
+    FILE *run_file = _open_file(run_path, "wb");
+    ext_access_t access;
+    while (merger.next(&access)) {
+      fwrite(&access, sizeof(access), 1, run_file);
+    }
+    fclose(run_file);
+    merger.close();
+    sorter->run_paths.push_back(run_path);
+    INFO("%s: merge %ld runs into %s\n", sorter->tmp_path.c_str(), (long)n_merge, run_path.c_str());
+  }
+}
+
+void next_access_sorter_sort(struct next_access_sorter *sorter, const std::function<void(const ext_obj_t &)> &obj_cb) {
+  _spill_run(sorter);
+  std::vector<ext_access_t>().swap(sorter->buf);
+
+  int64_t n_req = sorter->n_req;
+  int64_t bucket_span = sorter->bucket_span;
+  int64_t n_bucket = (n_req + bucket_span - 1) / bucket_span;
+  _check_n_bucket(sorter, n_req);
+  INFO("%s: merge %ld sorted runs of %ld requests\n", sorter->tmp_path.c_str(), (long)sorter->run_paths.size(),
+       (long)n_req);
+  _merge_runs(sorter, n_bucket);
+
+  std::vector<std::string> bucket_paths(n_bucket);
+  std::vector<FILE *> bucket_files(n_bucket);
+  for (int64_t i = 0; i < n_bucket; i++) {
+    bucket_paths[i] = sorter->tmp_path + ".bucket" + std::to_string(i);
+    bucket_files[i] = _open_file(bucket_paths[i], "wb");
+  }
+
+  /* k-way merge of the runs */
+  bool vtime_asc = sorter->vtime_asc;
+  struct run_merger merger;
+  merger.open(sorter->run_paths, sorter->mem_limit, vtime_asc);
+
+  /* the accesses of one object are consecutive in the merged order, the
+   * first access of an object in the merged order has the size to keep */
+  ext_obj_t obj = {0, 0, 0, false};
+  ext_access_t prev = {0, -1, 0};
+  int64_t kept_size = 0;
+  bool in_obj = false;
+  auto emit = [&](const ext_access_t &access, int64_t next_access_vtime) {
+    int64_t obj_size = sorter->size_policy == KEEP_SIZE_CHANGE ? access.obj_size : kept_size;
+    ext_next_access_t next_access = {access.vtime, next_access_vtime, obj_size};
+    fwrite(&next_access, sizeof(next_access), 1, bucket_files[access.vtime / bucket_span]);
+  };
+  auto finish_obj = [&]() {
+    if (vtime_asc) {
+      /* prev is the last access of the object */
+      emit(prev, -1);
+      obj.last_size = prev.obj_size;
+    }
+    obj_cb(obj);
+  };
+
+  ext_access_t access;
+  while (merger.next(&access)) {
+    if (in_obj && access.obj_id == obj.obj_id) {
+      if (vtime_asc) {
+        /* the previous access is followed by this one */
+        emit(prev, access.vtime);
+      } else {
+        /* this access is followed by the previous one */
+        emit(access, prev.vtime);
+      }
+      obj.freq += 1;
+      obj.size_changed |= access.obj_size != prev.obj_size;
+    } else {
+      if (in_obj) finish_obj();
+      in_obj = true;
+      obj = {access.obj_id, 1, access.obj_size, false};
+      kept_size = access.obj_size;
+      if (!vtime_asc) emit(access, -1);
+    }
+    prev = access;
+  }
+  if (in_obj) finish_obj();
+
+  merger.close();
+  sorter->run_paths.clear();
+
+  /* place the next accesses of each bucket in vtime order */
+  sorter->next_path = sorter->tmp_path + ".next";
+  FILE *next_file = _open_file(sorter->next_path, "wb");
+  std::vector<ext_next_access_entry_t> entries(std::min(bucket_span, n_req));
+  for (int64_t i = 0; i < n_bucket; i++) {
+    fclose(bucket_files[i]);
+    FILE *bucket_file = _open_file(bucket_paths[i], "rb");
+    int64_t bucket_start = i * bucket_span;
+    int64_t bucket_n_req = std::min(bucket_span, n_req - bucket_start);
+    ext_next_access_t next_access;
+    int64_t n_read = 0;
+    while (fread(&next_access, sizeof(next_access), 1, bucket_file) == 1) {
+      entries[next_access.vtime - bucket_start] = {next_access.next_access_vtime, next_access.obj_size};
+      n_read++;
+    }
+    assert(n_read == bucket_n_req);
+    fwrite(entries.data(), sizeof(ext_next_access_entry_t), bucket_n_req, next_file);
+    fclose(bucket_file);
+    remove(bucket_paths[i].c_str());
+  }
+  fclose(next_file);
+
+  sorter->next_file = _open_file(sorter->next_path, "rb");
+}
+
+int next_access_sorter_read(struct next_access_sorter *sorter, int64_t *next_access_vtime, int64_t *obj_size) {
+  ext_next_access_entry_t entry;
+  if (fread(&entry, sizeof(entry), 1, sorter->next_file) != 1) {
+    return 1;
+  }
+  *next_access_vtime = entry.next_access_vtime;
+  *obj_size = entry.obj_size;
+  return 0;
+}
+
+void free_next_access_sorter(struct next_access_sorter *sorter) {
+  for (const auto &run_path : sorter->run_paths) {
+    remove(run_path.c_str());
+  }
+  sorter->run_paths.clear();
+  if (sorter->next_file != nullptr) {
+    fclose(sorter->next_file);
+    sorter->next_file = nullptr;
+    remove(sorter->next_path.c_str());
+  }
+}
+
+}  // namespace traceConv
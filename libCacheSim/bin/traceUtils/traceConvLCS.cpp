@@ -23,15 +23,23 @@ struct obj_info {
   int64_t size;
   int32_t freq;
   int64_t last_access_vtime;
+  // the object id in [0, n_obj) if the object ids are remapped
+  int64_t dense_id;
 };
 
 typedef lcs_req_v3_t lcs_req_full_t;
 
 static void _reverse_file(std::string ofilepath, lcs_trace_stat_t stat, bool output_txt, int64_t lcs_ver);
 static void _write_lcs_header(std::ofstream &ofile, lcs_trace_stat_t &stat, int64_t lcs_ver);
-static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<uint64_t, struct obj_info> &obj_map,
+static void _write_lcs_req(std::ofstream &ofile, std::ofstream &ofile_txt, const lcs_req_full_t &lcs_req_full,
+                           const char *features, int64_t lcs_ver, bool output_txt,
+                           struct lcs_block_writer *block_writer);
+static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<int64_t, int32_t> &size_cnt,
+                           const std::unordered_map<int32_t, int32_t> &freq_cnt,
                            const std::unordered_map<int32_t, int32_t> &tenant_cnt,
                            const std::unordered_map<int32_t, int32_t> &ttl_cnt);
+static void _convert_to_lcs_external(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change,
+                                     int lcs_ver, int64_t mem_limit);
 
 /**
  * @brief Convert a trace to lcs format
@@ -42,8 +50,23 @@ static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<uint
  * @param output_txt
  * @param remove_size_change
  * @param lcs_ver       the version of lcs format, see lcs.h for more details
+ * @param remap_obj_id  remap the object ids to [0, n_obj) in the order of
+ *                      the last request of each object, so that the cache can
+ *                      use the object id as the index of a flat array
+ * @param n_thread      the number of threads to parse a csv/txt trace
+ * @param mem_limit     if not 0, compute the next access with an external
+ *                      sort using at most mem_limit bytes
  */
-void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change, int lcs_ver) {
+void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change, int lcs_ver,
+                    bool remap_obj_id, int n_thread, int64_t mem_limit) {
+  if (mem_limit > 0) {
+    if (remap_obj_id) {
+      ERROR("remapping object ids is not supported with a memory limit\n");
+    }
+    _convert_to_lcs_external(reader, ofilepath, output_txt, remove_size_change, lcs_ver, mem_limit);
+    return;
+  }
+
   request_t *req = new_request();
   std::ofstream ofile_temp(ofilepath + ".reverse", std::ios::out | std::ios::binary | std::ios::trunc);
   std::unordered_map<uint64_t, struct obj_info> obj_map;
@@ -54,15 +77,25 @@ void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bo
   lcs_trace_stat_t stat;
   memset(&stat, 0, sizeof(stat));
   stat.version = CURR_STAT_VERSION;
-  int64_t n_req_total = get_num_of_req(reader);
+  stat.dense_obj_id = remap_obj_id ? 1 : 0;
+
+  /* the requests are parsed in parallel and read back from the end, or read
+   * backward from the trace */
+  struct parsed_trace parsed;
+  bool is_parsed = parse_trace_parallel(reader, ofilepath, n_thread, n_features, &parsed);
+  int64_t n_req_total = is_parsed ? parsed.n_req : get_num_of_req(reader);
   obj_map.reserve(n_req_total / 100 + 1e4);
 
   INFO("%s: %.2f M requests in total\n", reader->trace_path, (double)n_req_total / 1.0e6);
 
-  reader->read_direction = READ_BACKWARD;
-  reader_set_read_pos(reader, 1.0);
-  go_back_one_req(reader);
-  read_one_req(reader, req);
+  if (is_parsed) {
+    parsed_trace_read_one_req_above(&parsed, req);
+  } else {
+    reader->read_direction = READ_BACKWARD;
+    reader_set_read_pos(reader, 1.0);
+    go_back_one_req(reader);
+    read_one_req(reader, req);
+  }
 
   // because we read backwards, the first request is the last request in the trace
   stat.end_timestamp = req->clock_time;
@@ -78,14 +111,17 @@ void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bo
     }
 
     auto info_it = obj_map.find(req->obj_id);
+    int64_t dense_id;
 
     if (info_it == obj_map.end()) {
       req->next_access_vtime = INT64_MAX;
+      dense_id = stat.n_obj;
       stat.n_obj++;
       stat.n_obj_byte += req->obj_size;
-      struct obj_info info = {req->obj_size, 1, stat.n_req};
+      struct obj_info info = {req->obj_size, 1, stat.n_req, dense_id};
       obj_map[req->obj_id] = info;
     } else {
+      dense_id = info_it->second.dense_id;
       req->next_access_vtime = info_it->second.last_access_vtime;
       info_it->second.last_access_vtime = stat.n_req;
       info_it->second.freq++;
@@ -101,7 +137,7 @@ void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bo
 
     lcs_req_full_t lcs_req;
     lcs_req.clock_time = req->clock_time;
-    lcs_req.obj_id = req->obj_id;
+    lcs_req.obj_id = remap_obj_id ? (uint64_t)dense_id : req->obj_id;
     lcs_req.obj_size = req->obj_size;
     lcs_req.op = req->op;
     lcs_req.tenant = req->tenant_id;
@@ -152,12 +188,15 @@ void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bo
       ERROR("n_req_curr (%ld) > n_req_total (%ld)\n", stat.n_req, n_req_total);
     }
 
-    if (read_one_req_above(reader, req) != 0) {
+    if ((is_parsed ? parsed_trace_read_one_req_above(&parsed, req) : read_one_req_above(reader, req)) != 0) {
       break;
     }
   }
 
   stat.start_timestamp = req->clock_time;
+  if (is_parsed) {
+    free_parsed_trace(&parsed);
+  }
 
   if (reader->sampler == nullptr) {
     assert(stat.n_req == get_num_of_req(reader));
@@ -166,7 +205,24 @@ void convert_to_lcs(reader_t *reader, std::string ofilepath, bool output_txt, bo
   free_request(req);
   ofile_temp.close();
 
-  _analyze_trace(stat, obj_map, tenant_cnt, ttl_cnt);
+  std::unordered_map<int64_t, int32_t> size_cnt;
+  for (const auto &kv : obj_map) {
+    if (size_cnt.find(kv.second.size) == size_cnt.end()) {
+      size_cnt[kv.second.size] = 1;
+    } else {
+      size_cnt[kv.second.size]++;
+    }
+  }
+  std::unordered_map<int32_t, int32_t> freq_cnt;
+  for (const auto &kv : obj_map) {
+    if (freq_cnt.find(kv.second.freq) == freq_cnt.end()) {
+      freq_cnt[kv.second.freq] = 1;
+    } else {
+      freq_cnt[kv.second.freq]++;
+    }
+  }
+
+  _analyze_trace(stat, size_cnt, freq_cnt, tenant_cnt, ttl_cnt);
 
   _reverse_file(ofilepath, stat, output_txt, lcs_ver);
 }
@@ -182,7 +238,17 @@ static void _write_lcs_header(std::ofstream &ofile, lcs_trace_stat_t &stat, int6
   ofile.write(reinterpret_cast<char *>(&lcs_header), sizeof(lcs_trace_header_t));
 }
 
-static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<uint64_t, struct obj_info> &obj_map,
+/**
+ * @brief compute the trace statistics in the header
+ *
+ * @param stat
+ * @param size_cnt    the number of objects of each size
+ * @param freq_cnt    the number of objects of each frequency
+ * @param tenant_cnt  the number of requests of each tenant
+ * @param ttl_cnt     the number of requests of each ttl
+ */
+static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<int64_t, int32_t> &size_cnt,
+                           const std::unordered_map<int32_t, int32_t> &freq_cnt,
                            const std::unordered_map<int32_t, int32_t> &tenant_cnt,
                            const std::unordered_map<int32_t, int32_t> &ttl_cnt) {
   INFO("########################################\n");
@@ -197,20 +263,14 @@ static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<uint
        (double)(stat.end_timestamp - stat.start_timestamp) / (24 * 3600.0));
 
   /**** analyze object size ****/
-  std::unordered_map<int64_t, int32_t> size_cnt;
   stat.smallest_obj_size = INT64_MAX;
   stat.largest_obj_size = 0;
-  for (const auto &kv : obj_map) {
-    if (size_cnt.find(kv.second.size) == size_cnt.end()) {
-      size_cnt[kv.second.size] = 1;
-    } else {
-      size_cnt[kv.second.size]++;
+  for (const auto &kv : size_cnt) {
+    if (kv.first < stat.smallest_obj_size) {
+      stat.smallest_obj_size = kv.first;
     }
-    if (kv.second.size < stat.smallest_obj_size) {
-      stat.smallest_obj_size = kv.second.size;
-    }
-    if (kv.second.size > stat.largest_obj_size) {
-      stat.largest_obj_size = kv.second.size;
+    if (kv.first > stat.largest_obj_size) {
+      stat.largest_obj_size = kv.first;
     }
   }
 
@@ -229,15 +289,6 @@ static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<uint
        stat.most_common_obj_sizes[3], stat.most_common_obj_size_ratio[3]);
 
   /**** analyze object popularity ****/
-  std::unordered_map<int32_t, int32_t> freq_cnt;
-  for (const auto &kv : obj_map) {
-    if (freq_cnt.find(kv.second.freq) == freq_cnt.end()) {
-      freq_cnt[kv.second.freq] = 1;
-    } else {
-      freq_cnt[kv.second.freq]++;
-    }
-  }
-
   // sort by freq
   std::vector<std::pair<int32_t, int32_t>> freq_cnt_vec(freq_cnt.begin(), freq_cnt.end());
   std::sort(freq_cnt_vec.begin(), freq_cnt_vec.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
@@ -245,21 +296,24 @@ static void _analyze_trace(lcs_trace_stat_t &stat, const std::unordered_map<uint
     stat.highest_freq[i] = freq_cnt_vec[i].first;
   }
 
-  /* calculate Zipf alpha using linear regression */
-  double *log_freq = new double[stat.n_obj];
-  double *log_rank = new double[stat.n_obj];
+  /* calculate Zipf alpha using linear regression of log(freq) on log(rank),
+   * the sums are accumulated without storing one point per object */
+  double sum_x = 0, sum_y = 0, sum_xy = 0, sum_xx = 0;
   int64_t n = 0;
   for (int i = 0; i < freq_cnt_vec.size(); i++) {
+    double log_freq = log(static_cast<double>(freq_cnt_vec[i].first));
     for (int j = 0; j < freq_cnt_vec[i].second; j++) {
-      log_freq[n] = log(static_cast<double>(freq_cnt_vec[i].first));
-      log_rank[n] = log(static_cast<double>(n + 1));
+      double log_rank = log(static_cast<double>(n + 1));
+      sum_x += log_rank;
+      sum_y += log_freq;
+      sum_xy += log_rank * log_freq;
+      sum_xx += log_rank * log_rank;
       n++;
     }
   }
   assert(n == stat.n_obj);
 
-  double slope, intercept;
-  linear_regression(log_rank, log_freq, n, &slope, &intercept);
+  double slope = (n * sum_xy - sum_x * sum_y) / (n * sum_xx - sum_x * sum_x);
 
   stat.skewness = -slope;
 
@@ -338,6 +392,7 @@ static void _reverse_file(std::string ofilepath, lcs_trace_stat_t stat, bool out
   INFO("start to reverse the trace...\n");
   std::ofstream ofile_txt;
   if (output_txt) ofile_txt.open(ofilepath + ".txt", std::ios::out | std::ios::trunc);
+  struct lcs_block_writer *block_writer = lcs_ver == LCS_BLOCK_VER ? new_lcs_block_writer(ofile) : nullptr;
 
   lcs_req_full_t lcs_req_full;
   size_t lcs_full_req_entry_size = sizeof(lcs_req_full_t);
@@ -358,62 +413,214 @@ static void _reverse_file(std::string ofilepath, lcs_trace_stat_t stat, bool out
       lcs_req_full.next_access_vtime = stat.n_req - lcs_req_full.next_access_vtime;
     }
 
-    if (lcs_ver == 1) {
-      lcs_req_v1_t lcs_req_v1;
-      lcs_req_v1.clock_time = lcs_req_full.clock_time;
-      lcs_req_v1.obj_id = lcs_req_full.obj_id;
-      lcs_req_v1.obj_size = lcs_req_full.obj_size;
-      lcs_req_v1.next_access_vtime = lcs_req_full.next_access_vtime;
-
-      ofile.write(reinterpret_cast<char *>(&lcs_req_v1), sizeof(lcs_req_v1));
-    } else if (lcs_ver == 2) {
-      lcs_req_v2_t lcs_req_v2;
-      lcs_req_v2.clock_time = lcs_req_full.clock_time;
-      lcs_req_v2.obj_id = lcs_req_full.obj_id;
-      lcs_req_v2.obj_size = lcs_req_full.obj_size;
-      lcs_req_v2.op = lcs_req_full.op;
-      lcs_req_v2.tenant = lcs_req_full.tenant;
-      lcs_req_v2.next_access_vtime = lcs_req_full.next_access_vtime;
-
-      ofile.write(reinterpret_cast<char *>(&lcs_req_v2), sizeof(lcs_req_v2));
-    } else if (lcs_ver == 3) {
-      lcs_req_v3_t lcs_req_v3;
-      lcs_req_v3.clock_time = lcs_req_full.clock_time;
-      lcs_req_v3.obj_id = lcs_req_full.obj_id;
-      lcs_req_v3.ttl = lcs_req_full.ttl;
-      lcs_req_v3.obj_size = lcs_req_full.obj_size;
-      lcs_req_v3.op = lcs_req_full.op;
-      lcs_req_v3.tenant = lcs_req_full.tenant;
-      lcs_req_v3.next_access_vtime = lcs_req_full.next_access_vtime;
-
-      ofile.write(reinterpret_cast<char *>(&lcs_req_v3), sizeof(lcs_req_v3));
-    } else if (lcs_ver >= 4 && lcs_ver <= 8) {
-      lcs_req_v3_t base;
-      base.clock_time = lcs_req_full.clock_time;
-      base.obj_id = lcs_req_full.obj_id;
-      base.ttl = lcs_req_full.ttl;
-      base.obj_size = lcs_req_full.obj_size;
-      base.op = lcs_req_full.op;
-      base.tenant = lcs_req_full.tenant;
-      base.next_access_vtime = lcs_req_full.next_access_vtime;
-
-      ofile.write(reinterpret_cast<char *>(&base), sizeof(lcs_req_v3));
-      ofile.write(mapped_file + pos + lcs_full_req_entry_size, n_features * sizeof(int32_t));
-    } else {
-      ERROR("invalid lcs version %ld\n", lcs_ver);
+    _write_lcs_req(ofile, ofile_txt, lcs_req_full, mapped_file + pos + lcs_full_req_entry_size, lcs_ver, output_txt,
+                   block_writer);
+  }
+
+  if (block_writer != nullptr) free_lcs_block_writer(block_writer);
+  munmap(mapped_file, file_size);
+  ofile.close();
+  if (output_txt) ofile_txt.close();
+
+  remove((ofilepath + ".reverse").c_str());
+
+  INFO("trace conversion finished, output %s\n", ofilepath.c_str());
+}
+
+/**
+ * @brief write one request in the given lcs version
+ *
+ * @param ofile
+ * @param ofile_txt
+ * @param lcs_req_full  the request with the final next_access_vtime
+ * @param features      the features of the request, used by lcs version 4-8
+ * @param lcs_ver
+ * @param output_txt
+ * @param block_writer  the writer of lcs version 9, nullptr for other versions
+ */
+static void _write_lcs_req(std::ofstream &ofile, std::ofstream &ofile_txt, const lcs_req_full_t &lcs_req_full,
+                           const char *features, int64_t lcs_ver, bool output_txt,
+                           struct lcs_block_writer *block_writer) {
+  if (lcs_ver == 1) {
+    lcs_req_v1_t lcs_req_v1;
+    lcs_req_v1.clock_time = lcs_req_full.clock_time;
+    lcs_req_v1.obj_id = lcs_req_full.obj_id;
+    lcs_req_v1.obj_size = lcs_req_full.obj_size;
+    lcs_req_v1.next_access_vtime = lcs_req_full.next_access_vtime;
+
+    ofile.write(reinterpret_cast<char *>(&lcs_req_v1), sizeof(lcs_req_v1));
+  } else if (lcs_ver == 2) {
+    lcs_req_v2_t lcs_req_v2;
+    lcs_req_v2.clock_time = lcs_req_full.clock_time;
+    lcs_req_v2.obj_id = lcs_req_full.obj_id;
+    lcs_req_v2.obj_size = lcs_req_full.obj_size;
+    lcs_req_v2.op = lcs_req_full.op;
+    lcs_req_v2.tenant = lcs_req_full.tenant;
+    lcs_req_v2.next_access_vtime = lcs_req_full.next_access_vtime;
+
+    ofile.write(reinterpret_cast<char *>(&lcs_req_v2), sizeof(lcs_req_v2));
+  } else if (lcs_ver == 3) {
+    lcs_req_v3_t lcs_req_v3;
+    lcs_req_v3.clock_time = lcs_req_full.clock_time;
+    lcs_req_v3.obj_id = lcs_req_full.obj_id;
+    lcs_req_v3.ttl = lcs_req_full.ttl;
+    lcs_req_v3.obj_size = lcs_req_full.obj_size;
+    lcs_req_v3.op = lcs_req_full.op;
+    lcs_req_v3.tenant = lcs_req_full.tenant;
+    lcs_req_v3.next_access_vtime = lcs_req_full.next_access_vtime;
+
+    ofile.write(reinterpret_cast<char *>(&lcs_req_v3), sizeof(lcs_req_v3));
+  } else if (lcs_ver >= 4 && lcs_ver <= 8) {
+    lcs_req_v3_t base;
+    base.clock_time = lcs_req_full.clock_time;
+    base.obj_id = lcs_req_full.obj_id;
+    base.ttl = lcs_req_full.ttl;
+    base.obj_size = lcs_req_full.obj_size;
+    base.op = lcs_req_full.op;
+    base.tenant = lcs_req_full.tenant;
+    base.next_access_vtime = lcs_req_full.next_access_vtime;
+
+    ofile.write(reinterpret_cast<char *>(&base), sizeof(lcs_req_v3));
+    ofile.write(features, LCS_VER_TO_N_FEATURES[lcs_ver] * sizeof(int32_t));
+  } else if (lcs_ver == LCS_BLOCK_VER) {
+    lcs_block_writer_add(block_writer, lcs_req_full);
+  } else {
+    ERROR("invalid lcs version %ld\n", lcs_ver);
+  }
+
+  if (output_txt) {
+    ofile_txt << lcs_req_full.clock_time << "," << lcs_req_full.obj_id << "," << lcs_req_full.obj_size << ","
+              << lcs_req_full.next_access_vtime << "\n";
+  }
+}
+
+/**
+ * @brief convert a trace to lcs format with bounded memory, the trace is read
+ * forward into a temporary file, and the next access of each request is
+ * computed with an external sort, see next_access_sorter
+ */
+static void _convert_to_lcs_external(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change,
+                                     int lcs_ver, int64_t mem_limit) {
+  request_t *req = new_request();
+  std::ofstream ofile_temp(ofilepath + ".forward", std::ios::out | std::ios::binary | std::ios::trunc);
+  std::unordered_map<int32_t, int32_t> tenant_cnt;
+  std::unordered_map<int32_t, int32_t> ttl_cnt;
+  int n_features = LCS_VER_TO_N_FEATURES[lcs_ver];
+
+  lcs_trace_stat_t stat;
+  memset(&stat, 0, sizeof(stat));
+  stat.version = CURR_STAT_VERSION;
+
+  struct next_access_sorter sorter;
+  init_next_access_sorter(&sorter, ofilepath, mem_limit, remove_size_change ? USE_LAST_SIZE : KEEP_SIZE_CHANGE,
+                          next_access_sorter_n_req_hint(reader));
+
+  INFO("%s: compute the next access with an external sort, memory limit %.2lf GiB\n", reader->trace_path,
+       (double)mem_limit / GiB);
+
+  while (read_one_req(reader, req) == 0) {
+    if (lcs_ver == 1 || lcs_ver == 2) {
+      if (req->clock_time > UINT32_MAX) {
+        WARN("clock_time %ld > UINT32_MAX, may cause overflow consider using lcs_ver 3\n", req->clock_time);
+      }
+      if (req->obj_size > UINT32_MAX) {
+        WARN("obj_size %ld > UINT32_MAX, may cause overflow consider using lcs_ver 3\n", req->obj_size);
+      }
+    }
+
+    if (stat.n_req == 0) {
+      stat.start_timestamp = req->clock_time;
+    }
+    stat.end_timestamp = req->clock_time;
+
+    lcs_req_full_t lcs_req;
+    lcs_req.clock_time = req->clock_time;
+    lcs_req.obj_id = req->obj_id;
+    lcs_req.obj_size = req->obj_size;
+    lcs_req.op = req->op;
+    lcs_req.tenant = req->tenant_id;
+    lcs_req.ttl = req->ttl;
+    lcs_req.next_access_vtime = INT64_MAX;
+
+    if (lcs_req.op == OP_GET || lcs_req.op == OP_GETS || lcs_req.op == OP_READ) {
+      stat.n_read++;
+    } else if (lcs_req.op == OP_WRITE || lcs_req.op == OP_SET || lcs_req.op == OP_REPLACE || lcs_req.op == OP_ADD ||
+               lcs_req.op == OP_UPDATE) {
+      stat.n_write++;
+    } else if (lcs_req.op == OP_DELETE) {
+      stat.n_delete++;
     }
 
-    if (output_txt) {
-      ofile_txt << lcs_req_full.clock_time << "," << lcs_req_full.obj_id << "," << lcs_req_full.obj_size << ","
-                << lcs_req_full.next_access_vtime << "\n";
+    tenant_cnt[lcs_req.tenant]++;
+    ttl_cnt[req->ttl]++;
+
+    ofile_temp.write(reinterpret_cast<char *>(&lcs_req), sizeof(lcs_req_full_t));
+    ofile_temp.write(reinterpret_cast<char *>(req->features), n_features * sizeof(int32_t));
+    next_access_sorter_add(&sorter, req->obj_id, req->obj_size);
+
+    stat.n_req_byte += req->obj_size;
+    stat.n_req += 1;
+
+    if (stat.n_req % 100000000 == 0) {
+      INFO("%s: %ld M requests (%.2lf GB), trace time %ld\n", reader->trace_path, (long)(stat.n_req / 1e6),
+           (double)stat.n_req_byte / GiB, (long)(req->clock_time - stat.start_timestamp));
     }
   }
 
+  free_request(req);
+  ofile_temp.close();
+
+  std::unordered_map<int64_t, int32_t> size_cnt;
+  std::unordered_map<int32_t, int32_t> freq_cnt;
+  if (remove_size_change) {
+    /* the requests use the size of the last request to the object */
+    stat.n_req_byte = 0;
+  }
+  next_access_sorter_sort(&sorter, [&](const ext_obj_t &obj) {
+    stat.n_obj++;
+    stat.n_obj_byte += obj.last_size;
+    size_cnt[obj.last_size]++;
+    freq_cnt[(int32_t)obj.freq]++;
+    if (remove_size_change) {
+      stat.n_req_byte += obj.freq * obj.last_size;
+    } else if (obj.size_changed) {
+      WARN("find object size change, obj %lu, please enable remove_size_change\n", (unsigned long)obj.obj_id);
+    }
+  });
+
+  _analyze_trace(stat, size_cnt, freq_cnt, tenant_cnt, ttl_cnt);
+
+  size_t file_size;
+  char *mapped_file = reinterpret_cast<char *>(utils::setup_mmap(ofilepath + ".forward", &file_size));
+  std::ofstream ofile(ofilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+  _write_lcs_header(ofile, stat, lcs_ver);
+  std::ofstream ofile_txt;
+  if (output_txt) ofile_txt.open(ofilepath + ".txt", std::ios::out | std::ios::trunc);
+  struct lcs_block_writer *block_writer = lcs_ver == LCS_BLOCK_VER ? new_lcs_block_writer(ofile) : nullptr;
+
+  size_t entry_size = sizeof(lcs_req_full_t) + n_features * sizeof(int32_t);
+  lcs_req_full_t lcs_req_full;
+  int64_t next_access_vtime, obj_size;
+  for (size_t pos = 0; pos + entry_size <= file_size; pos += entry_size) {
+    memcpy(&lcs_req_full, mapped_file + pos, sizeof(lcs_req_full_t));
+    if (next_access_sorter_read(&sorter, &next_access_vtime, &obj_size) != 0) {
+      ERROR("the next access of request %zu is missing\n", pos / entry_size);
+    }
+    /* next_access_vtime in the trace starts from 1 */
+    lcs_req_full.next_access_vtime = next_access_vtime == -1 ? INT64_MAX : next_access_vtime + 1;
+    lcs_req_full.obj_size = obj_size;
+
+    _write_lcs_req(ofile, ofile_txt, lcs_req_full, mapped_file + pos + sizeof(lcs_req_full_t), lcs_ver, output_txt,
+                   block_writer);
+  }
+
+  if (block_writer != nullptr) free_lcs_block_writer(block_writer);
   munmap(mapped_file, file_size);
   ofile.close();
   if (output_txt) ofile_txt.close();
 
-  remove((ofilepath + ".reverse").c_str());
+  remove((ofilepath + ".forward").c_str());
+  free_next_access_sorter(&sorter);
 
   INFO("trace conversion finished, output %s\n", ofilepath.c_str());
 }
@@ -0,0 +1,153 @@
+/* write the requests of a lcs v9 trace in blocks column by column */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../traceReader/customizedReader/lcs.h"
+#include "internal.hpp"
+
+namespace traceConv {
+
+struct lcs_block_writer {
+  std::ofstream *ofile;
+  /* the offset of the next block in the trace */
+  uint64_t offset;
+  /* the number of requests written, which is the vtime of the next request */
+  int64_t n_req;
+
+  /* the current block */
+  int64_t first_clock_time;
+  int64_t prev_clock_time;
+  std::vector<int64_t> cols[LCS_N_COL];
+  std::vector<uint64_t> obj_ids;
+  std::unordered_map<uint64_t, uint32_t> obj_id_to_idx;
+
+  std::vector<lcs_block_index_t> index;
+  std::vector<char> buf;
+};
+
+/* the number of bits to store the values in [0, range], the values that need
+ * more than 57 bits cannot be decoded with one 8-byte load, so they are stored
+ * in 64 bits */
+static uint8_t _col_width(uint64_t range) {
+  if (range == 0) return 0;
+  uint8_t width = 64 - __builtin_clzll(range);
+  return width > 57 ? 64 : width;
+}
+
+static void _pack_col(const std::vector<int64_t> &col, int64_t base, uint8_t width, char *dst) {
+  if (width == 0) return;
+  for (size_t i = 0; i < col.size(); i++) {
+    uint64_t v = (uint64_t)col[i] - (uint64_t)base;
+    if (width == 64) {
+      memcpy(dst + i * sizeof(uint64_t), &v, sizeof(uint64_t));
+    } else {
+      uint64_t bit = (uint64_t)i * width;
+      uint64_t word;
+      memcpy(&word, dst + (bit >> 3), sizeof(word));
+      word |= v << (bit & 7);
+      memcpy(dst + (bit >> 3), &word, sizeof(word));
+    }
+  }
+}
+
+static void _write_block(struct lcs_block_writer *writer) {
+  uint32_t n = writer->cols[0].size();
+  if (n == 0) return;
+
+  lcs_block_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.n_req = n;
+  header.n_obj = writer->obj_ids.size();
+  header.first_clock_time = writer->first_clock_time;
+
+  size_t block_size = sizeof(lcs_block_header_t) + header.n_obj * sizeof(uint64_t);
+  for (int i = 0; i < LCS_N_COL; i++) {
+    auto minmax = std::minmax_element(writer->cols[i].begin(), writer->cols[i].end());
+    header.col_base[i] = *minmax.first;
+    header.col_width[i] = _col_width((uint64_t)*minmax.second - (uint64_t)*minmax.first);
+    block_size += lcs_block_col_size(n, header.col_width[i]);
+  }
+
+  writer->buf.assign(block_size, 0);
+  char *pos = writer->buf.data();
+  memcpy(pos, &header, sizeof(header));
+  pos += sizeof(header);
+  memcpy(pos, writer->obj_ids.data(), header.n_obj * sizeof(uint64_t));
+  pos += header.n_obj * sizeof(uint64_t);
+  for (int i = 0; i < LCS_N_COL; i++) {
+    _pack_col(writer->cols[i], header.col_base[i], header.col_width[i], pos);
+    pos += lcs_block_col_size(n, header.col_width[i]);
+  }
+
+  writer->ofile->write(writer->buf.data(), block_size);
+  writer->index.push_back({writer->offset, writer->first_clock_time, n});
+  writer->offset += block_size;
+
+  for (int i = 0; i < LCS_N_COL; i++) {
+    writer->cols[i].clear();
+  }
+  writer->obj_ids.clear();
+  writer->obj_id_to_idx.clear();
+}
+
+struct lcs_block_writer *new_lcs_block_writer(std::ofstream &ofile) {
+  struct lcs_block_writer *writer = new lcs_block_writer();
+  writer->ofile = &ofile;
+  writer->offset = sizeof(lcs_trace_header_t);
+  writer->n_req = 0;
+  for (int i = 0; i < LCS_N_COL; i++) {
+    writer->cols[i].reserve(LCS_BLOCK_N_REQ);
+  }
+  return writer;
+}
+
+void lcs_block_writer_add(struct lcs_block_writer *writer, const struct lcs_req_v3 &req) {
+  if (writer->cols[0].empty()) {
+    writer->first_clock_time = req.clock_time;
+    writer->prev_clock_time = req.clock_time;
+  }
+
+  auto it = writer->obj_id_to_idx.try_emplace(req.obj_id, (uint32_t)writer->obj_ids.size());
+  if (it.second) {
+    writer->obj_ids.push_back(req.obj_id);
+  }
+
+  writer->cols[LCS_COL_CLOCK_TIME].push_back((int64_t)req.clock_time - writer->prev_clock_time);
+  writer->cols[LCS_COL_OBJ_ID].push_back(it.first->second);
+  writer->cols[LCS_COL_OBJ_SIZE].push_back(req.obj_size);
+  writer->cols[LCS_COL_OP].push_back(req.op);
+  writer->cols[LCS_COL_TENANT].push_back(req.tenant);
+  writer->cols[LCS_COL_TTL].push_back(req.ttl);
+  bool has_next = req.next_access_vtime != INT64_MAX && req.next_access_vtime != -1;
+  writer->cols[LCS_COL_NEXT_ACCESS_VTIME].push_back(has_next ? req.next_access_vtime - writer->n_req : 0);
+  writer->prev_clock_time = req.clock_time;
+  writer->n_req += 1;
+
+  if (writer->cols[0].size() == LCS_BLOCK_N_REQ) {
+    _write_block(writer);
+  }
+}
+
+void free_lcs_block_writer(struct lcs_block_writer *writer) {
+  _write_block(writer);
+
+  lcs_block_footer_t footer;
+  footer.n_block = writer->index.size();
+  footer.end_magic = LCS_TRACE_END_MAGIC;
+  writer->ofile->write(reinterpret_cast<char *>(writer->index.data()),
+                       writer->index.size() * sizeof(lcs_block_index_t));
+  writer->ofile->write(reinterpret_cast<char *>(&footer), sizeof(footer));
+
+  INFO("wrote %ld requests in %zu blocks, %.2lf bytes per request\n", (long)writer->n_req, writer->index.size(),
+       writer->n_req == 0 ? 0.0 : (double)(writer->offset - sizeof(lcs_trace_header_t)) / writer->n_req);
+  delete writer;
+}
+
+}  // namespace traceConv
@@ -33,25 +33,41 @@ int main(int argc, char *argv[]) {
 
   INFO("output format %s, output path %s\n", args.output_format, args.ofilepath);
   if (strcasecmp(args.output_format, "lcs") == 0 || strcasecmp(args.output_format, "lcs_v1") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 1);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 1,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v2") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 2);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 2,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v3") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 3);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 3,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v4") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 4);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 4,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v5") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 5);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 5,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v6") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 6);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 6,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v7") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 7);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 7,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "lcs_v8") == 0) {
-    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 8);
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 8,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
+  } else if (strcasecmp(args.output_format, "lcs_v9") == 0) {
+    traceConv::convert_to_lcs(args.reader, args.ofilepath, args.output_txt, args.remove_size_change, 9,
+                              args.remap_obj_id, args.n_thread, args.mem_limit);
   } else if (strcasecmp(args.output_format, "oracleGeneral") == 0) {
-    traceConv::convert_to_oracleGeneral(args.reader, args.ofilepath, args.output_txt, args.remove_size_change);
+    traceConv::convert_to_oracleGeneral(args.reader, args.ofilepath, args.output_txt, args.remove_size_change,
+                                        args.n_thread, args.mem_limit);
   } else {
     ERROR("unknown output format %s\n", args.output_format);
     exit(1);
   }
+
+  if (args.output_zstd) {
+    utils::compress_to_seekable_zstd(args.ofilepath, std::string(args.ofilepath) + ".zst", args.zstd_frame_size);
+  }
 }
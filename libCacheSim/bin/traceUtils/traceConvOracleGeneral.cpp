@@ -34,6 +34,8 @@ struct trace_stat {
 };
 
 static void _reverse_file(std::string ofilepath, struct trace_stat stat, bool output_txt, bool remove_size_change);
+static void _convert_to_oracleGeneral_external(reader_t *reader, std::string ofilepath, bool output_txt,
+                                               bool remove_size_change, int64_t mem_limit);
 
 /**
  * @brief Convert a trace to oracleGeneral format, which is a binary format
@@ -46,22 +48,40 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat, bool ou
  * @param sample_ratio
  * @param output_txt
  * @param remove_size_change
+ * @param n_thread  the number of threads to parse a csv/txt trace
+ * @param mem_limit if not 0, compute the next access with an external sort
+ *                  using at most mem_limit bytes
  */
-void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change) {
+void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath, bool output_txt, bool remove_size_change,
+                              int n_thread, int64_t mem_limit) {
+  if (mem_limit > 0) {
+    _convert_to_oracleGeneral_external(reader, ofilepath, output_txt, remove_size_change, mem_limit);
+    return;
+  }
+
   request_t *req = new_request();
   std::ofstream ofile_temp(ofilepath + ".reverse", std::ios::out | std::ios::binary | std::ios::trunc);
   std::unordered_map<uint64_t, int64_t> last_access_map;
 
-  int64_t n_req_curr = 0, n_req_total = get_num_of_req(reader);
+  /* the requests are parsed in parallel and read back from the end, or read
+   * backward from the trace */
+  struct parsed_trace parsed;
+  bool is_parsed = parse_trace_parallel(reader, ofilepath, n_thread, 0, &parsed);
+
+  int64_t n_req_curr = 0, n_req_total = is_parsed ? parsed.n_req : get_num_of_req(reader);
   last_access_map.reserve(n_req_total / 100 + 1e4);
 
   int64_t unique_bytes = 0, total_bytes = 0, n_obj = 0;
   INFO("%s: %.2f M requests in total\n", reader->trace_path, (double)n_req_total / 1.0e6);
 
-  reader->read_direction = READ_BACKWARD;
-  reader_set_read_pos(reader, 1.0);
-  go_back_one_req(reader);
-  read_one_req(reader, req);
+  if (is_parsed) {
+    parsed_trace_read_one_req_above(&parsed, req);
+  } else {
+    reader->read_direction = READ_BACKWARD;
+    reader_set_read_pos(reader, 1.0);
+    go_back_one_req(reader);
+    read_one_req(reader, req);
+  }
 
   int64_t start_ts = req->clock_time;
 
@@ -97,12 +117,16 @@ void convert_to_oracleGeneral(reader_t *reader, std::string ofilepath, bool outp
       ERROR("n_req_curr (%ld) > n_req_total (%ld)\n", n_req_curr, n_req_total);
     }
 
-    if (read_one_req_above(reader, req) != 0) {
+    if ((is_parsed ? parsed_trace_read_one_req_above(&parsed, req) : read_one_req_above(reader, req)) != 0) {
       break;
     }
     og_req.init(req);
   }
 
+  if (is_parsed) {
+    free_parsed_trace(&parsed);
+  }
+
   if (reader->sampler == nullptr) {
     assert(n_req_curr == get_num_of_req(reader));
   }
@@ -182,4 +206,85 @@ static void _reverse_file(std::string ofilepath, struct trace_stat stat, bool ou
   INFO("trace conversion finished, %ld requests %ld objects, output %s\n", (long)n_req, (long)stat.n_obj,
        ofilepath.c_str());
 }
+/**
+ * @brief convert a trace to oracleGeneral format with bounded memory, the
+ * trace is read forward into a temporary file, and the next access of each
+ * request is computed with an external sort, see next_access_sorter
+ */
+static void _convert_to_oracleGeneral_external(reader_t *reader, std::string ofilepath, bool output_txt,
+                                               bool remove_size_change, int64_t mem_limit) {
+  request_t *req = new_request();
+  std::ofstream ofile_temp(ofilepath + ".forward", std::ios::out | std::ios::binary | std::ios::trunc);
+
+  /* the size of the first request to an object is kept if size change is removed */
+  struct next_access_sorter sorter;
+  init_next_access_sorter(&sorter, ofilepath, mem_limit, remove_size_change ? USE_FIRST_SIZE : KEEP_SIZE_CHANGE,
+                          next_access_sorter_n_req_hint(reader));
+
+  INFO("%s: compute the next access with an external sort, memory limit %.2lf GiB\n", reader->trace_path,
+       (double)mem_limit / GiB);
+
+  struct trace_stat stat;
+  memset(&stat, 0, sizeof(stat));
+  oracleGeneral_req_t og_req;
+  while (read_one_req(reader, req) == 0) {
+    og_req.init(req);
+    og_req.next_access_vtime = -1;
+    ofile_temp.write(reinterpret_cast<char *>(&og_req), sizeof(oracleGeneral_req_t));
+    next_access_sorter_add(&sorter, req->obj_id, req->obj_size);
+
+    stat.n_req_byte += req->obj_size;
+    stat.n_req += 1;
+    if (stat.n_req % 100000000 == 0) {
+      INFO("%s: %ld M requests (%.2lf GB)\n", reader->trace_path, (long)(stat.n_req / 1e6),
+           (double)stat.n_req_byte / GiB);
+    }
+  }
+
+  free_request(req);
+  ofile_temp.close();
+
+  next_access_sorter_sort(&sorter, [&](const ext_obj_t &obj) {
+    stat.n_obj++;
+    stat.n_obj_byte += obj.last_size;
+  });
+
+  INFO("%s: %ld M requests (%.2lf GB), working set %lld object, %lld B (%.2lf GB), writing output...\n",
+       reader->trace_path, (long)(stat.n_req / 1e6), (double)stat.n_req_byte / GiB, (long long)stat.n_obj,
+       (long long)stat.n_obj_byte, (double)stat.n_obj_byte / GiB);
+
+  size_t file_size;
+  char *mapped_file = reinterpret_cast<char *>(utils::setup_mmap(ofilepath + ".forward", &file_size));
+  std::ofstream ofile(ofilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+  std::ofstream ofile_txt;
+  if (output_txt) ofile_txt.open(ofilepath + ".txt", std::ios::out | std::ios::trunc);
+
+  int64_t next_access_vtime, obj_size;
+  for (size_t pos = 0; pos + sizeof(oracleGeneral_req_t) <= file_size; pos += sizeof(oracleGeneral_req_t)) {
+    memcpy(&og_req, mapped_file + pos, sizeof(oracleGeneral_req_t));
+    if (next_access_sorter_read(&sorter, &next_access_vtime, &obj_size) != 0) {
+      ERROR("the next access of request %zu is missing\n", pos / sizeof(oracleGeneral_req_t));
+    }
+    /* next_access_vtime in the trace starts from 1 */
+    og_req.next_access_vtime = next_access_vtime == -1 ? -1 : next_access_vtime + 1;
+    og_req.obj_size = obj_size;
+
+    ofile.write(reinterpret_cast<char *>(&og_req), sizeof(oracleGeneral_req_t));
+    if (output_txt) {
+      ofile_txt << og_req.clock_time << "," << og_req.obj_id << "," << og_req.obj_size << ","
+                << og_req.next_access_vtime << "\n";
+    }
+  }
+
+  munmap(mapped_file, file_size);
+  ofile.close();
+  if (output_txt) ofile_txt.close();
+
+  remove((ofilepath + ".forward").c_str());
+  free_next_access_sorter(&sorter);
+
+  INFO("trace conversion finished, %ld requests %ld objects, output %s\n", (long)stat.n_req, (long)stat.n_obj,
+       ofilepath.c_str());
+}
+
 }  // namespace traceConv
\ No newline at end of file
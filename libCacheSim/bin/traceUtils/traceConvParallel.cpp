@@ -0,0 +1,225 @@
+/* parse a csv/txt trace on multiple threads for traceConv */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/reader.h"
+#include "../../traceReader/readerInternal.h"
+#include "internal.hpp"
+
+namespace traceConv {
+
+/* a parsed request in the chunk files, followed by n_features int32_t */
+typedef struct parsed_req {
+  int64_t clock_time;
+  uint64_t obj_id;
+  int64_t obj_size;
+  int32_t ttl;
+  int32_t tenant_id;
+  int32_t op;
+} __attribute__((packed)) parsed_req_t;
+
+/**
+ * @brief whether reading the trace in chunks gives the same requests as
+ * reading it backward from the end
+ */
+static bool _can_parse_in_chunks(const reader_t *reader) {
+  if (reader->trace_format != TXT_TRACE_FORMAT || reader->is_zstd_file) {
+    return false;
+  }
+
+  /* the requests are capped from the start of the trace */
+  if (reader->cap_at_n_req > 1) {
+    return false;
+  }
+
+  if (reader->trace_type == CSV_TRACE) {
+    const csv_params_t *csv_params = reinterpret_cast<const csv_params_t *>(reader->reader_params);
+    /* the repeated requests are not replayed the same way when reading backward */
+    if (csv_params->cnt_field_idx != 0) {
+      return false;
+    }
+  } else if (reader->trace_type == PLAIN_TXT_TRACE) {
+    /* string object ids are numbered in the order they are read */
+    if (!reader->obj_id_is_num) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief parse the lines in [start, end) of the trace and write the requests
+ * to chunk_path
+ */
+static void _parse_chunk(const reader_t *reader, char *mapped_file, size_t start, size_t end,
+                         const std::string &chunk_path, int n_features, int64_t *n_req) {
+  std::ofstream ofile(chunk_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  *n_req = 0;
+  if (start == end) {
+    return;
+  }
+
+  /* the header and the delimiter are already known from the input reader */
+  reader_init_param_t init_params = reader->init_params;
+  init_params.has_header = false;
+  init_params.has_header_set = true;
+  init_params.cap_at_n_req = 0;
+  init_params.compute_hv = false;
+  init_params.sampler = NULL;
+  if (reader->trace_type == CSV_TRACE) {
+    init_params.delimiter = reinterpret_cast<const csv_params_t *>(reader->reader_params)->delimiter;
+  }
+
+  reader_t *chunk_reader = setup_reader(reader->trace_path, reader->trace_type, &init_params);
+  fclose(chunk_reader->file);
+  chunk_reader->file = fmemopen(mapped_file + start, end - start, "r");
+  if (chunk_reader->file == NULL) {
+    ERROR("cannot open chunk [%zu, %zu) of %s, %s\n", start, end, reader->trace_path, strerror(errno));
+  }
+
+  request_t *req = new_request();
+  parsed_req_t parsed_req;
+  while (read_one_req(chunk_reader, req) == 0) {
+    parsed_req.clock_time = req->clock_time;
+    parsed_req.obj_id = req->obj_id;
+    parsed_req.obj_size = req->obj_size;
+    parsed_req.ttl = req->ttl;
+    parsed_req.tenant_id = req->tenant_id;
+    parsed_req.op = req->op;
+
+    ofile.write(reinterpret_cast<char *>(&parsed_req), sizeof(parsed_req_t));
+    ofile.write(reinterpret_cast<char *>(req->features), n_features * sizeof(int32_t));
+    *n_req += 1;
+  }
+
+  free_request(req);
+  close_reader(chunk_reader);
+  ofile.close();
+}
+
+bool parse_trace_parallel(reader_t *reader, const std::string &tmp_path, int n_thread, int n_features,
+                          struct parsed_trace *trace) {
+  if (n_thread < 1 || !_can_parse_in_chunks(reader)) {
+    return false;
+  }
+
+  size_t file_size;
+  char *mapped_file = reinterpret_cast<char *>(utils::setup_mmap(reader->trace_path, &file_size));
+
+  size_t data_start = 0;
+  if (reader->trace_type == CSV_TRACE && reinterpret_cast<csv_params_t *>(reader->reader_params)->has_header) {
+    data_start = reader->trace_start_offset;
+  }
+
+  /* each chunk ends after a newline, so that a line is parsed by one thread */
+  std::vector<size_t> chunk_bounds(n_thread + 1);
+  chunk_bounds[0] = data_start;
+  chunk_bounds[n_thread] = file_size;
+  for (int i = 1; i < n_thread; i++) {
+    size_t pos = data_start + (file_size - data_start) / n_thread * i;
+    pos = std::max(pos, chunk_bounds[i - 1]);
+    char *line_end = pos < file_size ? reinterpret_cast<char *>(memchr(mapped_file + pos, '\n', file_size - pos))
+                                     : nullptr;
+    chunk_bounds[i] = line_end == nullptr ? file_size : line_end - mapped_file + 1;
+  }
+
+  INFO("%s: parse the trace in %d chunks\n", reader->trace_path, n_thread);
+
+  trace->n_features = n_features;
+  trace->chunk_paths.resize(n_thread);
+  trace->chunk_n_req.resize(n_thread);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < n_thread; i++) {
+    trace->chunk_paths[i] = tmp_path + ".part" + std::to_string(i);
+    threads.emplace_back(_parse_chunk, reader, mapped_file, chunk_bounds[i], chunk_bounds[i + 1],
+                         std::cref(trace->chunk_paths[i]), n_features, &trace->chunk_n_req[i]);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  munmap(mapped_file, file_size);
+
+  trace->n_req = 0;
+  for (int i = 0; i < n_thread; i++) {
+    trace->n_req += trace->chunk_n_req[i];
+  }
+  /* the same as counting the requests with get_num_of_req */
+  reader->n_total_req = trace->n_req;
+
+  trace->sampler = reader->sampler;
+  trace->curr_chunk = n_thread;
+  trace->mapped_chunk = nullptr;
+  trace->mapped_chunk_size = 0;
+  trace->pos = 0;
+
+  return true;
+}
+
+int parsed_trace_read_one_req_above(struct parsed_trace *trace, request_t *req) {
+  size_t entry_size = sizeof(parsed_req_t) + trace->n_features * sizeof(int32_t);
+  parsed_req_t parsed_req;
+
+  while (true) {
+    while (trace->pos < entry_size) {
+      /* move to the chunk above */
+      if (trace->mapped_chunk != nullptr) {
+        munmap(trace->mapped_chunk, trace->mapped_chunk_size);
+        trace->mapped_chunk = nullptr;
+      }
+      if (trace->curr_chunk == 0) {
+        req->valid = false;
+        return 1;
+      }
+      trace->curr_chunk--;
+      if (trace->chunk_n_req[trace->curr_chunk] > 0) {
+        trace->mapped_chunk = reinterpret_cast<char *>(
+            utils::setup_mmap(trace->chunk_paths[trace->curr_chunk], &trace->mapped_chunk_size));
+        trace->pos = trace->mapped_chunk_size;
+      }
+    }
+
+    trace->pos -= entry_size;
+    memcpy(&parsed_req, trace->mapped_chunk + trace->pos, sizeof(parsed_req_t));
+    req->clock_time = parsed_req.clock_time;
+    req->obj_id = parsed_req.obj_id;
+    req->obj_size = parsed_req.obj_size;
+    req->ttl = parsed_req.ttl;
+    req->tenant_id = parsed_req.tenant_id;
+    req->op = static_cast<req_op_e>(parsed_req.op);
+    memcpy(req->features, trace->mapped_chunk + trace->pos + sizeof(parsed_req_t), trace->n_features * sizeof(int32_t));
+    req->hv = 0;
+    req->valid = true;
+
+    /* the same sampling as read_one_req */
+    if (trace->sampler == nullptr || trace->sampler->sample(trace->sampler, req)) {
+      return 0;
+    }
+  }
+}
+
+void free_parsed_trace(struct parsed_trace *trace) {
+  if (trace->mapped_chunk != nullptr) {
+    munmap(trace->mapped_chunk, trace->mapped_chunk_size);
+    trace->mapped_chunk = nullptr;
+  }
+  for (const auto &chunk_path : trace->chunk_paths) {
+    remove(chunk_path.c_str());
+  }
+  trace->chunk_paths.clear();
+  trace->chunk_n_req.clear();
+}
+
+}  // namespace traceConv
@@ -66,7 +66,7 @@ int main(int argc, char *argv[]) {
 
   if (args.cache_size < 1) {
     int64_t wss_obj = 0, wss_byte = 0;
-    cal_working_set_size(args.reader, &wss_obj, &wss_byte);
+    estimate_working_set_size(args.reader, &wss_obj, &wss_byte);
     if (args.ignore_obj_size) {
       args.cache_size = (int64_t)(wss_obj * args.cache_size);
     } else {
@@ -6,7 +6,12 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <algorithm>
+#include <vector>
 #include "../../include/libCacheSim/logging.h"
+#ifdef SUPPORT_ZSTD_TRACE
+#include "../../traceReader/generalReader/zstdReader.h"
+#endif
 
 namespace utils{
 void *setup_mmap(const std::string &file_path, size_t *size) {
@@ -46,4 +51,56 @@ void *setup_mmap(const std::string &file_path, size_t *size) {
   return mapped_file;
 }
 
+void compress_to_seekable_zstd(const std::string &ifilepath, const std::string &ofilepath, size_t frame_size) {
+#ifdef SUPPORT_ZSTD_TRACE
+  /* each frame is decompressed into one block of the reader */
+  const int compression_level = 3;
+
+  size_t file_size;
+  char *mapped_file = static_cast<char *>(setup_mmap(ifilepath, &file_size));
+  FILE *ofile = fopen(ofilepath.c_str(), "wb");
+  if (ofile == nullptr) {
+    ERROR("cannot open %s, %s\n", ofilepath.c_str(), strerror(errno));
+    abort();
+  }
+
+  ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  std::vector<char> buf(ZSTD_compressBound(frame_size));
+  /* compressed size and decompressed size of each frame */
+  std::vector<uint32_t> seek_table;
+  for (size_t offset = 0; offset < file_size; offset += frame_size) {
+    size_t content_size = std::min(frame_size, file_size - offset);
+    size_t compressed_size =
+        ZSTD_compressCCtx(cctx, buf.data(), buf.size(), mapped_file + offset, content_size, compression_level);
+    if (ZSTD_isError(compressed_size)) {
+      ERROR("zstd compression error: %s\n", ZSTD_getErrorName(compressed_size));
+      abort();
+    }
+    fwrite(buf.data(), 1, compressed_size, ofile);
+    seek_table.push_back(static_cast<uint32_t>(compressed_size));
+    seek_table.push_back(static_cast<uint32_t>(content_size));
+  }
+
+  uint32_t n_frame = seek_table.size() / 2;
+  uint32_t header[2] = {ZSTD_SEEKABLE_SKIPPABLE_MAGIC,
+                        static_cast<uint32_t>(seek_table.size() * sizeof(uint32_t) + ZSTD_SEEKABLE_FOOTER_SIZE)};
+  /* no checksum in the entries */
+  uint8_t descriptor = 0;
+  uint32_t magic = ZSTD_SEEKABLE_MAGIC;
+  fwrite(header, sizeof(uint32_t), 2, ofile);
+  fwrite(seek_table.data(), sizeof(uint32_t), seek_table.size(), ofile);
+  fwrite(&n_frame, sizeof(n_frame), 1, ofile);
+  fwrite(&descriptor, sizeof(descriptor), 1, ofile);
+  fwrite(&magic, sizeof(magic), 1, ofile);
+
+  fclose(ofile);
+  ZSTD_freeCCtx(cctx);
+  munmap(mapped_file, file_size);
+  INFO("compressed trace %s in %u frames\n", ofilepath.c_str(), n_frame);
+#else
+  ERROR("zstd is not supported, please build with OPT_SUPPORT_ZSTD_TRACE\n");
+  abort();
+#endif
+}
+
 }
\ No newline at end of file
@@ -3,8 +3,10 @@
 //
 
 #include "../dataStructure/hashtable/hashtable.h"
+#include "../dataStructure/objSampler.h"
 #include "../include/libCacheSim/cache.h"
 #include "../include/libCacheSim/prefetchAlgo.h"
+#include "../include/libCacheSim/reader.h"
 
 /** this file contains both base function, which should be called by all
  *eviction algorithms, and the queue related functions, which should be called
@@ -40,8 +42,10 @@ cache_t *cache_struct_init(const char *const cache_name,
   cache->n_req = 0;
   cache->to_evict_candidate = NULL;
   cache->to_evict_candidate_gen_vtime = -1;
+  cache->obj_eviction_md_size = -1;
 
   cache->can_insert = cache_can_insert_default;
+  cache->get_batch = cache_get_batch_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
 
@@ -71,6 +75,7 @@ cache_t *cache_struct_init(const char *const cache_name,
  */
 void cache_struct_free(cache_t *cache) {
   free_hashtable(cache->hashtable);
+  if (cache->obj_sampler != NULL) free_obj_sampler(cache->obj_sampler);
   if (cache->admissioner != NULL) cache->admissioner->free(cache->admissioner);
   if (cache->prefetcher != NULL) cache->prefetcher->free(cache->prefetcher);
   my_free(sizeof(cache_t), cache);
@@ -92,6 +97,12 @@ cache_t *clone_cache(const cache_t *old_cache) {
   };
   assert(sizeof(cc_params) == 24);
   cache_t *cache = old_cache->cache_init(cc_params, old_cache->init_params);
+  if (hashtable_obj_size(old_cache->hashtable) < sizeof(cache_obj_t)) {
+    cache_shrink_obj(cache);
+  }
+  if (old_cache->hashtable->dense_obj_id) {
+    cache_use_dense_obj_id(cache, hashsize(old_cache->hashtable->hashpower));
+  }
   if (old_cache->admissioner != NULL) {
     cache->admissioner = old_cache->admissioner->clone(old_cache->admissioner);
   }
@@ -118,6 +129,12 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache,
   };
   assert(sizeof(cc_params) == 24);
   cache_t *cache = old_cache->cache_init(cc_params, old_cache->init_params);
+  if (hashtable_obj_size(old_cache->hashtable) < sizeof(cache_obj_t)) {
+    cache_shrink_obj(cache);
+  }
+  if (old_cache->hashtable->dense_obj_id) {
+    cache_use_dense_obj_id(cache, hashsize(old_cache->hashtable->hashpower));
+  }
   if (old_cache->admissioner != NULL) {
     cache->admissioner = old_cache->admissioner->clone(old_cache->admissioner);
   }
@@ -130,6 +147,325 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache,
   return cache;
 }
 
+bool cache_shrink_obj(cache_t *cache) {
+  if (cache->obj_eviction_md_size < 0 ||
+      cache->obj_eviction_md_size >= (int32_t)CACHE_OBJ_MD_SIZE) {
+    return false;
+  }
+  if (cache->n_obj != 0) {
+    WARN("%s: objects can only be shrunk in a new cache\n", cache->cache_name);
+    return false;
+  }
+
+  return hashtable_set_obj_size(
+      cache->hashtable, CACHE_OBJ_SIZE_WITH_MD(cache->obj_eviction_md_size));
+}
+
+bool cache_use_dense_obj_id(cache_t *cache, int64_t n_obj) {
+  if (cache->n_obj != 0) {
+    WARN("%s: dense object ids can only be used in a new cache\n",
+         cache->cache_name);
+    return false;
+  }
+
+  return hashtable_use_dense_obj_id(cache->hashtable, (uint64_t)n_obj);
+}
+
+void cache_enable_obj_sampler(cache_t *cache, size_t pos_offset) {
+  assert(cache->n_obj == 0 && cache->obj_sampler == NULL);
+  assert(pos_offset >= CACHE_OBJ_MD_OFFSET &&
+         pos_offset + sizeof(int32_t) <= sizeof(cache_obj_t));
+  cache->obj_sampler = create_obj_sampler(pos_offset);
+}
+
+cache_obj_t *cache_rand_obj(const cache_t *cache) {
+  if (cache->obj_sampler != NULL) {
+    return obj_sampler_rand_obj(cache->obj_sampler);
+  }
+  /* most buckets of a table indexed by dense object ids are empty when the
+   * cache is small, so sampling from the table does not terminate in time */
+  if (cache->hashtable->dense_obj_id) {
+    ERROR("%s: sampling a cache with dense object ids requires "
+          "cache_enable_obj_sampler\n",
+          cache->cache_name);
+  }
+  return hashtable_rand_obj(cache->hashtable);
+}
+
+/********************************************************************
+ *                     checkpoint and restore
+ *
+ * a checkpoint has a header with the reader position, followed by the
+ * state of the cache, which has the common cache fields followed by the
+ * algorithm-specific state written by cache->dump_state. Objects are
+ * written without the pointers, and the per-algorithm metadata union is
+ * copied as is (zero-padded if the objects are shrunk), so a checkpoint can
+ * only be loaded by a binary compiled with the same cache_obj_t layout
+ *******************************************************************/
+#define CACHE_STATE_MAGIC "LCSCKPT"
+#define CACHE_STATE_VERSION 1
+
+typedef struct {
+  char magic[8];
+  int32_t version;
+  int32_t obj_struct_size;
+  /* -1 if the checkpoint does not have a reader */
+  int64_t n_read_req;
+  int64_t mmap_offset;
+} __attribute__((packed)) cache_state_header_t;
+
+typedef struct {
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  int64_t cache_size;
+  int64_t n_req;
+  int64_t n_obj;
+  int64_t occupied_byte;
+} __attribute__((packed)) cache_state_base_t;
+
+static inline bool _dump_bytes(FILE *ofile, const void *p, size_t sz) {
+  return fwrite(p, sz, 1, ofile) == 1;
+}
+
+static inline bool _load_bytes(FILE *ifile, void *p, size_t sz) {
+  return fread(p, sz, 1, ifile) == 1;
+}
+
+/* use the offset to avoid taking the address of a packed member */
+#define _OBJ_FIELD(obj, field) ((char *)(obj) + offsetof(cache_obj_t, field))
+#define _OBJ_FIELD_SIZE(field) sizeof(((cache_obj_t *)0)->field)
+
+/* the object fields that are part of the cache state, i.e., all fields
+ * except the pointers, are dumped and loaded one by one */
+#if defined(SUPPORT_TTL)
+#define _OBJ_TTL_FIELD(F, obj) F(obj, exp_time)
+#else
+#define _OBJ_TTL_FIELD(F, obj) true
+#endif
+#if defined(TRACK_EVICTION_V_AGE) || defined(TRACK_DEMOTION) || \
+    defined(TRACK_CREATE_TIME)
+#define _OBJ_CREATE_TIME_FIELD(F, obj) F(obj, create_time)
+#else
+#define _OBJ_CREATE_TIME_FIELD(F, obj) true
+#endif
+
+/* obj_size is the number of bytes of the object, the metadata union is
+ * always written in full so that the checkpoint does not depend on it */
+static bool _dump_obj(const cache_obj_t *obj, size_t obj_size, FILE *ofile) {
+  char md[CACHE_OBJ_MD_SIZE];
+  memset(md, 0, sizeof(md));
+  memcpy(md, (const char *)obj + CACHE_OBJ_MD_OFFSET,
+         obj_size - CACHE_OBJ_MD_OFFSET);
+#define _DUMP(o, field) \
+  _dump_bytes(ofile, _OBJ_FIELD(o, field), _OBJ_FIELD_SIZE(field))
+  return _DUMP(obj, obj_id) && _DUMP(obj, obj_size) &&
+         _OBJ_TTL_FIELD(_DUMP, obj) && _OBJ_CREATE_TIME_FIELD(_DUMP, obj) &&
+         _DUMP(obj, misc) && _dump_bytes(ofile, md, sizeof(md));
+#undef _DUMP
+}
+
+static bool _load_obj(cache_obj_t *obj, FILE *ifile) {
+#define _LOAD(o, field) \
+  _load_bytes(ifile, _OBJ_FIELD(o, field), _OBJ_FIELD_SIZE(field))
+  return _LOAD(obj, obj_id) && _LOAD(obj, obj_size) &&
+         _OBJ_TTL_FIELD(_LOAD, obj) && _OBJ_CREATE_TIME_FIELD(_LOAD, obj) &&
+         _LOAD(obj, misc) &&
+         _load_bytes(ifile, (char *)obj + CACHE_OBJ_MD_OFFSET,
+                     CACHE_OBJ_MD_SIZE);
+#undef _LOAD
+}
+
+/* copy the object state without changing the pointers of dst, dst has
+ * obj_size bytes */
+static void _copy_obj_state(cache_obj_t *dst, const cache_obj_t *src,
+                            size_t obj_size) {
+  /* the links are not converted, with COMPACT_CACHE_OBJ they are relative
+   * to dst and are restored to dst unchanged */
+  obj_link_t hash_next = dst->hash_next;
+  obj_link_t prev = dst->queue.prev, next = dst->queue.next;
+  obj_hv_t hv = dst->hv;
+  memcpy(dst, src, obj_size);
+  dst->hash_next = hash_next;
+  dst->hv = hv;
+  dst->queue.prev = prev;
+  dst->queue.next = next;
+}
+
+bool cache_dump_obj_queue(const cache_t *cache, const cache_obj_t *head,
+                          FILE *ofile) {
+  size_t obj_size = hashtable_obj_size(cache->hashtable);
+  int64_t n_obj = 0;
+  for (const cache_obj_t *obj = head; obj != NULL;
+       obj = obj_queue_next(obj)) {
+    n_obj += 1;
+  }
+
+  bool success = _dump_bytes(ofile, &n_obj, sizeof(n_obj));
+  for (const cache_obj_t *obj = head; success && obj != NULL;
+       obj = obj_queue_next(obj)) {
+    success = _dump_obj(obj, obj_size, ofile);
+  }
+
+  return success;
+}
+
+bool cache_load_obj_queue(cache_t *cache, cache_obj_t **head,
+                          cache_obj_t **tail, FILE *ifile) {
+  int64_t n_obj;
+  if (!_load_bytes(ifile, &n_obj, sizeof(n_obj))) return false;
+
+  size_t obj_size = hashtable_obj_size(cache->hashtable);
+  request_t *req = new_request();
+  cache_obj_t loaded;
+  memset(&loaded, 0, sizeof(loaded));
+  bool success = true;
+  for (int64_t i = 0; i < n_obj; i++) {
+    if (!_load_obj(&loaded, ifile)) {
+      success = false;
+      break;
+    }
+    req->obj_id = loaded.obj_id;
+    req->obj_size = loaded.obj_size;
+    cache_obj_t *obj = cache_insert_base(cache, req);
+    append_obj_to_tail(head, tail, obj);
+    _copy_obj_state(obj, &loaded, obj_size);
+  }
+  free_request(req);
+
+  return success;
+}
+
+bool cache_dump_state_base(const cache_t *cache, FILE *ofile) {
+  if (cache->dump_state == NULL) {
+    WARN("%s does not support checkpointing\n", cache->cache_name);
+    return false;
+  }
+
+  cache_state_base_t base;
+  memset(&base, 0, sizeof(base));
+  strncpy(base.cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN - 1);
+  base.cache_size = cache->cache_size;
+  base.n_req = cache->n_req;
+  base.n_obj = cache->n_obj;
+  base.occupied_byte = cache->occupied_byte;
+
+  return _dump_bytes(ofile, &base, sizeof(base)) &&
+         cache->dump_state(cache, ofile);
+}
+
+bool cache_load_state_base(cache_t *cache, FILE *ifile) {
+  if (cache->load_state == NULL) {
+    WARN("%s does not support checkpointing\n", cache->cache_name);
+    return false;
+  }
+
+  cache_state_base_t base;
+  if (!_load_bytes(ifile, &base, sizeof(base))) return false;
+  base.cache_name[CACHE_NAME_ARRAY_LEN - 1] = '\0';
+  if (strcmp(base.cache_name, cache->cache_name) != 0 ||
+      base.cache_size != cache->cache_size) {
+    WARN("checkpoint of %s size %ld cannot be loaded into %s size %ld\n",
+         base.cache_name, (long)base.cache_size, cache->cache_name,
+         (long)cache->cache_size);
+    return false;
+  }
+  if (cache->n_req != 0 || cache->n_obj != 0) {
+    WARN("checkpoint can only be loaded into a new cache\n");
+    return false;
+  }
+
+  cache->n_req = base.n_req;
+  if (!cache->load_state(cache, ifile)) return false;
+
+  if (cache->n_obj != base.n_obj ||
+      cache->occupied_byte != base.occupied_byte) {
+    WARN("%s checkpoint is corrupted, %ld objects %ld bytes, expect %ld %ld\n",
+         cache->cache_name, (long)cache->n_obj, (long)cache->occupied_byte,
+         (long)base.n_obj, (long)base.occupied_byte);
+    return false;
+  }
+
+  return true;
+}
+
+bool cache_dump_state(const cache_t *cache, const reader_t *reader,
+                      FILE *ofile) {
+  cache_state_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_STATE_MAGIC, sizeof(CACHE_STATE_MAGIC));
+  header.version = CACHE_STATE_VERSION;
+  header.obj_struct_size = sizeof(cache_obj_t);
+  header.n_read_req = reader == NULL ? -1 : (int64_t)reader->n_read_req;
+  header.mmap_offset = reader == NULL ? 0 : (int64_t)reader->mmap_offset;
+
+  return _dump_bytes(ofile, &header, sizeof(header)) &&
+         cache_dump_state_base(cache, ofile);
+}
+
+/**
+ * @brief move the reader to the position where n_read_req requests have been
+ * read
+ */
+static bool _restore_reader_pos(reader_t *reader,
+                                const cache_state_header_t *header) {
+  /* item_size is 0 if the binary trace has no fixed-size records */
+  if (reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file &&
+      reader->item_size > 0) {
+    if ((size_t)header->mmap_offset > reader->file_size) {
+      WARN("checkpoint offset %ld is beyond the end of %s\n",
+           (long)header->mmap_offset, reader->trace_path);
+      return false;
+    }
+    reader->mmap_offset = header->mmap_offset;
+    reader->n_read_req = header->n_read_req;
+    return true;
+  }
+
+  /* the position of the text and compressed readers depends on the state of
+   * the decoder, so decode the trace from the beginning */
+  reset_reader(reader);
+  request_t *req = new_request();
+  while ((int64_t)reader->n_read_req < header->n_read_req) {
+    if (read_one_req(reader, req) != 0) break;
+  }
+  free_request(req);
+
+  if ((int64_t)reader->n_read_req != header->n_read_req) {
+    WARN("checkpoint position %ld is beyond the end of %s\n",
+         (long)header->n_read_req, reader->trace_path);
+    return false;
+  }
+  return true;
+}
+
+bool cache_load_state(cache_t *cache, reader_t *reader, FILE *ifile) {
+  cache_state_header_t header;
+  if (!_load_bytes(ifile, &header, sizeof(header)) ||
+      memcmp(header.magic, CACHE_STATE_MAGIC, sizeof(CACHE_STATE_MAGIC)) !=
+          0) {
+    WARN("not a cache checkpoint\n");
+    return false;
+  }
+  if (header.version != CACHE_STATE_VERSION ||
+      header.obj_struct_size != (int32_t)sizeof(cache_obj_t)) {
+    WARN("checkpoint version %d object size %d, expect %d %d\n",
+         header.version, header.obj_struct_size, CACHE_STATE_VERSION,
+         (int)sizeof(cache_obj_t));
+    return false;
+  }
+
+  if (!cache_load_state_base(cache, ifile)) return false;
+
+  if (reader != NULL) {
+    if (header.n_read_req < 0) {
+      WARN("checkpoint does not have the reader position\n");
+      return false;
+    }
+    return _restore_reader_pos(reader, &header);
+  }
+
+  return true;
+}
+
 /**
  * @brief whether the request can be inserted into cache
  *
@@ -195,7 +531,9 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req,
 #endif
 
     if (update_cache) {
+#ifndef COMPACT_CACHE_OBJ
       cache_obj->misc.next_access_vtime = req->next_access_vtime;
+#endif
       cache_obj->misc.freq += 1;
     }
   }
@@ -253,6 +591,49 @@ bool cache_get_base(cache_t *cache, const request_t *req) {
   return hit;
 }
 
+#define GET_BATCH_PREFETCH_WINDOW 8
+
+/**
+ * @brief serve a batch of requests in order
+ *
+ * the requests are processed in windows, when a window is processed, the hash
+ * buckets of the next window are prefetched, and the first object in the
+ * buckets of the current window (whose buckets were prefetched when processing
+ * the previous window) are prefetched, so that the pointer chasing in the hash
+ * table does not stall on cache misses when the working set is large.
+ * Prefetching does not change the cache state, so the result is the same as
+ * calling cache->get on each request
+ *
+ * @param cache
+ * @param reqs
+ * @param n_req
+ * @param hits if not NULL, hits[i] is set to whether reqs[i] is a hit
+ * @return the number of hits
+ */
+int64_t cache_get_batch_default(cache_t *cache, const request_t *reqs,
+                                const int n_req, bool *hits) {
+  int64_t n_hit = 0;
+
+  hashtable_prefetch(cache->hashtable, reqs,
+                     MIN(n_req, GET_BATCH_PREFETCH_WINDOW), false);
+  for (int start = 0; start < n_req; start += GET_BATCH_PREFETCH_WINDOW) {
+    int n = MIN(n_req - start, GET_BATCH_PREFETCH_WINDOW);
+    int n_next = MIN(n_req - start - n, GET_BATCH_PREFETCH_WINDOW);
+    hashtable_prefetch(cache->hashtable, reqs + start, n, true);
+    if (n_next > 0) {
+      hashtable_prefetch(cache->hashtable, reqs + start + n, n_next, false);
+    }
+
+    for (int i = start; i < start + n; i++) {
+      bool hit = cache->get(cache, &reqs[i]);
+      n_hit += hit;
+      if (hits != NULL) hits[i] = hit;
+    }
+  }
+
+  return n_hit;
+}
+
 /**
  * @brief this function is called by all caches to
  * insert an object into the cache, update the hash table and cache metadata
@@ -265,6 +646,9 @@ bool cache_get_base(cache_t *cache, const request_t *req) {
  */
 cache_obj_t *cache_insert_base(cache_t *cache, const request_t *req) {
   cache_obj_t *cache_obj = hashtable_insert(cache->hashtable, req);
+  if (cache->obj_sampler != NULL) {
+    obj_sampler_add(cache->obj_sampler, cache_obj);
+  }
   cache->occupied_byte +=
       (int64_t)cache_obj->obj_size + (int64_t)cache->obj_md_size;
   cache->n_obj += 1;
@@ -280,7 +664,9 @@ cache_obj_t *cache_insert_base(cache_t *cache, const request_t *req) {
   cache_obj->create_time = CURR_TIME(cache, req);
 #endif
 
+#ifndef COMPACT_CACHE_OBJ
   cache_obj->misc.next_access_vtime = req->next_access_vtime;
+#endif
   cache_obj->misc.freq = 0;
 
   return cache_obj;
@@ -330,6 +716,9 @@ void cache_remove_obj_base(cache_t *cache, cache_obj_t *obj,
   cache->occupied_byte -= (obj->obj_size + cache->obj_md_size);
   cache->n_obj -= 1;
   if (remove_from_hashtable) {
+    if (cache->obj_sampler != NULL) {
+      obj_sampler_remove(cache->obj_sampler, obj);
+    }
     hashtable_delete(cache->hashtable, obj);
   }
 }
@@ -4,6 +4,7 @@
 #include <gmodule.h>
 
 #include "../include/libCacheSim/cacheObj.h"
+#include "../dataStructure/hash/hash.h"
 #include "../include/libCacheSim/macro.h"
 #include "../include/libCacheSim/request.h"
 
@@ -15,8 +16,12 @@
 void copy_cache_obj_to_request(request_t *req_dest,
                                const cache_obj_t *cache_obj) {
   req_dest->obj_id = cache_obj->obj_id;
+  req_dest->hv = cache_obj->hv;
+  req_dest->hv_obj_id = cache_obj->obj_id;
   req_dest->obj_size = cache_obj->obj_size;
+#ifndef COMPACT_CACHE_OBJ
   req_dest->next_access_vtime = cache_obj->misc.next_access_vtime;
+#endif
   req_dest->valid = true;
 }
 
@@ -26,6 +31,9 @@ void copy_cache_obj_to_request(request_t *req_dest,
  * @param req
  */
 void copy_request_to_cache_obj(cache_obj_t *cache_obj, const request_t *req) {
+#ifdef COMPACT_CACHE_OBJ
+  DEBUG_ASSERT(req->obj_size <= UINT32_MAX);
+#endif
   cache_obj->obj_size = req->obj_size;
 #ifdef SUPPORT_TTL
   if (req->ttl != 0)
@@ -34,6 +42,7 @@ void copy_request_to_cache_obj(cache_obj_t *cache_obj, const request_t *req) {
     cache_obj->exp_time = 0;
 #endif
   cache_obj->obj_id = req->obj_id;
+  cache_obj->hv = get_req_hash_value(req);
 }
 
 /**
@@ -57,22 +66,24 @@ cache_obj_t *create_cache_obj_from_request(const request_t *req) {
 void remove_obj_from_list(cache_obj_t **head, cache_obj_t **tail,
                           cache_obj_t *cache_obj) {
   if (head != NULL && cache_obj == *head) {
-    *head = cache_obj->queue.next;
-    if (cache_obj->queue.next != NULL) cache_obj->queue.next->queue.prev = NULL;
+    *head = obj_queue_next(cache_obj);
+    if (obj_queue_next(cache_obj) != NULL)
+      set_obj_queue_prev(obj_queue_next(cache_obj), NULL);
   }
   if (tail != NULL && cache_obj == *tail) {
-    *tail = cache_obj->queue.prev;
-    if (cache_obj->queue.prev != NULL) cache_obj->queue.prev->queue.next = NULL;
+    *tail = obj_queue_prev(cache_obj);
+    if (obj_queue_prev(cache_obj) != NULL)
+      set_obj_queue_next(obj_queue_prev(cache_obj), NULL);
   }
 
-  if (cache_obj->queue.prev != NULL)
-    cache_obj->queue.prev->queue.next = cache_obj->queue.next;
+  if (obj_queue_prev(cache_obj) != NULL)
+    set_obj_queue_next(obj_queue_prev(cache_obj), obj_queue_next(cache_obj));
 
-  if (cache_obj->queue.next != NULL)
-    cache_obj->queue.next->queue.prev = cache_obj->queue.prev;
+  if (obj_queue_next(cache_obj) != NULL)
+    set_obj_queue_prev(obj_queue_next(cache_obj), obj_queue_prev(cache_obj));
 
-  cache_obj->queue.prev = NULL;
-  cache_obj->queue.next = NULL;
+  set_obj_queue_prev(cache_obj, NULL);
+  set_obj_queue_next(cache_obj, NULL);
 }
 
 /**
@@ -86,19 +97,19 @@ void move_obj_to_tail(cache_obj_t **head, cache_obj_t **tail,
   if (*head == *tail) {
     // the list only has one element
     assert(cache_obj == *head);
-    assert(cache_obj->queue.next == NULL);
-    assert(cache_obj->queue.prev == NULL);
+    assert(obj_queue_next(cache_obj) == NULL);
+    assert(obj_queue_prev(cache_obj) == NULL);
     return;
   }
   if (cache_obj == *head) {
     // change head
-    *head = cache_obj->queue.next;
-    cache_obj->queue.next->queue.prev = NULL;
+    *head = obj_queue_next(cache_obj);
+    set_obj_queue_prev(obj_queue_next(cache_obj), NULL);
 
     // move to tail
-    (*tail)->queue.next = cache_obj;
-    cache_obj->queue.next = NULL;
-    cache_obj->queue.prev = *tail;
+    set_obj_queue_next(*tail, cache_obj);
+    set_obj_queue_next(cache_obj, NULL);
+    set_obj_queue_prev(cache_obj, *tail);
     *tail = cache_obj;
     return;
   }
@@ -107,15 +118,15 @@ void move_obj_to_tail(cache_obj_t **head, cache_obj_t **tail,
   }
 
   // bridge list_prev and next
-  cache_obj->queue.prev->queue.next = cache_obj->queue.next;
-  cache_obj->queue.next->queue.prev = cache_obj->queue.prev;
+  set_obj_queue_next(obj_queue_prev(cache_obj), obj_queue_next(cache_obj));
+  set_obj_queue_prev(obj_queue_next(cache_obj), obj_queue_prev(cache_obj));
 
   // handle current tail
-  (*tail)->queue.next = cache_obj;
+  set_obj_queue_next(*tail, cache_obj);
 
   // handle this moving object
-  cache_obj->queue.next = NULL;
-  cache_obj->queue.prev = *tail;
+  set_obj_queue_next(cache_obj, NULL);
+  set_obj_queue_prev(cache_obj, *tail);
 
   // handle tail
   *tail = cache_obj;
@@ -134,8 +145,8 @@ void move_obj_to_head(cache_obj_t **head, cache_obj_t **tail,
   if (tail != NULL && *head == *tail) {
     // the list only has one element
     DEBUG_ASSERT(cache_obj == *head);
-    DEBUG_ASSERT(cache_obj->queue.next == NULL);
-    DEBUG_ASSERT(cache_obj->queue.prev == NULL);
+    DEBUG_ASSERT(obj_queue_next(cache_obj) == NULL);
+    DEBUG_ASSERT(obj_queue_prev(cache_obj) == NULL);
     return;
   }
 
@@ -146,27 +157,27 @@ void move_obj_to_head(cache_obj_t **head, cache_obj_t **tail,
 
   if (tail != NULL && cache_obj == *tail) {
     // change tail
-    cache_obj->queue.prev->queue.next = cache_obj->queue.next;
-    *tail = cache_obj->queue.prev;
+    set_obj_queue_next(obj_queue_prev(cache_obj), obj_queue_next(cache_obj));
+    *tail = obj_queue_prev(cache_obj);
 
     // move to head
-    (*head)->queue.prev = cache_obj;
-    cache_obj->queue.prev = NULL;
-    cache_obj->queue.next = *head;
+    set_obj_queue_prev(*head, cache_obj);
+    set_obj_queue_prev(cache_obj, NULL);
+    set_obj_queue_next(cache_obj, *head);
     *head = cache_obj;
     return;
   }
 
   // bridge list_prev and next
-  cache_obj->queue.prev->queue.next = cache_obj->queue.next;
-  cache_obj->queue.next->queue.prev = cache_obj->queue.prev;
+  set_obj_queue_next(obj_queue_prev(cache_obj), obj_queue_next(cache_obj));
+  set_obj_queue_prev(obj_queue_next(cache_obj), obj_queue_prev(cache_obj));
 
   // handle current head
-  (*head)->queue.prev = cache_obj;
+  set_obj_queue_prev(*head, cache_obj);
 
   // handle this moving object
-  cache_obj->queue.prev = NULL;
-  cache_obj->queue.next = *head;
+  set_obj_queue_prev(cache_obj, NULL);
+  set_obj_queue_next(cache_obj, *head);
 
   // handle head
   *head = cache_obj;
@@ -183,8 +194,8 @@ void prepend_obj_to_head(cache_obj_t **head, cache_obj_t **tail,
                          cache_obj_t *cache_obj) {
   assert(head != NULL);
 
-  cache_obj->queue.prev = NULL;
-  cache_obj->queue.next = *head;
+  set_obj_queue_prev(cache_obj, NULL);
+  set_obj_queue_next(cache_obj, *head);
 
   if (tail != NULL && *tail == NULL) {
     // the list is empty
@@ -194,7 +205,7 @@ void prepend_obj_to_head(cache_obj_t **head, cache_obj_t **tail,
 
   if (*head != NULL) {
     // the list has at least one element
-    (*head)->queue.prev = cache_obj;
+    set_obj_queue_prev(*head, cache_obj);
   }
 
   *head = cache_obj;
@@ -210,8 +221,8 @@ void prepend_obj_to_head(cache_obj_t **head, cache_obj_t **tail,
 void append_obj_to_tail(cache_obj_t **head, cache_obj_t **tail,
                         cache_obj_t *cache_obj) {
 
-  cache_obj->queue.next = NULL;
-  cache_obj->queue.prev = *tail;
+  set_obj_queue_next(cache_obj, NULL);
+  set_obj_queue_prev(cache_obj, *tail);
 
   if (head != NULL && *head == NULL) {
     // the list is empty
@@ -221,7 +232,7 @@ void append_obj_to_tail(cache_obj_t **head, cache_obj_t **tail,
 
   if (*tail != NULL) {
     // the list has at least one element
-    (*tail)->queue.next = cache_obj;
+    set_obj_queue_next(*tail, cache_obj);
   }
 
 
@@ -111,6 +111,7 @@ cache_t *ARC_init(const common_cache_params_t ccache_params,
   cache->can_insert = cache_can_insert_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
+  cache->obj_eviction_md_size = sizeof(ARC_obj_metadata_t);
 
   if (ccache_params.consider_obj_metadata) {
     // two pointer + ghost metadata
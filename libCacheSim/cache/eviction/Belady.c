@@ -65,6 +65,7 @@ cache_t *Belady_init(const common_cache_params_t ccache_params,
   cache->evict = Belady_evict;
   cache->to_evict = Belady_to_evict;
   cache->remove = Belady_remove;
+  cache->obj_eviction_md_size = sizeof(Belady_obj_metadata_t);
 
   Belady_params_t *params = my_malloc(Belady_params_t);
   cache->eviction_params = params;
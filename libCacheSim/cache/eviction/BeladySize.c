@@ -62,6 +62,8 @@ cache_t *BeladySize_init(const common_cache_params_t ccache_params, const char *
   cache->evict = BeladySize_evict;
   cache->remove = BeladySize_remove;
   cache->to_evict = BeladySize_to_evict;
+  cache->obj_eviction_md_size = sizeof(Belady_obj_metadata_t);
+  cache_enable_obj_sampler(cache, offsetof(cache_obj_t, Belady.sample_pos));
 
   BeladySize_params_t *params = (BeladySize_params_t *)malloc(sizeof(BeladySize_params_t));
   cache->eviction_params = params;
@@ -210,7 +212,7 @@ static cache_obj_t *BeladySize_to_evict(cache_t *cache, const request_t *req) {
   cache_obj_t *obj_to_evict = NULL, *sampled_obj;
   double obj_to_evict_score = -1, sampled_obj_score;
   for (int i = 0; i < params->n_sample; i++) {
-    sampled_obj = hashtable_rand_obj(cache->hashtable);
+    sampled_obj = cache_rand_obj(cache);
     sampled_obj_score =
         log((double)sampled_obj->obj_size) + log((double)(sampled_obj->Belady.next_access_vtime - cache->n_req));
     if (obj_to_evict_score < sampled_obj_score) {
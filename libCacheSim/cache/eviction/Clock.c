@@ -29,6 +29,7 @@ static const char *DEFAULT_PARAMS = "init-freq=0,n-bit-counter=1";
 // ***********************************************************************
 
 static void Clock_parse_params(cache_t *cache, const char *cache_specific_params);
+static void Clock_update_params(cache_t *cache, const char *cache_specific_params);
 static void Clock_free(cache_t *cache);
 static bool Clock_get(cache_t *cache, const request_t *req);
 static cache_obj_t *Clock_find(cache_t *cache, const request_t *req, const bool update_cache);
@@ -36,6 +37,8 @@ static cache_obj_t *Clock_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *Clock_to_evict(cache_t *cache, const request_t *req);
 static void Clock_evict(cache_t *cache, const request_t *req);
 static bool Clock_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Clock_dump_state(const cache_t *cache, FILE *ofile);
+static bool Clock_load_state(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -62,7 +65,11 @@ cache_t *Clock_init(const common_cache_params_t ccache_params, const char *cache
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = Clock_to_evict;
+  cache->update_params = Clock_update_params;
+  cache->dump_state = Clock_dump_state;
+  cache->load_state = Clock_load_state;
   cache->obj_md_size = 0;
+  cache->obj_eviction_md_size = sizeof(Clock_obj_metadata_t);
 
 #ifdef USE_BELADY
   snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "Clock_Belady");
@@ -88,6 +95,24 @@ cache_t *Clock_init(const common_cache_params_t ccache_params, const char *cache
   return cache;
 }
 
+/**
+ * @brief change the parameters of a Clock cache that is in use,
+ * the cached objects keep their frequency, which decays as the hand passes
+ *
+ * @param cache
+ * @param cache_specific_params
+ */
+static void Clock_update_params(cache_t *cache, const char *cache_specific_params) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  Clock_parse_params(cache, cache_specific_params);
+
+  if (params->n_bit_counter != 1) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "Clock-%d-%d", params->n_bit_counter, params->init_freq);
+  } else {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "Clock");
+  }
+}
+
 /**
  * free resources used by this cache
  *
@@ -194,7 +219,7 @@ static cache_obj_t *Clock_to_evict(cache_t *cache, const request_t *req) {
 #else
   while (obj_to_evict->clock.freq - n_round >= 1) {
 #endif
-    obj_to_evict = obj_to_evict->queue.prev;
+    obj_to_evict = obj_queue_prev(obj_to_evict);
     if (obj_to_evict == NULL) {
       obj_to_evict = params->q_tail;
       n_round += 1;
@@ -276,6 +301,35 @@ static bool Clock_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+/**
+ * @brief write the cached objects in the queue order and the rewrite counters
+ * for checkpointing
+ *
+ * @param cache
+ * @param ofile
+ * @return whether the dump is successful
+ */
+static bool Clock_dump_state(const cache_t *cache, FILE *ofile) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  return fwrite(&params->n_obj_rewritten, sizeof(int64_t), 1, ofile) == 1 &&
+         fwrite(&params->n_byte_rewritten, sizeof(int64_t), 1, ofile) == 1 &&
+         cache_dump_obj_queue(cache, params->q_head, ofile);
+}
+
+/**
+ * @brief restore the state written by Clock_dump_state
+ *
+ * @param cache
+ * @param ifile
+ * @return whether the load is successful
+ */
+static bool Clock_load_state(cache_t *cache, FILE *ifile) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  return fread(&params->n_obj_rewritten, sizeof(int64_t), 1, ifile) == 1 &&
+         fread(&params->n_byte_rewritten, sizeof(int64_t), 1, ifile) == 1 &&
+         cache_load_obj_queue(cache, &params->q_head, &params->q_tail, ifile);
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                  parameter set up functions                   ****
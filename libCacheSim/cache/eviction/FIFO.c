@@ -32,6 +32,8 @@ static cache_obj_t *FIFO_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *FIFO_to_evict(cache_t *cache, const request_t *req);
 static void FIFO_evict(cache_t *cache, const request_t *req);
 static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id);
+static bool FIFO_dump_state(const cache_t *cache, FILE *ofile);
+static bool FIFO_load_state(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -60,7 +62,10 @@ cache_t *FIFO_init(const common_cache_params_t ccache_params,
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
   cache->can_insert = cache_can_insert_default;
+  cache->dump_state = FIFO_dump_state;
+  cache->load_state = FIFO_load_state;
   cache->obj_md_size = 0;
+  cache->obj_eviction_md_size = 0;
 
   cache->eviction_params = malloc(sizeof(FIFO_params_t));
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
@@ -175,9 +180,9 @@ static void FIFO_evict(cache_t *cache, const request_t *req) {
   // we chose to do it manually
   // remove_obj_from_list(&params->q_head, &params->q_tail, obj);
 
-  params->q_tail = params->q_tail->queue.prev;
+  params->q_tail = obj_queue_prev(params->q_tail);
   if (likely(params->q_tail != NULL)) {
-    params->q_tail->queue.next = NULL;
+    set_obj_queue_next(params->q_tail, NULL);
   } else {
     /* cache->n_obj has not been updated */
     DEBUG_ASSERT(cache->n_obj == 1);
@@ -214,6 +219,30 @@ static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+/**
+ * @brief write the cached objects in the queue order for checkpointing
+ *
+ * @param cache
+ * @param ofile
+ * @return whether the dump is successful
+ */
+static bool FIFO_dump_state(const cache_t *cache, FILE *ofile) {
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  return cache_dump_obj_queue(cache, params->q_head, ofile);
+}
+
+/**
+ * @brief restore the objects written by FIFO_dump_state
+ *
+ * @param cache
+ * @param ifile
+ * @return whether the load is successful
+ */
+static bool FIFO_load_state(cache_t *cache, FILE *ifile) {
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  return cache_load_obj_queue(cache, &params->q_head, &params->q_tail, ifile);
+}
+
 #ifdef __cplusplus
 }
 #endif
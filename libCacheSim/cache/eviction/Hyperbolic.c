@@ -42,11 +42,7 @@ static bool Hyperbolic_remove(cache_t *cache, const obj_id_t obj_id);
  */
 cache_t *Hyperbolic_init(const common_cache_params_t ccache_params,
                          const char *cache_specific_params) {
-  // reduce hash table size to make sampling faster
-  common_cache_params_t ccache_params_local = ccache_params;
-  ccache_params_local.hashpower = MAX(12, ccache_params_local.hashpower - 8);
-
-  cache_t *cache = cache_struct_init("Hyperbolic", ccache_params_local, cache_specific_params);
+  cache_t *cache = cache_struct_init("Hyperbolic", ccache_params, cache_specific_params);
   cache->cache_init = Hyperbolic_init;
   cache->cache_free = Hyperbolic_free;
   cache->get = Hyperbolic_get;
@@ -55,6 +51,8 @@ cache_t *Hyperbolic_init(const common_cache_params_t ccache_params,
   cache->evict = Hyperbolic_evict;
   cache->remove = Hyperbolic_remove;
   cache->to_evict = Hyperbolic_to_evict;
+  cache->obj_eviction_md_size = sizeof(Hyperbolic_obj_metadata_t);
+  cache_enable_obj_sampler(cache, offsetof(cache_obj_t, hyperbolic.sample_pos));
 
   Hyperbolic_params_t *params = my_malloc(Hyperbolic_params_t);
   params->n_sample = 64;
@@ -169,7 +167,7 @@ static cache_obj_t *Hyperbolic_to_evict(cache_t *cache, const request_t *req) {
   cache_obj_t *best_candidate = NULL, *sampled_obj;
   double best_candidate_score = 1.0e16, sampled_obj_score;
   for (int i = 0; i < params->n_sample; i++) {
-    sampled_obj = hashtable_rand_obj(cache->hashtable);
+    sampled_obj = cache_rand_obj(cache);
     double age =
         (double)(cache->n_req - sampled_obj->hyperbolic.vtime_enter_cache);
     sampled_obj_score = 1.0e8 * (double)sampled_obj->hyperbolic.freq / age;
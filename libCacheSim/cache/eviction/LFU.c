@@ -84,6 +84,7 @@ cache_t *LFU_init(const common_cache_params_t ccache_params,
   cache->evict = LFU_evict;
   cache->remove = LFU_remove;
   cache->to_evict = LFU_to_evict;
+  cache->obj_eviction_md_size = sizeof(LFU_obj_metadata_t);
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
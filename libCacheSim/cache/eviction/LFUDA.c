@@ -67,6 +67,7 @@ cache_t *LFUDA_init(const common_cache_params_t ccache_params,
   cache->evict = LFUDA_evict;
   cache->remove = LFUDA_remove;
   cache->to_evict = LFUDA_to_evict;
+  cache->obj_eviction_md_size = sizeof(LFU_obj_metadata_t);
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
@@ -33,6 +33,8 @@ static cache_obj_t *LRU_to_evict(cache_t *cache, const request_t *req);
 static void LRU_evict(cache_t *cache, const request_t *req);
 static bool LRU_remove(cache_t *cache, const obj_id_t obj_id);
 static void LRU_print_cache(const cache_t *cache);
+static bool LRU_dump_state(const cache_t *cache, FILE *ofile);
+static bool LRU_load_state(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -62,6 +64,9 @@ cache_t *LRU_init(const common_cache_params_t ccache_params,
   cache->can_insert = cache_can_insert_default;
   cache->get_n_obj = cache_get_n_obj_default;
   cache->print_cache = LRU_print_cache;
+  cache->dump_state = LRU_dump_state;
+  cache->load_state = LRU_load_state;
+  cache->obj_eviction_md_size = 0;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
@@ -197,9 +202,9 @@ static void LRU_evict(cache_t *cache, const request_t *req) {
   // we chose to do it manually
   // remove_obj_from_list(&params->q_head, &params->q_tail, obj)
 
-  params->q_tail = params->q_tail->queue.prev;
+  params->q_tail = obj_queue_prev(params->q_tail);
   if (likely(params->q_tail != NULL)) {
-    params->q_tail->queue.next = NULL;
+    set_obj_queue_next(params->q_tail, NULL);
   } else {
     /* cache->n_obj has not been updated */
     DEBUG_ASSERT(cache->n_obj == 1);
@@ -275,11 +280,35 @@ static void LRU_print_cache(const cache_t *cache) {
   }
   while (cur != NULL) {
     printf("%lu->", (unsigned long)cur->obj_id);
-    cur = cur->queue.next;
+    cur = obj_queue_next(cur);
   }
   printf("END\n");
 }
 
+/**
+ * @brief write the cached objects in the queue order for checkpointing
+ *
+ * @param cache
+ * @param ofile
+ * @return whether the dump is successful
+ */
+static bool LRU_dump_state(const cache_t *cache, FILE *ofile) {
+  LRU_params_t *params = (LRU_params_t *)cache->eviction_params;
+  return cache_dump_obj_queue(cache, params->q_head, ofile);
+}
+
+/**
+ * @brief restore the state written by LRU_dump_state
+ *
+ * @param cache
+ * @param ifile
+ * @return whether the load is successful
+ */
+static bool LRU_load_state(cache_t *cache, FILE *ifile) {
+  LRU_params_t *params = (LRU_params_t *)cache->eviction_params;
+  return cache_load_obj_queue(cache, &params->q_head, &params->q_tail, ifile);
+}
+
 #ifdef __cplusplus
 }
 #endif
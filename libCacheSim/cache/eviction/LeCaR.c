@@ -63,6 +63,8 @@ static void free_freq_node(void *list_node) {
 
 static void LeCaR_parse_params(cache_t *cache,
                                const char *cache_specific_params);
+static void LeCaR_update_params(cache_t *cache,
+                                const char *cache_specific_params);
 static void LeCaR_free(cache_t *cache);
 static bool LeCaR_get(cache_t *cache, const request_t *req);
 static cache_obj_t *LeCaR_find(cache_t *cache, const request_t *req,
@@ -115,6 +117,7 @@ cache_t *LeCaR_init(const common_cache_params_t ccache_params,
   cache->evict = LeCaR_evict;
   cache->remove = LeCaR_remove;
   cache->to_evict = LeCaR_to_evict;
+  cache->update_params = LeCaR_update_params;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2 + 8 * 2 + 8;  // LRU chain, LFU chain, history
@@ -164,6 +167,24 @@ cache_t *LeCaR_init(const common_cache_params_t ccache_params,
   return cache;
 }
 
+/**
+ * @brief change the parameters of a LeCaR cache that is in use, the learned
+ * weights are kept unless lru-weight is given
+ *
+ * @param cache
+ * @param cache_specific_params
+ */
+static void LeCaR_update_params(cache_t *cache,
+                                const char *cache_specific_params) {
+  LeCaR_params_t *params = (LeCaR_params_t *)(cache->eviction_params);
+  LeCaR_parse_params(cache, cache_specific_params);
+
+  if (!params->update_weight) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "LeCaR-%.4lflru",
+             params->w_lru);
+  }
+}
+
 /**
  * free resources used by this cache
  *
@@ -45,11 +45,8 @@ static bool Random_remove(cache_t *cache, const obj_id_t obj_id);
  */
 cache_t *Random_init(const common_cache_params_t ccache_params,
                      const char *cache_specific_params) {
-  common_cache_params_t ccache_params_copy = ccache_params;
-  ccache_params_copy.hashpower = MAX(12, ccache_params_copy.hashpower - 8);
-
   cache_t *cache =
-      cache_struct_init("Random", ccache_params_copy, cache_specific_params);
+      cache_struct_init("Random", ccache_params, cache_specific_params);
   cache->cache_init = Random_init;
   cache->cache_free = Random_free;
   cache->get = Random_get;
@@ -58,6 +55,8 @@ cache_t *Random_init(const common_cache_params_t ccache_params,
   cache->to_evict = Random_to_evict;
   cache->evict = Random_evict;
   cache->remove = Random_remove;
+  cache->obj_eviction_md_size = sizeof(Random_obj_metadata_t);
+  cache_enable_obj_sampler(cache, offsetof(cache_obj_t, Random.sample_pos));
 
   return cache;
 }
@@ -138,7 +137,7 @@ static cache_obj_t *Random_insert(cache_t *cache, const request_t *req) {
  * @return the object to be evicted
  */
 static cache_obj_t *Random_to_evict(cache_t *cache, const request_t *req) {
-  return hashtable_rand_obj(cache->hashtable);
+  return cache_rand_obj(cache);
 }
 
 /**
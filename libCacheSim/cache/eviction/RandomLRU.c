@@ -53,10 +53,7 @@ static void RandomLRU_parse_params(cache_t *cache, const char *cache_specific_pa
  * @param cache_specific_params RandomLRU specific parameters, should be NULL
  */
 cache_t *RandomLRU_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
-  common_cache_params_t ccache_params_copy = ccache_params;
-  ccache_params_copy.hashpower = MAX(12, ccache_params_copy.hashpower - 8);
-
-  cache_t *cache = cache_struct_init("RandomLRU", ccache_params_copy, cache_specific_params);
+  cache_t *cache = cache_struct_init("RandomLRU", ccache_params, cache_specific_params);
   cache->cache_init = RandomLRU_init;
   cache->cache_free = RandomLRU_free;
   cache->get = RandomLRU_get;
@@ -65,6 +62,8 @@ cache_t *RandomLRU_init(const common_cache_params_t ccache_params, const char *c
   cache->to_evict = RandomLRU_to_evict;
   cache->evict = RandomLRU_evict;
   cache->remove = RandomLRU_remove;
+  cache->obj_eviction_md_size = sizeof(Random_obj_metadata_t);
+  cache_enable_obj_sampler(cache, offsetof(cache_obj_t, Random.sample_pos));
 
   cache->eviction_params = (RandomLRU_params_t *)malloc(sizeof(RandomLRU_params_t));
   RandomLRU_params_t *params = (RandomLRU_params_t *)(cache->eviction_params);
@@ -202,7 +201,7 @@ static void RandomLRU_evict(cache_t *cache, const request_t *req) {
   const int N = 64;
   cache_obj_t *obj_to_evict[N];
   for (int i = 0; i < N; i++) {
-    obj_to_evict[i] = hashtable_rand_obj(cache->hashtable);
+    obj_to_evict[i] = cache_rand_obj(cache);
   }
   qsort(obj_to_evict, N, sizeof(cache_obj_t *), compare_access_time);
   cache_evict_base(cache, obj_to_evict[0], true);
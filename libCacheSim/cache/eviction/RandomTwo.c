@@ -46,11 +46,8 @@ static bool RandomTwo_remove(cache_t *cache, const obj_id_t obj_id);
  */
 cache_t *RandomTwo_init(const common_cache_params_t ccache_params,
                         const char *cache_specific_params) {
-  common_cache_params_t ccache_params_copy = ccache_params;
-  ccache_params_copy.hashpower = MAX(12, ccache_params_copy.hashpower - 8);
-
   cache_t *cache =
-      cache_struct_init("RandomTwo", ccache_params_copy, cache_specific_params);
+      cache_struct_init("RandomTwo", ccache_params, cache_specific_params);
   cache->cache_init = RandomTwo_init;
   cache->cache_free = RandomTwo_free;
   cache->get = RandomTwo_get;
@@ -59,6 +56,8 @@ cache_t *RandomTwo_init(const common_cache_params_t ccache_params,
   cache->to_evict = RandomTwo_to_evict;
   cache->evict = RandomTwo_evict;
   cache->remove = RandomTwo_remove;
+  cache->obj_eviction_md_size = sizeof(Random_obj_metadata_t);
+  cache_enable_obj_sampler(cache, offsetof(cache_obj_t, Random.sample_pos));
 
   return cache;
 }
@@ -147,8 +146,8 @@ static cache_obj_t *RandomTwo_insert(cache_t *cache, const request_t *req) {
  * @return the object to be evicted
  */
 static cache_obj_t *RandomTwo_to_evict(cache_t *cache, const request_t *req) {
-  cache_obj_t *obj_to_evict1 = hashtable_rand_obj(cache->hashtable);
-  cache_obj_t *obj_to_evict2 = hashtable_rand_obj(cache->hashtable);
+  cache_obj_t *obj_to_evict1 = cache_rand_obj(cache);
+  cache_obj_t *obj_to_evict2 = cache_rand_obj(cache);
   if (obj_to_evict1->Random.last_access_vtime <
       obj_to_evict2->Random.last_access_vtime)
     return obj_to_evict1;
@@ -165,8 +164,8 @@ static cache_obj_t *RandomTwo_to_evict(cache_t *cache, const request_t *req) {
  * @param req not used
  */
 static void RandomTwo_evict(cache_t *cache, const request_t *req) {
-  cache_obj_t *obj_to_evict1 = hashtable_rand_obj(cache->hashtable);
-  cache_obj_t *obj_to_evict2 = hashtable_rand_obj(cache->hashtable);
+  cache_obj_t *obj_to_evict1 = cache_rand_obj(cache);
+  cache_obj_t *obj_to_evict2 = cache_rand_obj(cache);
   if (obj_to_evict1->Random.last_access_vtime <
       obj_to_evict2->Random.last_access_vtime)
     cache_evict_base(cache, obj_to_evict1, true);
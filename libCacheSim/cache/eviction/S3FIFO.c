@@ -67,6 +67,8 @@ static inline int64_t S3FIFO_get_occupied_byte(const cache_t *cache);
 static inline int64_t S3FIFO_get_n_obj(const cache_t *cache);
 static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req);
 static void S3FIFO_parse_params(cache_t *cache, const char *cache_specific_params);
+static bool S3FIFO_dump_state(const cache_t *cache, FILE *ofile);
+static bool S3FIFO_load_state(cache_t *cache, FILE *ifile);
 
 static void S3FIFO_evict_small(cache_t *cache, const request_t *req);
 static void S3FIFO_evict_main(cache_t *cache, const request_t *req);
@@ -90,6 +92,8 @@ cache_t *S3FIFO_init(const common_cache_params_t ccache_params, const char *cach
   cache->get_n_obj = S3FIFO_get_n_obj;
   cache->get_occupied_byte = S3FIFO_get_occupied_byte;
   cache->can_insert = S3FIFO_can_insert;
+  cache->dump_state = S3FIFO_dump_state;
+  cache->load_state = S3FIFO_load_state;
 
   cache->obj_md_size = 0;
 
@@ -403,6 +407,45 @@ static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req) {
   return req->obj_size <= params->small_fifo->cache_size && cache_can_insert_default(cache, req);
 }
 
+/**
+ * @brief write the small, main and ghost FIFOs for checkpointing, the
+ * per-object S3FIFO metadata is kept in the objects of the sub-caches
+ *
+ * @param cache
+ * @param ofile
+ * @return whether the dump is successful
+ */
+static bool S3FIFO_dump_state(const cache_t *cache, FILE *ofile) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+  bool success = fwrite(&params->has_evicted, sizeof(bool), 1, ofile) == 1 &&
+                 cache_dump_state_base(params->small_fifo, ofile) &&
+                 cache_dump_state_base(params->main_fifo, ofile);
+  if (success && params->ghost_fifo != NULL) {
+    success = cache_dump_state_base(params->ghost_fifo, ofile);
+  }
+
+  return success;
+}
+
+/**
+ * @brief restore the state written by S3FIFO_dump_state
+ *
+ * @param cache
+ * @param ifile
+ * @return whether the load is successful
+ */
+static bool S3FIFO_load_state(cache_t *cache, FILE *ifile) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+  bool success = fread(&params->has_evicted, sizeof(bool), 1, ifile) == 1 &&
+                 cache_load_state_base(params->small_fifo, ifile) &&
+                 cache_load_state_base(params->main_fifo, ifile);
+  if (success && params->ghost_fifo != NULL) {
+    success = cache_load_state_base(params->ghost_fifo, ifile);
+  }
+
+  return success;
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                parameter set up functions                     ****
@@ -113,6 +113,7 @@ cache_t *SLRU_init(const common_cache_params_t ccache_params,
   cache->remove = SLRU_remove;
   cache->to_evict = SLRU_to_evict;
   cache->can_insert = SLRU_can_insert;
+  cache->obj_eviction_md_size = sizeof(SLRU_obj_metadata_t);
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
@@ -27,6 +27,8 @@ static cache_obj_t *Sieve_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *Sieve_to_evict(cache_t *cache, const request_t *req);
 static void Sieve_evict(cache_t *cache, const request_t *req);
 static bool Sieve_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Sieve_dump_state(const cache_t *cache, FILE *ofile);
+static bool Sieve_load_state(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -54,6 +56,9 @@ cache_t *Sieve_init(const common_cache_params_t ccache_params,
   cache->evict = Sieve_evict;
   cache->remove = Sieve_remove;
   cache->to_evict = Sieve_to_evict;
+  cache->dump_state = Sieve_dump_state;
+  cache->load_state = Sieve_load_state;
+  cache->obj_eviction_md_size = sizeof(Sieve_obj_params_t);
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 1;
@@ -173,14 +178,14 @@ static cache_obj_t *Sieve_to_evict_with_freq(cache_t *cache,
 
   /* find the first untouched */
   while (pointer != NULL && pointer->sieve.freq > to_evict_freq) {
-    pointer = pointer->queue.prev;
+    pointer = obj_queue_prev(pointer);
   }
 
   /* if we have finished one around, start from the tail */
   if (pointer == NULL) {
     pointer = params->q_tail;
     while (pointer != NULL && pointer->sieve.freq > to_evict_freq) {
-      pointer = pointer->queue.prev;
+      pointer = obj_queue_prev(pointer);
     }
   }
 
@@ -223,10 +228,10 @@ static void Sieve_evict(cache_t *cache, const request_t *req) {
 
   while (obj->sieve.freq > 0) {
     obj->sieve.freq -= 1;
-    obj = obj->queue.prev == NULL ? params->q_tail : obj->queue.prev;
+    obj = obj_queue_prev(obj) == NULL ? params->q_tail : obj_queue_prev(obj);
   }
 
-  params->pointer = obj->queue.prev;
+  params->pointer = obj_queue_prev(obj);
   remove_obj_from_list(&params->q_head, &params->q_tail, obj);
   cache_evict_base(cache, obj, true);
 }
@@ -235,7 +240,7 @@ static void Sieve_remove_obj(cache_t *cache, cache_obj_t *obj_to_remove) {
   DEBUG_ASSERT(obj_to_remove != NULL);
   Sieve_params_t *params = cache->eviction_params;
   if (obj_to_remove == params->pointer) {
-    params->pointer = obj_to_remove->queue.prev;
+    params->pointer = obj_queue_prev(obj_to_remove);
   }
   remove_obj_from_list(&params->q_head, &params->q_tail, obj_to_remove);
   cache_remove_obj_base(cache, obj_to_remove, true);
@@ -265,6 +270,57 @@ static bool Sieve_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+/**
+ * @brief write the cached objects in the queue order and the position of the
+ * hand for checkpointing
+ *
+ * @param cache
+ * @param ofile
+ * @return whether the dump is successful
+ */
+static bool Sieve_dump_state(const cache_t *cache, FILE *ofile) {
+  Sieve_params_t *params = cache->eviction_params;
+  /* the hand is stored as its position from the head, -1 if not set */
+  int64_t pointer_pos = -1, pos = 0;
+  for (cache_obj_t *obj = params->q_head; obj != NULL;
+       obj = obj_queue_next(obj)) {
+    if (obj == params->pointer) {
+      pointer_pos = pos;
+      break;
+    }
+    pos++;
+  }
+
+  return fwrite(&pointer_pos, sizeof(pointer_pos), 1, ofile) == 1 &&
+         cache_dump_obj_queue(cache, params->q_head, ofile);
+}
+
+/**
+ * @brief restore the state written by Sieve_dump_state
+ *
+ * @param cache
+ * @param ifile
+ * @return whether the load is successful
+ */
+static bool Sieve_load_state(cache_t *cache, FILE *ifile) {
+  Sieve_params_t *params = cache->eviction_params;
+  int64_t pointer_pos;
+  if (fread(&pointer_pos, sizeof(pointer_pos), 1, ifile) != 1 ||
+      !cache_load_obj_queue(cache, &params->q_head, &params->q_tail, ifile)) {
+    return false;
+  }
+
+  params->pointer = NULL;
+  if (pointer_pos >= 0) {
+    params->pointer = params->q_head;
+    for (int64_t i = 0; i < pointer_pos && params->pointer != NULL; i++) {
+      params->pointer = obj_queue_next(params->pointer);
+    }
+  }
+
+  return true;
+}
+
 static void Sieve_verify(cache_t *cache) {
   Sieve_params_t *params = cache->eviction_params;
   int64_t n_obj = 0, n_byte = 0;
@@ -274,7 +330,7 @@ static void Sieve_verify(cache_t *cache) {
     assert(hashtable_find_obj_id(cache->hashtable, obj->obj_id) != NULL);
     n_obj++;
     n_byte += obj->obj_size;
-    obj = obj->queue.next;
+    obj = obj_queue_next(obj);
   }
 
   assert(n_obj == cache->get_n_obj(cache));
@@ -63,6 +63,7 @@ cache_t *Size_init(const common_cache_params_t ccache_params,
   cache->evict = Size_evict;
   cache->to_evict = Size_to_evict;
   cache->remove = Size_remove;
+  cache->obj_eviction_md_size = sizeof(Size_obj_metadata_t);
 
   Size_params_t *params = my_malloc(Size_params_t);
   cache->eviction_params = params;
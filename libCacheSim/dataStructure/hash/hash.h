@@ -52,6 +52,12 @@ typedef enum{
   #error "unknown hash"
 #endif
 
+/* the hash value of the obj_id of a request, reuse the hash value computed by
+ * the reader if it is computed for the current obj_id */
+#define get_req_hash_value(req)                                  \
+  ((req)->hv != 0 && (req)->hv_obj_id == (req)->obj_id ? (req)->hv \
+                                                      : (uint64_t)get_hash_value_int_64(&(req)->obj_id))
+
 //(size_t) XXH64(src, srcSize, 0)
 //(size_t) XXH3_64bits(src, srcSize)
 
@@ -0,0 +1,428 @@
+//
+// a chained hash table that chains buckets of object pointers instead of
+// objects, each bucket is one cache line
+//
+// |--------------------------------------------------------------------|
+// | item | item | item | item | item | item | item | next | ----> bucket
+// |--------------------------------------------------------------------|
+// | item | item | item |  0   |  0   |  0   |  0   |  0   |
+// |--------------------------------------------------------------------|
+//
+// each item is a 16-bit tag (from the hash value) and a 48-bit pointer to
+// cache_obj_t packed in 8 bytes, a lookup reads the tags in the bucket and only
+// dereferences the objects with matching tags, so finding an object usually
+// costs one cache miss on the bucket and one on the object, compared to one
+// cache miss per object in the chain of chainedHashTableV2.
+//
+// when the items in a bucket are full, an overflow bucket is allocated and
+// linked from the last slot, overflow buckets are only freed when the table is
+// resized. The objects are not moved in memory, so the pointers to the objects
+// stay valid, which is the same as chainedHashTableV2.
+//
+// hashpower is the log2 of the number of slots, so the first-level table uses
+// the same amount of memory as chainedHashTableV2 with the same hashpower
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bulkChainingHashTable.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../../utils/include/mymath.h"
+#include "../hash/hash.h"
+
+#define CACHE_LINE_SIZE 64
+/* the number of slots in one bucket, 8 * 8 B = one cache line */
+#define N_SLOT_PER_BUCKET 8
+#define N_SLOT_PER_BUCKET_IN_BITS 3
+/* the last slot stores the pointer to the next bucket */
+#define N_ITEM_PER_BUCKET (N_SLOT_PER_BUCKET - 1)
+#define NEXT_BUCKET_SLOT (N_SLOT_PER_BUCKET - 1)
+#define MIN_HASHPOWER N_SLOT_PER_BUCKET_IN_BITS
+
+/* user-space pointers on x86-64 and aarch64 use at most 48 bits */
+#define TAG_SHIFT 48
+#define PTR_MASK ((1ULL << TAG_SHIFT) - 1)
+
+/* expand when there are on average 4 objects in a bucket of 7 items, with
+ * which about 5% of buckets need an overflow bucket */
+#define EXPAND_LOAD 0.5
+
+typedef struct bulk_bucket {
+  uint64_t slots[N_SLOT_PER_BUCKET];
+} __attribute__((aligned(CACHE_LINE_SIZE))) bulk_bucket_t;
+
+static void _bulk_chaining_hashtable_resize(hashtable_t *hashtable,
+                                            uint16_t new_hashpower);
+
+/************************ helper func ************************/
+static inline uint64_t _n_bucket(const hashtable_t *hashtable) {
+  return hashsize(hashtable->hashpower - N_SLOT_PER_BUCKET_IN_BITS);
+}
+
+static inline bulk_bucket_t *_first_bucket(const hashtable_t *hashtable,
+                                           const uint64_t hv) {
+  return &((bulk_bucket_t *)hashtable->btable)[hv & (_n_bucket(hashtable) - 1)];
+}
+
+static inline bulk_bucket_t *_next_bucket(const bulk_bucket_t *bucket) {
+  return (bulk_bucket_t *)bucket->slots[NEXT_BUCKET_SLOT];
+}
+
+static inline uint64_t _tag(const uint64_t hv) { return hv >> TAG_SHIFT; }
+
+static inline cache_obj_t *_info_to_obj(const uint64_t item_info) {
+  return (cache_obj_t *)(item_info & PTR_MASK);
+}
+
+static inline uint64_t _build_item_info(const uint64_t tag,
+                                        const cache_obj_t *cache_obj) {
+  return (tag << TAG_SHIFT) | (uint64_t)cache_obj;
+}
+
+/* a non-empty slot whose tag matches */
+static inline bool _tag_match(const uint64_t item_info, const uint64_t tag) {
+  return item_info != 0 && (item_info >> TAG_SHIFT) == tag;
+}
+
+static bulk_bucket_t *_alloc_buckets(const uint64_t n_bucket) {
+  /* use aligned_alloc so that a bucket does not cross cache lines */
+  size_t size = sizeof(bulk_bucket_t) * n_bucket;
+  bulk_bucket_t *buckets = aligned_alloc(CACHE_LINE_SIZE, size);
+  if (buckets == NULL) {
+    ERROR("allocate hash table %lu buckets * %zu B = %ld MiB failed\n",
+          (unsigned long)n_bucket, sizeof(bulk_bucket_t),
+          (long)(size / 1024 / 1024));
+    exit(1);
+  }
+#ifdef USE_HUGEPAGE
+  madvise(buckets, size, MADV_HUGEPAGE);
+#endif
+  memset(buckets, 0, size);
+  return buckets;
+}
+
+/* add an object to the hashtable */
+static inline void add_to_table(hashtable_t *hashtable,
+                                cache_obj_t *cache_obj) {
+  if (unlikely(((uint64_t)cache_obj & ~PTR_MASK) != 0)) {
+    ERROR("object pointer %p uses more than %d bits\n", (void *)cache_obj,
+          TAG_SHIFT);
+    abort();
+  }
+
+  uint64_t hv = cache_obj->hv;
+  uint64_t item_info = _build_item_info(_tag(hv), cache_obj);
+  bulk_bucket_t *bucket = _first_bucket(hashtable, hv);
+  while (true) {
+    for (int i = 0; i < N_ITEM_PER_BUCKET; i++) {
+      if (bucket->slots[i] == 0) {
+        bucket->slots[i] = item_info;
+        return;
+      }
+    }
+    if (_next_bucket(bucket) == NULL) break;
+    bucket = _next_bucket(bucket);
+  }
+
+  /* all buckets in the chain are full */
+  bulk_bucket_t *new_bucket = _alloc_buckets(1);
+  new_bucket->slots[0] = item_info;
+  bucket->slots[NEXT_BUCKET_SLOT] = (uint64_t)new_bucket;
+}
+
+/* free all overflow buckets chained to the first-level buckets */
+static void _free_overflow_buckets(bulk_bucket_t *buckets,
+                                   const uint64_t n_bucket) {
+  for (uint64_t i = 0; i < n_bucket; i++) {
+    bulk_bucket_t *bucket = _next_bucket(&buckets[i]);
+    while (bucket != NULL) {
+      bulk_bucket_t *next_bucket = _next_bucket(bucket);
+      free(bucket);
+      bucket = next_bucket;
+    }
+  }
+}
+
+/************************ hashtable func ************************/
+hashtable_t *create_bulk_chaining_hashtable(const uint16_t hashpower_init) {
+  hashtable_t *hashtable = my_malloc(hashtable_t);
+  memset(hashtable, 0, sizeof(hashtable_t));
+
+  hashtable->hashpower = MAX(hashpower_init, MIN_HASHPOWER);
+  hashtable->btable = (uint64_t *)_alloc_buckets(_n_bucket(hashtable));
+  hashtable->external_obj = false;
+  hashtable->n_obj = 0;
+  hashtable_init_obj_pool(hashtable);
+  return hashtable;
+}
+
+static inline cache_obj_t *_find_obj_id_with_hv(const hashtable_t *hashtable,
+                                                const obj_id_t obj_id,
+                                                const uint64_t hv) {
+  uint64_t tag = _tag(hv);
+  const bulk_bucket_t *bucket = _first_bucket(hashtable, hv);
+
+  while (bucket != NULL) {
+    for (int i = 0; i < N_ITEM_PER_BUCKET; i++) {
+      if (!_tag_match(bucket->slots[i], tag)) continue;
+      /* a potential hit */
+      cache_obj_t *cache_obj = _info_to_obj(bucket->slots[i]);
+      if (cache_obj->obj_id == obj_id) return cache_obj;
+    }
+    bucket = _next_bucket(bucket);
+  }
+  return NULL;
+}
+
+cache_obj_t *bulk_chaining_hashtable_find_obj_id(const hashtable_t *hashtable,
+                                                 const obj_id_t obj_id) {
+  return _find_obj_id_with_hv(hashtable, obj_id, get_hash_value_int_64(&obj_id));
+}
+
+/* use the hash value computed by the reader if available */
+cache_obj_t *bulk_chaining_hashtable_find(const hashtable_t *hashtable,
+                                          const request_t *req) {
+  return _find_obj_id_with_hv(hashtable, req->obj_id, get_req_hash_value(req));
+}
+
+cache_obj_t *bulk_chaining_hashtable_find_obj(const hashtable_t *hashtable,
+                                              const cache_obj_t *obj_to_find) {
+  return bulk_chaining_hashtable_find_obj_id(hashtable, obj_to_find->obj_id);
+}
+
+/**
+ * @brief issue software prefetch for the hash buckets of a batch of requests,
+ * the prefetch is only a hint and does not change the hash table
+ *
+ * @param hashtable
+ * @param reqs
+ * @param n_req
+ * @param prefetch_obj prefetch the objects whose tags match in the first
+ *  bucket, this is only useful when the buckets have been prefetched earlier
+ */
+void bulk_chaining_hashtable_prefetch(const hashtable_t *hashtable,
+                                      const request_t *reqs, const int n_req,
+                                      const bool prefetch_obj) {
+  for (int i = 0; i < n_req; i++) {
+    uint64_t hv = get_req_hash_value(&reqs[i]);
+    const bulk_bucket_t *bucket = _first_bucket(hashtable, hv);
+    if (prefetch_obj) {
+      uint64_t tag = _tag(hv);
+      for (int j = 0; j < N_ITEM_PER_BUCKET; j++) {
+        if (_tag_match(bucket->slots[j], tag)) {
+          __builtin_prefetch(_info_to_obj(bucket->slots[j]), 0, 3);
+          break;
+        }
+      }
+    } else {
+      __builtin_prefetch(bucket, 0, 3);
+    }
+  }
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *bulk_chaining_hashtable_insert(hashtable_t *hashtable,
+                                            const request_t *req) {
+  if (hashtable->n_obj > (uint64_t)(hashsize(hashtable->hashpower) * EXPAND_LOAD)) {
+    _bulk_chaining_hashtable_resize(hashtable, hashtable->hashpower + 1);
+  }
+
+  cache_obj_t *new_cache_obj = hashtable_new_obj(hashtable, req);
+  add_to_table(hashtable, new_cache_obj);
+  hashtable->n_obj += 1;
+  return new_cache_obj;
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *bulk_chaining_hashtable_insert_obj(hashtable_t *hashtable,
+                                                cache_obj_t *cache_obj) {
+  DEBUG_ASSERT(hashtable->external_obj);
+  if (hashtable->n_obj > (uint64_t)(hashsize(hashtable->hashpower) * EXPAND_LOAD)) {
+    _bulk_chaining_hashtable_resize(hashtable, hashtable->hashpower + 1);
+  }
+
+  /* the object may not be created from a request */
+  cache_obj->hv = get_hash_value_int_64(&cache_obj->obj_id);
+
+  add_to_table(hashtable, cache_obj);
+  hashtable->n_obj += 1;
+  return cache_obj;
+}
+
+bool bulk_chaining_hashtable_try_delete(hashtable_t *hashtable,
+                                        cache_obj_t *cache_obj) {
+  uint64_t hv = cache_obj->hv;
+  uint64_t item_info = _build_item_info(_tag(hv), cache_obj);
+  bulk_bucket_t *bucket = _first_bucket(hashtable, hv);
+
+  while (bucket != NULL) {
+    for (int i = 0; i < N_ITEM_PER_BUCKET; i++) {
+      if (bucket->slots[i] == item_info) {
+        bucket->slots[i] = 0;
+        hashtable->n_obj -= 1;
+        if (!hashtable->external_obj) hashtable_free_obj(hashtable, cache_obj);
+        return true;
+      }
+    }
+    bucket = _next_bucket(bucket);
+  }
+  return false;
+}
+
+/* you need to free the extra_metadata before deleting from hash table */
+void bulk_chaining_hashtable_delete(hashtable_t *hashtable,
+                                    cache_obj_t *cache_obj) {
+  bool found = bulk_chaining_hashtable_try_delete(hashtable, cache_obj);
+  // the object to remove is not in the hash table
+  DEBUG_ASSERT(found);
+}
+
+bool bulk_chaining_hashtable_delete_obj_id(hashtable_t *hashtable,
+                                           const obj_id_t obj_id) {
+  cache_obj_t *cache_obj = bulk_chaining_hashtable_find_obj_id(hashtable, obj_id);
+  if (cache_obj == NULL) return false;
+
+  return bulk_chaining_hashtable_try_delete(hashtable, cache_obj);
+}
+
+/**
+ * @brief pick a random non-empty bucket and a random object in the bucket
+ * chain, same as chainedHashTableV2, the table is shrunk if most buckets are
+ * empty
+ */
+cache_obj_t *bulk_chaining_hashtable_rand_obj(hashtable_t *hashtable) {
+  DEBUG_ASSERT(hashtable->n_obj > 0);
+  if (hashtable->n_obj == 0) return NULL;
+
+  int n_tries = 0;
+  while (true) {
+    uint64_t pos = next_rand() & (_n_bucket(hashtable) - 1);
+    const bulk_bucket_t *first_bucket =
+        &((bulk_bucket_t *)hashtable->btable)[pos];
+
+    int n_obj_in_bucket = 0;
+    for (const bulk_bucket_t *bucket = first_bucket; bucket != NULL;
+         bucket = _next_bucket(bucket)) {
+      for (int i = 0; i < N_ITEM_PER_BUCKET; i++) {
+        n_obj_in_bucket += bucket->slots[i] != 0;
+      }
+    }
+
+    if (n_obj_in_bucket > 0) {
+      int rand_pos = next_rand() % n_obj_in_bucket;
+      for (const bulk_bucket_t *bucket = first_bucket; bucket != NULL;
+           bucket = _next_bucket(bucket)) {
+        for (int i = 0; i < N_ITEM_PER_BUCKET; i++) {
+          if (bucket->slots[i] != 0 && rand_pos-- == 0) {
+            return _info_to_obj(bucket->slots[i]);
+          }
+        }
+      }
+    }
+
+    n_tries += 1;
+    if (n_tries > 32 && hashtable->hashpower > MIN_HASHPOWER &&
+        hashtable->n_obj < _n_bucket(hashtable) / 4) {
+      _bulk_chaining_hashtable_resize(hashtable, hashtable->hashpower - 1);
+      n_tries = 0;
+    }
+  }
+}
+
+void bulk_chaining_hashtable_foreach(hashtable_t *hashtable,
+                                     hashtable_iter iter_func,
+                                     void *user_data) {
+  bulk_bucket_t *buckets = (bulk_bucket_t *)hashtable->btable;
+  for (uint64_t i = 0; i < _n_bucket(hashtable); i++) {
+    for (bulk_bucket_t *bucket = &buckets[i]; bucket != NULL;
+         bucket = _next_bucket(bucket)) {
+      for (int j = 0; j < N_ITEM_PER_BUCKET; j++) {
+        if (bucket->slots[j] != 0) {
+          iter_func(_info_to_obj(bucket->slots[j]), user_data);
+        }
+      }
+    }
+  }
+}
+
+void free_bulk_chaining_hashtable(hashtable_t *hashtable) {
+  hashtable_free_all_obj(hashtable, bulk_chaining_hashtable_foreach);
+  _free_overflow_buckets((bulk_bucket_t *)hashtable->btable,
+                         _n_bucket(hashtable));
+  free(hashtable->btable);
+  my_free(sizeof(hashtable_t), hashtable);
+}
+
+uint64_t bulk_chaining_hashtable_n_overflow_bucket(const hashtable_t *hashtable) {
+  const bulk_bucket_t *buckets = (const bulk_bucket_t *)hashtable->btable;
+  uint64_t n_overflow_bucket = 0;
+  for (uint64_t i = 0; i < _n_bucket(hashtable); i++) {
+    for (const bulk_bucket_t *bucket = _next_bucket(&buckets[i]);
+         bucket != NULL; bucket = _next_bucket(bucket)) {
+      n_overflow_bucket += 1;
+    }
+  }
+  return n_overflow_bucket;
+}
+
+/* move the objects to a table with hashsize(new_hashpower) slots */
+static void _bulk_chaining_hashtable_resize(hashtable_t *hashtable,
+                                            uint16_t new_hashpower) {
+  bulk_bucket_t *old_buckets = (bulk_bucket_t *)hashtable->btable;
+  uint64_t old_n_bucket = _n_bucket(hashtable);
+
+  DEBUG("resize hashtable from %llu to %llu slots, hashtable load %lu/%llu\n",
+        hashsizeULL(hashtable->hashpower), hashsizeULL(new_hashpower),
+        (unsigned long)hashtable->n_obj, hashsizeULL(hashtable->hashpower));
+
+  hashtable->hashpower = new_hashpower;
+  hashtable->btable = (uint64_t *)_alloc_buckets(_n_bucket(hashtable));
+
+  for (uint64_t i = 0; i < old_n_bucket; i++) {
+    for (bulk_bucket_t *bucket = &old_buckets[i]; bucket != NULL;
+         bucket = _next_bucket(bucket)) {
+      for (int j = 0; j < N_ITEM_PER_BUCKET; j++) {
+        if (bucket->slots[j] != 0) {
+          add_to_table(hashtable, _info_to_obj(bucket->slots[j]));
+        }
+      }
+    }
+  }
+
+  _free_overflow_buckets(old_buckets, old_n_bucket);
+  free(old_buckets);
+}
+
+void check_bulk_chaining_hashtable_integrity(const hashtable_t *hashtable) {
+  const bulk_bucket_t *buckets = (const bulk_bucket_t *)hashtable->btable;
+  uint64_t n_obj = 0;
+  for (uint64_t i = 0; i < _n_bucket(hashtable); i++) {
+    for (const bulk_bucket_t *bucket = &buckets[i]; bucket != NULL;
+         bucket = _next_bucket(bucket)) {
+      for (int j = 0; j < N_ITEM_PER_BUCKET; j++) {
+        if (bucket->slots[j] == 0) continue;
+        cache_obj_t *cache_obj = _info_to_obj(bucket->slots[j]);
+        uint64_t hv = cache_obj->hv;
+        assert(hv == get_hash_value_int_64(&cache_obj->obj_id));
+        assert(_first_bucket(hashtable, hv) == &buckets[i]);
+        assert(_tag_match(bucket->slots[j], _tag(hv)));
+        n_obj += 1;
+      }
+    }
+  }
+  assert(n_obj == hashtable->n_obj);
+}
+
+#ifdef __cplusplus
+}
+#endif
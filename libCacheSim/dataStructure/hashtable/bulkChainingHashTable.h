@@ -0,0 +1,66 @@
+//
+// a chained hash table whose buckets are one cache line, each bucket holds
+// several (tag, cache_obj_t*) pairs, an overflow bucket is chained to the
+// bucket when it is full
+//
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "../../include/libCacheSim/cacheObj.h"
+#include "../../include/libCacheSim/request.h"
+#include "hashtableStruct.h"
+
+hashtable_t *create_bulk_chaining_hashtable(const uint16_t hashpower_init);
+
+cache_obj_t *bulk_chaining_hashtable_find_obj_id(const hashtable_t *hashtable,
+                                                 const obj_id_t obj_id);
+
+cache_obj_t *bulk_chaining_hashtable_find(const hashtable_t *hashtable,
+                                          const request_t *req);
+
+cache_obj_t *bulk_chaining_hashtable_find_obj(const hashtable_t *hashtable,
+                                              const cache_obj_t *obj_to_find);
+
+void bulk_chaining_hashtable_prefetch(const hashtable_t *hashtable,
+                                      const request_t *reqs, const int n_req,
+                                      const bool prefetch_obj);
+
+/* return an empty cache_obj_t */
+cache_obj_t *bulk_chaining_hashtable_insert(hashtable_t *hashtable,
+                                            const request_t *req);
+
+cache_obj_t *bulk_chaining_hashtable_insert_obj(hashtable_t *hashtable,
+                                                cache_obj_t *cache_obj);
+
+bool bulk_chaining_hashtable_try_delete(hashtable_t *hashtable,
+                                        cache_obj_t *cache_obj);
+
+void bulk_chaining_hashtable_delete(hashtable_t *hashtable,
+                                    cache_obj_t *cache_obj);
+
+bool bulk_chaining_hashtable_delete_obj_id(hashtable_t *hashtable,
+                                           const obj_id_t obj_id);
+
+cache_obj_t *bulk_chaining_hashtable_rand_obj(hashtable_t *hashtable);
+
+void bulk_chaining_hashtable_foreach(hashtable_t *hashtable,
+                                     hashtable_iter iter_func,
+                                     void *user_data);
+
+void free_bulk_chaining_hashtable(hashtable_t *hashtable);
+
+/* the number of overflow buckets, used to evaluate the table */
+uint64_t bulk_chaining_hashtable_n_overflow_bucket(const hashtable_t *hashtable);
+
+void check_bulk_chaining_hashtable_integrity(const hashtable_t *hashtable);
+
+#ifdef __cplusplus
+}
+#endif
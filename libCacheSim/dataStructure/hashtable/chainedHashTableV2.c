@@ -17,6 +17,20 @@
 // |     void*      | ----> NULL
 // |----------------|
 //
+// with incremental expansion (CHAINED_HASHTABLE_INCREMENTAL_EXPAND), an
+// expansion allocates the new table and keeps the old one, each insert
+// migrates a few buckets of the old table (from the first bucket) to the new
+// table, until all buckets are migrated and the old table is freed;
+// the objects of a bucket that has not been migrated stay in the old table,
+// including the objects inserted during the expansion, so each object is in
+// exactly one bucket, which is found by _bucket
+//
+// with dense object ids (chained_hashtable_use_dense_obj_id_v2), the object
+// ids of the trace are remapped to [0, n_obj), the table has at least n_obj
+// buckets and the bucket of an object is decided by its object id instead of
+// the hash value, so each bucket has at most one object and the table is a
+// flat array indexed by the object id; objects with an id out of the range
+// share buckets as in a normal chained hash table
 //
 
 #ifdef __cplusplus
@@ -31,6 +45,7 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include "../../include/libCacheSim/logging.h"
 #include "../../include/libCacheSim/macro.h"
@@ -38,52 +53,83 @@ extern "C" {
 #include "../hash/hash.h"
 
 #define OBJ_EMPTY(cache_obj) ((cache_obj)->obj_size == 0)
-#define NEXT_OBJ(cur_obj) (((cache_obj_t *)(cur_obj))->hash_next)
+#define NEXT_OBJ(cur_obj) obj_hash_next((cache_obj_t *)(cur_obj))
+
+/* the number of old buckets migrated on each insert during an incremental
+ * expansion, the table doubles when the load reaches the expand threshold,
+ * so migrating one bucket per insert finishes before the next expansion */
+#define REHASH_N_BUCKET_PER_INSERT 4
+/* the migrated part of the old table is returned to the OS in chunks */
+#define REHASH_RELEASE_N_BUCKET (64 * KiB / sizeof(cache_obj_t *))
 
 static void _copy_entries(hashtable_t *new_table, cache_obj_t **old_table, uint64_t old_size);
 static void _chained_hashtable_shrink_v2(hashtable_t *hashtable);
 static void _chained_hashtable_expand_v2(hashtable_t *hashtable);
+static void _chained_hashtable_rehash_v2(hashtable_t *hashtable, uint64_t n_bucket);
 static void print_hashbucket_item_distribution(const hashtable_t *hashtable);
 
 /************************ helper func ************************/
+/**
+ * get the bucket of the objects with hash value hv, it is in the old table
+ * if the table is being expanded and the old bucket has not been migrated
+ */
+static inline cache_obj_t **_bucket(const hashtable_t *hashtable, const uint64_t hv) {
+  if (hashtable->old_ptr_table != NULL) {
+    uint64_t old_pos = hv & hashmask(hashtable->hashpower - 1);
+    if (old_pos >= hashtable->rehash_idx) return &hashtable->old_ptr_table[old_pos];
+  }
+  return &hashtable->ptr_table[hv & hashmask(hashtable->hashpower)];
+}
+
+/**
+ * the key that decides the bucket of an object, the object id is used as is
+ * if the object ids are dense; the hash value of the object is not changed
+ * because it is copied to requests that may be used with other hash tables
+ */
+static inline uint64_t _obj_key(const hashtable_t *hashtable, const cache_obj_t *cache_obj) {
+  return hashtable->dense_obj_id ? (uint64_t)cache_obj->obj_id : (uint64_t)cache_obj->hv;
+}
+
+static inline uint64_t _obj_id_key(const hashtable_t *hashtable, const obj_id_t obj_id) {
+  return hashtable->dense_obj_id ? (uint64_t)obj_id : get_hash_value_int_64(&obj_id);
+}
+
+static inline uint64_t _req_key(const hashtable_t *hashtable, const request_t *req) {
+  return hashtable->dense_obj_id ? (uint64_t)req->obj_id : get_req_hash_value(req);
+}
+
 /**
  * get the last object in the hash bucket
  */
 static inline cache_obj_t *_last_obj_in_bucket(const hashtable_t *hashtable, const uint64_t hv) {
-  cache_obj_t *cur_obj_in_bucket = hashtable->ptr_table[hv];
-  while (cur_obj_in_bucket->hash_next) {
-    cur_obj_in_bucket = cur_obj_in_bucket->hash_next;
+  cache_obj_t *cur_obj_in_bucket = *_bucket(hashtable, hv);
+  while (obj_hash_next(cur_obj_in_bucket)) {
+    cur_obj_in_bucket = obj_hash_next(cur_obj_in_bucket);
   }
   return cur_obj_in_bucket;
 }
 
 /* add an object to the hashtable */
 static inline void add_to_table(hashtable_t *hashtable, cache_obj_t *cache_obj) {
-  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) & hashmask(hashtable->hashpower);
-  if (hashtable->ptr_table[hv] == NULL) {
-    hashtable->ptr_table[hv] = cache_obj;
+  cache_obj_t **bucket = _bucket(hashtable, _obj_key(hashtable, cache_obj));
+  if (*bucket == NULL) {
+    *bucket = cache_obj;
     return;
   }
-  cache_obj_t *head_ptr = hashtable->ptr_table[hv];
+  cache_obj_t *head_ptr = *bucket;
 
-  cache_obj->hash_next = head_ptr;
-  hashtable->ptr_table[hv] = cache_obj;
+  set_obj_hash_next(cache_obj, head_ptr);
+  *bucket = cache_obj;
 
 #ifdef HASHTABLE_DEBUG
-  cache_obj_t *curr_obj = cache_obj->hash_next;
+  cache_obj_t *curr_obj = obj_hash_next(cache_obj);
   while (curr_obj) {
     assert(curr_obj->obj_id != cache_obj->obj_id);
-    curr_obj = curr_obj->hash_next;
+    curr_obj = obj_hash_next(curr_obj);
   }
 #endif
 }
 
-/* free object, called by other functions when iterating through the hashtable
- */
-static inline void foreach_free_obj(cache_obj_t *cache_obj, void *user_data) {
-  my_free(sizeof(cache_obj_t), cache_obj);
-}
-
 /************************ hashtable func ************************/
 hashtable_t *create_chained_hashtable_v2(const uint16_t hashpower) {
   hashtable_t *hashtable = my_malloc(hashtable_t);
@@ -104,39 +150,97 @@ hashtable_t *create_chained_hashtable_v2(const uint16_t hashpower) {
   hashtable->external_obj = false;
   hashtable->hashpower = hashpower;
   hashtable->n_obj = 0;
+  hashtable->incremental_expand = CHAINED_HASHTABLE_INCREMENTAL_EXPAND;
+  hashtable_init_obj_pool(hashtable);
   return hashtable;
 }
 
-cache_obj_t *chained_hashtable_find_obj_id_v2(const hashtable_t *hashtable, const obj_id_t obj_id) {
-  cache_obj_t *cache_obj = NULL;
-  uint64_t hv = get_hash_value_int_64(&obj_id);
-  hv = hv & hashmask(hashtable->hashpower);
-  cache_obj = hashtable->ptr_table[hv];
+bool chained_hashtable_use_dense_obj_id_v2(hashtable_t *hashtable, const uint64_t n_obj) {
+  if (hashtable->n_obj != 0) {
+    WARN("dense object ids can only be used with an empty hash table\n");
+    return false;
+  }
+
+  uint16_t hashpower = 1;
+  while (hashsize(hashpower) < n_obj) hashpower++;
+  if (hashpower != hashtable->hashpower) {
+    my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower), hashtable->ptr_table);
+    hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(hashpower));
+    ASSERT_NOT_NULL(hashtable->ptr_table, "unable to allocate hashtable of size %llu\n", hashsizeULL(hashpower));
+#ifdef USE_HUGEPAGE
+    madvise(hashtable->table, sizeof(cache_obj_t *) * hashsize(hashpower), MADV_HUGEPAGE);
+#endif
+    memset(hashtable->ptr_table, 0, sizeof(cache_obj_t *) * hashsize(hashpower));
+    hashtable->hashpower = hashpower;
+  }
+  hashtable->dense_obj_id = true;
+
+  return true;
+}
+
+static inline cache_obj_t *_find_obj_id_with_hv(const hashtable_t *hashtable, const obj_id_t obj_id, uint64_t hv) {
+  cache_obj_t *cache_obj = *_bucket(hashtable, hv);
 
   while (cache_obj) {
     if (cache_obj->obj_id == obj_id) {
       return cache_obj;
     }
-    cache_obj = cache_obj->hash_next;
+    cache_obj = obj_hash_next(cache_obj);
   }
   return cache_obj;
 }
 
+cache_obj_t *chained_hashtable_find_obj_id_v2(const hashtable_t *hashtable, const obj_id_t obj_id) {
+  return _find_obj_id_with_hv(hashtable, obj_id, _obj_id_key(hashtable, obj_id));
+}
+
+/* use the hash value computed by the reader if available */
 cache_obj_t *chained_hashtable_find_v2(const hashtable_t *hashtable, const request_t *req) {
-  return chained_hashtable_find_obj_id_v2(hashtable, req->obj_id);
+  return _find_obj_id_with_hv(hashtable, req->obj_id, _req_key(hashtable, req));
 }
 
 cache_obj_t *chained_hashtable_find_obj_v2(const hashtable_t *hashtable, const cache_obj_t *obj_to_find) {
   return chained_hashtable_find_obj_id_v2(hashtable, obj_to_find->obj_id);
 }
 
-/* the user needs to make sure the added object is not in the hash table */
-cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable, const request_t *req) {
+/**
+ * @brief issue software prefetch for the hash buckets of a batch of requests,
+ * the prefetch is only a hint and does not change the hash table
+ *
+ * @param hashtable
+ * @param reqs
+ * @param n_req
+ * @param prefetch_obj also prefetch the first object in each bucket, this is
+ *  only useful when the buckets have been prefetched earlier, otherwise
+ *  reading the bucket stalls
+ */
+void chained_hashtable_prefetch_v2(const hashtable_t *hashtable, const request_t *reqs, const int n_req,
+                                   const bool prefetch_obj) {
+  for (int i = 0; i < n_req; i++) {
+    cache_obj_t **bucket = _bucket(hashtable, _req_key(hashtable, &reqs[i]));
+    if (prefetch_obj) {
+      cache_obj_t *cache_obj = *bucket;
+      if (cache_obj != NULL) __builtin_prefetch(cache_obj, 0, 3);
+    } else {
+      __builtin_prefetch(bucket, 0, 3);
+    }
+  }
+}
+
+/* expand the table if it is too full, or continue an incremental expansion */
+static inline void _expand_if_needed(hashtable_t *hashtable) {
   if (hashtable->n_obj > (uint64_t)(hashsize(hashtable->hashpower) * CHAINED_HASHTABLE_EXPAND_THRESHOLD)) {
     _chained_hashtable_expand_v2(hashtable);
+  } else if (hashtable->old_ptr_table != NULL) {
+    _chained_hashtable_rehash_v2(hashtable, REHASH_N_BUCKET_PER_INSERT);
   }
+}
 
-  cache_obj_t *new_cache_obj = create_cache_obj_from_request(req);
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable, const request_t *req) {
+  _expand_if_needed(hashtable);
+
+  cache_obj_t *new_cache_obj = hashtable_new_obj(hashtable, req);
   add_to_table(hashtable, new_cache_obj);
   hashtable->n_obj += 1;
   return new_cache_obj;
@@ -145,8 +249,10 @@ cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable, const request_t
 /* the user needs to make sure the added object is not in the hash table */
 cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable, cache_obj_t *cache_obj) {
   DEBUG_ASSERT(hashtable->external_obj);
-  if (hashtable->n_obj > (uint64_t)(hashsize(hashtable->hashpower) * CHAINED_HASHTABLE_EXPAND_THRESHOLD))
-    _chained_hashtable_expand_v2(hashtable);
+  _expand_if_needed(hashtable);
+
+  /* the object may not be created from a request */
+  cache_obj->hv = get_hash_value_int_64(&cache_obj->obj_id);
 
   add_to_table(hashtable, cache_obj);
   hashtable->n_obj += 1;
@@ -156,18 +262,18 @@ cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable, cache_obj_t
 /* you need to free the extra_metadata before deleting from hash table */
 void chained_hashtable_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_obj) {
   hashtable->n_obj -= 1;
-  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) & hashmask(hashtable->hashpower);
-  if (hashtable->ptr_table[hv] == cache_obj) {
-    hashtable->ptr_table[hv] = cache_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cache_obj);
+  cache_obj_t **bucket = _bucket(hashtable, _obj_key(hashtable, cache_obj));
+  if (*bucket == cache_obj) {
+    *bucket = obj_hash_next(cache_obj);
+    if (!hashtable->external_obj) hashtable_free_obj(hashtable, cache_obj);
     return;
   }
 
   static int max_chain_len = 64;
   int chain_len = 1;
-  cache_obj_t *cur_obj = hashtable->ptr_table[hv];
-  while (cur_obj != NULL && cur_obj->hash_next != cache_obj) {
-    cur_obj = cur_obj->hash_next;
+  cache_obj_t *cur_obj = *bucket;
+  while (cur_obj != NULL && obj_hash_next(cur_obj) != cache_obj) {
+    cur_obj = obj_hash_next(cur_obj);
     chain_len += 1;
   }
 
@@ -182,27 +288,27 @@ void chained_hashtable_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_obj)
 
   // the object to remove is not in the hash table
   DEBUG_ASSERT(cur_obj != NULL);
-  cur_obj->hash_next = cache_obj->hash_next;
+  set_obj_hash_next(cur_obj, obj_hash_next(cache_obj));
   if (!hashtable->external_obj) {
-    free_cache_obj(cache_obj);
+    hashtable_free_obj(hashtable, cache_obj);
   }
 }
 
 bool chained_hashtable_try_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_obj) {
   static int max_chain_len = 1;
 
-  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) & hashmask(hashtable->hashpower);
-  if (hashtable->ptr_table[hv] == cache_obj) {
-    hashtable->ptr_table[hv] = cache_obj->hash_next;
+  cache_obj_t **bucket = _bucket(hashtable, _obj_key(hashtable, cache_obj));
+  if (*bucket == cache_obj) {
+    *bucket = obj_hash_next(cache_obj);
     hashtable->n_obj -= 1;
-    if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    if (!hashtable->external_obj) hashtable_free_obj(hashtable, cache_obj);
     return true;
   }
 
   int chain_len = 1;
-  cache_obj_t *cur_obj = hashtable->ptr_table[hv];
-  while (cur_obj != NULL && cur_obj->hash_next != cache_obj) {
-    cur_obj = cur_obj->hash_next;
+  cache_obj_t *cur_obj = *bucket;
+  while (cur_obj != NULL && obj_hash_next(cur_obj) != cache_obj) {
+    cur_obj = obj_hash_next(cur_obj);
     chain_len += 1;
   }
 
@@ -226,9 +332,9 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_
   }
 
   if (cur_obj != NULL) {
-    cur_obj->hash_next = cache_obj->hash_next;
+    set_obj_hash_next(cur_obj, obj_hash_next(cache_obj));
     hashtable->n_obj -= 1;
-    if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    if (!hashtable->external_obj) hashtable_free_obj(hashtable, cache_obj);
     return true;
   }
   return false;
@@ -249,15 +355,15 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_
  *  @return                                    [true or false]
  */
 bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable, const obj_id_t obj_id) {
-  uint64_t hv = get_hash_value_int_64(&obj_id) & hashmask(hashtable->hashpower);
-  cache_obj_t *cur_obj = hashtable->ptr_table[hv];
+  cache_obj_t **bucket = _bucket(hashtable, _obj_id_key(hashtable, obj_id));
+  cache_obj_t *cur_obj = *bucket;
   // the hash bucket is empty
   if (cur_obj == NULL) return false;
 
   // the object to remove is the first object in the hash bucket
   if (cur_obj->obj_id == obj_id) {
-    hashtable->ptr_table[hv] = cur_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cur_obj);
+    *bucket = obj_hash_next(cur_obj);
+    if (!hashtable->external_obj) hashtable_free_obj(hashtable, cur_obj);
     hashtable->n_obj -= 1;
     return true;
   }
@@ -266,13 +372,13 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable, const obj_id_t o
 
   do {
     prev_obj = cur_obj;
-    cur_obj = cur_obj->hash_next;
+    cur_obj = obj_hash_next(cur_obj);
   } while (cur_obj != NULL && cur_obj->obj_id != obj_id);
 
   // the object to remove is in the hash bucket
   if (cur_obj != NULL) {
-    prev_obj->hash_next = cur_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cur_obj);
+    set_obj_hash_next(prev_obj, obj_hash_next(cur_obj));
+    if (!hashtable->external_obj) hashtable_free_obj(hashtable, cur_obj);
     hashtable->n_obj -= 1;
     return true;
   }
@@ -280,47 +386,68 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable, const obj_id_t o
   return false;
 }
 
+/* whether the object is at position pos of the (new) table, an object in an
+ * old bucket that has not been migrated is at one of two positions */
+#define OBJ_AT_POS(hashtable, cache_obj, pos) ((_obj_key(hashtable, cache_obj) & hashmask((hashtable)->hashpower)) == (pos))
+
 cache_obj_t *chained_hashtable_rand_obj_v2(hashtable_t *hashtable) {
   uint64_t pos = next_rand() & hashmask(hashtable->hashpower);
   int n_tries = 0;
-  while (hashtable->ptr_table[pos] == NULL) {
+  int n_obj_in_bucket = 0;
+  cache_obj_t *cur_obj;
+  /* sample a position and then an object at the position, so that the
+   * objects in the old table are sampled as if they had been migrated */
+  while (true) {
+    for (cur_obj = *_bucket(hashtable, pos); cur_obj != NULL; cur_obj = obj_hash_next(cur_obj)) {
+      n_obj_in_bucket += OBJ_AT_POS(hashtable, cur_obj, pos);
+    }
+    if (n_obj_in_bucket > 0) break;
+
     n_tries += 1;
-    if (n_tries > 32) {
+    /* a table indexed by dense object ids keeps its size */
+    if (n_tries > 32 && !hashtable->dense_obj_id) {
       _chained_hashtable_shrink_v2(hashtable);
     }
     pos = next_rand() & hashmask(hashtable->hashpower);
   }
 
-  int n_obj_in_bucket = 1;
-  cache_obj_t *cur_obj = hashtable->ptr_table[pos];
-  while (cur_obj->hash_next) {
-    cur_obj = cur_obj->hash_next;
-    n_obj_in_bucket += 1;
-  }
   int rand_pos = next_rand() % n_obj_in_bucket;
-  cur_obj = hashtable->ptr_table[pos];
-  for (int i = 0; i < rand_pos; i++) {
-    cur_obj = cur_obj->hash_next;
+  cur_obj = *_bucket(hashtable, pos);
+  while (!OBJ_AT_POS(hashtable, cur_obj, pos) || rand_pos-- > 0) {
+    cur_obj = obj_hash_next(cur_obj);
   }
 
   return cur_obj;
 }
 
-void chained_hashtable_foreach_v2(hashtable_t *hashtable, hashtable_iter iter_func, void *user_data) {
+static void _foreach_in_buckets(cache_obj_t **table, uint64_t start, uint64_t end, hashtable_iter iter_func,
+                                void *user_data) {
   cache_obj_t *cur_obj, *next_obj;
-  for (uint64_t i = 0; i < hashsize(hashtable->hashpower); i++) {
-    cur_obj = hashtable->ptr_table[i];
+  for (uint64_t i = start; i < end; i++) {
+    cur_obj = table[i];
     while (cur_obj != NULL) {
-      next_obj = cur_obj->hash_next;
+      next_obj = obj_hash_next(cur_obj);
       iter_func(cur_obj, user_data);
       cur_obj = next_obj;
     }
   }
 }
 
+/* iter_func can delete the object, but must not insert objects */
+void chained_hashtable_foreach_v2(hashtable_t *hashtable, hashtable_iter iter_func, void *user_data) {
+  _foreach_in_buckets(hashtable->ptr_table, 0, hashsize(hashtable->hashpower), iter_func, user_data);
+  if (hashtable->old_ptr_table != NULL) {
+    _foreach_in_buckets(hashtable->old_ptr_table, hashtable->rehash_idx, hashsize(hashtable->hashpower - 1),
+                        iter_func, user_data);
+  }
+}
+
 void free_chained_hashtable_v2(hashtable_t *hashtable) {
-  if (!hashtable->external_obj) chained_hashtable_foreach_v2(hashtable, foreach_free_obj, NULL);
+  hashtable_free_all_obj(hashtable, chained_hashtable_foreach_v2);
   my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower), hashtable->ptr_table);
+  if (hashtable->old_ptr_table != NULL) {
+    my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower - 1), hashtable->old_ptr_table);
+  }
   my_free(sizeof(hashtable_t), hashtable);
 }
 
@@ -337,8 +464,8 @@ static void _copy_entries(hashtable_t *new_table, cache_obj_t **old_table, uint6
   for (uint64_t i = 0; i < old_size; i++) {
     cur_obj = old_table[i];
     while (cur_obj != NULL) {
-      next_obj = cur_obj->hash_next;
-      cur_obj->hash_next = NULL;
+      next_obj = obj_hash_next(cur_obj);
+      set_obj_hash_next(cur_obj, NULL);
       add_to_table(new_table, cur_obj);
       cur_obj = next_obj;
     }
@@ -346,6 +473,9 @@ static void _copy_entries(hashtable_t *new_table, cache_obj_t **old_table, uint6
 }
 
 static void _chained_hashtable_shrink_v2(hashtable_t *hashtable) {
+  /* finish the incremental expansion first */
+  _chained_hashtable_rehash_v2(hashtable, UINT64_MAX);
+
   cache_obj_t **old_table = hashtable->ptr_table;
   hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(--hashtable->hashpower));
 #ifdef USE_HUGEPAGE
@@ -362,8 +492,52 @@ static void _chained_hashtable_shrink_v2(hashtable_t *hashtable) {
   my_free(sizeof(cache_obj_t) * hashsize(hashtable->hashpower + 1), old_table);
 }
 
+/**
+ * migrate the next n_bucket buckets of the old table during an incremental
+ * expansion, and free the old table when all buckets are migrated
+ */
+static void _chained_hashtable_rehash_v2(hashtable_t *hashtable, uint64_t n_bucket) {
+  if (hashtable->old_ptr_table == NULL) return;
+
+  cache_obj_t **old_table = hashtable->old_ptr_table;
+  uint64_t old_size = hashsize(hashtable->hashpower - 1);
+  while (n_bucket-- > 0 && hashtable->rehash_idx < old_size) {
+    cache_obj_t *cur_obj = old_table[hashtable->rehash_idx];
+    old_table[hashtable->rehash_idx] = NULL;
+    /* move rehash_idx first so that add_to_table adds to the new table */
+    hashtable->rehash_idx += 1;
+    while (cur_obj != NULL) {
+      cache_obj_t *next_obj = obj_hash_next(cur_obj);
+      set_obj_hash_next(cur_obj, NULL);
+      add_to_table(hashtable, cur_obj);
+      cur_obj = next_obj;
+    }
+
+    if (hashtable->rehash_idx % REHASH_RELEASE_N_BUCKET == 0) {
+      /* the migrated buckets are NULL and are not read again, the pages read
+       * as zero if they are accessed after being released */
+      uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+      uintptr_t start = (uintptr_t)(old_table + hashtable->rehash_idx - REHASH_RELEASE_N_BUCKET);
+      uintptr_t end = (uintptr_t)(old_table + hashtable->rehash_idx);
+      start = (start + page_size - 1) & ~(page_size - 1);
+      end = end & ~(page_size - 1);
+      if (end > start) madvise((void *)start, end - start, MADV_DONTNEED);
+    }
+  }
+
+  if (hashtable->rehash_idx == old_size) {
+    DEBUG("finish expanding hashtable to %llu entries\n", hashsizeULL(hashtable->hashpower));
+    my_free(sizeof(cache_obj_t *) * old_size, old_table);
+    hashtable->old_ptr_table = NULL;
+    hashtable->rehash_idx = 0;
+  }
+}
+
 /* grows the hashtable to the next power of 2. */
 static void _chained_hashtable_expand_v2(hashtable_t *hashtable) {
+  /* the previous incremental expansion has not finished */
+  _chained_hashtable_rehash_v2(hashtable, UINT64_MAX);
+
   cache_obj_t **old_table = hashtable->ptr_table;
   hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(++hashtable->hashpower));
 #ifdef USE_HUGEPAGE
@@ -376,6 +550,13 @@ static void _chained_hashtable_expand_v2(hashtable_t *hashtable) {
         hashsizeULL((uint16_t)(hashtable->hashpower - 1)), hashsizeULL(hashtable->hashpower), hashtable->n_obj,
         hashsize(hashtable->hashpower));
 
+  if (hashtable->incremental_expand) {
+    /* the buckets are migrated by the following inserts */
+    hashtable->old_ptr_table = old_table;
+    hashtable->rehash_idx = 0;
+    return;
+  }
+
   _copy_entries(hashtable, old_table, hashsize(hashtable->hashpower - 1));
   my_free(sizeof(cache_obj_t) * hashsize(hashtable->hashpower), old_table);
 }
@@ -385,8 +566,23 @@ void check_hashtable_integrity_v2(const hashtable_t *hashtable) {
   for (uint64_t i = 0; i < hashsize(hashtable->hashpower); i++) {
     cur_obj = hashtable->ptr_table[i];
     while (cur_obj != NULL) {
-      next_obj = cur_obj->hash_next;
-      assert(i == (get_hash_value_int_64(&cur_obj->obj_id) & hashmask(hashtable->hashpower)));
+      next_obj = obj_hash_next(cur_obj);
+      assert(cur_obj->hv == (obj_hv_t)get_hash_value_int_64(&cur_obj->obj_id));
+      assert(i == (_obj_key(hashtable, cur_obj) & hashmask(hashtable->hashpower)));
+      assert(_bucket(hashtable, _obj_key(hashtable, cur_obj)) == &hashtable->ptr_table[i]);
+      cur_obj = next_obj;
+    }
+  }
+
+  if (hashtable->old_ptr_table == NULL) return;
+  for (uint64_t i = 0; i < hashsize(hashtable->hashpower - 1); i++) {
+    cur_obj = hashtable->old_ptr_table[i];
+    /* the migrated buckets are empty */
+    assert(i >= hashtable->rehash_idx || cur_obj == NULL);
+    while (cur_obj != NULL) {
+      next_obj = obj_hash_next(cur_obj);
+      assert(cur_obj->hv == (obj_hv_t)get_hash_value_int_64(&cur_obj->obj_id));
+      assert(i == (_obj_key(hashtable, cur_obj) & hashmask(hashtable->hashpower - 1)));
       cur_obj = next_obj;
     }
   }
@@ -404,7 +600,7 @@ static int count_n_obj_in_bucket(cache_obj_t *curr_obj) {
       }
     }
 
-    curr_obj = curr_obj->hash_next;
+    curr_obj = obj_hash_next(curr_obj);
     chain_len += 1;
   }
 
@@ -438,7 +634,21 @@ void print_chained_hashtable_v2(const hashtable_t *hashtable) {
     printf("hash bucket %d: ", i);
     while (cur_obj != NULL) {
       printf("%lu, ", (unsigned long)cur_obj->obj_id);
-      cur_obj = cur_obj->hash_next;
+      cur_obj = obj_hash_next(cur_obj);
+    }
+    printf("\n");
+  }
+
+  if (hashtable->old_ptr_table == NULL) return;
+  for (uint64_t i = hashtable->rehash_idx; i < hashsize(hashtable->hashpower - 1); i++) {
+    cache_obj_t *cur_obj = hashtable->old_ptr_table[i];
+    if (cur_obj == NULL) {
+      continue;
+    }
+    printf("old hash bucket %lu: ", (unsigned long)i);
+    while (cur_obj != NULL) {
+      printf("%lu, ", (unsigned long)cur_obj->obj_id);
+      cur_obj = obj_hash_next(cur_obj);
     }
     printf("\n");
   }
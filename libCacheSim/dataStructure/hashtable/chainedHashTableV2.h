@@ -18,6 +18,15 @@ extern "C" {
 
 hashtable_t *create_chained_hashtable_v2(const uint16_t hashpower_init);
 
+/**
+ * index the table by object id, the object ids must be in [0, n_obj) for
+ * each bucket to have at most one object, this can only be called on an
+ * empty table
+ * @return whether the table uses dense object ids
+ */
+bool chained_hashtable_use_dense_obj_id_v2(hashtable_t *hashtable,
+                                           const uint64_t n_obj);
+
 cache_obj_t *chained_hashtable_find_obj_id_v2(const hashtable_t *hashtable,
                                               const obj_id_t obj_id);
 
@@ -27,6 +36,10 @@ cache_obj_t *chained_hashtable_find_v2(const hashtable_t *hashtable,
 cache_obj_t *chained_hashtable_find_obj_v2(const hashtable_t *hashtable,
                                            const cache_obj_t *obj_to_evict);
 
+void chained_hashtable_prefetch_v2(const hashtable_t *hashtable,
+                                   const request_t *reqs, const int n_req,
+                                   const bool prefetch_obj);
+
 /* return an empty cache_obj_t */
 cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable,
                                          const request_t *req);
@@ -40,6 +53,9 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable,
 void chained_hashtable_delete_v2(hashtable_t *hashtable,
                                  cache_obj_t *cache_obj);
 
+bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
+                                        const obj_id_t obj_id);
+
 cache_obj_t *chained_hashtable_rand_obj_v2(hashtable_t *hashtable);
 
 void chained_hashtable_foreach_v2(hashtable_t *hashtable,
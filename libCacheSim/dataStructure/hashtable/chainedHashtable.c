@@ -135,14 +135,9 @@ cache_obj_t *chained_hashtable_find(hashtable_t *hashtable, obj_id_t obj_id) {
 cache_obj_t *chained_hashtable_find_req(hashtable_t *hashtable,
                                         request_t *req) {
   cache_obj_t *cache_obj, *ret = NULL;
-  uint64_t hv;
-
-  if (req->hv == 0) {
-    hv = get_hash_value_int_64(&req->obj_id);
-    req->hv = hv;
-  } else {
-    hv = req->hv;
-  }
+  uint64_t hv = get_req_hash_value(req);
+  req->hv = hv;
+  req->hv_obj_id = req->obj_id;
 
   hv = hv & hashmask(hashtable->hashpower);
   cache_obj = &hashtable->table[hv];
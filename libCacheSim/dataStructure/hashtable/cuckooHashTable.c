@@ -0,0 +1,467 @@
+//
+// a bucketized cuckoo hash table, each object can be stored in one of
+// two buckets, and each bucket has 7 slots and fills one cache line
+//
+// |------------------------------------------------------|
+// | tag x 7, pad (8 B) | cache_obj_t* x 7 (56 B)          |
+// |------------------------------------------------------|
+// | tag x 7, pad (8 B) | cache_obj_t* x 7 (56 B)          |
+// |------------------------------------------------------|
+//
+// the tag is one byte of the hash value (0 means the slot is empty), a
+// lookup compares the tags of a bucket with one SSE2 instruction and only
+// reads the objects whose tags match, so a lookup usually touches one bucket
+// cache line and the object, compared to one pointer chase per object in the
+// chain of the chained hash table.
+//
+// the alternative bucket is computed from the bucket and the tag (partial-key
+// cuckoo hashing), so that moving an object does not need to read the object.
+// When an object cannot be placed after CUCKOO_MAX_KICK moves, the table is
+// expanded. The objects are not moved in memory, only the pointers are.
+//
+// hashpower is the log2 of the number of slots including the pad slot of
+// each bucket, which is the same as the number of buckets in the chained hash
+// table, so the table holds 7/8 of hashsize(hashpower) objects
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cuckooHashTable.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../../utils/include/mymath.h"
+#include "../hash/hash.h"
+
+#define CUCKOO_BUCKET_N_SLOT 7
+/* the log2 of the slots in a bucket including the pad slot */
+#define CUCKOO_BUCKET_N_SLOT_POWER 3
+/* at least two buckets so that an object has two candidate buckets */
+#define CUCKOO_MIN_HASHPOWER (CUCKOO_BUCKET_N_SLOT_POWER + 1)
+/* the max number of objects moved when inserting one object */
+#define CUCKOO_MAX_KICK 512
+/* expand the table before it is too full, insertion becomes slow when the
+ * load is close to the max load (about 0.97 for 2 x 7-way buckets) */
+#define CUCKOO_EXPAND_LOAD 0.90
+
+#define EMPTY_TAG 0
+#define CACHE_LINE_SIZE 64
+
+typedef struct cuckoo_bucket {
+  /* the last tag is the pad slot, which is always empty */
+  uint8_t tags[CUCKOO_BUCKET_N_SLOT + 1];
+  cache_obj_t *objs[CUCKOO_BUCKET_N_SLOT];
+} __attribute__((aligned(CACHE_LINE_SIZE))) cuckoo_bucket_t;
+
+_Static_assert(sizeof(cuckoo_bucket_t) == CACHE_LINE_SIZE,
+               "a cuckoo bucket should fill one cache line");
+
+/* the slots in a bucket except the pad slot */
+#define CUCKOO_SLOT_MASK ((1u << CUCKOO_BUCKET_N_SLOT) - 1)
+
+static void _cuckoo_hashtable_rehash(hashtable_t *hashtable,
+                                     uint16_t new_hashpower);
+
+/************************ helper func ************************/
+static inline uint64_t _n_bucket(const hashtable_t *hashtable) {
+  return hashsize(hashtable->hashpower - CUCKOO_BUCKET_N_SLOT_POWER);
+}
+
+/* the number of objects the table can hold */
+static inline uint64_t _n_slot(const hashtable_t *hashtable) {
+  return _n_bucket(hashtable) * CUCKOO_BUCKET_N_SLOT;
+}
+
+static inline uint8_t _tag(const uint64_t hv) {
+  /* the low bits are used for the bucket index, use the high bits */
+  uint8_t tag = (uint8_t)(hv >> 56);
+  return tag == EMPTY_TAG ? 1 : tag;
+}
+
+/**
+ * the alternative bucket of an object only depends on the current bucket and
+ * the tag, and alt(alt(b)) == b, the offset is never 0 so the two buckets are
+ * different
+ */
+static inline uint64_t _alt_bucket(const uint64_t bucket_idx,
+                                   const uint8_t tag, const uint64_t mask) {
+  uint64_t offset = ((uint64_t)tag * 0xc6a4a7935bd1e995ULL) & mask;
+  if (offset == 0) offset = 1;
+  return (bucket_idx ^ offset) & mask;
+}
+
+/**
+ * @brief find the slots in the bucket whose tag matches
+ *
+ * @return a bitmap, bit i is set if the tag at slot i matches, the pad slot
+ * never matches
+ */
+static inline uint32_t _match_tag(const cuckoo_bucket_t *bucket,
+                                  const uint8_t tag) {
+#if defined(__SSE2__)
+  __m128i tags = _mm_loadl_epi64((const __m128i *)bucket->tags);
+  __m128i match = _mm_cmpeq_epi8(tags, _mm_set1_epi8((char)tag));
+  return (uint32_t)_mm_movemask_epi8(match) & CUCKOO_SLOT_MASK;
+#else
+  uint32_t bitmap = 0;
+  for (int i = 0; i < CUCKOO_BUCKET_N_SLOT; i++) {
+    bitmap |= (uint32_t)(bucket->tags[i] == tag) << i;
+  }
+  return bitmap;
+#endif
+}
+
+static inline cache_obj_t *_find_in_bucket(const cuckoo_bucket_t *bucket,
+                                           const uint8_t tag,
+                                           const obj_id_t obj_id) {
+  uint32_t bitmap = _match_tag(bucket, tag);
+  while (bitmap != 0) {
+    cache_obj_t *cache_obj = bucket->objs[__builtin_ctz(bitmap)];
+    if (cache_obj->obj_id == obj_id) return cache_obj;
+    bitmap &= bitmap - 1;
+  }
+  return NULL;
+}
+
+/**
+ * @brief remove the object (compared by pointer) from the bucket
+ *
+ * @return whether the object is found in the bucket
+ */
+static inline bool _remove_from_bucket(cuckoo_bucket_t *bucket,
+                                       const uint8_t tag,
+                                       const cache_obj_t *cache_obj) {
+  uint32_t bitmap = _match_tag(bucket, tag);
+  while (bitmap != 0) {
+    int slot = __builtin_ctz(bitmap);
+    if (bucket->objs[slot] == cache_obj) {
+      bucket->tags[slot] = EMPTY_TAG;
+      bucket->objs[slot] = NULL;
+      return true;
+    }
+    bitmap &= bitmap - 1;
+  }
+  return false;
+}
+
+static inline bool _put_in_bucket(cuckoo_bucket_t *bucket, const uint8_t tag,
+                                  cache_obj_t *cache_obj) {
+  uint32_t bitmap = _match_tag(bucket, EMPTY_TAG);
+  if (bitmap == 0) return false;
+
+  int slot = __builtin_ctz(bitmap);
+  bucket->tags[slot] = tag;
+  bucket->objs[slot] = cache_obj;
+  return true;
+}
+
+/**
+ * @brief place an object in the table, if both candidate buckets are full,
+ * the object takes the slot of another object, which is moved to its
+ * alternative bucket, and so on
+ *
+ * @return NULL if success, otherwise, the object that cannot be placed,
+ * which may be different from the object passed in
+ */
+static cache_obj_t *_place_obj(hashtable_t *hashtable,
+                               cache_obj_t *cache_obj) {
+  cuckoo_bucket_t *buckets = hashtable->buckets;
+  uint64_t mask = _n_bucket(hashtable) - 1;
+  uint64_t hv = cache_obj->hv;
+  uint8_t tag = _tag(hv);
+  uint64_t bucket_idx = hv & mask;
+
+  if (_put_in_bucket(&buckets[bucket_idx], tag, cache_obj)) return NULL;
+  bucket_idx = _alt_bucket(bucket_idx, tag, mask);
+
+  for (int n_kick = 0; n_kick < CUCKOO_MAX_KICK; n_kick++) {
+    cuckoo_bucket_t *bucket = &buckets[bucket_idx];
+    if (_put_in_bucket(bucket, tag, cache_obj)) return NULL;
+
+    /* take a slot (chosen pseudo-randomly to avoid cycles) and carry the
+     * object in the slot to its alternative bucket */
+    int slot = (tag + n_kick) % CUCKOO_BUCKET_N_SLOT;
+    uint8_t victim_tag = bucket->tags[slot];
+    cache_obj_t *victim = bucket->objs[slot];
+    bucket->tags[slot] = tag;
+    bucket->objs[slot] = cache_obj;
+
+    tag = victim_tag;
+    cache_obj = victim;
+    bucket_idx = _alt_bucket(bucket_idx, tag, mask);
+  }
+
+  return cache_obj;
+}
+
+static inline void _add_to_table(hashtable_t *hashtable,
+                                 cache_obj_t *cache_obj) {
+  if (hashtable->n_obj + 1 >
+      (uint64_t)(_n_slot(hashtable) * CUCKOO_EXPAND_LOAD)) {
+    _cuckoo_hashtable_rehash(hashtable, hashtable->hashpower + 1);
+  }
+
+  cache_obj_t *unplaced = _place_obj(hashtable, cache_obj);
+  while (unplaced != NULL) {
+    _cuckoo_hashtable_rehash(hashtable, hashtable->hashpower + 1);
+    unplaced = _place_obj(hashtable, unplaced);
+  }
+  hashtable->n_obj += 1;
+}
+
+static cuckoo_bucket_t *_alloc_buckets(uint16_t hashpower) {
+  uint64_t n_bucket = hashsize(hashpower - CUCKOO_BUCKET_N_SLOT_POWER);
+  /* use aligned_alloc so that a bucket does not cross cache lines */
+  cuckoo_bucket_t *buckets =
+      aligned_alloc(CACHE_LINE_SIZE, sizeof(cuckoo_bucket_t) * n_bucket);
+  if (buckets == NULL) {
+    ERROR("allocate cuckoo hash table %lu buckets * %zu B failed\n",
+          (unsigned long)n_bucket, sizeof(cuckoo_bucket_t));
+    exit(1);
+  }
+#ifdef USE_HUGEPAGE
+  madvise(buckets, sizeof(cuckoo_bucket_t) * n_bucket, MADV_HUGEPAGE);
+#endif
+  memset(buckets, 0, sizeof(cuckoo_bucket_t) * n_bucket);
+  return buckets;
+}
+
+/************************ hashtable func ************************/
+hashtable_t *create_cuckoo_hashtable(const uint16_t hashpower_init) {
+  hashtable_t *hashtable = my_malloc(hashtable_t);
+  memset(hashtable, 0, sizeof(hashtable_t));
+
+  hashtable->hashpower = MAX(hashpower_init, CUCKOO_MIN_HASHPOWER);
+  hashtable->buckets = _alloc_buckets(hashtable->hashpower);
+  hashtable->external_obj = false;
+  hashtable->n_obj = 0;
+  hashtable_init_obj_pool(hashtable);
+  return hashtable;
+}
+
+static inline cache_obj_t *_find_obj_id_with_hv(const hashtable_t *hashtable,
+                                                const obj_id_t obj_id,
+                                                const uint64_t hv) {
+  const cuckoo_bucket_t *buckets = hashtable->buckets;
+  uint64_t mask = _n_bucket(hashtable) - 1;
+  uint8_t tag = _tag(hv);
+  uint64_t bucket_idx = hv & mask;
+
+  /* most objects are in the first bucket, so we do not read the second
+   * bucket unless necessary */
+  cache_obj_t *cache_obj = _find_in_bucket(&buckets[bucket_idx], tag, obj_id);
+  if (cache_obj != NULL) return cache_obj;
+
+  return _find_in_bucket(&buckets[_alt_bucket(bucket_idx, tag, mask)], tag,
+                         obj_id);
+}
+
+cache_obj_t *cuckoo_hashtable_find_obj_id(const hashtable_t *hashtable,
+                                          const obj_id_t obj_id) {
+  return _find_obj_id_with_hv(hashtable, obj_id, get_hash_value_int_64(&obj_id));
+}
+
+/* use the hash value computed by the reader if available */
+cache_obj_t *cuckoo_hashtable_find(const hashtable_t *hashtable,
+                                   const request_t *req) {
+  return _find_obj_id_with_hv(hashtable, req->obj_id, get_req_hash_value(req));
+}
+
+cache_obj_t *cuckoo_hashtable_find_obj(const hashtable_t *hashtable,
+                                       const cache_obj_t *obj_to_find) {
+  return cuckoo_hashtable_find_obj_id(hashtable, obj_to_find->obj_id);
+}
+
+/**
+ * @brief issue software prefetch for the first-choice buckets of a batch of
+ * requests, the prefetch is only a hint and does not change the hash table
+ *
+ * @param hashtable
+ * @param reqs
+ * @param n_req
+ * @param prefetch_obj prefetch the objects whose tags match instead of the
+ *  buckets, this is only useful when the buckets have been prefetched earlier
+ */
+void cuckoo_hashtable_prefetch(const hashtable_t *hashtable,
+                               const request_t *reqs, const int n_req,
+                               const bool prefetch_obj) {
+  const cuckoo_bucket_t *buckets = hashtable->buckets;
+  uint64_t mask = _n_bucket(hashtable) - 1;
+  for (int i = 0; i < n_req; i++) {
+    uint64_t hv = get_req_hash_value(&reqs[i]);
+    const cuckoo_bucket_t *bucket = &buckets[hv & mask];
+    if (prefetch_obj) {
+      uint32_t bitmap = _match_tag(bucket, _tag(hv));
+      if (bitmap != 0) __builtin_prefetch(bucket->objs[__builtin_ctz(bitmap)], 0, 3);
+    } else {
+      __builtin_prefetch(bucket, 0, 3);
+    }
+  }
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *cuckoo_hashtable_insert(hashtable_t *hashtable,
+                                     const request_t *req) {
+  cache_obj_t *new_cache_obj = hashtable_new_obj(hashtable, req);
+  _add_to_table(hashtable, new_cache_obj);
+  return new_cache_obj;
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *cuckoo_hashtable_insert_obj(hashtable_t *hashtable,
+                                         cache_obj_t *cache_obj) {
+  DEBUG_ASSERT(hashtable->external_obj);
+  /* the object may not be created from a request */
+  cache_obj->hv = get_hash_value_int_64(&cache_obj->obj_id);
+  _add_to_table(hashtable, cache_obj);
+  return cache_obj;
+}
+
+bool cuckoo_hashtable_try_delete(hashtable_t *hashtable,
+                                 cache_obj_t *cache_obj) {
+  cuckoo_bucket_t *buckets = hashtable->buckets;
+  uint64_t mask = _n_bucket(hashtable) - 1;
+  uint64_t hv = cache_obj->hv;
+  uint8_t tag = _tag(hv);
+  uint64_t bucket_idx = hv & mask;
+
+  if (!_remove_from_bucket(&buckets[bucket_idx], tag, cache_obj) &&
+      !_remove_from_bucket(&buckets[_alt_bucket(bucket_idx, tag, mask)], tag,
+                           cache_obj)) {
+    return false;
+  }
+
+  hashtable->n_obj -= 1;
+  if (!hashtable->external_obj) hashtable_free_obj(hashtable, cache_obj);
+  return true;
+}
+
+/* you need to free the extra_metadata before deleting from hash table */
+void cuckoo_hashtable_delete(hashtable_t *hashtable, cache_obj_t *cache_obj) {
+  bool found = cuckoo_hashtable_try_delete(hashtable, cache_obj);
+  // the object to remove is not in the hash table
+  DEBUG_ASSERT(found);
+}
+
+bool cuckoo_hashtable_delete_obj_id(hashtable_t *hashtable,
+                                    const obj_id_t obj_id) {
+  cache_obj_t *cache_obj = cuckoo_hashtable_find_obj_id(hashtable, obj_id);
+  if (cache_obj == NULL) return false;
+
+  return cuckoo_hashtable_try_delete(hashtable, cache_obj);
+}
+
+/**
+ * @brief sample a slot uniformly until it is not empty, so each object has
+ * the same probability to be chosen, the pad slots are sampled as empty
+ * slots. The table is not shrunk here, the caches that sample often keep
+ * their objects in an obj_sampler instead
+ */
+cache_obj_t *cuckoo_hashtable_rand_obj(hashtable_t *hashtable) {
+  DEBUG_ASSERT(hashtable->n_obj > 0);
+  if (hashtable->n_obj == 0) return NULL;
+
+  while (true) {
+    uint64_t pos = next_rand() & hashmask(hashtable->hashpower);
+    const cuckoo_bucket_t *bucket =
+        &((cuckoo_bucket_t *)hashtable->buckets)[pos >> CUCKOO_BUCKET_N_SLOT_POWER];
+    int slot = pos & hashmask(CUCKOO_BUCKET_N_SLOT_POWER);
+    if (bucket->tags[slot] != EMPTY_TAG) return bucket->objs[slot];
+  }
+}
+
+void cuckoo_hashtable_foreach(hashtable_t *hashtable, hashtable_iter iter_func,
+                              void *user_data) {
+  cuckoo_bucket_t *buckets = hashtable->buckets;
+  uint64_t n_bucket = _n_bucket(hashtable);
+  for (uint64_t i = 0; i < n_bucket; i++) {
+    for (int j = 0; j < CUCKOO_BUCKET_N_SLOT; j++) {
+      if (buckets[i].tags[j] != EMPTY_TAG) {
+        iter_func(buckets[i].objs[j], user_data);
+      }
+    }
+  }
+}
+
+void free_cuckoo_hashtable(hashtable_t *hashtable) {
+  hashtable_free_all_obj(hashtable, cuckoo_hashtable_foreach);
+  free(hashtable->buckets);
+  my_free(sizeof(hashtable_t), hashtable);
+}
+
+/**
+ * @brief move all objects to a new table with hashsize(new_hashpower) slots,
+ * if the objects cannot be placed in the new table, a larger table is used
+ */
+static void _cuckoo_hashtable_rehash(hashtable_t *hashtable,
+                                     uint16_t new_hashpower) {
+  cuckoo_bucket_t *old_buckets = hashtable->buckets;
+  uint64_t old_n_bucket = _n_bucket(hashtable);
+
+  while (true) {
+    hashtable->hashpower = new_hashpower;
+    hashtable->buckets = _alloc_buckets(new_hashpower);
+
+    bool success = true;
+    for (uint64_t i = 0; i < old_n_bucket && success; i++) {
+      for (int j = 0; j < CUCKOO_BUCKET_N_SLOT; j++) {
+        if (old_buckets[i].tags[j] == EMPTY_TAG) continue;
+        if (_place_obj(hashtable, old_buckets[i].objs[j]) != NULL) {
+          success = false;
+          break;
+        }
+      }
+    }
+    if (success) break;
+
+    /* the old table still has all objects, retry with a larger table */
+    free(hashtable->buckets);
+    new_hashpower += 1;
+  }
+
+  DEBUG("rehash cuckoo hashtable from %llu to %llu slots, load %lu/%llu\n",
+        (unsigned long long)(old_n_bucket * CUCKOO_BUCKET_N_SLOT),
+        (unsigned long long)_n_slot(hashtable), (unsigned long)hashtable->n_obj,
+        (unsigned long long)_n_slot(hashtable));
+
+  free(old_buckets);
+}
+
+void check_cuckoo_hashtable_integrity(const hashtable_t *hashtable) {
+  const cuckoo_bucket_t *buckets = hashtable->buckets;
+  uint64_t n_bucket = _n_bucket(hashtable);
+  uint64_t n_obj = 0;
+  for (uint64_t i = 0; i < n_bucket; i++) {
+    for (int j = 0; j < CUCKOO_BUCKET_N_SLOT; j++) {
+      if (buckets[i].tags[j] == EMPTY_TAG) continue;
+      const cache_obj_t *cache_obj = buckets[i].objs[j];
+      uint64_t hv = cache_obj->hv;
+      uint8_t tag = _tag(hv);
+      assert(hv == get_hash_value_int_64(&cache_obj->obj_id));
+      assert(buckets[i].tags[j] == tag);
+      assert(i == (hv & (n_bucket - 1)) ||
+             i == _alt_bucket(hv & (n_bucket - 1), tag, n_bucket - 1));
+      n_obj += 1;
+    }
+  }
+  for (uint64_t i = 0; i < n_bucket; i++) {
+    assert(buckets[i].tags[CUCKOO_BUCKET_N_SLOT] == EMPTY_TAG);
+  }
+  assert(n_obj == hashtable->n_obj);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,65 @@
+//
+// a bucketized cuckoo hash table that stores pointers to cache_obj_t,
+// each bucket fills one cache line with 7 one-byte tags, a pad byte and 7
+// pointers, the tags are matched with one SIMD compare so that a lookup only
+// reads the object whose tag matches
+//
+
+#ifndef libCacheSim_CUCKOOHASHTABLE_H
+#define libCacheSim_CUCKOOHASHTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "../../include/libCacheSim/cacheObj.h"
+#include "../../include/libCacheSim/request.h"
+#include "hashtableStruct.h"
+
+hashtable_t *create_cuckoo_hashtable(const uint16_t hashpower_init);
+
+cache_obj_t *cuckoo_hashtable_find_obj_id(const hashtable_t *hashtable,
+                                          const obj_id_t obj_id);
+
+cache_obj_t *cuckoo_hashtable_find(const hashtable_t *hashtable,
+                                   const request_t *req);
+
+cache_obj_t *cuckoo_hashtable_find_obj(const hashtable_t *hashtable,
+                                       const cache_obj_t *obj_to_find);
+
+void cuckoo_hashtable_prefetch(const hashtable_t *hashtable,
+                               const request_t *reqs, const int n_req,
+                               const bool prefetch_obj);
+
+/* return an empty cache_obj_t */
+cache_obj_t *cuckoo_hashtable_insert(hashtable_t *hashtable,
+                                     const request_t *req);
+
+cache_obj_t *cuckoo_hashtable_insert_obj(hashtable_t *hashtable,
+                                         cache_obj_t *cache_obj);
+
+bool cuckoo_hashtable_try_delete(hashtable_t *hashtable,
+                                 cache_obj_t *cache_obj);
+
+void cuckoo_hashtable_delete(hashtable_t *hashtable, cache_obj_t *cache_obj);
+
+bool cuckoo_hashtable_delete_obj_id(hashtable_t *hashtable,
+                                    const obj_id_t obj_id);
+
+cache_obj_t *cuckoo_hashtable_rand_obj(hashtable_t *hashtable);
+
+void cuckoo_hashtable_foreach(hashtable_t *hashtable, hashtable_iter iter_func,
+                              void *user_data);
+
+void free_cuckoo_hashtable(hashtable_t *hashtable);
+
+void check_cuckoo_hashtable_integrity(const hashtable_t *hashtable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_CUCKOOHASHTABLE_H
@@ -26,6 +26,7 @@ extern "C" {
 #define hashtable_insert(hashtable, req) \
   chained_hashtable_insert(hashtable, req)
 #define hashtable_insert_obj(hashtable, cache_obj) assert(0);
+#define hashtable_prefetch(hashtable, reqs, n_req, prefetch_obj)
 #define hashtable_delete(hashtable, cache_obj) \
   chained_hashtable_delete(hashtable, cache_obj)
 #define hashtable_rand_obj(hashtable) chained_hashtable_rand_obj(hashtable)
@@ -34,6 +35,7 @@ extern "C" {
 #define free_hashtable(hashtable) free_chained_hashtable(hashtable)
 #define hashtable_add_ptr_to_monitoring(hashtable, ptr) \
   chained_hashtable_add_ptr_to_monitoring(hashtable, ptr)
+#define hashtable_use_dense_obj_id(hashtable, n_obj) false
 #define HASHTABLE_VER 1
 
 #elif HASHTABLE_TYPE == CHAINED_HASHTABLEV2
@@ -44,6 +46,8 @@ extern "C" {
   chained_hashtable_find_obj_id_v2(hashtable, obj_id)
 #define hashtable_find_obj(hashtable, cache_obj) \
   chained_hashtable_find_obj_v2(hashtable, cache_obj)
+#define hashtable_prefetch(hashtable, reqs, n_req, prefetch_obj) \
+  chained_hashtable_prefetch_v2(hashtable, reqs, n_req, prefetch_obj)
 #define hashtable_insert(hashtable, req) \
   chained_hashtable_insert_v2(hashtable, req)
 #define hashtable_insert_obj(hashtable, cache_obj) \
@@ -60,11 +64,69 @@ extern "C" {
 
 #define free_hashtable(hashtable) free_chained_hashtable_v2(hashtable)
 #define hashtable_add_ptr_to_monitoring(hashtable, ptr)
+#define hashtable_use_dense_obj_id(hashtable, n_obj) \
+  chained_hashtable_use_dense_obj_id_v2(hashtable, n_obj)
 #define HASHTABLE_VER 2
 
-#elif HASHTABLE_TYPE == CUCKCOO_HASHTABLE
+#elif HASHTABLE_TYPE == CUCKOO_HASHTABLE
 #include "cuckooHashTable.h"
-#error not implemented
+#define create_hashtable(hashpower) create_cuckoo_hashtable(hashpower)
+#define hashtable_find(hashtable, req) cuckoo_hashtable_find(hashtable, req)
+#define hashtable_find_obj_id(hashtable, obj_id) \
+  cuckoo_hashtable_find_obj_id(hashtable, obj_id)
+#define hashtable_find_obj(hashtable, cache_obj) \
+  cuckoo_hashtable_find_obj(hashtable, cache_obj)
+#define hashtable_prefetch(hashtable, reqs, n_req, prefetch_obj) \
+  cuckoo_hashtable_prefetch(hashtable, reqs, n_req, prefetch_obj)
+#define hashtable_insert(hashtable, req) cuckoo_hashtable_insert(hashtable, req)
+#define hashtable_insert_obj(hashtable, cache_obj) \
+  cuckoo_hashtable_insert_obj(hashtable, cache_obj)
+#define hashtable_delete(hashtable, cache_obj) \
+  cuckoo_hashtable_delete(hashtable, cache_obj)
+#define hashtable_try_delete(hashtable, cache_obj) \
+  cuckoo_hashtable_try_delete(hashtable, cache_obj)
+#define hashtable_delete_obj_id(hashtable, obj_id) \
+  cuckoo_hashtable_delete_obj_id(hashtable, obj_id)
+#define hashtable_rand_obj(hashtable) cuckoo_hashtable_rand_obj(hashtable)
+#define hashtable_foreach(hashtable, iter_func, user_data) \
+  cuckoo_hashtable_foreach(hashtable, iter_func, user_data)
+
+#define free_hashtable(hashtable) free_cuckoo_hashtable(hashtable)
+#define hashtable_add_ptr_to_monitoring(hashtable, ptr)
+#define hashtable_use_dense_obj_id(hashtable, n_obj) false
+#define HASHTABLE_VER 3
+
+#elif HASHTABLE_TYPE == BULK_CHAINING_HASHTABLE
+#include "bulkChainingHashTable.h"
+#define create_hashtable(hashpower) create_bulk_chaining_hashtable(hashpower)
+#define hashtable_find(hashtable, req) \
+  bulk_chaining_hashtable_find(hashtable, req)
+#define hashtable_find_obj_id(hashtable, obj_id) \
+  bulk_chaining_hashtable_find_obj_id(hashtable, obj_id)
+#define hashtable_find_obj(hashtable, cache_obj) \
+  bulk_chaining_hashtable_find_obj(hashtable, cache_obj)
+#define hashtable_prefetch(hashtable, reqs, n_req, prefetch_obj) \
+  bulk_chaining_hashtable_prefetch(hashtable, reqs, n_req, prefetch_obj)
+#define hashtable_insert(hashtable, req) \
+  bulk_chaining_hashtable_insert(hashtable, req)
+#define hashtable_insert_obj(hashtable, cache_obj) \
+  bulk_chaining_hashtable_insert_obj(hashtable, cache_obj)
+#define hashtable_delete(hashtable, cache_obj) \
+  bulk_chaining_hashtable_delete(hashtable, cache_obj)
+#define hashtable_try_delete(hashtable, cache_obj) \
+  bulk_chaining_hashtable_try_delete(hashtable, cache_obj)
+#define hashtable_delete_obj_id(hashtable, obj_id) \
+  bulk_chaining_hashtable_delete_obj_id(hashtable, obj_id)
+#define hashtable_rand_obj(hashtable) \
+  bulk_chaining_hashtable_rand_obj(hashtable)
+#define hashtable_foreach(hashtable, iter_func, user_data) \
+  bulk_chaining_hashtable_foreach(hashtable, iter_func, user_data)
+
+#define free_hashtable(hashtable) free_bulk_chaining_hashtable(hashtable)
+#define hashtable_add_ptr_to_monitoring(hashtable, ptr)
+#define hashtable_use_dense_obj_id(hashtable, n_obj) false
+#define HASHTABLE_VER 4
+
 #else
 #error not implemented
 #endif
@@ -10,8 +10,11 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <string.h>
 
+#include "../../include/config.h"
 #include "../../include/libCacheSim/cacheObj.h"
+#include "../objPool.h"
 
 #define hashsize(n) ((uint64_t)1 << (uint16_t)(n))
 #define hashsizeULL(n) ((unsigned long long)1 << (uint16_t)(n))
@@ -24,6 +27,7 @@ typedef struct hashtable {
     cache_obj_t *table;
     cache_obj_t **ptr_table;
     uint64_t *btable;
+    struct cuckoo_bucket *buckets; /* used by the cuckoo hash table */
   };
   uint64_t n_obj;
   uint16_t hashpower;
@@ -40,8 +44,101 @@ typedef struct hashtable {
     };
     void *extra_data;
   };
+  /* the objects owned by the hash table are allocated from this pool when
+   * HEAP_ALLOCATOR is HEAP_ALLOCATOR_OBJ_POOL */
+  obj_pool_t *obj_pool;
+  /* used by chainedHashTableV2 to expand incrementally, the old table has
+   * hashsize(hashpower - 1) buckets and the buckets before rehash_idx have
+   * been migrated to ptr_table, old_ptr_table is NULL if the table is not
+   * being expanded */
+  bool incremental_expand;
+  cache_obj_t **old_ptr_table;
+  uint64_t rehash_idx;
+  /* used by chainedHashTableV2, the bucket of an object is decided by its
+   * object id instead of the hash value, see
+   * chained_hashtable_use_dense_obj_id_v2 */
+  bool dense_obj_id;
 } hashtable_t;
 
+/* the objects owned by the hash table are allocated and freed with these
+ * functions instead of create_cache_obj_from_request and free_cache_obj */
+static inline void hashtable_init_obj_pool(hashtable_t *hashtable) {
+#if HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+  hashtable->obj_pool = create_obj_pool();
+#endif
+}
+
+static inline cache_obj_t *hashtable_new_obj(hashtable_t *hashtable,
+                                             const struct request *req) {
+#if HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+  cache_obj_t *cache_obj = obj_pool_alloc(hashtable->obj_pool);
+  memset(cache_obj, 0, hashtable->obj_pool->obj_size);
+  copy_request_to_cache_obj(cache_obj, req);
+  return cache_obj;
+#else
+  return create_cache_obj_from_request(req);
+#endif
+}
+
+/**
+ * allocate the objects owned by the hash table with obj_size bytes,
+ * this is only supported with the object pool and must be called before
+ * any object is inserted
+ * @return whether the object size is changed
+ */
+static inline bool hashtable_set_obj_size(hashtable_t *hashtable,
+                                          size_t obj_size) {
+#if HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+  /* chainedHashTable (v1) stores the objects in the table */
+  if (hashtable->obj_pool == NULL) return false;
+  return obj_pool_set_obj_size(hashtable->obj_pool, obj_size);
+#else
+  return false;
+#endif
+}
+
+/* the number of bytes of the objects owned by the hash table */
+static inline size_t hashtable_obj_size(const hashtable_t *hashtable) {
+#if HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+  if (hashtable->obj_pool == NULL) return sizeof(cache_obj_t);
+  return hashtable->obj_pool->obj_size;
+#else
+  return sizeof(cache_obj_t);
+#endif
+}
+
+static inline void hashtable_free_obj(hashtable_t *hashtable,
+                                      cache_obj_t *cache_obj) {
+#if HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+  obj_pool_free(hashtable->obj_pool, cache_obj);
+#else
+  free_cache_obj(cache_obj);
+#endif
+}
+
+static inline void _hashtable_free_obj_iter(cache_obj_t *cache_obj,
+                                            void *hashtable) {
+  free_cache_obj(cache_obj);
+}
+
+/**
+ * free all objects owned by the hash table when the hash table is freed,
+ * with the object pool, this only frees the slabs
+ * @param hashtable
+ * @param foreach the foreach function of the hash table
+ */
+static inline void hashtable_free_all_obj(
+    hashtable_t *hashtable,
+    void (*foreach)(hashtable_t *, hashtable_iter, void *)) {
+#if HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+  free_obj_pool(hashtable->obj_pool);
+  hashtable->obj_pool = NULL;
+#else
+  if (!hashtable->external_obj)
+    foreach(hashtable, _hashtable_free_obj_iter, NULL);
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,126 @@
+//
+// a pool of cache_obj_t, see objPool.h
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "objPool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "../include/libCacheSim/const.h"
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/mem.h"
+
+/* one slab is one huge page */
+#define OBJ_POOL_SLAB_SIZE (2 * MiB)
+/* the first cache line of a slab stores the slab header */
+#define OBJ_POOL_SLAB_HEADER_SIZE 64
+
+obj_pool_t *create_obj_pool(void) {
+  obj_pool_t *pool = my_malloc(obj_pool_t);
+  memset(pool, 0, sizeof(obj_pool_t));
+  pool->obj_size = sizeof(cache_obj_t);
+  return pool;
+}
+
+bool obj_pool_set_obj_size(obj_pool_t *pool, size_t obj_size) {
+#ifdef COMPACT_CACHE_OBJ
+  /* the links between compact objects are in number of cache_obj_t */
+  return false;
+#else
+  if (pool->slab_next_obj != NULL) {
+    WARN("cannot change the object size after objects are allocated\n");
+    return false;
+  }
+  if (obj_size < CACHE_OBJ_MD_OFFSET || obj_size > sizeof(cache_obj_t)) {
+    WARN("object size %zu is out of range [%zu, %zu]\n", obj_size,
+         (size_t)CACHE_OBJ_MD_OFFSET, sizeof(cache_obj_t));
+    return false;
+  }
+  pool->obj_size = obj_size;
+  return true;
+#endif
+}
+
+#ifdef COMPACT_CACHE_OBJ
+/* the largest offset between two objects must fit in obj_link_t */
+#define COMPACT_OBJ_ARENA_SIZE ((size_t)INT32_MAX * sizeof(cache_obj_t))
+
+cache_obj_t *obj_pool_alloc_slow(obj_pool_t *pool) {
+  if (pool->arena != NULL) {
+    ERROR("object pool arena is full, the cache has more than %d objects\n",
+          INT32_MAX);
+  }
+
+  /* reserve the address space, pages are committed when they are touched */
+  pool->arena = mmap(NULL, COMPACT_OBJ_ARENA_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (pool->arena == MAP_FAILED) {
+    ERROR("reserve object pool arena %zu B failed\n",
+          (size_t)COMPACT_OBJ_ARENA_SIZE);
+  }
+#ifdef USE_HUGEPAGE
+  madvise(pool->arena, COMPACT_OBJ_ARENA_SIZE, MADV_HUGEPAGE);
+#endif
+
+  pool->slab_next_obj = pool->arena;
+  pool->slab_end = pool->arena + COMPACT_OBJ_ARENA_SIZE;
+
+  return obj_pool_alloc(pool);
+}
+
+void free_obj_pool(obj_pool_t *pool) {
+  if (pool->arena != NULL) munmap(pool->arena, COMPACT_OBJ_ARENA_SIZE);
+  my_free(sizeof(obj_pool_t), pool);
+}
+
+#else
+
+static obj_pool_slab_t *_alloc_slab(void) {
+#ifdef USE_HUGEPAGE
+  obj_pool_slab_t *slab =
+      aligned_alloc(OBJ_POOL_SLAB_SIZE, OBJ_POOL_SLAB_SIZE);
+  if (slab != NULL) madvise(slab, OBJ_POOL_SLAB_SIZE, MADV_HUGEPAGE);
+#else
+  obj_pool_slab_t *slab = malloc(OBJ_POOL_SLAB_SIZE);
+#endif
+  if (slab == NULL) {
+    ERROR("allocate object pool slab %lld B failed\n",
+          (long long)OBJ_POOL_SLAB_SIZE);
+  }
+  return slab;
+}
+
+/* the current slab is used up, carve the object from a new slab */
+cache_obj_t *obj_pool_alloc_slow(obj_pool_t *pool) {
+  obj_pool_slab_t *slab = _alloc_slab();
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  pool->n_slab += 1;
+
+  pool->slab_next_obj = (char *)slab + OBJ_POOL_SLAB_HEADER_SIZE;
+  pool->slab_end = (char *)slab + OBJ_POOL_SLAB_SIZE;
+
+  return obj_pool_alloc(pool);
+}
+
+/* free all objects in the pool, this does not need to walk the objects */
+void free_obj_pool(obj_pool_t *pool) {
+  obj_pool_slab_t *slab = pool->slabs;
+  while (slab != NULL) {
+    obj_pool_slab_t *next_slab = slab->next;
+    free(slab);
+    slab = next_slab;
+  }
+  my_free(sizeof(obj_pool_t), pool);
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
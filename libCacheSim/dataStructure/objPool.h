@@ -0,0 +1,97 @@
+//
+// a pool of cache_obj_t used by one cache (hash table),
+// objects are carved from large slabs and freed objects are kept in an
+// intrusive free list, so inserting and evicting objects do not go through
+// malloc/free, and freeing the pool only frees the slabs
+//
+// with COMPACT_CACHE_OBJ, objects are carved from one contiguous arena
+// reserved (but not committed) when the first object is allocated, so the
+// objects of a cache can link to each other using 32-bit offsets
+//
+// the objects of a pool can be smaller than cache_obj_t if the eviction
+// algorithm only uses part of the metadata union, see obj_pool_set_obj_size
+//
+// the pool is not thread-safe, each cache has its own pool
+//
+
+#ifndef libCacheSim_OBJPOOL_H
+#define libCacheSim_OBJPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/libCacheSim/cacheObj.h"
+
+typedef struct obj_pool_slab {
+  struct obj_pool_slab *next;
+} obj_pool_slab_t;
+
+typedef struct obj_pool {
+  /* freed objects, linked through hash_next */
+  cache_obj_t *free_list;
+  /* the slab that new objects are carved from */
+  obj_pool_slab_t *slabs;
+  char *slab_next_obj;
+  char *slab_end;
+#ifdef COMPACT_CACHE_OBJ
+  /* all objects are in this arena */
+  char *arena;
+#endif
+
+  int64_t n_slab;
+  /* the number of objects allocated and not freed */
+  int64_t n_obj;
+  /* the number of bytes of each object, sizeof(cache_obj_t) by default */
+  size_t obj_size;
+} obj_pool_t;
+
+obj_pool_t *create_obj_pool(void);
+
+void free_obj_pool(obj_pool_t *pool);
+
+cache_obj_t *obj_pool_alloc_slow(obj_pool_t *pool);
+
+/**
+ * allocate objects of obj_size bytes, which is no smaller than
+ * CACHE_OBJ_MD_OFFSET, the bytes after obj_size must not be accessed,
+ * this can only be called before the first object is allocated,
+ * and is not supported with COMPACT_CACHE_OBJ
+ * @return whether the object size is changed
+ */
+bool obj_pool_set_obj_size(obj_pool_t *pool, size_t obj_size);
+
+/* allocate an object, the content of the object is not initialized */
+static inline cache_obj_t *obj_pool_alloc(obj_pool_t *pool) {
+  cache_obj_t *cache_obj = pool->free_list;
+  if (cache_obj != NULL) {
+    pool->free_list = obj_hash_next(cache_obj);
+    pool->n_obj += 1;
+    return cache_obj;
+  }
+
+  if ((size_t)(pool->slab_end - pool->slab_next_obj) >= pool->obj_size) {
+    cache_obj = (cache_obj_t *)pool->slab_next_obj;
+    pool->slab_next_obj += pool->obj_size;
+    pool->n_obj += 1;
+    return cache_obj;
+  }
+
+  return obj_pool_alloc_slow(pool);
+}
+
+static inline void obj_pool_free(obj_pool_t *pool, cache_obj_t *cache_obj) {
+  set_obj_hash_next(cache_obj, pool->free_list);
+  pool->free_list = cache_obj;
+  pool->n_obj -= 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_OBJPOOL_H
@@ -0,0 +1,49 @@
+//
+// a dense array of the objects in a cache, see objSampler.h
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "objSampler.h"
+
+#include <stdlib.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/mem.h"
+
+#define OBJ_SAMPLER_INIT_CAPACITY 1024
+
+obj_sampler_t *create_obj_sampler(size_t pos_offset) {
+  obj_sampler_t *sampler = my_malloc(obj_sampler_t);
+  memset(sampler, 0, sizeof(obj_sampler_t));
+  sampler->pos_offset = pos_offset;
+  return sampler;
+}
+
+void free_obj_sampler(obj_sampler_t *sampler) {
+  free(sampler->objs);
+  my_free(sizeof(obj_sampler_t), sampler);
+}
+
+void obj_sampler_grow(obj_sampler_t *sampler) {
+  int64_t new_capacity = sampler->capacity == 0 ? OBJ_SAMPLER_INIT_CAPACITY
+                                                : sampler->capacity * 2;
+  if (new_capacity > INT32_MAX) {
+    /* the position of an object is stored in 32 bits */
+    ERROR("the sampler cannot have more than %d objects\n", INT32_MAX);
+  }
+
+  cache_obj_t **objs =
+      realloc(sampler->objs, sizeof(cache_obj_t *) * new_capacity);
+  if (objs == NULL) {
+    ERROR("failed to grow the sampler to %" PRId64 " objects\n", new_capacity);
+  }
+  sampler->objs = objs;
+  sampler->capacity = new_capacity;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,96 @@
+//
+// a dense array of the objects in a cache, used to sample an object
+// uniformly at random in O(1)
+//
+// sampling from the hash table needs to retry on empty buckets and favors
+// objects in short chains, so its cost and bias depend on the load factor;
+// the sampler keeps every object at a position in a dense array, and a
+// removed object is replaced by the last object in the array, so the array
+// never has holes
+//
+// the position of an object is stored in an int32_t field of the
+// per-algorithm metadata, pos_offset is the offset of the field in
+// cache_obj_t, e.g., offsetof(cache_obj_t, Random.sample_pos)
+//
+// the sampler is not thread-safe, each cache has its own sampler
+//
+
+#ifndef libCacheSim_OBJSAMPLER_H
+#define libCacheSim_OBJSAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/libCacheSim/cacheObj.h"
+#include "../include/libCacheSim/macro.h"
+#include "../utils/include/mymath.h"
+
+typedef struct obj_sampler {
+  cache_obj_t **objs;
+  int64_t n_obj;
+  int64_t capacity;
+  /* the offset of the int32_t position field in cache_obj_t */
+  size_t pos_offset;
+} obj_sampler_t;
+
+obj_sampler_t *create_obj_sampler(size_t pos_offset);
+
+void free_obj_sampler(obj_sampler_t *sampler);
+
+void obj_sampler_grow(obj_sampler_t *sampler);
+
+/* cache_obj_t is packed, so the position is read and written with memcpy */
+static inline int32_t obj_sampler_get_pos(const obj_sampler_t *sampler,
+                                          const cache_obj_t *obj) {
+  int32_t pos;
+  memcpy(&pos, (const char *)obj + sampler->pos_offset, sizeof(pos));
+  return pos;
+}
+
+static inline void obj_sampler_set_pos(const obj_sampler_t *sampler,
+                                       cache_obj_t *obj, int32_t pos) {
+  memcpy((char *)obj + sampler->pos_offset, &pos, sizeof(pos));
+}
+
+static inline void obj_sampler_add(obj_sampler_t *sampler, cache_obj_t *obj) {
+  if (sampler->n_obj == sampler->capacity) {
+    obj_sampler_grow(sampler);
+  }
+  obj_sampler_set_pos(sampler, obj, (int32_t)sampler->n_obj);
+  sampler->objs[sampler->n_obj++] = obj;
+}
+
+/**
+ * remove the object by moving the last object in the array to its position
+ */
+static inline void obj_sampler_remove(obj_sampler_t *sampler,
+                                      cache_obj_t *obj) {
+  int32_t pos = obj_sampler_get_pos(sampler, obj);
+  DEBUG_ASSERT(pos >= 0 && pos < sampler->n_obj);
+  DEBUG_ASSERT(sampler->objs[pos] == obj);
+
+  cache_obj_t *last_obj = sampler->objs[--sampler->n_obj];
+  sampler->objs[pos] = last_obj;
+  obj_sampler_set_pos(sampler, last_obj, pos);
+}
+
+/**
+ * @return an object chosen uniformly at random, NULL if there is no object
+ */
+static inline cache_obj_t *obj_sampler_rand_obj(const obj_sampler_t *sampler) {
+  if (sampler->n_obj == 0) {
+    return NULL;
+  }
+  return sampler->objs[next_rand() % (uint64_t)sampler->n_obj];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_OBJSAMPLER_H
@@ -0,0 +1,94 @@
+//
+// a streaming estimate of the working set size, see wssSketch.h
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "wssSketch.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "../include/libCacheSim/mem.h"
+
+wss_sketch_t *create_wss_sketch(void) {
+  wss_sketch_t *sketch = my_malloc(wss_sketch_t);
+  memset(sketch, 0, sizeof(wss_sketch_t));
+  return sketch;
+}
+
+void free_wss_sketch(wss_sketch_t *sketch) { my_free(sizeof(wss_sketch_t), sketch); }
+
+/**
+ * insert the hash value into the sorted sample if it is not in the sample,
+ * the largest hash value is dropped when the sample is full
+ */
+void _wss_sketch_sample(wss_sketch_t *sketch, uint64_t hv, int64_t obj_size) {
+  int64_t lo = 0, hi = sketch->n_sample;
+  while (lo < hi) {
+    int64_t mid = (lo + hi) / 2;
+    if (sketch->sample_hv[mid] < hv) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo < sketch->n_sample && sketch->sample_hv[lo] == hv) {
+    return;
+  }
+
+  int64_t n_move = sketch->n_sample - lo;
+  if (sketch->n_sample == WSS_SKETCH_N_SAMPLE) {
+    n_move -= 1;
+  } else {
+    sketch->n_sample += 1;
+  }
+  memmove(&sketch->sample_hv[lo + 1], &sketch->sample_hv[lo], sizeof(uint64_t) * n_move);
+  memmove(&sketch->sample_size[lo + 1], &sketch->sample_size[lo], sizeof(int64_t) * n_move);
+  sketch->sample_hv[lo] = hv;
+  sketch->sample_size[lo] = obj_size;
+}
+
+/* the HyperLogLog estimate with linear counting for small cardinalities,
+ * the hash values have 64 bits, so there is no large range correction */
+static double _hll_estimate(const wss_sketch_t *sketch) {
+  const int64_t m = 1 << WSS_SKETCH_HLL_P;
+  double sum = 0;
+  int64_t n_zero = 0;
+  for (int64_t i = 0; i < m; i++) {
+    sum += ldexp(1.0, -sketch->registers[i]);
+    n_zero += sketch->registers[i] == 0;
+  }
+
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double est = alpha * m * m / sum;
+  if (est <= 2.5 * m && n_zero > 0) {
+    est = m * log((double)m / n_zero);
+  }
+  return est;
+}
+
+void wss_sketch_estimate(const wss_sketch_t *sketch, int64_t *n_obj, int64_t *n_byte) {
+  int64_t sample_byte = 0;
+  for (int64_t i = 0; i < sketch->n_sample; i++) {
+    sample_byte += sketch->sample_size[i];
+  }
+
+  if (sketch->n_sample < WSS_SKETCH_N_SAMPLE) {
+    /* all objects are in the sample */
+    *n_obj = sketch->n_sample;
+    *n_byte = sample_byte;
+    return;
+  }
+
+  /* the sample is full, so there are at least as many objects */
+  double est = fmax(_hll_estimate(sketch), (double)WSS_SKETCH_N_SAMPLE);
+  *n_obj = (int64_t)llround(est);
+  *n_byte = (int64_t)llround(est * ((double)sample_byte / sketch->n_sample));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+//
+// a streaming estimate of the working set size of a trace in constant memory
+//
+// the number of distinct objects is estimated with a HyperLogLog of
+// 2^WSS_SKETCH_HLL_P registers (about 0.4% standard error), and the bytes of
+// the distinct objects with a bottom-k sample, which keeps the size of the
+// WSS_SKETCH_N_SAMPLE objects with the smallest hash values, a uniform sample
+// of the distinct objects, so the working set in byte is the estimated number
+// of objects times the mean size in the sample
+//
+// when a trace has fewer distinct objects than the sample, every object is in
+// the sample and the working set size is exact
+//
+// the size of an object is the size of its first request
+//
+
+#ifndef libCacheSim_WSSSKETCH_H
+#define libCacheSim_WSSSKETCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#define WSS_SKETCH_HLL_P 16
+#define WSS_SKETCH_N_SAMPLE 16384
+
+typedef struct wss_sketch {
+  uint8_t registers[1 << WSS_SKETCH_HLL_P];
+  /* the smallest hash values of the objects in ascending order */
+  uint64_t sample_hv[WSS_SKETCH_N_SAMPLE];
+  int64_t sample_size[WSS_SKETCH_N_SAMPLE];
+  int64_t n_sample;
+} wss_sketch_t;
+
+wss_sketch_t *create_wss_sketch(void);
+
+void free_wss_sketch(wss_sketch_t *sketch);
+
+void wss_sketch_estimate(const wss_sketch_t *sketch, int64_t *n_obj, int64_t *n_byte);
+
+void _wss_sketch_sample(wss_sketch_t *sketch, uint64_t hv, int64_t obj_size);
+
+/* the finalizer of murmur3, the obj_id is hashed in the sketch so that the
+ * estimate does not depend on the hash function of the hash tables */
+static inline uint64_t _wss_sketch_hash(uint64_t obj_id) {
+  uint64_t h = obj_id;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline void wss_sketch_add(wss_sketch_t *sketch, uint64_t obj_id, int64_t obj_size) {
+  uint64_t hv = _wss_sketch_hash(obj_id);
+
+  /* the register is chosen by the high bits, and the rank is the position
+   * of the first 1 bit in the other bits */
+  uint64_t idx = hv >> (64 - WSS_SKETCH_HLL_P);
+  uint64_t w = (hv << WSS_SKETCH_HLL_P) | (1ULL << (WSS_SKETCH_HLL_P - 1));
+  uint8_t rank = (uint8_t)__builtin_clzll(w) + 1;
+  if (rank > sketch->registers[idx]) {
+    sketch->registers[idx] = rank;
+  }
+
+  /* most requests are not in the sample once it is full */
+  if (sketch->n_sample < WSS_SKETCH_N_SAMPLE || hv < sketch->sample_hv[WSS_SKETCH_N_SAMPLE - 1]) {
+    _wss_sketch_sample(sketch, hv, obj_size);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_WSSSKETCH_H
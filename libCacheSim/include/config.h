@@ -18,7 +18,13 @@ extern "C" {
 #define _GNU_SOURCE /* for sched in utils.h */
 #endif
 
+#if defined(COMPACT_CACHE_OBJ) && !defined(HEAP_ALLOCATOR)
+/* the compact objects are allocated from a per-cache arena */
+#define HEAP_ALLOCATOR HEAP_ALLOCATOR_OBJ_POOL
+#endif
+
 #ifndef HEAP_ALLOCATOR
+//#define HEAP_ALLOCATOR HEAP_ALLOCATOR_OBJ_POOL
 #define HEAP_ALLOCATOR HEAP_ALLOCATOR_MALLOC
 #endif
 
@@ -32,9 +38,18 @@ extern "C" {
 #endif
 
 #ifndef HASHTABLE_TYPE
+//#define HASHTABLE_TYPE CUCKOO_HASHTABLE
+//#define HASHTABLE_TYPE BULK_CHAINING_HASHTABLE
 #define HASHTABLE_TYPE CHAINED_HASHTABLEV2
 #endif
 
+#ifdef COMPACT_CACHE_OBJ
+#if HEAP_ALLOCATOR != HEAP_ALLOCATOR_OBJ_POOL || \
+    HASHTABLE_TYPE != CHAINED_HASHTABLEV2
+#error "COMPACT_CACHE_OBJ requires HEAP_ALLOCATOR_OBJ_POOL and CHAINED_HASHTABLEV2"
+#endif
+#endif
+
 #ifndef HASH_POWER_DEFAULT
 #define HASH_POWER_DEFAULT 23
 #endif
@@ -43,6 +58,13 @@ extern "C" {
 #define CHAINED_HASHTABLE_EXPAND_THRESHOLD 2
 #endif
 
+/* expand chainedHashTableV2 incrementally, the old and the new table are kept
+ * and a few buckets are migrated on each insert, so an expansion does not
+ * pause the simulation for a full rehash */
+#ifndef CHAINED_HASHTABLE_INCREMENTAL_EXPAND
+#define CHAINED_HASHTABLE_INCREMENTAL_EXPAND 0
+#endif
+
 #include <sys/mman.h>
 #ifndef MADV_HUGEPAGE
 #undef USE_HUGEPAGE
@@ -43,6 +43,9 @@ typedef void (*cache_free_func_ptr)(cache_t *);
 
 typedef bool (*cache_get_func_ptr)(cache_t *, const request_t *);
 
+typedef int64_t (*cache_get_batch_func_ptr)(cache_t *, const request_t *,
+                                            const int, bool *);
+
 typedef cache_obj_t *(*cache_find_func_ptr)(cache_t *, const request_t *,
                                             const bool);
 
@@ -66,6 +69,12 @@ typedef int64_t (*cache_get_n_obj_func_ptr)(const cache_t *);
 
 typedef void (*cache_print_cache_func_ptr)(const cache_t *);
 
+typedef void (*cache_update_params_func_ptr)(cache_t *, const char *);
+
+typedef bool (*cache_dump_state_func_ptr)(const cache_t *, FILE *);
+
+typedef bool (*cache_load_state_func_ptr)(cache_t *, FILE *);
+
 // #define EVICTION_AGE_ARRAY_SZE 40
 #define EVICTION_AGE_ARRAY_SZE 320
 #define EVICTION_AGE_LOG_BASE 1.08
@@ -90,12 +99,20 @@ typedef struct {
 } cache_stat_t;
 
 struct hashtable;
+struct obj_sampler;
+struct reader;
 struct cache {
   struct hashtable *hashtable;
+  // optional, a dense array of the cached objects for cache_rand_obj,
+  // NULL if the algorithm does not sample objects
+  struct obj_sampler *obj_sampler;
 
   cache_init_func_ptr cache_init;
   cache_free_func_ptr cache_free;
   cache_get_func_ptr get;
+  // serve a batch of requests in order, the result is the same as calling
+  // get on each request, but it can prefetch the hash table
+  cache_get_batch_func_ptr get_batch;
 
   cache_find_func_ptr find;
   cache_can_insert_func_ptr can_insert;
@@ -107,6 +124,13 @@ struct cache {
   cache_get_occupied_byte_func_ptr get_occupied_byte;
   cache_get_n_obj_func_ptr get_n_obj;
   cache_print_cache_func_ptr print_cache;
+  // optional, change the eviction parameters of a cache that is in use, e.g.,
+  // after warmup, NULL if the algorithm does not support it
+  cache_update_params_func_ptr update_params;
+  // optional, write/read the objects and the eviction metadata of the cache
+  // for checkpointing, NULL if the algorithm does not support it
+  cache_dump_state_func_ptr dump_state;
+  cache_load_state_func_ptr load_state;
 
   admissioner_t *admissioner;
 
@@ -139,6 +163,10 @@ struct cache {
   int64_t cache_size;
   int64_t default_ttl;
   int32_t obj_md_size;
+  // the number of bytes of the metadata union in cache_obj_t used by the
+  // eviction algorithm, -1 (default) if the algorithm does not declare it,
+  // see cache_shrink_obj
+  int32_t obj_eviction_md_size;
 
   /* cache stat is not updated automatically, it is popped up only in
    * some situations */
@@ -202,6 +230,136 @@ cache_t *clone_cache(const cache_t *old_cache);
 cache_t *create_cache_with_new_size(const cache_t *old_cache,
                                     const uint64_t new_size);
 
+/**
+ * @brief allocate the objects of the cache with only the part of the
+ * metadata union that the eviction algorithm declares in
+ * obj_eviction_md_size, e.g., FIFO and LRU objects do not have the union
+ *
+ * this must be called on a new cache, and only the creator of a top-level
+ * cache should call it, because the algorithms that are composed of other
+ * caches store their own metadata in the objects of the internal caches;
+ * it requires HEAP_ALLOCATOR_OBJ_POOL and is a no-op with COMPACT_CACHE_OBJ
+ *
+ * @param cache
+ * @return whether the objects are shrunk
+ */
+bool cache_shrink_obj(cache_t *cache);
+
+/**
+ * @brief index the hash table of the cache by object id, so a lookup is one
+ * array access without hashing; the object ids of the trace should be
+ * remapped to [0, n_obj), e.g., by traceConv with --remap-obj-id, otherwise
+ * the objects share buckets as in a normal hash table
+ *
+ * this must be called on a new cache, the table has at least n_obj entries
+ * regardless of the cache size, and it requires chainedHashTableV2;
+ * cache_rand_obj is only supported with an obj_sampler, which every
+ * eviction algorithm that samples objects enables
+ *
+ * @param cache
+ * @param n_obj the number of objects in the trace
+ * @return whether the hash table is indexed by object id
+ */
+bool cache_use_dense_obj_id(cache_t *cache, int64_t n_obj);
+
+/**
+ * @brief keep the objects of the cache in a dense array so that
+ * cache_rand_obj samples an object uniformly at random in O(1) regardless
+ * of the hash table size
+ *
+ * the position of an object in the array is stored in an int32_t field of
+ * the metadata union at pos_offset, e.g.,
+ * offsetof(cache_obj_t, Random.sample_pos); it should be called in the init
+ * function of an eviction algorithm that inserts and removes objects using
+ * cache_insert_base and cache_remove_obj_base
+ *
+ * @param cache
+ * @param pos_offset
+ */
+void cache_enable_obj_sampler(cache_t *cache, size_t pos_offset);
+
+/**
+ * @brief sample an object in the cache, the sample is uniform if the cache
+ * has an obj_sampler, otherwise, the object is sampled from the hash table,
+ * which is slow when the hash table is much larger than the number of
+ * objects and favors the objects in short chains; a cache with dense object
+ * ids must have an obj_sampler
+ *
+ * @param cache
+ * @return the sampled object
+ */
+cache_obj_t *cache_rand_obj(const cache_t *cache);
+
+/**
+ * @brief checkpoint the cache state and the reader position to a file,
+ * the cache can be restored with cache_load_state
+ *
+ * @param cache
+ * @param reader the reader that feeds the cache, can be NULL
+ * @param ofile
+ * @return whether the dump is successful
+ */
+bool cache_dump_state(const cache_t *cache, const struct reader *reader,
+                      FILE *ofile);
+
+/**
+ * @brief restore a checkpoint written by cache_dump_state, the cache must be
+ * newly created with the same algorithm, parameters and size as the
+ * checkpointed one, the reader (if not NULL) must open the same trace and
+ * is moved to the checkpointed position
+ *
+ * @param cache
+ * @param reader
+ * @param ifile
+ * @return whether the load is successful
+ */
+bool cache_load_state(cache_t *cache, struct reader *reader, FILE *ifile);
+
+/**
+ * @brief write the common cache fields and call cache->dump_state, this is
+ * used by the algorithms that are composed of other caches
+ *
+ * @param cache
+ * @param ofile
+ * @return whether the dump is successful
+ */
+bool cache_dump_state_base(const cache_t *cache, FILE *ofile);
+
+/**
+ * @brief the counterpart of cache_dump_state_base
+ *
+ * @param cache
+ * @param ifile
+ * @return whether the load is successful
+ */
+bool cache_load_state_base(cache_t *cache, FILE *ifile);
+
+/**
+ * @brief write the objects in a queue (from head to tail) that is linked by
+ * obj->queue, this is used by the algorithms that keep the objects in one
+ * queue, e.g., FIFO, LRU, Clock
+ *
+ * @param cache the cache that owns the objects
+ * @param head
+ * @param ofile
+ * @return whether the dump is successful
+ */
+bool cache_dump_obj_queue(const cache_t *cache, const cache_obj_t *head,
+                          FILE *ofile);
+
+/**
+ * @brief read the objects written by cache_dump_obj_queue, insert them into
+ * the hash table and append them to the queue in the same order
+ *
+ * @param cache
+ * @param head
+ * @param tail
+ * @param ifile
+ * @return whether the load is successful
+ */
+bool cache_load_obj_queue(cache_t *cache, cache_obj_t **head,
+                          cache_obj_t **tail, FILE *ifile);
+
 /**
  * a function that finds object from the cache, it is used by
  * all eviction algorithms that directly use the hashtable
@@ -222,6 +380,19 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req,
  */
 bool cache_get_base(cache_t *cache, const request_t *req);
 
+/**
+ * @brief serve a batch of requests in order, this is the default get_batch,
+ * it prefetches the hash buckets of the requests before calling cache->get
+ *
+ * @param cache
+ * @param reqs
+ * @param n_req
+ * @param hits if not NULL, hits[i] is set to whether reqs[i] is a hit
+ * @return the number of hits
+ */
+int64_t cache_get_batch_default(cache_t *cache, const request_t *reqs,
+                                const int n_req, bool *hits);
+
 /**
  * @brief check whether the object can be inserted into the cache
  *
@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 
 #include "../config.h"
@@ -61,11 +62,13 @@ typedef struct {
   int64_t vtime_enter_cache:40;
   int64_t freq:24;
   void *pq_node;
+  int32_t sample_pos;  // position in the cache's obj_sampler
 } Hyperbolic_obj_metadata_t;
 
 typedef struct Belady_obj_metadata {
   void *pq_node;
   int64_t next_access_vtime;
+  int32_t sample_pos;  // position in the cache's obj_sampler
 } Belady_obj_metadata_t;
 
 typedef struct {
@@ -102,6 +105,7 @@ typedef struct {
   int64_t last_access_vtime;
   int64_t insertion_time;
   int32_t oracle_idx;
+  int32_t sample_pos;  // position in the cache's obj_sampler
 } Random_obj_metadata_t;
 
 typedef struct {
@@ -117,30 +121,64 @@ typedef struct {
   bool visited;
 } QDLP_obj_metadata_t;
 
+#ifndef COMPACT_CACHE_OBJ
 typedef struct {
   int64_t insertion_time;   // measured in number of objects inserted
   int64_t freq;
   int32_t main_insert_freq;
 } S3FIFO_obj_metadata_t;
+#else
+typedef struct {
+  int32_t freq;
+} S3FIFO_obj_metadata_t;
+#endif
 
 typedef struct {
   int32_t freq;
 } __attribute__((packed)) Sieve_obj_params_t;
 
+#ifndef COMPACT_CACHE_OBJ
 typedef struct {
   int64_t next_access_vtime;
   int32_t freq;
 } __attribute__((packed)) misc_metadata_t;
+#else
+typedef struct {
+  int32_t freq;
+} __attribute__((packed)) misc_metadata_t;
+#endif
 
 // ############################## cache obj ###################################
+/**
+ * with COMPACT_CACHE_OBJ, the objects of a cache are allocated from one
+ * contiguous arena (see dataStructure/objPool.h), so the links between
+ * objects are stored as 32-bit offsets (in number of objects) relative to the
+ * object itself, 0 means NULL; the hash value and the object size are 32-bit,
+ * and the metadata union only has the algorithms that support the compact
+ * layout (FIFO, LRU, Clock, Sieve, S3FIFO)
+ *
+ * the links should always be accessed using obj_hash_next, obj_queue_prev,
+ * obj_queue_next and the corresponding setters, which work with both layouts
+ */
 struct cache_obj;
+#ifndef COMPACT_CACHE_OBJ
+typedef struct cache_obj *obj_link_t;
+typedef uint64_t obj_hv_t;
+typedef uint64_t obj_size_t;
+#else
+typedef int32_t obj_link_t;
+typedef uint32_t obj_hv_t;
+typedef uint32_t obj_size_t;
+#endif
+
 typedef struct cache_obj {
-  struct cache_obj *hash_next;
+  obj_link_t hash_next;
   obj_id_t obj_id;
-  uint64_t obj_size;
+  obj_hv_t hv;  // hash value of obj_id, so rehashing does not compute it
+  obj_size_t obj_size;
   struct {
-    struct cache_obj *prev;
-    struct cache_obj *next;
+    obj_link_t prev;
+    obj_link_t next;
   } queue;  // for LRU, FIFO, etc.
 #ifdef SUPPORT_TTL
   uint32_t exp_time;
@@ -154,6 +192,7 @@ typedef struct cache_obj {
   misc_metadata_t misc;
 
   union {
+#ifndef COMPACT_CACHE_OBJ
     LFU_obj_metadata_t lfu;          // for LFU
     Clock_obj_metadata_t clock;      // for Clock
     Size_obj_metadata_t Size;        // for Size
@@ -176,10 +215,63 @@ typedef struct cache_obj {
 
 #if defined(ENABLE_GLCACHE) && ENABLE_GLCACHE == 1
     GLCache_obj_metadata_t GLCache;
+#endif
+#else
+    Clock_obj_metadata_t clock;  // for Clock
+    S3FIFO_obj_metadata_t S3FIFO;
+    Sieve_obj_params_t sieve;
 #endif
   };
 } __attribute__((packed)) cache_obj_t;
 
+/**
+ * the per-algorithm metadata union is the last field of cache_obj_t, an
+ * algorithm that only uses a small member of the union can have its objects
+ * allocated without the rest of the union, see cache_shrink_obj in cache.h
+ */
+#define CACHE_OBJ_MD_OFFSET offsetof(cache_obj_t, clock)
+#define CACHE_OBJ_MD_SIZE (sizeof(cache_obj_t) - CACHE_OBJ_MD_OFFSET)
+/* the number of bytes of an object that uses md_size bytes of the union */
+#define CACHE_OBJ_SIZE_WITH_MD(md_size) (CACHE_OBJ_MD_OFFSET + (md_size))
+
+#ifndef COMPACT_CACHE_OBJ
+#define _OBJ_LINK_GET(obj, link) (link)
+#define _OBJ_LINK_TO(obj, target) (target)
+#else
+#define _OBJ_LINK_GET(obj, link) \
+  ((link) == 0 ? NULL : (cache_obj_t *)(obj) + (link))
+#define _OBJ_LINK_TO(obj, target) \
+  ((target) == NULL ? 0                 \
+                    : (obj_link_t)((const cache_obj_t *)(target) - (obj)))
+#endif
+
+static inline cache_obj_t *obj_hash_next(const cache_obj_t *cache_obj) {
+  return _OBJ_LINK_GET(cache_obj, cache_obj->hash_next);
+}
+
+static inline void set_obj_hash_next(cache_obj_t *cache_obj,
+                                     cache_obj_t *next) {
+  cache_obj->hash_next = _OBJ_LINK_TO(cache_obj, next);
+}
+
+static inline cache_obj_t *obj_queue_prev(const cache_obj_t *cache_obj) {
+  return _OBJ_LINK_GET(cache_obj, cache_obj->queue.prev);
+}
+
+static inline cache_obj_t *obj_queue_next(const cache_obj_t *cache_obj) {
+  return _OBJ_LINK_GET(cache_obj, cache_obj->queue.next);
+}
+
+static inline void set_obj_queue_prev(cache_obj_t *cache_obj,
+                                      cache_obj_t *prev) {
+  cache_obj->queue.prev = _OBJ_LINK_TO(cache_obj, prev);
+}
+
+static inline void set_obj_queue_next(cache_obj_t *cache_obj,
+                                      cache_obj_t *next) {
+  cache_obj->queue.next = _OBJ_LINK_TO(cache_obj, next);
+}
+
 struct request;
 /**
  * copy the cache_obj to req_dest
@@ -199,6 +291,8 @@ void copy_request_to_cache_obj(cache_obj_t *cache_obj,
 
 /**
  * create a cache_obj from request
+ * with COMPACT_CACHE_OBJ, the object is not allocated from a cache arena,
+ * so it cannot be linked with the objects of a cache
  * @param req
  * @return
  */
@@ -217,7 +311,8 @@ cache_obj_t *create_cache_obj_from_request(const struct request *req);
 static inline cache_obj_t *prev_obj_in_slist(cache_obj_t *head,
                                              cache_obj_t *cache_obj) {
   assert(head != cache_obj);
-  while (head != NULL && head->queue.next != cache_obj) head = head->queue.next;
+  while (head != NULL && obj_queue_next(head) != cache_obj)
+    head = obj_queue_next(head);
   return head;
 }
 
@@ -19,6 +19,8 @@ extern "C" {
 #define HEAP_ALLOCATOR_G_SLICE_NEW 0xa20
 #define HEAP_ALLOCATOR_MALLOC 0xa30
 #define HEAP_ALLOCATOR_ALIGNED_MALLOC 0xa40
+/* malloc, but cache_obj_t owned by the hash table uses a per-cache pool */
+#define HEAP_ALLOCATOR_OBJ_POOL 0xa50
 
 #define MURMUR3 0xb10
 #define XXHASH 0xb20
@@ -28,6 +30,8 @@ extern "C" {
 
 #define CHAINED_HASHTABLE 0xc1
 #define CUCKOO_HASHTABLE 0xc2
+#define CHAINED_HASHTABLEV2 0xc3
+#define BULK_CHAINING_HASHTABLE 0xc4
 
 #define MEM_ALIGN_SIZE 128
 
@@ -19,7 +19,11 @@
 #define my_malloc_n(type, n) (type *)g_slice_alloc(sizeof(type) * n)
 #define my_free(size, addr) g_slice_free1(size, addr)
 
-#elif HEAP_ALLOCATOR == HEAP_ALLOCATOR_MALLOC
+#elif HEAP_ALLOCATOR == HEAP_ALLOCATOR_MALLOC || \
+    HEAP_ALLOCATOR == HEAP_ALLOCATOR_OBJ_POOL
+/* with HEAP_ALLOCATOR_OBJ_POOL, the cache_obj_t owned by the hash table are
+ * allocated from a per-cache pool (dataStructure/objPool.h), others use
+ * malloc */
 #include <stdlib.h>
 #define my_malloc(type) (type *)malloc(sizeof(type))
 #define my_malloc_n(type, n) (type *)calloc(sizeof(type), n)
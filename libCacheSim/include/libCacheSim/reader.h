@@ -74,6 +74,10 @@ typedef struct {
 
   // sample some requests in the trace
   sampler_t *sampler;
+
+  // compute the hash of obj_id (req->hv) when reading the trace, so that
+  // the caches sharing the request do not hash the obj_id again
+  bool compute_hv;
 } reader_init_param_t;
 
 enum read_direction {
@@ -81,6 +85,33 @@ enum read_direction {
   READ_BACKWARD = 1,
 };
 
+/* an entry of the sparse time index of a trace */
+typedef struct trace_time_index {
+  int64_t clock_time;
+  /* the index of the request in the trace, starting from 0 */
+  int64_t req_idx;
+  /* where the request starts, the file offset of text traces, mmap_offset of
+   * binary traces (in the decompressed trace for zstd traces), and req_idx
+   * of lcs v9 traces */
+  int64_t offset;
+} trace_time_index_t;
+
+/* the metadata of a trace, which is cached in a sidecar file
+ * (<trace_path>.meta) so that it is computed only once for each trace */
+typedef struct trace_meta {
+  int64_t n_req;
+  /* the working set size, it is estimated with a sketch (see wssSketch.h)
+   * except for lcs traces */
+  int64_t n_obj;
+  int64_t wss_byte;
+  /* one entry every TRACE_META_INDEX_INTERVAL requests, lcs traces have no
+   * time index */
+  int64_t n_index;
+  trace_time_index_t *index;
+} trace_meta_t;
+
+#define TRACE_META_INDEX_INTERVAL 100000
+
 struct zstd_reader;
 typedef struct reader {
   /************* common fields *************/
@@ -141,10 +172,17 @@ typedef struct reader {
 
   // lcs trace version, used only lcs reader
   int64_t lcs_ver;
+  /* if the obj_id in the trace is remapped to [0, n_dense_obj), the number of
+   * objects, otherwise 0, see cache_use_dense_obj_id */
+  int64_t n_dense_obj;
 
   /* used for trace sampling */
   sampler_t *sampler;
   enum read_direction read_direction;
+
+  /* the metadata of the trace, NULL if it has not been loaded,
+   * see get_trace_meta */
+  trace_meta_t *meta;
 } reader_t;
 
 static inline void set_default_reader_init_params(reader_init_param_t *params) {
@@ -166,6 +204,7 @@ static inline void set_default_reader_init_params(reader_init_param_t *params) {
   params->binary_fmt_str = NULL;
 
   params->sampler = NULL;
+  params->compute_hv = true;
 }
 
 static inline reader_init_param_t default_reader_init_params(void) {
@@ -235,6 +274,28 @@ int read_one_req(reader_t *reader, request_t *req);
  */
 static inline int read_trace(reader_t *const reader, request_t *const req) { return read_one_req(reader, req); }
 
+/**
+ * read at most n requests from reader/trace into the pre-allocated reqs,
+ * oracleGeneral, lcs (v1, v2 and v9) and binary traces are read in a tight loop,
+ * and the sampler and cap_at_n_req are applied to the batch, other traces
+ * are read one request at a time
+ * @param reader
+ * @param reqs an array of at least n requests
+ * @param n
+ * return the number of requests read, which is smaller than n only at the end
+ * of the trace (or the cap), 0 if no request is left
+ */
+int read_n_reqs(reader_t *reader, request_t *reqs, int n);
+
+/**
+ * the same as read_n_reqs, but only reads the fields used in simulation
+ * @param reader
+ * @param reqs an array of at least n requests
+ * @param n
+ * return the number of requests read
+ */
+int read_n_hot_reqs(reader_t *reader, req_hot_t *reqs, int n);
+
 /**
  * reset reader, so we can read from the beginning
  * @param reader
@@ -269,6 +330,38 @@ int go_back_one_req(reader_t *reader);
 
 void reader_set_read_pos(reader_t *reader, double pos);
 
+int reader_seek_req(reader_t *reader, int64_t req_idx);
+
+/**
+ * jump to the first request whose clock_time is not before the given time,
+ * so that a time range of the trace can be read without reading the requests
+ * before it. The requests in the trace must be sorted by time.
+ * Uncompressed binary traces (e.g., oracleGeneral and lcs) are binary
+ * searched, lcs v9 traces use the block index, and text and zstd traces read
+ * forward from the closest entry of the time index in the trace metadata
+ * (see get_trace_meta). Seekable zstd traces are binary searched if the
+ * reader has no metadata, e.g., when it samples the trace.
+ *
+ * @param reader
+ * @param clock_time
+ * @return 0 on success, 1 if all requests are before the time, the reader is
+ *      then at the end of the trace
+ */
+int reader_seek_time(reader_t *reader, int64_t clock_time);
+
+/**
+ * get the metadata of the trace, the metadata is read from the sidecar file
+ * <trace_path>.meta if the trace and the reader parameters have not changed
+ * since the sidecar was written, otherwise it is computed with one pass over
+ * the trace and written to the sidecar. lcs traces use the stat in the trace
+ * header instead. The position of the reader does not change.
+ *
+ * @param reader
+ * @return the metadata owned by the reader, NULL if the reader samples or
+ *      caps the trace, so its requests are not the requests in the trace
+ */
+const trace_meta_t *get_trace_meta(reader_t *reader);
+
 static inline void print_reader(reader_t *reader) {
   printf(
       "trace_type: %s, trace_path: %s, trace_start_offset: %d, mmap_offset: "
@@ -6,6 +6,7 @@
 #define libCacheSim_REQUEST_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -19,11 +20,15 @@ extern "C" {
 
 #define N_MAX_FEATURES 16
 
-/* need to optimize this for CPU cacheline */
 typedef struct request {
+  /* the fields used when simulating a cache are in the first cache line */
   int64_t clock_time; /* use uint64_t because vscsi uses microsec timestamp */
 
-  uint64_t hv; /* hash value, used when offloading hash to reader */
+  /* hash value of obj_id, used when offloading hash to reader,
+   * hv is only valid if hv_obj_id == obj_id, so changing the obj_id of a
+   * copied request does not need to reset the hv */
+  uint64_t hv;
+  obj_id_t hv_obj_id;
 
   /* this represents the hash of the object id in key-value cache
    * or the logical block address in block cache, note that LBA % block_size == 0 */
@@ -31,15 +36,20 @@ typedef struct request {
 
   int64_t obj_size;
 
+  int64_t next_access_vtime;
+
   int32_t ttl;
 
   req_op_e op;
 
   int32_t tenant_id;
 
-  uint64_t n_req;
+  bool valid; /* indicate whether request is valid request
+               * it is invalid if the trace reaches the end */
 
-  int64_t next_access_vtime;
+  /* the fields below are used by a few algorithms, the trace analyzer and
+   * traces with features */
+  uint64_t n_req;
 
   // this is used by key-value cache traces
   struct {
@@ -62,13 +72,28 @@ typedef struct request {
   bool first_seen_in_window; /* the first time see in the time window */
   /* used in trace analysis */
 
-  bool valid; /* indicate whether request is valid request
-               * it is invalid if the trace reaches the end */
-
   int32_t n_features;
   int32_t features[N_MAX_FEATURES];
 
 } request_t;
+// assert the simulation fields fit in one cache line at compile time
+typedef char static_assert_request_hot_fields[(offsetof(request_t, n_req) <= 64) ? 1 : -1];
+
+/**
+ * the fields of request_t used in simulation, this is used to store and pass
+ * large batches of requests, it is less than a third of the size of request_t
+ */
+typedef struct req_hot {
+  int64_t clock_time;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  int64_t next_access_vtime;
+  /* 0 if the hash is not computed */
+  uint64_t hv;
+  int32_t ttl;
+  int32_t tenant_id;
+  req_op_e op;
+} req_hot_t;
 
 /**
  * allocate a new request_t struct and fill in necessary field
@@ -83,6 +108,7 @@ static inline request_t *new_request(void) {
   req->obj_id = 0;
   req->clock_time = 0;
   req->hv = 0;
+  req->hv_obj_id = 0;
   req->next_access_vtime = -2;
   req->ttl = 0;
   return req;
@@ -97,6 +123,41 @@ static inline void copy_request(request_t *req_dest, const request_t *req_src) {
   memcpy(req_dest, req_src, sizeof(request_t));
 }
 
+/**
+ * copy the simulation fields of req_src to hot_dest
+ * @param hot_dest
+ * @param req_src
+ */
+static inline void copy_request_to_hot(req_hot_t *hot_dest, const request_t *req_src) {
+  hot_dest->clock_time = req_src->clock_time;
+  hot_dest->obj_id = req_src->obj_id;
+  hot_dest->obj_size = req_src->obj_size;
+  hot_dest->next_access_vtime = req_src->next_access_vtime;
+  hot_dest->hv = req_src->hv_obj_id == req_src->obj_id ? req_src->hv : 0;
+  hot_dest->ttl = req_src->ttl;
+  hot_dest->tenant_id = req_src->tenant_id;
+  hot_dest->op = req_src->op;
+}
+
+/**
+ * copy hot_src to the simulation fields of req_dest, the other fields of
+ * req_dest are not changed
+ * @param req_dest
+ * @param hot_src
+ */
+static inline void copy_hot_to_request(request_t *req_dest, const req_hot_t *hot_src) {
+  req_dest->clock_time = hot_src->clock_time;
+  req_dest->obj_id = hot_src->obj_id;
+  req_dest->obj_size = hot_src->obj_size;
+  req_dest->next_access_vtime = hot_src->next_access_vtime;
+  req_dest->hv = hot_src->hv;
+  req_dest->hv_obj_id = hot_src->obj_id;
+  req_dest->ttl = hot_src->ttl;
+  req_dest->tenant_id = hot_src->tenant_id;
+  req_dest->op = hot_src->op;
+  req_dest->valid = true;
+}
+
 /**
  * clone the given request
  * @param req
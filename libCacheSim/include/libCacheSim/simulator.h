@@ -35,6 +35,10 @@ extern "C" {
  * @param warmup_reader
  * @param warmup_frac
  * @param num_of_threads
+ * @param use_random_seed
+ * @param shared_decode decode the trace once in a producer thread and feed
+ *  the requests to all simulations, instead of each simulation decoding
+ *  the trace on its own
  * @return
  */
 cache_stat_t *simulate_at_multi_sizes(reader_t *reader, 
@@ -45,7 +49,8 @@ cache_stat_t *simulate_at_multi_sizes(reader_t *reader,
                                       double warmup_frac, 
                                       int warmup_sec,
                                       int num_of_threads, 
-                                      bool use_random_seed);
+                                      bool use_random_seed,
+                                      bool shared_decode);
 
 /**
  * this function performs cache_size/step_size simulations to obtain miss ratio,
@@ -64,6 +69,8 @@ cache_stat_t *simulate_at_multi_sizes(reader_t *reader,
  * @param step_size
  * @param warmup_frac
  * @param num_of_threads
+ * @param use_random_seed
+ * @param shared_decode see simulate_at_multi_sizes
  * @return an array of cache_stat_t, each corresponds to one simulation
  */
 
@@ -74,7 +81,8 @@ cache_stat_t *simulate_at_multi_sizes_with_step_size(reader_t *reader_in,
                                                      double warmup_frac, 
                                                      int warmup_sec, 
                                                      int num_of_threads, 
-                                                     bool use_random_seed);
+                                                     bool use_random_seed,
+                                                     bool shared_decode);
 
 /**
  * this function performs num_of_caches simulations with the caches,
@@ -87,6 +95,9 @@ cache_stat_t *simulate_at_multi_sizes_with_step_size(reader_t *reader_in,
  * @param warmup_reader
  * @param warmup_frac
  * @param num_of_threads
+ * @param free_cache_when_finish
+ * @param use_random_seed
+ * @param shared_decode see simulate_at_multi_sizes
  * @return
  */
 cache_stat_t *simulate_with_multi_caches(reader_t *reader, 
@@ -97,7 +108,40 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader,
                                          int warmup_sec,
                                          int num_of_threads, 
                                          bool free_cache_when_finish, 
-                                         bool use_random_seed);
+                                         bool use_random_seed,
+                                         bool shared_decode);
+
+/**
+ * this function warms up one cache and then simulates n_variant parameter
+ * variants of the warm cache, each variant changes the eviction parameters
+ * of the warm cache with cache->update_params and replays the rest of the
+ * trace, so the warmup is only simulated once for all variants.
+ * Each variant runs in a child process forked from the warm cache, the
+ * children share the warm cache with the parent through copy-on-write
+ * and report their result through a pipe
+ * the returned cache_stat_t should be freed by the user
+ *
+ * @param reader
+ * @param cache the cache to warm up, it is not modified
+ * @param n_variant
+ * @param variant_params the eviction parameters of each variant, NULL keeps
+ *  the parameters of the cache
+ * @param warmup_reader
+ * @param warmup_frac
+ * @param warmup_sec
+ * @param num_of_procs the max number of child processes running at once
+ * @param use_random_seed
+ * @return an array of cache_stat_t, each corresponds to one variant
+ */
+cache_stat_t *simulate_with_warm_cache_branching(reader_t *reader,
+                                                 const cache_t *cache,
+                                                 int n_variant,
+                                                 const char *variant_params[],
+                                                 reader_t *warmup_reader,
+                                                 double warmup_frac,
+                                                 int warmup_sec,
+                                                 int num_of_procs,
+                                                 bool use_random_seed);
 
 #ifdef __cplusplus
 }
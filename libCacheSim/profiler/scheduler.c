@@ -0,0 +1,242 @@
+//
+// a cost-aware work-stealing scheduler used by the simulator
+//
+// the simulations in a sweep have very different running time, e.g., LRB
+// at a large cache size can take orders of magnitude longer than FIFO at a
+// small size, a FIFO thread pool that starts the jobs in submission order
+// often ends with one expensive job running alone. Here the jobs are started
+// longest first (LPT scheduling), each worker owns a queue, and an idle
+// worker steals the most expensive job left in other queues
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "scheduler.h"
+
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/mem.h"
+#include "../utils/include/myprint.h"
+
+/* how often the main thread reports progress */
+#define SCHED_PROGRESS_INTERVAL_SEC 60
+
+/* the relative per-request cost of the eviction algorithms, the ones not in
+ * the list use 1, the names are matched by prefix in order */
+static const struct {
+  const char *name_prefix;
+  double weight;
+} algo_cost_weights[] = {
+    {"LRB", 64},      {"GLCache", 16}, {"LHD", 16},     {"BeladySize", 8}, {"Hyperbolic", 8},
+    {"Cacheus", 6},   {"LeCaR", 6},    {"Belady", 3},   {"GDSF", 3},       {"LFUDA", 3},
+    {"CR_LFU", 3},    {"LFU", 3},      {"LIRS", 2},     {"ARC", 2},        {"WTinyLFU", 2},
+};
+
+typedef struct {
+  /* job indices in descending order of cost */
+  int *jobs;
+  /* jobs[head, tail) have not started */
+  int head;
+  int tail;
+  double remaining_cost;
+  GMutex mtx;
+} job_queue_t;
+
+typedef struct {
+  job_queue_t *queues;
+  int n_worker;
+  const double *job_costs;
+  sched_job_func_ptr func;
+  void *user_data;
+
+  GMutex mtx;
+  GCond job_done;
+  int n_done;
+} scheduler_t;
+
+typedef struct {
+  scheduler_t *sched;
+  int worker_id;
+} worker_arg_t;
+
+double estimate_sim_job_cost(const cache_t *cache) {
+  double weight = 1;
+  for (size_t i = 0; i < sizeof(algo_cost_weights) / sizeof(algo_cost_weights[0]); i++) {
+    const char *prefix = algo_cost_weights[i].name_prefix;
+    if (strncasecmp(cache->cache_name, prefix, strlen(prefix)) == 0) {
+      weight = algo_cost_weights[i].weight;
+      break;
+    }
+  }
+
+  /* a larger cache keeps more objects, which makes the hash table and the
+   * eviction metadata less cache-friendly and the learned algorithms train
+   * on more objects */
+  return weight * log2((double)cache->cache_size + 2);
+}
+
+static gint _cmp_job_cost_desc(gconstpointer a, gconstpointer b, gpointer user_data) {
+  const double *job_costs = (const double *)user_data;
+  double ca = job_costs[*(const int *)a];
+  double cb = job_costs[*(const int *)b];
+  if (ca > cb) return -1;
+  if (ca < cb) return 1;
+  /* keep the submission order for jobs with the same cost */
+  return *(const int *)a - *(const int *)b;
+}
+
+/**
+ * @brief take the most expensive job from the queue
+ *
+ * @return the job index, -1 if the queue is empty
+ */
+static int _pop_job(scheduler_t *sched, job_queue_t *queue) {
+  int job = -1;
+  g_mutex_lock(&queue->mtx);
+  if (queue->head < queue->tail) {
+    job = queue->jobs[queue->head++];
+    queue->remaining_cost -= sched->job_costs[job];
+  }
+  g_mutex_unlock(&queue->mtx);
+  return job;
+}
+
+/**
+ * @brief steal a job from the queue that has the most work left,
+ * because the jobs are never added after start, the function returns -1
+ * only when all jobs have been started
+ */
+static int _steal_job(scheduler_t *sched, int thief_id) {
+  while (true) {
+    int victim = -1;
+    double max_cost = -1;
+    for (int i = 0; i < sched->n_worker; i++) {
+      if (i == thief_id) continue;
+      job_queue_t *queue = &sched->queues[i];
+      g_mutex_lock(&queue->mtx);
+      if (queue->head < queue->tail && queue->remaining_cost > max_cost) {
+        max_cost = queue->remaining_cost;
+        victim = i;
+      }
+      g_mutex_unlock(&queue->mtx);
+    }
+    if (victim == -1) return -1;
+
+    int job = _pop_job(sched, &sched->queues[victim]);
+    /* the victim may have emptied its queue since we looked */
+    if (job != -1) return job;
+  }
+}
+
+static gpointer _worker(gpointer data) {
+  worker_arg_t *arg = (worker_arg_t *)data;
+  scheduler_t *sched = arg->sched;
+
+  while (true) {
+    int job = _pop_job(sched, &sched->queues[arg->worker_id]);
+    if (job == -1) job = _steal_job(sched, arg->worker_id);
+    if (job == -1) break;
+
+    sched->func(job, sched->user_data);
+
+    g_mutex_lock(&sched->mtx);
+    sched->n_done += 1;
+    g_cond_signal(&sched->job_done);
+    g_mutex_unlock(&sched->mtx);
+  }
+
+  return NULL;
+}
+
+void run_jobs_with_work_stealing(int n_job, const double *job_costs, int n_thread, sched_job_func_ptr func,
+                                 void *user_data) {
+  if (n_job <= 0) return;
+
+  double *costs = my_malloc_n(double, n_job);
+  for (int i = 0; i < n_job; i++) {
+    costs[i] = job_costs != NULL ? job_costs[i] : 1;
+  }
+
+  int *order = my_malloc_n(int, n_job);
+  for (int i = 0; i < n_job; i++) {
+    order[i] = i;
+  }
+  g_qsort_with_data(order, n_job, sizeof(int), _cmp_job_cost_desc, costs);
+
+  scheduler_t sched;
+  sched.n_worker = MAX(1, MIN(n_thread, n_job));
+  sched.job_costs = costs;
+  sched.func = func;
+  sched.user_data = user_data;
+  sched.n_done = 0;
+  g_mutex_init(&sched.mtx);
+  g_cond_init(&sched.job_done);
+
+  /* assign each job, longest first, to the queue with the least work, so
+   * that the workers rarely need to steal */
+  sched.queues = my_malloc_n(job_queue_t, sched.n_worker);
+  for (int i = 0; i < sched.n_worker; i++) {
+    sched.queues[i].jobs = my_malloc_n(int, n_job);
+    sched.queues[i].head = 0;
+    sched.queues[i].tail = 0;
+    sched.queues[i].remaining_cost = 0;
+    g_mutex_init(&sched.queues[i].mtx);
+  }
+  for (int i = 0; i < n_job; i++) {
+    job_queue_t *min_queue = &sched.queues[0];
+    for (int j = 1; j < sched.n_worker; j++) {
+      if (sched.queues[j].remaining_cost < min_queue->remaining_cost) min_queue = &sched.queues[j];
+    }
+    min_queue->jobs[min_queue->tail++] = order[i];
+    min_queue->remaining_cost += costs[order[i]];
+  }
+
+  worker_arg_t *args = my_malloc_n(worker_arg_t, sched.n_worker);
+  GThread **workers = my_malloc_n(GThread *, sched.n_worker);
+  for (int i = 0; i < sched.n_worker; i++) {
+    args[i].sched = &sched;
+    args[i].worker_id = i;
+    workers[i] = g_thread_new("sim-worker", _worker, &args[i]);
+  }
+
+  /* sleep until all jobs finish, wake up periodically to report progress */
+  gint64 report_time = g_get_monotonic_time() + SCHED_PROGRESS_INTERVAL_SEC * G_TIME_SPAN_SECOND;
+  g_mutex_lock(&sched.mtx);
+  while (sched.n_done < n_job) {
+    if (!g_cond_wait_until(&sched.job_done, &sched.mtx, report_time)) {
+      double perc = (double)sched.n_done / (double)n_job * 100;
+      g_mutex_unlock(&sched.mtx);
+      print_progress(perc);
+      g_mutex_lock(&sched.mtx);
+      report_time = g_get_monotonic_time() + SCHED_PROGRESS_INTERVAL_SEC * G_TIME_SPAN_SECOND;
+    }
+  }
+  g_mutex_unlock(&sched.mtx);
+
+  for (int i = 0; i < sched.n_worker; i++) {
+    g_thread_join(workers[i]);
+  }
+
+  for (int i = 0; i < sched.n_worker; i++) {
+    my_free(sizeof(int) * n_job, sched.queues[i].jobs);
+    g_mutex_clear(&sched.queues[i].mtx);
+  }
+  my_free(sizeof(job_queue_t) * sched.n_worker, sched.queues);
+  my_free(sizeof(GThread *) * sched.n_worker, workers);
+  my_free(sizeof(worker_arg_t) * sched.n_worker, args);
+  my_free(sizeof(int) * n_job, order);
+  my_free(sizeof(double) * n_job, costs);
+  g_mutex_clear(&sched.mtx);
+  g_cond_clear(&sched.job_done);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+//
+// a cost-aware work-stealing scheduler used by the simulator to run one
+// simulation per job
+//
+
+#ifndef libCacheSim_SCHEDULER_H
+#define libCacheSim_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../include/libCacheSim/cache.h"
+
+typedef void (*sched_job_func_ptr)(int job_idx, void *user_data);
+
+/**
+ * @brief estimate the relative cost of simulating a cache, the cost is only
+ * used to order the jobs, so only the ratio between two costs matters
+ *
+ * @param cache
+ * @return the estimated cost
+ */
+double estimate_sim_job_cost(const cache_t *cache);
+
+/**
+ * @brief run n_job jobs on n_thread worker threads and return when all jobs
+ * finish, the jobs are started in descending order of cost so that the
+ * expensive jobs do not form a long tail, each worker has its own queue and
+ * steals the most expensive job left from other workers when its queue is
+ * empty. The calling thread sleeps until the jobs finish and reports
+ * progress periodically
+ *
+ * @param n_job
+ * @param job_costs the estimated cost of each job, can be NULL
+ * @param n_thread
+ * @param func called as func(job_idx, user_data) for each job
+ * @param user_data
+ */
+void run_jobs_with_work_stealing(int n_job, const double *job_costs, int n_thread, sched_job_func_ptr func,
+                                 void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_SCHEDULER_H
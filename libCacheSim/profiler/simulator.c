@@ -12,13 +12,19 @@ extern "C" {
 
 #include "../include/libCacheSim/simulator.h"
 
+#include <errno.h>
 #include <math.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../cache/cacheUtils.h"
 #include "../include/libCacheSim/evictionAlgo.h"
 #include "../include/libCacheSim/plugin.h"
+#include "../traceReader/customizedReader/lcs.h"
 #include "../utils/include/myprint.h"
 #include "../utils/include/mystr.h"
+#include "scheduler.h"
 
 typedef struct simulator_multithreading_params {
   reader_t *reader;
@@ -28,16 +34,17 @@ typedef struct simulator_multithreading_params {
   reader_t *warmup_reader;
   int warmup_sec; /* num of seconds of requests used for warming up cache */
   cache_stat_t *result;
-  GMutex mtx; /* prevent simultaneous write to progress */
-  gint *progress;
   gpointer other_data;
   bool free_cache_when_finish;
   bool use_random_seed;
+  struct shared_req_ring *ring; /* only used in shared decode mode */
 } sim_mt_params_t;
 
-static void _simulate(gpointer data, gpointer user_data) {
+/* the number of requests passed to cache->get_batch at a time */
+#define SIM_GET_BATCH_SIZE 64
+
+static void _simulate(int idx, void *user_data) {
   sim_mt_params_t *params = (sim_mt_params_t *)user_data;
-  int idx = GPOINTER_TO_UINT(data) - 1;
   if (params->use_random_seed) {
     set_rand_seed(rand());
   } else {
@@ -85,17 +92,39 @@ static void _simulate(gpointer data, gpointer user_data) {
          local_cache->cache_name, local_cache->cache_size, n_warmup, (double)(req->clock_time - start_ts) / 3600.0);
   }
 
-  while (req->valid) {
-    result[idx].n_req++;
-    result[idx].n_req_byte += req->obj_size;
-
-    req->clock_time -= start_ts;
-    if (local_cache->get(local_cache, req) == false) {
-      result[idx].n_miss++;
-      result[idx].n_miss_byte += req->obj_size;
+  /* serve the requests in batches so that the cache can prefetch */
+  request_t *reqs = my_malloc_n(request_t, SIM_GET_BATCH_SIZE);
+  bool *hits = my_malloc_n(bool, SIM_GET_BATCH_SIZE);
+  /* the readers only set the fields in the trace, the other fields keep the
+   * values of req */
+  for (int i = 0; i < SIM_GET_BATCH_SIZE; i++) {
+    copy_request(&reqs[i], req);
+  }
+  int n_req = 0;
+  if (req->valid) {
+    /* the request read after warmup */
+    copy_request(&reqs[n_req++], req);
+    n_req += read_n_reqs(cloned_reader, reqs + n_req, SIM_GET_BATCH_SIZE - n_req);
+  }
+  while (n_req > 0) {
+    for (int i = 0; i < n_req; i++) {
+      reqs[i].clock_time -= start_ts;
     }
-    read_one_req(cloned_reader, req);
+    req->clock_time = reqs[n_req - 1].clock_time;
+
+    local_cache->get_batch(local_cache, reqs, n_req, hits);
+    for (int i = 0; i < n_req; i++) {
+      result[idx].n_req++;
+      result[idx].n_req_byte += reqs[i].obj_size;
+      if (!hits[i]) {
+        result[idx].n_miss++;
+        result[idx].n_miss_byte += reqs[i].obj_size;
+      }
+    }
+    n_req = read_n_reqs(cloned_reader, reqs, SIM_GET_BATCH_SIZE);
   }
+  my_free(sizeof(request_t) * SIM_GET_BATCH_SIZE, reqs);
+  my_free(sizeof(bool) * SIM_GET_BATCH_SIZE, hits);
 
 /* disabled due to ARC and LeCaR use ghost entries in the hash table */
 #if defined(SUPPORT_TTL) && defined(ENABLE_SCAN)
@@ -123,11 +152,6 @@ static void _simulate(gpointer data, gpointer user_data) {
   result[idx].occupied_byte = local_cache->occupied_byte;
   strncpy(result[idx].cache_name, local_cache->cache_name, CACHE_NAME_ARRAY_LEN);
 
-  // report progress
-  g_mutex_lock(&(params->mtx));
-  (*(params->progress))++;
-  g_mutex_unlock(&(params->mtx));
-
   // clean up
   if (params->free_cache_when_finish) {
     local_cache->cache_free(local_cache);
@@ -136,9 +160,381 @@ static void _simulate(gpointer data, gpointer user_data) {
   close_reader(cloned_reader);
 }
 
+/************************ shared decode ************************/
+/* in shared decode mode, one producer thread reads the trace into a ring of
+ * fixed-size request batches, and every consumer thread runs the batches
+ * through the caches it owns, so the trace is decoded once no matter how
+ * many caches are simulated. A batch is refilled only after all consumers
+ * have finished it */
+#define SHARED_DECODE_BATCH_SIZE 4096
+#define SHARED_DECODE_N_BATCH 8
+/* how often the main thread reports progress */
+#define SHARED_DECODE_PROGRESS_INTERVAL_SEC 60
+
+typedef struct {
+  /* only the simulation fields are decoded, which keeps the ring small */
+  req_hot_t *reqs;
+  int n_req;
+  /* the number of consumers that have not finished this batch */
+  int n_pending_consumer;
+  /* the requests are from the warmup reader */
+  bool from_warmup_reader;
+  /* the last batch of the trace */
+  bool last;
+} req_batch_t;
+
+typedef struct shared_req_ring {
+  req_batch_t batches[SHARED_DECODE_N_BATCH];
+  int n_consumer;
+  /* the number of batches that have been filled since the start */
+  int64_t n_filled;
+  /* the number of requests that all consumers have finished, for reporting
+   * progress */
+  int64_t n_done_req;
+  int n_done_consumer;
+  GMutex mtx;
+  GCond batch_filled;
+  GCond batch_freed;
+  GCond consumer_done;
+} shared_req_ring_t;
+
+/* the per-cache state of a consumer */
+typedef struct {
+  int idx;
+  bool in_warmup;
+  uint64_t n_warmup;
+  /* each cache has its own random number stream so that the result is the
+   * same as simulating the cache on its own thread */
+  __uint128_t rand_state;
+} shared_cache_state_t;
+
+typedef struct {
+  sim_mt_params_t *params;
+  int consumer_id;
+} shared_consumer_arg_t;
+
+static shared_req_ring_t *_create_shared_req_ring(int n_consumer) {
+  shared_req_ring_t *ring = my_malloc(shared_req_ring_t);
+  memset(ring, 0, sizeof(shared_req_ring_t));
+  for (int i = 0; i < SHARED_DECODE_N_BATCH; i++) {
+    ring->batches[i].reqs = my_malloc_n(req_hot_t, SHARED_DECODE_BATCH_SIZE);
+  }
+  ring->n_consumer = n_consumer;
+  ring->n_filled = 0;
+  ring->n_done_req = 0;
+  ring->n_done_consumer = 0;
+  g_mutex_init(&ring->mtx);
+  g_cond_init(&ring->batch_filled);
+  g_cond_init(&ring->batch_freed);
+  g_cond_init(&ring->consumer_done);
+
+  return ring;
+}
+
+static void _free_shared_req_ring(shared_req_ring_t *ring) {
+  for (int i = 0; i < SHARED_DECODE_N_BATCH; i++) {
+    my_free(sizeof(req_hot_t) * SHARED_DECODE_BATCH_SIZE, ring->batches[i].reqs);
+  }
+  g_mutex_clear(&ring->mtx);
+  g_cond_clear(&ring->batch_filled);
+  g_cond_clear(&ring->batch_freed);
+  g_cond_clear(&ring->consumer_done);
+  my_free(sizeof(shared_req_ring_t), ring);
+}
+
+/**
+ * @brief fill the batches from the reader and publish them to the consumers
+ *
+ * @param ring
+ * @param reader
+ * @param from_warmup_reader
+ * @param last_reader whether this is the last reader to read from
+ * @param seq the sequence number of the next batch to fill
+ * @return the sequence number of the next batch to fill
+ */
+static int64_t _shared_decode_fill(shared_req_ring_t *ring, reader_t *reader, bool from_warmup_reader, bool last_reader,
+                                   int64_t seq) {
+  int64_t start_ts = -1;
+  bool eof = false;
+
+  while (!eof) {
+    req_batch_t *batch = &ring->batches[seq % SHARED_DECODE_N_BATCH];
+
+    /* wait for the slowest consumer to finish the batch */
+    g_mutex_lock(&ring->mtx);
+    while (batch->n_pending_consumer > 0) {
+      g_cond_wait(&ring->batch_freed, &ring->mtx);
+    }
+    g_mutex_unlock(&ring->mtx);
+
+    int n_req = read_n_hot_reqs(reader, batch->reqs, SHARED_DECODE_BATCH_SIZE);
+    eof = n_req < SHARED_DECODE_BATCH_SIZE;
+    /* the warmup trace is replayed as is */
+    if (!from_warmup_reader && n_req > 0) {
+      if (start_ts == -1) start_ts = batch->reqs[0].clock_time;
+      for (int i = 0; i < n_req; i++) {
+        batch->reqs[i].clock_time -= start_ts;
+      }
+    }
+
+    if (eof && n_req == 0 && !last_reader) {
+      /* nothing to publish, the next reader fills this batch */
+      break;
+    }
+
+    g_mutex_lock(&ring->mtx);
+    batch->n_req = n_req;
+    batch->from_warmup_reader = from_warmup_reader;
+    batch->last = eof && last_reader;
+    batch->n_pending_consumer = ring->n_consumer;
+    ring->n_filled = ++seq;
+    g_cond_broadcast(&ring->batch_filled);
+    g_mutex_unlock(&ring->mtx);
+  }
+
+  return seq;
+}
+
+static gpointer _shared_decode_producer(gpointer data) {
+  sim_mt_params_t *params = (sim_mt_params_t *)data;
+  int64_t seq = 0;
+
+  if (params->warmup_reader) {
+    reader_t *warmup_cloned_reader = clone_reader(params->warmup_reader);
+    seq = _shared_decode_fill(params->ring, warmup_cloned_reader, true, false, seq);
+    close_reader(warmup_cloned_reader);
+  }
+
+  reader_t *cloned_reader = clone_reader(params->reader);
+  _shared_decode_fill(params->ring, cloned_reader, false, true, seq);
+  close_reader(cloned_reader);
+
+  return NULL;
+}
+
+static void _shared_decode_finish_warmup(sim_mt_params_t *params, shared_cache_state_t *state,
+                                         int64_t clock_time) {
+  cache_t *local_cache = params->caches[state->idx];
+  state->in_warmup = false;
+  params->result[state->idx].n_warmup_req += state->n_warmup;
+  INFO("cache %s (size %" PRIu64 ") finishes warm up using with %" PRIu64 " requests, %.2lf hour trace time\n",
+       local_cache->cache_name, local_cache->cache_size, state->n_warmup, (double)clock_time / 3600.0);
+}
+
+/* run one batch through one cache, this follows the same logic as _simulate,
+ * reqs is a scratch array of SIM_GET_BATCH_SIZE requests that the hot requests
+ * are expanded into */
+static void _shared_decode_process_batch(sim_mt_params_t *params, shared_cache_state_t *state,
+                                         const req_batch_t *batch, request_t *reqs, bool *hits) {
+  cache_t *local_cache = params->caches[state->idx];
+  cache_stat_t *result = &params->result[state->idx];
+
+  g_lehmer64_state = state->rand_state;
+
+  if (batch->from_warmup_reader) {
+    for (int i = 0; i < batch->n_req; i++) {
+      copy_hot_to_request(&reqs[0], &batch->reqs[i]);
+      local_cache->get(local_cache, &reqs[0]);
+    }
+    result->n_warmup_req += batch->n_req;
+    state->rand_state = g_lehmer64_state;
+    return;
+  }
+
+  int i = 0;
+  while (state->in_warmup && i < batch->n_req) {
+    const req_hot_t *req = &batch->reqs[i];
+    if (state->n_warmup < params->n_warmup_req || req->clock_time < params->warmup_sec) {
+      copy_hot_to_request(&reqs[0], req);
+      local_cache->get(local_cache, &reqs[0]);
+      state->n_warmup += 1;
+      i += 1;
+    } else {
+      _shared_decode_finish_warmup(params, state, req->clock_time);
+    }
+  }
+
+  for (; i < batch->n_req; i += SIM_GET_BATCH_SIZE) {
+    int n_req = MIN(batch->n_req - i, SIM_GET_BATCH_SIZE);
+    for (int j = 0; j < n_req; j++) {
+      copy_hot_to_request(&reqs[j], &batch->reqs[i + j]);
+    }
+    local_cache->get_batch(local_cache, reqs, n_req, hits);
+    for (int j = 0; j < n_req; j++) {
+      result->n_req++;
+      result->n_req_byte += reqs[j].obj_size;
+      if (!hits[j]) {
+        result->n_miss++;
+        result->n_miss_byte += reqs[j].obj_size;
+      }
+    }
+  }
+  if (batch->n_req > 0) {
+    result->curr_rtime = batch->reqs[batch->n_req - 1].clock_time;
+  }
+
+  state->rand_state = g_lehmer64_state;
+}
+
+static gpointer _shared_decode_consumer(gpointer data) {
+  shared_consumer_arg_t *arg = (shared_consumer_arg_t *)data;
+  sim_mt_params_t *params = arg->params;
+  shared_req_ring_t *ring = params->ring;
+  cache_stat_t *result = params->result;
+
+  /* the caches are assigned to the consumers round-robin */
+  int n_owned_cache = 0;
+  shared_cache_state_t *states = my_malloc_n(shared_cache_state_t, params->n_caches / ring->n_consumer + 1);
+  for (int idx = arg->consumer_id; idx < params->n_caches; idx += ring->n_consumer) {
+    shared_cache_state_t *state = &states[n_owned_cache++];
+    state->idx = idx;
+    state->in_warmup = params->n_warmup_req > 0 || params->warmup_sec > 0;
+    state->n_warmup = 0;
+    if (params->use_random_seed) {
+      set_rand_seed(rand());
+    } else {
+      set_rand_seed(1);
+    }
+    state->rand_state = g_lehmer64_state;
+    strncpy(result[idx].cache_name, params->caches[idx]->cache_name, CACHE_NAME_ARRAY_LEN);
+  }
+
+  request_t *reqs = my_malloc_n(request_t, SIM_GET_BATCH_SIZE);
+  request_t *default_req = new_request();
+  for (int i = 0; i < SIM_GET_BATCH_SIZE; i++) {
+    copy_request(&reqs[i], default_req);
+  }
+  free_request(default_req);
+  bool *hits = my_malloc_n(bool, SIM_GET_BATCH_SIZE);
+  int64_t seq = 0;
+  bool last = false;
+  while (!last) {
+    req_batch_t *batch = &ring->batches[seq % SHARED_DECODE_N_BATCH];
+
+    g_mutex_lock(&ring->mtx);
+    while (ring->n_filled <= seq) {
+      g_cond_wait(&ring->batch_filled, &ring->mtx);
+    }
+    g_mutex_unlock(&ring->mtx);
+
+    for (int i = 0; i < n_owned_cache; i++) {
+      _shared_decode_process_batch(params, &states[i], batch, reqs, hits);
+    }
+    last = batch->last;
+
+    g_mutex_lock(&ring->mtx);
+    batch->n_pending_consumer -= 1;
+    if (batch->n_pending_consumer == 0) {
+      ring->n_done_req += batch->n_req;
+      g_cond_signal(&ring->batch_freed);
+    }
+    g_mutex_unlock(&ring->mtx);
+    seq += 1;
+  }
+
+  for (int i = 0; i < n_owned_cache; i++) {
+    int idx = states[i].idx;
+    cache_t *local_cache = params->caches[idx];
+    if (states[i].in_warmup) {
+      /* the whole trace is used for warmup */
+      result[idx].n_warmup_req += states[i].n_warmup;
+    }
+    result[idx].n_obj = local_cache->n_obj;
+    result[idx].occupied_byte = local_cache->occupied_byte;
+
+    if (params->free_cache_when_finish) {
+      local_cache->cache_free(local_cache);
+    }
+  }
+
+  my_free(sizeof(request_t) * SIM_GET_BATCH_SIZE, reqs);
+  my_free(sizeof(bool) * SIM_GET_BATCH_SIZE, hits);
+  my_free(sizeof(shared_cache_state_t) * (params->n_caches / ring->n_consumer + 1), states);
+
+  g_mutex_lock(&ring->mtx);
+  ring->n_done_consumer += 1;
+  g_cond_signal(&ring->consumer_done);
+  g_mutex_unlock(&ring->mtx);
+  return NULL;
+}
+
+/**
+ * @brief simulate all caches in params with the trace decoded only once
+ *
+ * @param params
+ * @param num_of_threads the number of consumer threads, each consumer
+ *  simulates n_caches / num_of_threads caches
+ */
+static void _simulate_shared_decode(sim_mt_params_t *params, int num_of_threads) {
+  int n_consumer = MIN(num_of_threads, params->n_caches);
+  if (n_consumer < 1) n_consumer = 1;
+
+  params->ring = _create_shared_req_ring(n_consumer);
+  shared_consumer_arg_t *args = my_malloc_n(shared_consumer_arg_t, n_consumer);
+  GThread **consumers = my_malloc_n(GThread *, n_consumer);
+
+  GThread *producer = g_thread_new("shared-decode", _shared_decode_producer, params);
+  for (int i = 0; i < n_consumer; i++) {
+    args[i].params = params;
+    args[i].consumer_id = i;
+    consumers[i] = g_thread_new("shared-sim", _shared_decode_consumer, &args[i]);
+  }
+
+  /* sleep until all consumers finish, wake up periodically to report the
+   * fraction of the trace simulated, the trace is only counted if the
+   * simulation runs long enough to report */
+  shared_req_ring_t *ring = params->ring;
+  int64_t n_total_req = -1;
+  gint64 report_time = g_get_monotonic_time() + SHARED_DECODE_PROGRESS_INTERVAL_SEC * G_TIME_SPAN_SECOND;
+  g_mutex_lock(&ring->mtx);
+  while (ring->n_done_consumer < n_consumer) {
+    if (!g_cond_wait_until(&ring->consumer_done, &ring->mtx, report_time)) {
+      int64_t n_done_req = ring->n_done_req;
+      g_mutex_unlock(&ring->mtx);
+      if (n_total_req == -1) {
+        n_total_req = (int64_t)get_num_of_req(params->reader);
+        if (params->warmup_reader) n_total_req += (int64_t)get_num_of_req(params->warmup_reader);
+      }
+      print_progress(MIN((double)n_done_req / (double)MAX(n_total_req, 1) * 100, 100));
+      g_mutex_lock(&ring->mtx);
+      report_time = g_get_monotonic_time() + SHARED_DECODE_PROGRESS_INTERVAL_SEC * G_TIME_SPAN_SECOND;
+    }
+  }
+  g_mutex_unlock(&ring->mtx);
+
+  for (int i = 0; i < n_consumer; i++) {
+    g_thread_join(consumers[i]);
+  }
+  g_thread_join(producer);
+
+  my_free(sizeof(GThread *) * n_consumer, consumers);
+  my_free(sizeof(shared_consumer_arg_t) * n_consumer, args);
+  _free_shared_req_ring(params->ring);
+  params->ring = NULL;
+}
+
+/**
+ * @brief run one simulation per cache on a work-stealing scheduler, the
+ * expensive simulations (by algorithm and cache size) start first
+ *
+ * @param params
+ * @param num_of_threads
+ */
+static void _simulate_with_work_stealing(sim_mt_params_t *params, int num_of_threads) {
+  /* the costs are estimated before starting because the caches are freed
+   * when the simulations finish */
+  double *job_costs = my_malloc_n(double, params->n_caches);
+  for (int i = 0; i < params->n_caches; i++) {
+    job_costs[i] = estimate_sim_job_cost(params->caches[i]);
+  }
+
+  run_jobs_with_work_stealing(params->n_caches, job_costs, num_of_threads, _simulate, params);
+  my_free(sizeof(double) * params->n_caches, job_costs);
+}
+
 cache_stat_t *simulate_at_multi_sizes_with_step_size(reader_t *const reader, const cache_t *cache, uint64_t step_size,
                                                      reader_t *warmup_reader, double warmup_frac, int warmup_sec,
-                                                     int num_of_threads, bool use_random_seed) {
+                                                     int num_of_threads, bool use_random_seed, bool shared_decode) {
   int num_of_sizes = (int)ceil((double)cache->cache_size / (double)step_size);
   get_num_of_req(reader);
   uint64_t *cache_sizes = my_malloc_n(uint64_t, num_of_sizes);
@@ -147,7 +543,7 @@ cache_stat_t *simulate_at_multi_sizes_with_step_size(reader_t *const reader, con
   }
 
   cache_stat_t *res = simulate_at_multi_sizes(reader, cache, num_of_sizes, cache_sizes, warmup_reader, warmup_frac,
-                                              warmup_sec, num_of_threads, use_random_seed);
+                                              warmup_sec, num_of_threads, use_random_seed, shared_decode);
   my_free(sizeof(uint64_t) * num_of_sizes, cache_sizes);
   return res;
 }
@@ -163,19 +559,19 @@ cache_stat_t *simulate_at_multi_sizes_with_step_size(reader_t *const reader, con
  * @param warmup_frac use warmup_frac of requests from reader to warm up cache
  * @param warmup_sec uses warmup_sec seconds of requests to warm up cache
  * @param num_of_threads
+ * @param use_random_seed
+ * @param shared_decode decode the trace once and share it among all caches
  *
  * note that warmup_reader, warmup_frac and warmup_sec are mutually exclusive
  *
  */
 cache_stat_t *simulate_at_multi_sizes(reader_t *reader, const cache_t *cache, int num_of_sizes,
                                       const uint64_t *cache_sizes, reader_t *warmup_reader, double warmup_frac,
-                                      int warmup_sec, int num_of_threads, bool use_random_seed) {
-  int progress = 0;
-
+                                      int warmup_sec, int num_of_threads, bool use_random_seed, bool shared_decode) {
   cache_stat_t *result = my_malloc_n(cache_stat_t, num_of_sizes);
   memset(result, 0, sizeof(cache_stat_t) * num_of_sizes);
 
-  // build parameters and send to thread pool
+  // build parameters for the worker threads
   sim_mt_params_t *params = my_malloc(sim_mt_params_t);
   params->reader = reader;
   params->warmup_reader = warmup_reader;
@@ -184,21 +580,13 @@ cache_stat_t *simulate_at_multi_sizes(reader_t *reader, const cache_t *cache, in
   params->n_warmup_req = (uint64_t)((double)get_num_of_req(reader) * warmup_frac);
   params->result = result;
   params->free_cache_when_finish = true;
-  params->progress = &progress;
   params->use_random_seed = use_random_seed;
-  g_mutex_init(&(params->mtx));
-
-  // build the thread pool
-  GThreadPool *gthread_pool = g_thread_pool_new((GFunc)_simulate, (gpointer)params, num_of_threads, TRUE, NULL);
-  ASSERT_NOT_NULL(gthread_pool, "cannot create thread pool in simulator\n");
 
-  // start computation
+  params->ring = NULL;
   params->caches = my_malloc_n(cache_t *, num_of_sizes);
-  for (int i = 1; i < num_of_sizes + 1; i++) {
-    params->caches[i - 1] = create_cache_with_new_size(cache, cache_sizes[i - 1]);
-    result[i - 1].cache_size = cache_sizes[i - 1];
-    ASSERT_TRUE(g_thread_pool_push(gthread_pool, GSIZE_TO_POINTER(i), NULL),
-                "cannot push data into thread_pool in get_miss_ratio\n");
+  for (int i = 0; i < num_of_sizes; i++) {
+    params->caches[i] = create_cache_with_new_size(cache, cache_sizes[i]);
+    result[i].cache_size = cache_sizes[i];
   }
 
   char start_cache_size[64], end_cache_size[64];
@@ -207,18 +595,17 @@ cache_stat_t *simulate_at_multi_sizes(reader_t *reader, const cache_t *cache, in
 
   INFO(
       "%s starts computation %s, num_warmup_req %lld, start cache size %s, "
-      "end cache size %s, %d sizes, %d threads, please wait\n",
+      "end cache size %s, %d sizes, %d threads%s, please wait\n",
       __func__, cache->cache_name, (long long)(params->n_warmup_req), start_cache_size, end_cache_size, num_of_sizes,
-      num_of_threads);
+      num_of_threads, shared_decode ? ", shared decode" : "");
 
-  // wait for all simulations to finish
-  while (progress < (uint64_t)num_of_sizes - 1) {
-    print_progress((double)progress / (double)(num_of_sizes - 1) * 100);
+  if (shared_decode) {
+    _simulate_shared_decode(params, num_of_threads);
+  } else {
+    _simulate_with_work_stealing(params, num_of_threads);
   }
 
   // clean up
-  g_thread_pool_free(gthread_pool, FALSE, TRUE);
-  g_mutex_clear(&(params->mtx));
   my_free(sizeof(cache_t *) * num_of_sizes, params->caches);
   my_free(sizeof(sim_mt_params_t), params);
 
@@ -236,21 +623,26 @@ cache_stat_t *simulate_at_multi_sizes(reader_t *reader, const cache_t *cache, in
  * @param warmup_frac
  * @param warmup_sec
  * @param num_of_threads
+ * @param free_cache_when_finish
+ * @param use_random_seed
+ * @param shared_decode decode the trace once and share it among all caches
  * @return cache_stat_t*
  */
 cache_stat_t *simulate_with_multi_caches(reader_t *reader, cache_t *caches[], int num_of_caches,
                                          reader_t *warmup_reader, double warmup_frac, int warmup_sec,
-                                         int num_of_threads, bool free_cache_when_finish, bool use_random_seed) {
+                                         int num_of_threads, bool free_cache_when_finish, bool use_random_seed,
+                                         bool shared_decode) {
   assert(num_of_caches > 0);
-  int i, progress = 0;
+  int i;
 
   cache_stat_t *result = my_malloc_n(cache_stat_t, num_of_caches);
   memset(result, 0, sizeof(cache_stat_t) * num_of_caches);
 
-  // build parameters and send to thread pool
+  // build parameters for the worker threads
   sim_mt_params_t *params = my_malloc(sim_mt_params_t);
   params->reader = reader;
   params->caches = caches;
+  params->n_caches = num_of_caches;
   params->warmup_reader = warmup_reader;
   params->warmup_sec = warmup_sec;
   params->use_random_seed = use_random_seed;
@@ -261,19 +653,10 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader, cache_t *caches[], in
   }
   params->result = result;
   params->free_cache_when_finish = free_cache_when_finish;
-  params->progress = &progress;
-  g_mutex_init(&(params->mtx));
-
-  // build the thread pool
-  GThreadPool *gthread_pool = g_thread_pool_new((GFunc)_simulate, (gpointer)params, num_of_threads, TRUE, NULL);
-  ASSERT_NOT_NULL(gthread_pool, "cannot create thread pool in simulator\n");
 
-  // start computation
-  for (i = 1; i < num_of_caches + 1; i++) {
-    result[i - 1].cache_size = caches[i - 1]->cache_size;
-
-    ASSERT_TRUE(g_thread_pool_push(gthread_pool, GSIZE_TO_POINTER(i), NULL),
-                "cannot push data into thread_pool in get_miss_ratio\n");
+  params->ring = NULL;
+  for (i = 0; i < num_of_caches; i++) {
+    result[i].cache_size = caches[i]->cache_size;
   }
 
   char start_cache_size[64], end_cache_size[64];
@@ -282,24 +665,255 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader, cache_t *caches[], in
 
   INFO(
       "%s starts computation, num_warmup_req %lld, start cache %s size %s, "
-      "end cache %s size %s, %d caches, %d threads, please wait\n",
+      "end cache %s size %s, %d caches, %d threads%s, please wait\n",
       __func__, (long long)(params->n_warmup_req), caches[0]->cache_name, start_cache_size,
-      caches[num_of_caches - 1]->cache_name, end_cache_size, num_of_caches, num_of_threads);
+      caches[num_of_caches - 1]->cache_name, end_cache_size, num_of_caches, num_of_threads,
+      shared_decode ? ", shared decode" : "");
 
-  // wait for all simulations to finish
-  while (progress < (uint64_t)num_of_caches - 1) {
-    print_progress((double)progress / (double)(num_of_caches - 1) * 100);
+  if (shared_decode) {
+    _simulate_shared_decode(params, num_of_threads);
+  } else {
+    _simulate_with_work_stealing(params, num_of_threads);
   }
 
   // clean up
-  g_thread_pool_free(gthread_pool, FALSE, TRUE);
-  g_mutex_clear(&(params->mtx));
   my_free(sizeof(sim_mt_params_t), params);
 
   // user is responsible for free-ing the result
   return result;
 }
 
+/************************ warm cache branching ************************/
+/* when sweeping the parameters of an algorithm with a long warmup, all the
+ * configurations replay the same warmup. In branching mode, one cache is
+ * warmed up to the cut point, and one child process is forked per parameter
+ * variant, the children share the warm cache (the objects, the hash table,
+ * and the eviction metadata) with the parent through copy-on-write, change
+ * the parameters, and only replay the requests after the cut point */
+
+typedef struct {
+  pid_t pid;
+  /* the read end of the pipe that the child writes its result to */
+  int fd;
+  int variant_idx;
+} branch_child_t;
+
+/**
+ * @brief run in the child process, finish the simulation from the cut point
+ * and write the result to fd
+ *
+ * @param cache the warm cache
+ * @param reader the reader that the parent used for warmup, it is positioned
+ *  after the pending request
+ * @param req the pending request, i.e., the first request after warmup
+ * @param start_ts the timestamp of the first request in the trace
+ * @param variant_params
+ * @param result the result from warmup
+ * @param fd
+ */
+static void _branch_child_run(cache_t *cache, reader_t *reader, request_t *req, int64_t start_ts,
+                              const char *variant_params, cache_stat_t *result, int fd) {
+  if (variant_params != NULL) {
+    cache->update_params(cache, variant_params);
+  }
+
+  /* the position of a mmaped reader is private to each process, other readers
+   * share the file offset with the parent and the other children, so we
+   * open the trace again and move to the read position of the parent without
+   * decoding the requests used for warmup */
+  if (reader->trace_format == TXT_TRACE_FORMAT) {
+    /* reader_seek_req would read the lines from the start of the trace */
+    long offset = ftell(reader->file);
+    reader = clone_reader(reader);
+    if (offset == -1 || fseek(reader->file, offset, SEEK_SET) != 0) {
+      ERROR("cannot move to offset %ld of %s: %s\n", offset, reader->trace_path, strerror(errno));
+    }
+  } else if (reader->is_zstd_file) {
+    int64_t req_idx = lcs_is_block_trace(reader)
+                          ? lcs_block_tell_req(reader)
+                          : (int64_t)(reader->mmap_offset - reader->trace_start_offset) / reader->item_size;
+    reader = clone_reader(reader);
+    if (reader_seek_req(reader, req_idx) != 0) {
+      ERROR("cannot move to request %" PRId64 " of %s\n", req_idx, reader->trace_path);
+    }
+  }
+
+  request_t *reqs = my_malloc_n(request_t, SIM_GET_BATCH_SIZE);
+  bool *hits = my_malloc_n(bool, SIM_GET_BATCH_SIZE);
+  while (req->valid) {
+    int n_req = 0;
+    while (req->valid && n_req < SIM_GET_BATCH_SIZE) {
+      req->clock_time -= start_ts;
+      copy_request(&reqs[n_req++], req);
+      read_one_req(reader, req);
+    }
+
+    cache->get_batch(cache, reqs, n_req, hits);
+    for (int i = 0; i < n_req; i++) {
+      result->n_req++;
+      result->n_req_byte += reqs[i].obj_size;
+      if (!hits[i]) {
+        result->n_miss++;
+        result->n_miss_byte += reqs[i].obj_size;
+      }
+    }
+    result->curr_rtime = reqs[n_req - 1].clock_time;
+  }
+
+  result->n_obj = cache->get_n_obj(cache);
+  result->occupied_byte = cache->get_occupied_byte(cache);
+  strncpy(result->cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+
+  /* the result is smaller than PIPE_BUF, so the write is atomic */
+  ssize_t n_written = write(fd, result, sizeof(cache_stat_t));
+  if (n_written != sizeof(cache_stat_t)) {
+    WARN("cannot write result to the parent: %s\n", strerror(errno));
+  }
+  close(fd);
+  fflush(stdout);
+  fflush(stderr);
+  /* do not run atexit handlers or close the streams shared with the parent */
+  _exit(n_written == sizeof(cache_stat_t) ? 0 : 1);
+}
+
+/**
+ * @brief wait for one of the variant children to finish and copy its result,
+ * a child is done when its pipe becomes readable, i.e., it has written the
+ * result or exited, only the children forked here are waited on, so the other
+ * child processes of the caller are left to the caller
+ */
+static void _branch_wait_child(branch_child_t *children, int n_child, cache_stat_t *result) {
+  struct pollfd *fds = my_malloc_n(struct pollfd, n_child);
+  for (int i = 0; i < n_child; i++) {
+    /* a negative fd is ignored by poll */
+    fds[i].fd = children[i].pid == -1 ? -1 : children[i].fd;
+    fds[i].events = POLLIN;
+    fds[i].revents = 0;
+  }
+  while (poll(fds, n_child, -1) == -1) {
+    if (errno != EINTR) {
+      ERROR("poll failed: %s\n", strerror(errno));
+    }
+  }
+
+  int i = 0;
+  while (fds[i].revents == 0) i++;
+  my_free(sizeof(struct pollfd) * n_child, fds);
+
+  cache_stat_t *res = &result[children[i].variant_idx];
+  ssize_t n_read = read(children[i].fd, res, sizeof(cache_stat_t));
+  close(children[i].fd);
+
+  int status;
+  while (waitpid(children[i].pid, &status, 0) == -1) {
+    if (errno != EINTR) {
+      ERROR("waitpid failed: %s\n", strerror(errno));
+    }
+  }
+  children[i].pid = -1;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || n_read != sizeof(cache_stat_t)) {
+    ERROR("simulation of variant %d failed, status %d\n", children[i].variant_idx, status);
+  }
+}
+
+cache_stat_t *simulate_with_warm_cache_branching(reader_t *reader, const cache_t *cache, int n_variant,
+                                                 const char *variant_params[], reader_t *warmup_reader,
+                                                 double warmup_frac, int warmup_sec, int num_of_procs,
+                                                 bool use_random_seed) {
+  assert(n_variant > 0);
+  for (int i = 0; i < n_variant; i++) {
+    if (variant_params[i] != NULL && cache->update_params == NULL) {
+      ERROR("%s does not support changing parameters after warmup\n", cache->cache_name);
+    }
+  }
+
+  cache_stat_t *result = my_malloc_n(cache_stat_t, n_variant);
+  memset(result, 0, sizeof(cache_stat_t) * n_variant);
+  cache_stat_t warm_result;
+  memset(&warm_result, 0, sizeof(cache_stat_t));
+  warm_result.cache_size = cache->cache_size;
+
+  /* the children inherit the state of the random number generator */
+  if (use_random_seed) {
+    set_rand_seed(rand());
+  } else {
+    set_rand_seed(1);
+  }
+  cache_t *warm_cache = create_cache_with_new_size(cache, cache->cache_size);
+  uint64_t n_warmup_req = (uint64_t)((double)get_num_of_req(reader) * warmup_frac);
+  request_t *req = new_request();
+
+  if (warmup_reader) {
+    reader_t *warmup_cloned_reader = clone_reader(warmup_reader);
+    read_one_req(warmup_cloned_reader, req);
+    while (req->valid) {
+      warm_cache->get(warm_cache, req);
+      warm_result.n_warmup_req += 1;
+      read_one_req(warmup_cloned_reader, req);
+    }
+    close_reader(warmup_cloned_reader);
+  }
+
+  reader_t *cloned_reader = clone_reader(reader);
+  read_one_req(cloned_reader, req);
+  int64_t start_ts = (int64_t)req->clock_time;
+  int64_t n_consumed = 0;
+  while (req->valid && (n_consumed < (int64_t)n_warmup_req || req->clock_time - start_ts < warmup_sec)) {
+    req->clock_time -= start_ts;
+    warm_cache->get(warm_cache, req);
+    n_consumed += 1;
+    read_one_req(cloned_reader, req);
+  }
+  warm_result.n_warmup_req += n_consumed;
+
+  INFO("%s cache %s (size %" PRIu64 ") finishes warm up with %" PRId64 " requests, branching into %d variants\n",
+       __func__, warm_cache->cache_name, warm_cache->cache_size, warm_result.n_warmup_req, n_variant);
+
+  /* the buffered output would otherwise be printed by every child */
+  fflush(stdout);
+  fflush(stderr);
+
+  int max_active = MAX(1, num_of_procs);
+  branch_child_t *children = my_malloc_n(branch_child_t, n_variant);
+  int n_active = 0;
+  for (int i = 0; i < n_variant; i++) {
+    if (n_active == max_active) {
+      _branch_wait_child(children, i, result);
+      n_active -= 1;
+    }
+
+    int pipe_fd[2];
+    if (pipe(pipe_fd) != 0) {
+      ERROR("cannot create pipe: %s\n", strerror(errno));
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+      ERROR("cannot fork: %s\n", strerror(errno));
+    } else if (pid == 0) {
+      close(pipe_fd[0]);
+      _branch_child_run(warm_cache, cloned_reader, req, start_ts, variant_params[i], &warm_result, pipe_fd[1]);
+    }
+
+    close(pipe_fd[1]);
+    children[i].pid = pid;
+    children[i].fd = pipe_fd[0];
+    children[i].variant_idx = i;
+    n_active += 1;
+  }
+  while (n_active > 0) {
+    _branch_wait_child(children, n_variant, result);
+    n_active -= 1;
+  }
+
+  my_free(sizeof(branch_child_t) * n_variant, children);
+  free_request(req);
+  close_reader(cloned_reader);
+  warm_cache->cache_free(warm_cache);
+
+  // user is responsible for free-ing the result
+  return result;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,9 +23,11 @@ static inline char *_read_bytes(reader_t *reader, size_t size) {
 }
 
 #ifdef SUPPORT_ZSTD_TRACE
-/* read zstd compressed data */
+/* read zstd compressed data, mmap_offset is the offset in the decompressed
+ * trace */
 static inline char *_read_bytes_zstd(reader_t *reader, size_t size) {
   char *start;
+  zstd_reader_seek(reader->zstd_reader_p, reader->mmap_offset);
   size_t sz =
       zstd_reader_read_bytes(reader->zstd_reader_p, size, &start);
   if (sz == 0) {
@@ -34,6 +36,7 @@ static inline char *_read_bytes_zstd(reader_t *reader, size_t size) {
     }
     return NULL;
   }
+  reader->mmap_offset += size;
 
   return start;
 }
@@ -3,7 +3,9 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "../../include/libCacheSim/macro.h"
 #include "../customizedReader/binaryUtils.h"
 #include "../readerInternal.h"
 
@@ -67,6 +69,10 @@ static void _lcs_print_trace_stat(lcs_trace_stat_t *stat) {
            stat->most_common_tenants[3], stat->most_common_tenant_ratio[3]);
   }
 
+  if (stat->dense_obj_id == 1) {
+    printf("obj_id is remapped to [0, %lld)\n", (long long)stat->n_obj);
+  }
+
   if (stat->n_ttl > 1) {
     printf("#ttl: %ld\n", (long)stat->n_ttl);
     printf("smallest ttl: %ld, largest ttl: %ld\n", (long)stat->smallest_ttl, (long)stat->largest_ttl);
@@ -77,6 +83,97 @@ static void _lcs_print_trace_stat(lcs_trace_stat_t *stat) {
   }
 }
 
+/* the decoded block and the block index of a v9 trace */
+typedef struct lcs_block_reader {
+  int64_t n_block;
+  lcs_block_index_t *index;
+  // the index of the first request of each block, n_block + 1 entries
+  int64_t *block_start_req;
+  // the end of the last block
+  size_t data_end;
+
+  // the decoded block, -1 before the first block is decoded
+  int64_t curr_block;
+  int32_t curr_n_req;
+  // the next request in the decoded block
+  int32_t curr_pos;
+  int64_t *cols[LCS_N_COL];
+} lcs_block_reader_t;
+
+/* the end of the decompressed trace */
+static size_t _lcs_data_end(reader_t *reader) {
+#ifdef SUPPORT_ZSTD_TRACE
+  if (reader->is_zstd_file) {
+    int64_t content_size = zstd_reader_content_size(reader->zstd_reader_p);
+    if (content_size < 0) {
+      ERROR(
+          "cannot find the block index of %s, the zstd trace has no frame "
+          "index, use traceConv --zstd to compress it in the seekable "
+          "format\n",
+          reader->trace_path);
+      exit(1);
+    }
+    return (size_t)content_size;
+  }
+#endif
+  return reader->file_size;
+}
+
+/* read the block index from the end of the trace, the decode buffers are
+ * allocated with the index in reader_params so that close_reader frees them */
+static void _lcs_block_reader_setup(reader_t *reader) {
+  size_t file_end = _lcs_data_end(reader);
+  if (file_end < sizeof(lcs_trace_header_t) + sizeof(lcs_block_footer_t)) {
+    ERROR("invalid trace file %s, the block index is missing\n", reader->trace_path);
+    exit(1);
+  }
+  reader->mmap_offset = file_end - sizeof(lcs_block_footer_t);
+  lcs_block_footer_t footer = *(lcs_block_footer_t *)read_bytes(reader, sizeof(lcs_block_footer_t));
+  size_t index_size = footer.n_block * sizeof(lcs_block_index_t);
+  if (footer.end_magic != LCS_TRACE_END_MAGIC || index_size > file_end - sizeof(lcs_trace_header_t) - sizeof(footer)) {
+    ERROR("invalid trace file %s, the block index is corrupted\n", reader->trace_path);
+    exit(1);
+  }
+  size_t data_end = file_end - sizeof(lcs_block_footer_t) - index_size;
+
+  int64_t n_block = (int64_t)footer.n_block;
+  size_t params_size = sizeof(lcs_block_reader_t) + index_size + (n_block + 1) * sizeof(int64_t);
+  char *params_mem = malloc(params_size);
+  lcs_block_reader_t *params = (lcs_block_reader_t *)params_mem;
+  params->n_block = n_block;
+  params->index = (lcs_block_index_t *)(params_mem + sizeof(lcs_block_reader_t));
+  params->block_start_req = (int64_t *)(params_mem + sizeof(lcs_block_reader_t) + index_size);
+  params->data_end = data_end;
+
+  if (n_block > 0) {
+    reader->mmap_offset = data_end;
+    memcpy(params->index, read_bytes(reader, index_size), index_size);
+  }
+
+  int64_t max_block_n_req = 0;
+  params->block_start_req[0] = 0;
+  for (int64_t i = 0; i < n_block; i++) {
+    params->block_start_req[i + 1] = params->block_start_req[i] + (int64_t)params->index[i].n_req;
+    max_block_n_req = MAX(max_block_n_req, (int64_t)params->index[i].n_req);
+  }
+
+  /* the decoded columns are allocated after the index is known */
+  params_mem = realloc(params_mem, params_size + LCS_N_COL * max_block_n_req * sizeof(int64_t));
+  params = (lcs_block_reader_t *)params_mem;
+  params->index = (lcs_block_index_t *)(params_mem + sizeof(lcs_block_reader_t));
+  params->block_start_req = (int64_t *)(params_mem + sizeof(lcs_block_reader_t) + index_size);
+  for (int i = 0; i < LCS_N_COL; i++) {
+    params->cols[i] = (int64_t *)(params_mem + params_size) + i * max_block_n_req;
+  }
+  params->curr_block = -1;
+  params->curr_n_req = 0;
+  params->curr_pos = 0;
+
+  reader->reader_params = params;
+  reader->n_total_req = params->block_start_req[n_block];
+  reader->mmap_offset = reader->trace_start_offset;
+}
+
 int lcsReader_setup(reader_t *reader) {
   char *data = read_bytes(reader, sizeof(lcs_trace_header_t));
   lcs_trace_header_t *header = (lcs_trace_header_t *)data;
@@ -91,6 +188,9 @@ int lcsReader_setup(reader_t *reader) {
   reader->trace_start_offset = sizeof(lcs_trace_header_t);
   reader->obj_id_is_num = true;
   reader->n_total_req = header->stat.n_req;
+  if (header->stat.dense_obj_id == 1) {
+    reader->n_dense_obj = header->stat.n_obj;
+  }
 
   if (reader->lcs_ver == 1) {
     reader->item_size = sizeof(lcs_req_v1_t);
@@ -113,6 +213,10 @@ int lcsReader_setup(reader_t *reader) {
   } else if (reader->lcs_ver == 8) {
     reader->item_size = sizeof(lcs_req_v8_t);
     assert(LCS_VER_TO_N_FEATURES[8] == 16);
+  } else if (reader->lcs_ver == LCS_BLOCK_VER) {
+    /* the requests have no fixed size */
+    reader->item_size = 0;
+    _lcs_block_reader_setup(reader);
   } else {
     ERROR("invalid lcs version %ld\n", (unsigned long)reader->lcs_ver);
     exit(1);
@@ -125,7 +229,251 @@ int lcsReader_setup(reader_t *reader) {
 
 // read one request from trace file
 // return 0 if success, 1 if error
+static inline void _lcs_parse_req_v1(const char *record, request_t *req) {
+  lcs_req_v1_t *req_v1 = (lcs_req_v1_t *)record;
+  req->clock_time = req_v1->clock_time;
+  req->obj_id = req_v1->obj_id;
+  req->obj_size = req_v1->obj_size;
+  req->next_access_vtime = req_v1->next_access_vtime;
+}
+
+static inline void _lcs_parse_req_v2(const char *record, request_t *req) {
+  lcs_req_v2_t *req_v2 = (lcs_req_v2_t *)record;
+  req->clock_time = req_v2->clock_time;
+  req->obj_id = req_v2->obj_id;
+  req->obj_size = req_v2->obj_size;
+  req->next_access_vtime = req_v2->next_access_vtime;
+  req->tenant_id = req_v2->tenant;
+  req->op = req_v2->op;
+}
+
+/* decode a bit-packed column, each value is one unaligned load, a shift and
+ * a mask, so the loop has no branch */
+static void _lcs_unpack_col(const char *src, uint32_t n, uint8_t width, int64_t base, int64_t *restrict dst) {
+  if (width == 0) {
+    for (uint32_t i = 0; i < n; i++) {
+      dst[i] = base;
+    }
+  } else if (width == 64) {
+    memcpy(dst, src, (size_t)n * sizeof(int64_t));
+    for (uint32_t i = 0; i < n; i++) {
+      dst[i] = (int64_t)((uint64_t)dst[i] + (uint64_t)base);
+    }
+  } else {
+    uint64_t mask = (1ULL << width) - 1;
+    for (uint32_t i = 0; i < n; i++) {
+      uint64_t bit = (uint64_t)i * width;
+      uint64_t word;
+      memcpy(&word, src + (bit >> 3), sizeof(word));
+      dst[i] = (int64_t)(((word >> (bit & 7)) & mask) + (uint64_t)base);
+    }
+  }
+}
+
+/* decode all columns of the given block of a v9 trace */
+static void _lcs_decode_block(reader_t *reader, int64_t block_idx) {
+  lcs_block_reader_t *params = reader->reader_params;
+  size_t block_end = block_idx + 1 < params->n_block ? params->index[block_idx + 1].offset : params->data_end;
+  size_t block_size = block_end - params->index[block_idx].offset;
+  reader->mmap_offset = params->index[block_idx].offset;
+  char *data = read_bytes(reader, block_size);
+  if (data == NULL) {
+    ERROR("cannot read block %ld of %s\n", (long)block_idx, reader->trace_path);
+    abort();
+  }
+
+  lcs_block_header_t *header = (lcs_block_header_t *)data;
+  uint32_t n = header->n_req;
+  const char *obj_ids = data + sizeof(lcs_block_header_t);
+  const char *col = obj_ids + (size_t)header->n_obj * sizeof(uint64_t);
+  for (int i = 0; i < LCS_N_COL; i++) {
+    _lcs_unpack_col(col, n, header->col_width[i], header->col_base[i], params->cols[i]);
+    col += lcs_block_col_size(n, header->col_width[i]);
+  }
+
+  /* the clock time is the prefix sum of the differences */
+  int64_t *clock_time = params->cols[LCS_COL_CLOCK_TIME];
+  int64_t prev_clock_time = header->first_clock_time;
+  for (uint32_t i = 0; i < n; i++) {
+    prev_clock_time += clock_time[i];
+    clock_time[i] = prev_clock_time;
+  }
+
+  /* obj_ids are not aligned in the block */
+  int64_t *obj_id = params->cols[LCS_COL_OBJ_ID];
+  for (uint32_t i = 0; i < n; i++) {
+    memcpy(&obj_id[i], obj_ids + obj_id[i] * sizeof(uint64_t), sizeof(uint64_t));
+  }
+
+  int64_t *next_access_vtime = params->cols[LCS_COL_NEXT_ACCESS_VTIME];
+  int64_t vtime = params->block_start_req[block_idx];
+  for (uint32_t i = 0; i < n; i++) {
+    next_access_vtime[i] = next_access_vtime[i] == 0 ? INT64_MAX : vtime + i + next_access_vtime[i];
+  }
+
+  params->curr_block = block_idx;
+  params->curr_n_req = (int32_t)n;
+  params->curr_pos = 0;
+}
+
+int64_t lcs_block_tell_req(reader_t *reader) {
+  lcs_block_reader_t *params = reader->reader_params;
+  if (params->curr_block < 0) {
+    return 0;
+  }
+  return params->block_start_req[params->curr_block] + params->curr_pos;
+}
+
+int lcs_block_seek_req(reader_t *reader, int64_t req_idx) {
+  lcs_block_reader_t *params = reader->reader_params;
+  if (req_idx < 0 || req_idx > params->block_start_req[params->n_block]) {
+    return 1;
+  }
+
+  /* the last block whose first request is not after req_idx */
+  int64_t lo = 0, hi = params->n_block;
+  while (hi - lo > 1) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (params->block_start_req[mid] <= req_idx) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (params->n_block == 0) {
+    params->curr_block = -1;
+    params->curr_n_req = 0;
+    params->curr_pos = 0;
+    return 0;
+  }
+  if (params->curr_block != lo) {
+    _lcs_decode_block(reader, lo);
+  }
+  params->curr_pos = (int32_t)(req_idx - params->block_start_req[lo]);
+  return 0;
+}
+
+int lcs_block_seek_time(reader_t *reader, int64_t clock_time) {
+  lcs_block_reader_t *params = reader->reader_params;
+
+  /* the first block that starts at or after clock_time, the first request at
+   * or after clock_time is in the block before it or is its first request */
+  int64_t lo = 0, hi = params->n_block;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (params->index[mid].first_clock_time < clock_time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo > 0) {
+    int64_t block_idx = lo - 1;
+    if (params->curr_block != block_idx) {
+      _lcs_decode_block(reader, block_idx);
+    }
+    const int64_t *col = params->cols[LCS_COL_CLOCK_TIME];
+    int32_t pos_lo = 0, pos_hi = params->curr_n_req;
+    while (pos_lo < pos_hi) {
+      int32_t mid = pos_lo + (pos_hi - pos_lo) / 2;
+      if (col[mid] < clock_time) {
+        pos_lo = mid + 1;
+      } else {
+        pos_hi = mid;
+      }
+    }
+    if (pos_lo < params->curr_n_req) {
+      params->curr_pos = pos_lo;
+      return 0;
+    }
+  }
+
+  lcs_block_seek_req(reader, params->block_start_req[lo]);
+  return lo == params->n_block ? 1 : 0;
+}
+
+/* move to the next request of a v9 trace, decode the next block if needed
+ * return false at the end of the trace */
+static inline bool _lcs_block_next(reader_t *reader, lcs_block_reader_t *params) {
+  if (likely(params->curr_pos < params->curr_n_req)) {
+    return true;
+  }
+  if (params->curr_block + 1 >= params->n_block) {
+    return false;
+  }
+  _lcs_decode_block(reader, params->curr_block + 1);
+  return true;
+}
+
+static inline void _lcs_block_parse_req(lcs_block_reader_t *params, request_t *req) {
+  int32_t pos = params->curr_pos++;
+  req->clock_time = params->cols[LCS_COL_CLOCK_TIME][pos];
+  req->obj_id = params->cols[LCS_COL_OBJ_ID][pos];
+  req->obj_size = params->cols[LCS_COL_OBJ_SIZE][pos];
+  req->op = params->cols[LCS_COL_OP][pos];
+  req->tenant_id = params->cols[LCS_COL_TENANT][pos];
+  req->ttl = params->cols[LCS_COL_TTL][pos];
+  req->next_access_vtime = params->cols[LCS_COL_NEXT_ACCESS_VTIME][pos];
+}
+
+static int _lcs_block_read_one_req(reader_t *reader, request_t *req) {
+  lcs_block_reader_t *params = reader->reader_params;
+  bool skip_size_zero = reader->ignore_size_zero_req && reader->read_direction == READ_FORWARD;
+  while (true) {
+    if (!_lcs_block_next(reader, params)) {
+      req->valid = FALSE;
+      return 1;
+    }
+    _lcs_block_parse_req(params, req);
+    if (req->obj_size != 0 || !skip_size_zero) break;
+  }
+
+  if (req->next_access_vtime == INT64_MAX) {
+    req->next_access_vtime = MAX_REUSE_DISTANCE;
+  }
+  return 0;
+}
+
+/* copy the requests from the decoded columns, one block at a time */
+static int _lcs_block_read_n_reqs(reader_t *reader, request_t *reqs, int n) {
+  lcs_block_reader_t *params = reader->reader_params;
+  bool skip_size_zero = reader->ignore_size_zero_req && reader->read_direction == READ_FORWARD;
+  int n_read = 0;
+  while (n_read < n && _lcs_block_next(reader, params)) {
+    int32_t start = params->curr_pos;
+    int32_t end = (int32_t)MIN((int64_t)params->curr_n_req, (int64_t)start + (n - n_read));
+    const int64_t *clock_time = params->cols[LCS_COL_CLOCK_TIME];
+    const int64_t *obj_id = params->cols[LCS_COL_OBJ_ID];
+    const int64_t *obj_size = params->cols[LCS_COL_OBJ_SIZE];
+    const int64_t *op = params->cols[LCS_COL_OP];
+    const int64_t *tenant = params->cols[LCS_COL_TENANT];
+    const int64_t *ttl = params->cols[LCS_COL_TTL];
+    const int64_t *next_access_vtime = params->cols[LCS_COL_NEXT_ACCESS_VTIME];
+    for (int32_t i = start; i < end; i++) {
+      request_t *req = &reqs[n_read];
+      req->clock_time = clock_time[i];
+      req->obj_id = obj_id[i];
+      req->obj_size = obj_size[i];
+      req->op = op[i];
+      req->tenant_id = tenant[i];
+      req->ttl = ttl[i];
+      req->next_access_vtime = next_access_vtime[i] == INT64_MAX ? MAX_REUSE_DISTANCE : next_access_vtime[i];
+      req->hv = 0;
+      req->valid = true;
+      n_read += obj_size[i] != 0 || !skip_size_zero;
+    }
+    params->curr_pos = end;
+  }
+  return n_read;
+}
+
 int lcs_read_one_req(reader_t *reader, request_t *req) {
+  if (reader->lcs_ver == LCS_BLOCK_VER) {
+    return _lcs_block_read_one_req(reader, req);
+  }
+
   char *record = read_bytes(reader, reader->item_size);
 
   if (record == NULL) {
@@ -134,19 +482,9 @@ int lcs_read_one_req(reader_t *reader, request_t *req) {
   }
 
   if (reader->lcs_ver == 1) {
-    lcs_req_v1_t *req_v1 = (lcs_req_v1_t *)record;
-    req->clock_time = req_v1->clock_time;
-    req->obj_id = req_v1->obj_id;
-    req->obj_size = req_v1->obj_size;
-    req->next_access_vtime = req_v1->next_access_vtime;
+    _lcs_parse_req_v1(record, req);
   } else if (reader->lcs_ver == 2) {
-    lcs_req_v2_t *req_v2 = (lcs_req_v2_t *)record;
-    req->clock_time = req_v2->clock_time;
-    req->obj_id = req_v2->obj_id;
-    req->obj_size = req_v2->obj_size;
-    req->next_access_vtime = req_v2->next_access_vtime;
-    req->tenant_id = req_v2->tenant;
-    req->op = req_v2->op;
+    _lcs_parse_req_v2(record, req);
   } else if (reader->lcs_ver == 3) {
     lcs_req_v3_t *req_v3 = (lcs_req_v3_t *)record;
     req->clock_time = req_v3->clock_time;
@@ -187,7 +525,45 @@ int lcs_read_one_req(reader_t *reader, request_t *req) {
   return 0;
 }
 
-void lcs_print_trace_stat(reader_t *reader) {
+/* parse_req is a constant at each call site, so the loop is specialized for
+ * each version after inlining */
+static inline int _lcs_read_n_reqs(reader_t *reader, request_t *reqs, int n,
+                                   void (*parse_req)(const char *, request_t *)) {
+  bool skip_size_zero = reader->ignore_size_zero_req && reader->read_direction == READ_FORWARD;
+  int n_read = 0;
+  while (n_read < n) {
+    char *record = read_bytes(reader, reader->item_size);
+    if (record == NULL) break;
+
+    request_t *req = &reqs[n_read];
+    parse_req(record, req);
+    if (req->obj_size == 0 && skip_size_zero) continue;
+
+    if (req->next_access_vtime == -1 || req->next_access_vtime == INT64_MAX) {
+      req->next_access_vtime = MAX_REUSE_DISTANCE;
+    }
+    req->hv = 0;
+    req->ttl = 0;
+    req->valid = true;
+    n_read++;
+  }
+  return n_read;
+}
+
+int lcs_read_n_reqs(reader_t *reader, request_t *reqs, int n) {
+  if (reader->lcs_ver == 1) {
+    return _lcs_read_n_reqs(reader, reqs, n, _lcs_parse_req_v1);
+  } else if (reader->lcs_ver == 2) {
+    return _lcs_read_n_reqs(reader, reqs, n, _lcs_parse_req_v2);
+  } else if (reader->lcs_ver == LCS_BLOCK_VER) {
+    return _lcs_block_read_n_reqs(reader, reqs, n);
+  }
+
+  ERROR("batch read does not support lcs version %ld\n", (long)reader->lcs_ver);
+  abort();
+}
+
+void lcs_read_trace_stat(reader_t *reader, lcs_trace_stat_t *stat) {
   reader_t *cloned_reader = clone_reader(reader);
 
   cloned_reader->mmap_offset = 0;
@@ -202,13 +578,17 @@ void lcs_print_trace_stat(reader_t *reader) {
 
   _verify_lcs_header(header);
 
-  lcs_trace_stat_t *stat = &(header->stat);
-
-  _lcs_print_trace_stat(stat);
+  memcpy(stat, &header->stat, sizeof(lcs_trace_stat_t));
 
   close_reader(cloned_reader);
 }
 
+void lcs_print_trace_stat(reader_t *reader) {
+  lcs_trace_stat_t stat;
+  lcs_read_trace_stat(reader, &stat);
+  _lcs_print_trace_stat(&stat);
+}
+
 #ifdef __cplusplus
 }
 #endif
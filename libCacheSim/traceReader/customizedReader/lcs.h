@@ -3,6 +3,7 @@
 //
 // A lcs trace file consists of a header and a sequence of requests.
 // The header is 1024 bytes, and the request is 24 bytes for v1 and 28 bytes for v2.
+// v9 stores the requests in compressed blocks column by column with an index of the blocks.
 // The header contains the trace statistics
 // The request contains the request information
 // The trace stat is defined in the lcs_trace_stat struct.
@@ -24,7 +25,8 @@ extern "C" {
 
 #define LCS_TRACE_START_MAGIC 0x123456789abcdef0
 #define LCS_TRACE_END_MAGIC 0x123456789abcdef0
-#define CURR_STAT_VERSION 1
+// stat version 2 adds dense_obj_id
+#define CURR_STAT_VERSION 2
 #define N_MOST_COMMON 16
 
 /******************************************************************************/
@@ -80,7 +82,11 @@ typedef struct lcs_trace_stat {
   float most_common_ttl_ratio[N_MOST_COMMON];
   // (10 + 26 + 33 + 16.5 + 17.5) * 8 bytes so far
 
-  int64_t unused[897];
+  // 1 if the obj_id is remapped to [0, n_obj) by the converter
+  int64_t dense_obj_id;
+  // (10 + 26 + 33 + 16.5 + 17.5 + 1) * 8 bytes so far
+
+  int64_t unused[896];
 } __attribute__((packed)) lcs_trace_stat_t;
 // assert the struct size at compile time
 typedef char static_assert_lcs_trace_stat_size[(sizeof(struct lcs_trace_stat) == 1000 * 8) ? 1 : -1];
@@ -203,14 +209,103 @@ typedef struct __attribute__((packed)) lcs_req_v8 {
 // assert the struct size at compile time
 typedef char static_assert_lcs_v8_size[(sizeof(struct lcs_req_v8) == 100) ? 1 : -1];
 
+/******************************************************************************/
+/**     v9 stores the v3 fields in blocks of requests column by column      **/
+/**                                                                          **/
+/** each block starts with a lcs_block_header_t, followed by the distinct    **/
+/** obj_ids of the block (uint64_t each, in the order of first request),     **/
+/** and one bit-packed column per field in lcs_block_col_e. A column stores  **/
+/** value - col_base[col] in col_width[col] bits (0 if all values are the    **/
+/** same, 64 if the values are stored as they are), and is padded with 8     **/
+/** bytes so that each value can be decoded with one unaligned 8-byte load.  **/
+/** The values of the columns are                                            **/
+/**         clock_time: the difference from the previous request             **/
+/**         obj_id: the index of the obj_id in the block dictionary          **/
+/**         next_access_vtime: the difference from the vtime of the          **/
+/**                  request, 0 if the object is not requested again         **/
+/**                                                                          **/
+/** the blocks are followed by an index of the blocks and the footer         **/
+/******************************************************************************/
+#define LCS_BLOCK_VER 9
+/* the number of requests in a block written by traceConv */
+#define LCS_BLOCK_N_REQ 65536
+
+typedef enum {
+  LCS_COL_CLOCK_TIME = 0,
+  LCS_COL_OBJ_ID,
+  LCS_COL_OBJ_SIZE,
+  LCS_COL_OP,
+  LCS_COL_TENANT,
+  LCS_COL_TTL,
+  LCS_COL_NEXT_ACCESS_VTIME,
+  LCS_N_COL,
+} lcs_block_col_e;
+
+typedef struct __attribute__((packed)) lcs_block_header {
+  uint32_t n_req;
+  // the number of distinct obj_ids in the block
+  uint32_t n_obj;
+  int64_t first_clock_time;
+  int64_t col_base[LCS_N_COL];
+  uint8_t col_width[LCS_N_COL];
+  uint8_t unused[1];
+} lcs_block_header_t;
+// assert the struct size at compile time
+typedef char static_assert_lcs_block_header_size[(sizeof(struct lcs_block_header) == 80) ? 1 : -1];
+
+typedef struct __attribute__((packed)) lcs_block_index {
+  // the offset of the block in the trace
+  uint64_t offset;
+  int64_t first_clock_time;
+  uint64_t n_req;
+} lcs_block_index_t;
+
+/* the last bytes of a v9 trace, the index of the blocks is right before it */
+typedef struct __attribute__((packed)) lcs_block_footer {
+  uint64_t n_block;
+  uint64_t end_magic;
+} lcs_block_footer_t;
+
+/* the size of a bit-packed column of n values */
+static inline size_t lcs_block_col_size(uint32_t n_req, uint8_t width) {
+  return width == 0 ? 0 : ((size_t)n_req * width + 7) / 8 + 8;
+}
+
 static int LCS_VER_TO_N_FEATURES[10] = {0, 0, 0, 0, 1, 2, 4, 8, 16, 0};
 
+/* the position in a v9 trace is the index of the next request, which is kept
+ * by the reader instead of mmap_offset */
+static inline bool lcs_is_block_trace(const reader_t *reader) {
+  return reader->trace_type == LCS_TRACE && reader->lcs_ver == LCS_BLOCK_VER;
+}
+
 int lcsReader_setup(reader_t *reader);
 
 int lcs_read_one_req(reader_t *reader, request_t *req);
 
+/* read at most n requests of a v1, v2 or v9 trace, requests of size zero are
+ * skipped, return the number of requests read */
+int lcs_read_n_reqs(reader_t *reader, request_t *reqs, int n);
+
+/* read the trace stat from the header */
+void lcs_read_trace_stat(reader_t *reader, lcs_trace_stat_t *stat);
+
 void lcs_print_trace_stat(reader_t *reader);
 
+/* the index of the next request in a v9 trace */
+int64_t lcs_block_tell_req(reader_t *reader);
+
+/* move to the request at the given index (0-based) of a v9 trace, the index
+ * can be the number of requests, which is the end of the trace
+ * return 0 on success, 1 if the index is out of the trace */
+int lcs_block_seek_req(reader_t *reader, int64_t req_idx);
+
+/* move to the first request at or after clock_time of a v9 trace using the
+ * block index, the requests must be sorted by time
+ * return 0 on success, 1 if all requests are before clock_time, and the
+ * reader is at the end of the trace */
+int lcs_block_seek_time(reader_t *reader, int64_t clock_time);
+
 #ifdef __cplusplus
 }
 #endif
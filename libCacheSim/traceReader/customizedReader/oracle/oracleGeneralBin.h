@@ -27,6 +27,23 @@ static inline int oracleGeneralBin_setup(reader_t *reader) {
   return 0;
 }
 
+/* decode a record into req, which can be a request_t or a req_hot_t,
+ * an object that is not requested again has next access MAX_REUSE_DISTANCE */
+#define ORACLE_GENERAL_BIN_DECODE(record, req)                                     \
+  do {                                                                             \
+    (req)->clock_time = *(uint32_t *)(record);                                     \
+    (req)->obj_id = *(uint64_t *)((record) + 4);                                   \
+    (req)->obj_size = *(uint32_t *)((record) + 12);                                \
+    (req)->next_access_vtime = *(int64_t *)((record) + 16);                        \
+    if ((req)->next_access_vtime == -1 || (req)->next_access_vtime == INT64_MAX) { \
+      (req)->next_access_vtime = MAX_REUSE_DISTANCE;                               \
+    }                                                                              \
+  } while (0)
+
+static inline void _oracleGeneralBin_parse_req(const char *record, request_t *req) {
+  ORACLE_GENERAL_BIN_DECODE(record, req);
+}
+
 static inline int oracleGeneralBin_read_one_req(reader_t *reader, request_t *req) {
   char *record = read_bytes(reader, reader->item_size);
 
@@ -35,13 +52,7 @@ static inline int oracleGeneralBin_read_one_req(reader_t *reader, request_t *req
     return 1;
   }
 
-  req->clock_time = *(uint32_t *)record;
-  req->obj_id = *(uint64_t *)(record + 4);
-  req->obj_size = *(uint32_t *)(record + 12);
-  req->next_access_vtime = *(int64_t *)(record + 16);
-  if (req->next_access_vtime == -1 || req->next_access_vtime == INT64_MAX) {
-    req->next_access_vtime = MAX_REUSE_DISTANCE;
-  }
+  _oracleGeneralBin_parse_req(record, req);
 
   if (req->obj_size == 0 && reader->ignore_size_zero_req && reader->read_direction == READ_FORWARD) {
     return oracleGeneralBin_read_one_req(reader, req);
@@ -49,6 +60,54 @@ static inline int oracleGeneralBin_read_one_req(reader_t *reader, request_t *req
   return 0;
 }
 
+/**
+ * read at most n requests into reqs, requests of size zero are skipped
+ * @return the number of requests read, fewer than n at the end of the trace
+ */
+static inline int oracleGeneralBin_read_n_reqs(reader_t *reader, request_t *reqs, int n) {
+  bool skip_size_zero = reader->ignore_size_zero_req && reader->read_direction == READ_FORWARD;
+  int n_read = 0;
+  while (n_read < n) {
+    char *record = read_bytes(reader, reader->item_size);
+    if (record == NULL) break;
+
+    request_t *req = &reqs[n_read];
+    _oracleGeneralBin_parse_req(record, req);
+    if (req->obj_size == 0 && skip_size_zero) continue;
+
+    req->hv = 0;
+    req->ttl = 0;
+    req->valid = true;
+    n_read++;
+  }
+  return n_read;
+}
+
+/**
+ * the same as oracleGeneralBin_read_n_reqs, but decodes the records directly
+ * into the simulation fields
+ * @return the number of requests read, fewer than n at the end of the trace
+ */
+static inline int oracleGeneralBin_read_n_hot_reqs(reader_t *reader, req_hot_t *reqs, int n) {
+  bool skip_size_zero = reader->ignore_size_zero_req && reader->read_direction == READ_FORWARD;
+  int n_read = 0;
+  while (n_read < n) {
+    char *record = read_bytes(reader, reader->item_size);
+    if (record == NULL) break;
+
+    req_hot_t *req = &reqs[n_read];
+    ORACLE_GENERAL_BIN_DECODE(record, req);
+    if (req->obj_size == 0 && skip_size_zero) continue;
+
+    req->hv = 0;
+    req->ttl = 0;
+    req->tenant_id = 0;
+    req->op = OP_NOP;
+    n_read++;
+  }
+  return n_read;
+}
+
 #ifdef __cplusplus
 }
 #endif
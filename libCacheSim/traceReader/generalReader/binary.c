@@ -248,6 +248,18 @@ int binary_read_one_req(reader_t *reader, request_t *req) {
   return 0;
 }
 
+int binary_read_n_reqs(reader_t *reader, request_t *reqs, int n) {
+  int n_read = 0;
+  while (n_read < n && reader->mmap_offset < reader->file_size) {
+    request_t *req = &reqs[n_read++];
+    req->hv = 0;
+    req->ttl = 0;
+    req->valid = true;
+    binary_read_one_req(reader, req);
+  }
+  return n_read;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,6 +12,12 @@
 #include <stdlib.h>
 #include <strings.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "../../../libCacheSim/include/libCacheSim/macro.h"
 #include "../../dataStructure/hash/hash.h"
 #include "../readerInternal.h"
@@ -24,6 +30,9 @@ extern "C" {
 // to suppress the warning of getline
 ssize_t getline(char **lineptr, size_t *n, FILE *stream);
 
+/* lines whose last used field is beyond this are parsed by libcsv */
+#define CSV_FAST_MAX_FIELDS 64
+
 /**
  * @brief count the number of times char c appears in string str
  *
@@ -197,12 +206,17 @@ static inline void csv_cb1(void *s, size_t len, void *data) {
   csv_params_t *csv_params = reader->reader_params;
   request_t *req = csv_params->request;
   char *end;
+  uint64_t val;
 
   if (csv_params->curr_field_idx == csv_params->obj_id_field_idx) {
     if (reader->obj_id_is_num) {
-      req->obj_id = strtoull((char *)s, &end, 0);
-      if (req->obj_id == 0 && s == end) {
-        WARN("object id is not numeric: \"%s\"\n", (char *)s);
+      if (parse_dec_num((char *)s, len, 19, &val)) {
+        req->obj_id = val;
+      } else {
+        req->obj_id = strtoull((char *)s, &end, 0);
+        if (req->obj_id == 0 && s == end) {
+          WARN("object id is not numeric: \"%s\"\n", (char *)s);
+        }
       }
     } else {
       if (!reader->obj_id_is_num_set) {
@@ -223,12 +237,20 @@ static inline void csv_cb1(void *s, size_t len, void *data) {
     }
   } else if (csv_params->curr_field_idx == csv_params->time_field_idx) {
     // int64_t ts = (int64_t)atof((char *)s);
-    int64_t ts = (int64_t)strtod((char *)s, NULL);
-    req->clock_time = ts;
+    /* a double represents integers of up to 15 digits exactly */
+    if (parse_dec_num((char *)s, len, 15, &val)) {
+      req->clock_time = (int64_t)val;
+    } else {
+      req->clock_time = (int64_t)strtod((char *)s, NULL);
+    }
   } else if (csv_params->curr_field_idx == csv_params->obj_size_field_idx) {
-    req->obj_size = (int64_t)strtoll((char *)s, &end, 0);
-    if (req->obj_size == 0 && end == s) {
-      WARN("csvReader obj_size is not a number: \"%s\"\n", (char *)s);
+    if (parse_dec_num((char *)s, len, 18, &val)) {
+      req->obj_size = (int64_t)val;
+    } else {
+      req->obj_size = (int64_t)strtoll((char *)s, &end, 0);
+      if (req->obj_size == 0 && end == s) {
+        WARN("csvReader obj_size is not a number: \"%s\"\n", (char *)s);
+      }
     }
   } else if (csv_params->curr_field_idx == csv_params->op_field_idx) {
     if (strncasecmp((char *)s, "read", len) == 0) {
@@ -273,6 +295,115 @@ static inline void csv_cb2(int c, void *data) {
   csv_params->curr_field_idx = 1;
 }
 
+/**
+ * @brief find the delimiters in a line, 32 (AVX2) or 16 (SSE2) bytes at a time
+ *
+ * @param line
+ * @param len
+ * @param delim
+ * @param delim_pos the offsets of the delimiters
+ * @param max_n stop after finding max_n delimiters
+ * @return the number of delimiters found, -1 if the line has a quote or a
+ * carriage return, which needs the full csv parser
+ */
+static int csv_find_delims(const char *line, size_t len, char delim, uint32_t *delim_pos, int max_n) {
+  int n = 0;
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i v_delim = _mm256_set1_epi8(delim);
+  const __m256i v_quote = _mm256_set1_epi8('"');
+  const __m256i v_cr = _mm256_set1_epi8('\r');
+  for (; i + 32 <= len; i += 32) {
+    __m256i chunk = _mm256_loadu_si256((const __m256i *)(line + i));
+    __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v_quote), _mm256_cmpeq_epi8(chunk, v_cr));
+    if (_mm256_movemask_epi8(special) != 0) return -1;
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, v_delim));
+    while (mask != 0) {
+      delim_pos[n++] = i + __builtin_ctz(mask);
+      if (n == max_n) return n;
+      mask &= mask - 1;
+    }
+  }
+#elif defined(__SSE2__)
+  const __m128i v_delim = _mm_set1_epi8(delim);
+  const __m128i v_quote = _mm_set1_epi8('"');
+  const __m128i v_cr = _mm_set1_epi8('\r');
+  for (; i + 16 <= len; i += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(line + i));
+    __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, v_quote), _mm_cmpeq_epi8(chunk, v_cr));
+    if (_mm_movemask_epi8(special) != 0) return -1;
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, v_delim));
+    while (mask != 0) {
+      delim_pos[n++] = i + __builtin_ctz(mask);
+      if (n == max_n) return n;
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  for (; i < len; i++) {
+    if (line[i] == delim) {
+      delim_pos[n++] = i;
+      if (n == max_n) return n;
+    } else if (line[i] == '"' || line[i] == '\r') {
+      return -1;
+    }
+  }
+  return n;
+}
+
+static inline bool csv_is_space(char c, char delim) { return (c == ' ' || c == '\t') && c != delim; }
+
+/* a line that has no field, libcsv does not call the callbacks on it */
+static inline bool csv_is_blank_line(const char *line, size_t len, char delim) {
+  for (size_t i = 0; i < len; i++) {
+    if (line[i] != '\n' && line[i] != '\r' && !csv_is_space(line[i], delim)) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief split a line that has no quote and pass the fields to csv_cb1, this
+ * produces the same fields as libcsv, but only parses the fields in use
+ *
+ * @param reader
+ * @param line the line, which is modified to terminate the fields
+ * @param len the length of the line
+ * @return false if the line needs the full csv parser
+ */
+static bool csv_parse_line_fast(reader_t *reader, char *line, size_t len) {
+  csv_params_t *csv_params = reader->reader_params;
+  char delim = (char)csv_params->delimiter;
+  uint32_t delim_pos[CSV_FAST_MAX_FIELDS];
+
+  if (len > 0 && line[len - 1] == '\n') len--;
+  if (len > 0 && line[len - 1] == '\r') len--;
+
+  size_t start = 0;
+  while (start < len && csv_is_space(line[start], delim)) start++;
+  /* blank lines are skipped by the caller */
+  DEBUG_ASSERT(start < len);
+
+  int n_delim = csv_find_delims(line + start, len - start, delim, delim_pos, csv_params->max_field_idx);
+  if (n_delim < 0) return false;
+
+  /* the fields after the last delimiter found is not needed */
+  int n_field = n_delim == csv_params->max_field_idx ? n_delim : n_delim + 1;
+  for (int i = 0; i < n_field; i++) {
+    size_t end = i < n_delim ? start + delim_pos[i] : len;
+    size_t field_start = i == 0 ? start : start + delim_pos[i - 1] + 1;
+    size_t field_end = end;
+    while (field_start < field_end && csv_is_space(line[field_start], delim)) field_start++;
+    while (field_end > field_start && csv_is_space(line[field_end - 1], delim)) field_end--;
+    line[field_end] = '\0';
+    csv_cb1(line + field_start, field_end - field_start, reader);
+  }
+  csv_cb2('\n', reader);
+
+  return true;
+}
+
 /**
  * @brief setup a csv reader
  *
@@ -300,6 +431,17 @@ void csv_setup_reader(reader_t *const reader) {
     csv_params->feature_fields[i] = init_params->feature_fields[i];
   }
 
+  int field_idxs[] = {csv_params->time_field_idx, csv_params->obj_id_field_idx, csv_params->obj_size_field_idx,
+                      csv_params->op_field_idx,   csv_params->ttl_field_idx,    csv_params->cnt_field_idx,
+                      csv_params->tenant_field_idx};
+  csv_params->max_field_idx = 0;
+  for (int i = 0; i < (int)(sizeof(field_idxs) / sizeof(field_idxs[0])); i++) {
+    csv_params->max_field_idx = MAX(csv_params->max_field_idx, field_idxs[i]);
+  }
+  for (int i = 0; i < csv_params->n_feature_fields; i++) {
+    csv_params->max_field_idx = MAX(csv_params->max_field_idx, csv_params->feature_fields[i]);
+  }
+
   csv_params->csv_parser = (struct csv_parser *)malloc(sizeof(struct csv_parser));
   csv_params->n_obj_id_is_num = 0;
   csv_params->n_obj_id_is_not_num = 0;
@@ -317,6 +459,9 @@ void csv_setup_reader(reader_t *const reader) {
     csv_params->delimiter = init_params->delimiter;
   }
   csv_set_delim(csv_params->csv_parser, csv_params->delimiter);
+  csv_params->fast_parse = csv_params->max_field_idx > 0 && csv_params->max_field_idx <= CSV_FAST_MAX_FIELDS &&
+                           csv_params->delimiter != '"' && csv_params->delimiter != '\r' &&
+                           csv_params->delimiter != '\n';
 
   if (!init_params->has_header_set) {
     csv_params->has_header = csv_detect_header(reader);
@@ -346,16 +491,23 @@ int csv_read_one_req(reader_t *const reader, request_t *const req) {
   DEBUG_ASSERT(csv_params->curr_field_idx == 1);
 
   ssize_t read_size = getline(line_buf_ptr, line_buf_size_ptr, reader->file);
+  while (read_size != -1 && csv_is_blank_line(*line_buf_ptr, read_size, (char)csv_params->delimiter)) {
+    /* otherwise the request is left unchanged and returned again */
+    DEBUG("skip an empty line\n");
+    read_size = getline(line_buf_ptr, line_buf_size_ptr, reader->file);
+  }
   if (read_size == -1) {
     req->valid = false;
     return 1;
   }
 
-  if ((size_t)csv_parse(csv_parser, *line_buf_ptr, read_size, csv_cb1, csv_cb2, reader) != read_size) {
-    WARN("parsing csv file error: %s\n", csv_strerror(csv_error(csv_params->csv_parser)));
-  }
+  if (!csv_params->fast_parse || !csv_parse_line_fast(reader, *line_buf_ptr, read_size)) {
+    if ((size_t)csv_parse(csv_parser, *line_buf_ptr, read_size, csv_cb1, csv_cb2, reader) != read_size) {
+      WARN("parsing csv file error: %s\n", csv_strerror(csv_error(csv_params->csv_parser)));
+    }
 
-  csv_fini(csv_params->csv_parser, csv_cb1, csv_cb2, reader);
+    csv_fini(csv_params->csv_parser, csv_cb1, csv_cb2, reader);
+  }
 
   if (req->obj_size == 0 && reader->ignore_size_zero_req) {
     if (reader->read_direction == READ_FORWARD) {
@@ -365,7 +517,10 @@ int csv_read_one_req(reader_t *const reader, request_t *const req) {
     }
   }
 
-  if (reader->n_req_left > 0) reader->last_req_clock_time = req->clock_time;
+  if (reader->n_req_left > 0) {
+    reader->last_req_clock_time = req->clock_time;
+    copy_request(&csv_params->repeated_req, req);
+  }
 
   return 0;
 }
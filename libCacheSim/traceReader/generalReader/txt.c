@@ -24,6 +24,16 @@ int txt_read_one_req(reader_t *const reader, request_t *const req) {
     return 1;
   }
   if (reader->obj_id_is_num) {
+    /* strtoull stops at the first non-digit as well, ids starting with 0
+     * can be hex (0x) or octal */
+    size_t n_digit = 0;
+    while (n_digit < (size_t)read_size && isdigit((unsigned char)reader->line_buf[n_digit])) n_digit++;
+    uint64_t obj_id;
+    if (reader->line_buf[0] != '0' && parse_dec_num(reader->line_buf, n_digit, 19, &obj_id)) {
+      req->obj_id = obj_id;
+      return 0;
+    }
+
     char *end;
     req->obj_id = strtoull(reader->line_buf, &end, 0);
     if (req->obj_id == 0 && end == reader->line_buf) {
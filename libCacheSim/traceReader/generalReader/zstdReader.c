@@ -8,15 +8,39 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>  // strerror
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <zstd.h>
 
 #include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
 
 #define LINE_DELIM '\n'
 
+/* the decompression threads and the block memory used by all the readers */
+static pthread_mutex_t budget_mtx = PTHREAD_MUTEX_INITIALIZER;
+static int budget_n_thread = 0;
+static size_t budget_mem = 0;
+
+static void _init_blocks(zstd_reader_t *reader) {
+  for (int i = 0; i < ZSTD_READER_MAX_BLOCKS; i++) {
+    reader->blocks[i].size = 0;
+    reader->blocks[i].seq = i;
+    reader->blocks[i].start = 0;
+    reader->blocks[i].last = false;
+    reader->blocks[i].error = false;
+    reader->blocks[i].state = ZSTD_BLOCK_EMPTY;
+  }
+  reader->next_fill_seq = 0;
+  reader->curr_seq = -1;
+  reader->curr_block = NULL;
+  reader->prev_block = NULL;
+}
+
 zstd_reader_t *create_zstd_reader(const char *trace_path) {
   zstd_reader_t *reader = malloc(sizeof(zstd_reader_t));
+  memset(reader, 0, sizeof(zstd_reader_t));
 
   reader->ifile = fopen(trace_path, "rb");
   if (reader->ifile == NULL) {
@@ -29,94 +53,628 @@ zstd_reader_t *create_zstd_reader(const char *trace_path) {
   reader->input.src = reader->buff_in;
   reader->input.size = 0;
   reader->input.pos = 0;
+  reader->stream_offset = 0;
+  reader->stream_block_size = ZSTD_READER_STREAM_BLOCK_SIZE;
 
-  reader->buff_out_sz = ZSTD_DStreamOutSize() * 2;
-  reader->buff_out = malloc(reader->buff_out_sz);
-  reader->output.dst = reader->buff_out;
-  reader->output.size = reader->buff_out_sz;
-  reader->output.pos = 0;
+  reader->zds = ZSTD_createDStream();
 
-  reader->buff_out_read_pos = 0;
-  reader->status = 0;
+  reader->mapped_file = NULL;
+  reader->frames = NULL;
+  reader->n_frame = -1;
+
+  reader->n_block = 0;
+  reader->ring_start_frame = 0;
+  reader->ring_step = 1;
+  reader->n_thread = 0;
+  reader->budget_mem = 0;
+  reader->threads_started = false;
+  reader->stop = false;
+  pthread_mutex_init(&reader->mtx, NULL);
+  pthread_cond_init(&reader->cond_ready, NULL);
+  pthread_cond_init(&reader->cond_empty, NULL);
+  _init_blocks(reader);
+  reader->read_pos = 0;
+
+  reader->stitch_buff_sz = 0;
+  reader->stitch_buff = NULL;
 
-  reader->zds = ZSTD_createDStream();
+  reader->status = 0;
 
   DEBUG("create zstd reader %s\n", trace_path);
   return reader;
 }
 
+static void _stop_threads(zstd_reader_t *reader) {
+  if (!reader->threads_started) {
+    return;
+  }
+
+  pthread_mutex_lock(&reader->mtx);
+  reader->stop = true;
+  pthread_cond_broadcast(&reader->cond_empty);
+  pthread_cond_broadcast(&reader->cond_ready);
+  pthread_mutex_unlock(&reader->mtx);
+
+  for (int i = 0; i < reader->n_thread; i++) {
+    pthread_join(reader->threads[i], NULL);
+  }
+
+  pthread_mutex_lock(&budget_mtx);
+  budget_n_thread -= reader->n_thread;
+  pthread_mutex_unlock(&budget_mtx);
+
+  reader->stop = false;
+  reader->threads_started = false;
+}
+
 void free_zstd_reader(zstd_reader_t *reader) {
+  _stop_threads(reader);
+
   ZSTD_freeDStream(reader->zds);
+  fclose(reader->ifile);
   free(reader->buff_in);
-  free(reader->buff_out);
+  for (int i = 0; i < ZSTD_READER_MAX_BLOCKS; i++) {
+    free(reader->blocks[i].data);
+  }
+  pthread_mutex_lock(&budget_mtx);
+  budget_mem -= reader->budget_mem;
+  pthread_mutex_unlock(&budget_mtx);
+  free(reader->stitch_buff);
+  free(reader->frames);
+  if (reader->mapped_file != NULL) {
+    munmap(reader->mapped_file, reader->file_size);
+  }
+  pthread_mutex_destroy(&reader->mtx);
+  pthread_cond_destroy(&reader->cond_ready);
+  pthread_cond_destroy(&reader->cond_empty);
   free(reader);
   DEBUG("free zstd reader\n");
 }
 
-void reset_zstd_reader(zstd_reader_t *reader) {
-  ZSTD_freeDStream(reader->zds);
-  reader->zds = ZSTD_createDStream();
+static void _reset_stream(zstd_reader_t *reader) {
+  ZSTD_DCtx_reset(reader->zds, ZSTD_reset_session_only);
   fseek(reader->ifile, 0, SEEK_SET);
   reader->input.size = 0;
   reader->input.pos = 0;
-  memset(reader->buff_in, 0, reader->buff_in_sz);
-  reader->output.pos = 0;
-  reader->buff_out_read_pos = 0;
-  memset(reader->buff_out, 0, reader->buff_out_sz);
+  reader->stream_offset = 0;
+}
+
+void reset_zstd_reader(zstd_reader_t *reader) {
+  _stop_threads(reader);
+  _reset_stream(reader);
+  _init_blocks(reader);
+  reader->read_pos = 0;
   reader->status = 0;
 }
 
-size_t _read_from_file(zstd_reader_t *reader) {
-  size_t read_sz;
-  read_sz = fread(reader->buff_in, 1, reader->buff_in_sz, reader->ifile);
-  if (read_sz < reader->buff_in_sz) {
-    if (feof(reader->ifile)) {
-      reader->status = MY_EOF;
+static inline uint32_t _load_u32(const char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/**
+ * read the frame index from the seek table at the end of a file in the zstd
+ * seekable format, the seek table is a skippable frame
+ *
+ * | magic | frame size | entries | n_frame | descriptor | seekable magic |
+ *
+ * each entry has the compressed and decompressed size of one frame, followed
+ * by an optional checksum
+ */
+static bool _read_seek_table(zstd_reader_t *reader) {
+  if (reader->file_size < 8 + ZSTD_SEEKABLE_FOOTER_SIZE) {
+    return false;
+  }
+
+  const char *footer =
+      reader->mapped_file + reader->file_size - ZSTD_SEEKABLE_FOOTER_SIZE;
+  if (_load_u32(footer + 5) != ZSTD_SEEKABLE_MAGIC) {
+    return false;
+  }
+
+  uint64_t n_frame = _load_u32(footer);
+  uint64_t entry_size = (footer[4] & 0x80) ? 12 : 8;
+  uint64_t table_size = 8 + n_frame * entry_size + ZSTD_SEEKABLE_FOOTER_SIZE;
+  if (table_size > reader->file_size) {
+    WARN("corrupted zstd seek table\n");
+    return false;
+  }
+  const char *table = reader->mapped_file + reader->file_size - table_size;
+  if (_load_u32(table) != ZSTD_SEEKABLE_SKIPPABLE_MAGIC) {
+    WARN("corrupted zstd seek table\n");
+    return false;
+  }
+
+  zstd_frame_t *frames = malloc(sizeof(zstd_frame_t) * MAX(n_frame, 1));
+  uint64_t offset = 0, content_offset = 0;
+  for (uint64_t i = 0; i < n_frame; i++) {
+    const char *entry = table + 8 + i * entry_size;
+    frames[i].offset = offset;
+    frames[i].compressed_size = _load_u32(entry);
+    frames[i].content_offset = content_offset;
+    frames[i].content_size = _load_u32(entry + 4);
+    offset += frames[i].compressed_size;
+    content_offset += frames[i].content_size;
+    if (frames[i].content_size > ZSTD_READER_MAX_FRAME_SIZE) {
+      WARN("zstd seek table has a frame of %" PRIu64
+           " bytes, larger than %d bytes, the trace is streamed without "
+           "seeking\n",
+           frames[i].content_size, ZSTD_READER_MAX_FRAME_SIZE);
+      free(frames);
+      return false;
+    }
+  }
+
+  if (offset != reader->file_size - table_size) {
+    WARN("zstd seek table does not match the file\n");
+    free(frames);
+    return false;
+  }
+
+  reader->frames = frames;
+  reader->n_frame = (int64_t)n_frame;
+  return true;
+}
+
+/**
+ * find the frames by walking the file, this only builds an index if every
+ * frame records its content size, a single-frame file usually records a
+ * content size larger than ZSTD_READER_MAX_FRAME_SIZE, so the scan stops at
+ * the first frame
+ */
+static bool _scan_frames(zstd_reader_t *reader) {
+  int64_t n_frame = 0, frames_capacity = 1024;
+  zstd_frame_t *frames = malloc(sizeof(zstd_frame_t) * frames_capacity);
+  uint64_t offset = 0, content_offset = 0;
+  while (offset < reader->file_size) {
+    const char *src = reader->mapped_file + offset;
+    size_t src_size = reader->file_size - offset;
+    size_t compressed_size = ZSTD_findFrameCompressedSize(src, src_size);
+    if (ZSTD_isError(compressed_size)) {
+      free(frames);
+      return false;
+    }
+
+    uint32_t magic = 0;
+    memcpy(&magic, src, MIN(sizeof(magic), src_size));
+    if ((magic & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START) {
+      /* pzstd writes a skippable frame before each frame */
+      offset += compressed_size;
+      continue;
+    }
+
+    unsigned long long content_size = ZSTD_getFrameContentSize(src, src_size);
+    if (content_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+        content_size == ZSTD_CONTENTSIZE_ERROR ||
+        content_size > ZSTD_READER_MAX_FRAME_SIZE) {
+      free(frames);
+      return false;
+    }
+
+    if (n_frame == frames_capacity) {
+      frames_capacity *= 2;
+      frames = realloc(frames, sizeof(zstd_frame_t) * frames_capacity);
+    }
+    frames[n_frame].offset = offset;
+    frames[n_frame].compressed_size = compressed_size;
+    frames[n_frame].content_offset = content_offset;
+    frames[n_frame].content_size = content_size;
+    n_frame++;
+    offset += compressed_size;
+    content_offset += content_size;
+  }
+
+  reader->frames = frames;
+  reader->n_frame = n_frame;
+  return true;
+}
+
+/**
+ * build the frame index of the file, n_frame is set to 0 if the file does not
+ * have an index, in which case the file is streamed
+ */
+static void _build_frame_index(zstd_reader_t *reader) {
+  reader->n_frame = 0;
+
+  struct stat st;
+  if (fstat(fileno(reader->ifile), &st) != 0 || st.st_size == 0) {
+    return;
+  }
+  reader->file_size = st.st_size;
+  reader->mapped_file = mmap(NULL, reader->file_size, PROT_READ, MAP_PRIVATE,
+                             fileno(reader->ifile), 0);
+  if (reader->mapped_file == MAP_FAILED) {
+    reader->mapped_file = NULL;
+    return;
+  }
+
+  if (!_read_seek_table(reader) && !_scan_frames(reader)) {
+    reader->n_frame = 0;
+  }
+
+  if (reader->n_frame == 0) {
+    free(reader->frames);
+    reader->frames = NULL;
+    munmap(reader->mapped_file, reader->file_size);
+    reader->mapped_file = NULL;
+    return;
+  }
+
+  reader->max_frame_size = 0;
+  for (int64_t i = 0; i < reader->n_frame; i++) {
+    reader->max_frame_size =
+        MAX(reader->max_frame_size, reader->frames[i].content_size);
+  }
+  DEBUG("zstd trace has %" PRId64 " frames\n", reader->n_frame);
+}
+
+bool zstd_reader_is_seekable(zstd_reader_t *reader) {
+  if (reader->n_frame == -1) {
+    _build_frame_index(reader);
+  }
+  return reader->n_frame > 0;
+}
+
+int64_t zstd_reader_content_size(zstd_reader_t *reader) {
+  if (!zstd_reader_is_seekable(reader)) {
+    return -1;
+  }
+  const zstd_frame_t *last_frame = &reader->frames[reader->n_frame - 1];
+  return (int64_t)(last_frame->content_offset + last_frame->content_size);
+}
+
+/* the frame that has the given offset, -1 if the offset is beyond the end */
+static int64_t _find_frame(const zstd_reader_t *reader, uint64_t offset) {
+  int64_t lo = 0, hi = reader->n_frame - 1;
+  const zstd_frame_t *last_frame = &reader->frames[hi];
+  if (offset >= last_frame->content_offset + last_frame->content_size) {
+    return -1;
+  }
+
+  while (lo < hi) {
+    int64_t mid = (lo + hi + 1) / 2;
+    if (reader->frames[mid].content_offset <= offset) {
+      lo = mid;
     } else {
-      assert(ferror(reader->ifile));
-      reader->status = ERR;
-      return 0;
+      hi = mid - 1;
     }
   }
-  //  DEBUG("read %zu bytes from file\n", read_sz);
+  return lo;
+}
 
-  reader->input.size = read_sz;
-  reader->input.pos = 0;
+/* wait until the block for seq can be filled, return NULL if stopped */
+static zstd_block_t *_wait_empty_block(zstd_reader_t *reader, int64_t seq) {
+  zstd_block_t *block = &reader->blocks[seq % reader->n_block];
+  pthread_mutex_lock(&reader->mtx);
+  while (!reader->stop &&
+         !(block->state == ZSTD_BLOCK_EMPTY && block->seq == seq)) {
+    pthread_cond_wait(&reader->cond_empty, &reader->mtx);
+  }
+  bool stopped = reader->stop;
+  pthread_mutex_unlock(&reader->mtx);
 
-  return read_sz;
-}
-
-rstatus _decompress_from_buff(zstd_reader_t *reader) {
-  /* move the unread decompressed data to the head of buff_out */
-  void *buff_start = reader->buff_out + reader->buff_out_read_pos;
-  size_t buff_left_sz = reader->output.pos - reader->buff_out_read_pos;
-  memmove(reader->buff_out, buff_start, buff_left_sz);
-  reader->output.pos = buff_left_sz;
-  reader->buff_out_read_pos = 0;
-  size_t old_pos = buff_left_sz;
-
-  if (reader->input.pos >= reader->input.size) {
-    size_t read_sz = _read_from_file(reader);
-    if (read_sz == 0) {
-      if (reader->status == MY_EOF) {
-        return MY_EOF;
-      } else {
-        ERROR("read from file error\n");
-        return ERR;
+  return stopped ? NULL : block;
+}
+
+static void _publish_block(zstd_reader_t *reader, zstd_block_t *block) {
+  pthread_mutex_lock(&reader->mtx);
+  block->state = ZSTD_BLOCK_READY;
+  pthread_cond_broadcast(&reader->cond_ready);
+  pthread_mutex_unlock(&reader->mtx);
+}
+
+/* stream the file into blocks of stream_block_size bytes */
+static void *_stream_worker(void *arg) {
+  zstd_reader_t *reader = arg;
+  bool file_eof = false;
+
+  for (int64_t seq = 0;; seq++) {
+    zstd_block_t *block = _wait_empty_block(reader, seq);
+    if (block == NULL) {
+      return NULL;
+    }
+
+    ZSTD_outBuffer output = {block->data, reader->stream_block_size, 0};
+    bool done = false;
+    while (output.pos < output.size) {
+      if (reader->input.pos >= reader->input.size && !file_eof) {
+        size_t read_sz =
+            fread(reader->buff_in, 1, reader->buff_in_sz, reader->ifile);
+        if (read_sz < reader->buff_in_sz) {
+          if (ferror(reader->ifile)) {
+            ERROR("read from file error\n");
+            block->error = true;
+          }
+          file_eof = true;
+        }
+        reader->input.size = read_sz;
+        reader->input.pos = 0;
+      }
+
+      size_t old_pos = output.pos;
+      size_t const ret =
+          ZSTD_decompressStream(reader->zds, &output, &reader->input);
+      if (ZSTD_isError(ret)) {
+        WARN("zstd decompression error: %s\n", ZSTD_getErrorName(ret));
+        block->error = true;
+      }
+
+      if (block->error || (file_eof && reader->input.pos >= reader->input.size &&
+                           output.pos == old_pos)) {
+        /* all the data in the decoder have been flushed */
+        done = true;
+        break;
       }
     }
+
+    block->size = output.pos;
+    block->start = reader->stream_offset;
+    block->last = done;
+    reader->stream_offset += output.pos;
+    _publish_block(reader, block);
+    if (done) {
+      return NULL;
+    }
+  }
+}
+
+static inline int64_t _ring_frame(const zstd_reader_t *reader, int64_t seq) {
+  return reader->ring_start_frame + seq * reader->ring_step;
+}
+
+/* decompress one frame into one block, frames are taken in the ring order */
+static void *_frame_worker(void *arg) {
+  zstd_reader_t *reader = arg;
+  ZSTD_DCtx *dctx = ZSTD_createDCtx();
+
+  while (true) {
+    pthread_mutex_lock(&reader->mtx);
+    int64_t seq = reader->next_fill_seq;
+    int64_t frame_idx = _ring_frame(reader, seq);
+    bool has_frame = frame_idx >= 0 && frame_idx < reader->n_frame;
+    if (has_frame) {
+      reader->next_fill_seq++;
+    }
+    pthread_mutex_unlock(&reader->mtx);
+    if (!has_frame) {
+      break;
+    }
+
+    zstd_block_t *block = _wait_empty_block(reader, seq);
+    if (block == NULL) {
+      break;
+    }
+
+    const zstd_frame_t *frame = &reader->frames[frame_idx];
+    if (block->capacity < frame->content_size) {
+      block->capacity = frame->content_size;
+      block->data = realloc(block->data, block->capacity);
+    }
+    size_t const ret =
+        ZSTD_decompressDCtx(dctx, block->data, block->capacity,
+                            reader->mapped_file + frame->offset,
+                            frame->compressed_size);
+    if (ZSTD_isError(ret) || ret != frame->content_size) {
+      WARN("zstd decompression error on frame %" PRId64 ": %s\n", frame_idx,
+           ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatch");
+      block->error = true;
+      block->size = 0;
+    } else {
+      block->size = ret;
+    }
+    block->start = frame->content_offset;
+    int64_t next_frame_idx = frame_idx + reader->ring_step;
+    block->last = next_frame_idx < 0 || next_frame_idx >= reader->n_frame;
+    _publish_block(reader, block);
+  }
+
+  ZSTD_freeDCtx(dctx);
+  return NULL;
+}
+
+/**
+ * the number of blocks in the ring, the reader holds two blocks, in streaming
+ * mode the thread fills the third block, otherwise each thread fills one block
+ * and has one decompressed block waiting to be read
+ */
+static inline int _n_block(bool seekable, int n_thread) {
+  return seekable ? n_thread * 2 + 2 : 3;
+}
+
+/**
+ * take up to n_thread threads and the memory of their blocks from the
+ * process budget, the memory of the previous ring of the reader is returned
+ * @return the number of threads to start, at least one
+ */
+static int _take_budget(zstd_reader_t *reader, bool seekable, int n_thread,
+                        size_t block_size) {
+  long n_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+  pthread_mutex_lock(&budget_mtx);
+  budget_mem -= reader->budget_mem;
+  n_thread = (int)MIN(n_thread, MAX(n_cpu - 1, 1) - budget_n_thread);
+  while (n_thread > 1 &&
+         budget_mem + _n_block(seekable, n_thread) * block_size >
+             ZSTD_READER_PROCESS_MAX_MEM) {
+    n_thread--;
+  }
+  /* the reader cannot make progress without a thread */
+  n_thread = MAX(n_thread, 1);
+  reader->budget_mem = _n_block(seekable, n_thread) * block_size;
+  budget_mem += reader->budget_mem;
+  budget_n_thread += n_thread;
+  pthread_mutex_unlock(&budget_mtx);
+
+  return n_thread;
+}
+
+/**
+ * (re)start the ring at the given frame, the blocks that are held by the
+ * reader are dropped
+ */
+static void _start_ring(zstd_reader_t *reader, int64_t start_frame, int step) {
+  _stop_threads(reader);
+  _init_blocks(reader);
+
+  void *(*worker)(void *);
+  bool seekable = zstd_reader_is_seekable(reader);
+  if (seekable) {
+    reader->n_thread = _take_budget(
+        reader, true, (int)MIN(ZSTD_READER_MAX_THREADS, reader->n_frame),
+        reader->max_frame_size);
+    reader->ring_start_frame = start_frame;
+    reader->ring_step = step;
+    worker = _frame_worker;
+  } else {
+    assert(start_frame == 0 && step == 1);
+    _reset_stream(reader);
+    reader->n_thread = _take_budget(reader, false, 1, reader->stream_block_size);
+    reader->ring_start_frame = 0;
+    reader->ring_step = 1;
+    worker = _stream_worker;
+  }
+  reader->n_block = _n_block(seekable, reader->n_thread);
+
+  /* the blocks out of the ring are not counted in the budget */
+  for (int i = reader->n_block; i < ZSTD_READER_MAX_BLOCKS; i++) {
+    free(reader->blocks[i].data);
+    reader->blocks[i].data = NULL;
+    reader->blocks[i].capacity = 0;
+  }
+  if (!seekable) {
+    for (int i = 0; i < reader->n_block; i++) {
+      if (reader->blocks[i].capacity < reader->stream_block_size) {
+        reader->blocks[i].capacity = reader->stream_block_size;
+        reader->blocks[i].data =
+            realloc(reader->blocks[i].data, reader->blocks[i].capacity);
+      }
+    }
+  }
+
+  for (int i = 0; i < reader->n_thread; i++) {
+    if (pthread_create(&reader->threads[i], NULL, worker, reader) != 0) {
+      ERROR("cannot create zstd decompression thread: %s\n", strerror(errno));
+      abort();
+    }
+  }
+  reader->threads_started = true;
+}
+
+/**
+ * release the older held block and move to the next block of the ring
+ * @return false if there is no more data in the direction of the ring
+ */
+static bool _next_block(zstd_reader_t *reader) {
+  zstd_block_t *block = reader->curr_block;
+  if (block == NULL) {
+    if (!reader->threads_started) {
+      _start_ring(reader, 0, 1);
+    }
+  } else if (block->last || block->error) {
+    reader->status = block->error ? ERR : MY_EOF;
+    return false;
+  }
+
+  if (reader->prev_block != NULL) {
+    pthread_mutex_lock(&reader->mtx);
+    reader->prev_block->state = ZSTD_BLOCK_EMPTY;
+    reader->prev_block->seq += reader->n_block;
+    pthread_cond_broadcast(&reader->cond_empty);
+    pthread_mutex_unlock(&reader->mtx);
+  }
+
+  reader->curr_seq++;
+  block = &reader->blocks[reader->curr_seq % reader->n_block];
+  pthread_mutex_lock(&reader->mtx);
+  while (!(block->state == ZSTD_BLOCK_READY && block->seq == reader->curr_seq)) {
+    pthread_cond_wait(&reader->cond_ready, &reader->mtx);
+  }
+  pthread_mutex_unlock(&reader->mtx);
+
+  reader->prev_block = reader->curr_block;
+  reader->curr_block = block;
+  if (block->error) {
+    ERROR("error decompress file\n");
+    reader->status = ERR;
+    return false;
+  }
+
+  return true;
+}
+
+static inline bool _block_has(const zstd_block_t *block, uint64_t offset) {
+  return block != NULL && offset >= block->start &&
+         offset < block->start + block->size;
+}
+
+/**
+ * make sure a block that has the offset is in memory
+ * @return the block, NULL if the offset is beyond the end of the trace
+ */
+static zstd_block_t *_fetch_block(zstd_reader_t *reader, uint64_t offset) {
+  if (_block_has(reader->curr_block, offset)) {
+    return reader->curr_block;
+  }
+  if (_block_has(reader->prev_block, offset)) {
+    return reader->prev_block;
+  }
+
+  if (zstd_reader_is_seekable(reader)) {
+    int64_t frame_idx = _find_frame(reader, offset);
+    if (frame_idx == -1) {
+      reader->status = MY_EOF;
+      return NULL;
+    }
+
+    if (reader->curr_block == NULL ||
+        _ring_frame(reader, reader->curr_seq + 1) != frame_idx) {
+      /* the frame is not the next one in the ring, restart the ring at the
+       * frame and move backward if the reader is moving backward */
+      int step = 1;
+      if (reader->curr_block != NULL &&
+          offset < reader->curr_block->start) {
+        step = -1;
+      }
+      _start_ring(reader, frame_idx, step);
+    }
+
+    if (!_next_block(reader)) {
+      return NULL;
+    }
+    /* a frame may be empty */
+    return _block_has(reader->curr_block, offset)
+               ? reader->curr_block
+               : _fetch_block(reader, offset);
   }
 
-  size_t const ret = ZSTD_decompressStream(reader->zds, &(reader->output), &(reader->input));
-  if (ret != 0) {
-    if (ZSTD_isError(ret)) {
-      printf("%zu\n", ret);
-      WARN("zstd decompression error: %s\n", ZSTD_getErrorName(ret));
+  /* the file can only be decompressed from the start */
+  if (reader->curr_block != NULL && offset < reader->curr_block->start) {
+    static bool warned = false;
+    if (!warned) {
+      WARN(
+          "seeking backward in a zstd trace without a frame index, "
+          "decompress from the start, use traceConv --zstd to compress the "
+          "trace in the seekable format\n");
+      warned = true;
     }
+    _start_ring(reader, 0, 1);
   }
-  //  DEBUG("decompress %zu - %zu bytes\n", reader->output.pos, old_pos);
 
-  return OK;
+  do {
+    if (!_next_block(reader)) {
+      return NULL;
+    }
+  } while (!_block_has(reader->curr_block, offset));
+
+  return reader->curr_block;
+}
+
+static void _ensure_stitch_buff(zstd_reader_t *reader, size_t sz) {
+  if (reader->stitch_buff_sz >= sz) {
+    return;
+  }
+  reader->stitch_buff_sz = MAX(sz, reader->stitch_buff_sz * 2);
+  reader->stitch_buff = realloc(reader->stitch_buff, reader->stitch_buff_sz);
 }
 
 /**
@@ -125,56 +683,60 @@ rstatus _decompress_from_buff(zstd_reader_t *reader) {
 
     @return the number of bytes read (include line ending byte)
 **/
-size_t zstd_reader_read_line(zstd_reader_t *reader, char **line_start, char **line_end) {
-  bool has_data_in_line_buff = false;
-
-  if (reader->buff_out_read_pos < reader->output.pos) {
-    /* there are still content in output buffer */
-    *line_start = reader->buff_out + reader->buff_out_read_pos;
-    void *buff_start = reader->buff_out + reader->buff_out_read_pos;
-    size_t buff_left_sz = reader->output.pos - reader->buff_out_read_pos;
-    *line_end = memchr(buff_start, LINE_DELIM, buff_left_sz);
-    if (*line_end == NULL) {
-      /* cannot find end of line, copy left over bytes, and decompress the next
-       * frame */
-      has_data_in_line_buff = true;
-    } else {
-      /* find a line in buff_out */
-      assert(**line_end == LINE_DELIM);
-      size_t sz = *line_end - *line_start + 1;
-      reader->buff_out_read_pos += sz;
+size_t zstd_reader_read_line(zstd_reader_t *reader, char **line_start,
+                             char **line_end) {
+  zstd_block_t *block = _fetch_block(reader, reader->read_pos);
+  if (block == NULL) {
+    return 0;
+  }
 
-      return sz;
-    }
+  char *start = block->data + (reader->read_pos - block->start);
+  size_t left_sz = block->start + block->size - reader->read_pos;
+  char *end = memchr(start, LINE_DELIM, left_sz);
+  if (end != NULL) {
+    /* find a line in the block */
+    *line_start = start;
+    *line_end = end;
+    reader->read_pos += end - start + 1;
+    return end - start + 1;
   }
 
-  rstatus status = _decompress_from_buff(reader);
-  if (status != OK) {
-    if (status == MY_EOF && has_data_in_line_buff) {
-      *(((char *)(reader->buff_out)) + reader->output.pos) = '\n';
-    } else {
-      return 0;
+  /* the line spans blocks, copy the left over bytes */
+  size_t line_sz = left_sz;
+  _ensure_stitch_buff(reader, line_sz + 1);
+  memcpy(reader->stitch_buff, start, line_sz);
+  reader->read_pos += left_sz;
+
+  while (true) {
+    block = _fetch_block(reader, reader->read_pos);
+    if (block == NULL) {
+      /* the last line does not end with a line delimiter */
+      reader->stitch_buff[line_sz] = LINE_DELIM;
+      break;
     }
-  } else if (reader->output.pos < reader->output.size / 4) {
-    /* input buffer does not have enough content, read more from file */
-    status = _decompress_from_buff(reader);
-  }
 
-  *line_start = reader->buff_out + reader->buff_out_read_pos;
-  *line_end = memchr(*line_start, LINE_DELIM, reader->output.pos);
-  // printf("start at %d %d end %d %d\n", reader->buff_out_read_pos,
-  // **line_start, *line_end - *line_start, **line_end);
-  assert(*line_end != NULL);
-  assert(**line_end == LINE_DELIM);
-  size_t sz = *line_end - *line_start + 1;
-  reader->buff_out_read_pos = sz;
+    start = block->data + (reader->read_pos - block->start);
+    left_sz = block->start + block->size - reader->read_pos;
+    end = memchr(start, LINE_DELIM, left_sz);
+    size_t sz = end == NULL ? left_sz : (size_t)(end - start) + 1;
+    _ensure_stitch_buff(reader, line_sz + sz + 1);
+    memcpy(reader->stitch_buff + line_sz, start, sz);
+    line_sz += sz;
+    reader->read_pos += sz;
+    if (end != NULL) {
+      line_sz -= 1;
+      break;
+    }
+  }
 
-  return sz;
+  *line_start = reader->stitch_buff;
+  *line_end = reader->stitch_buff + line_sz;
+  return line_sz + 1;
 }
 
 /**
  * read n_byte from reader, decompress if needed, data_start points to the new
- * data
+ * data, the data is valid until the next read
  *
  * return the number of available bytes
  *
@@ -183,31 +745,44 @@ size_t zstd_reader_read_line(zstd_reader_t *reader, char **line_start, char **li
  * @param data_start
  * @return
  */
-size_t zstd_reader_read_bytes(zstd_reader_t *reader, size_t n_byte, char **data_start) {
-  size_t sz = 0;
-  while (reader->buff_out_read_pos + n_byte > reader->output.pos) {
-    rstatus status = _decompress_from_buff(reader);
-
-    if (status != OK) {
-      if (status != MY_EOF) {
-        ERROR("error decompress file\n");
-      } else {
-        /* end of file */
-        return 0;
-      }
-      break;
-    }
+size_t zstd_reader_read_bytes(zstd_reader_t *reader, size_t n_byte,
+                              char **data_start) {
+  zstd_block_t *block = reader->curr_block;
+  uint64_t pos = reader->read_pos;
+  if (likely(block != NULL && pos >= block->start &&
+             pos + n_byte <= block->start + block->size)) {
+    *data_start = block->data + (pos - block->start);
+    reader->read_pos += n_byte;
+    return n_byte;
   }
 
-  if (reader->buff_out_read_pos + n_byte <= reader->output.pos) {
-    sz = n_byte;
-    *data_start = ((char *)reader->buff_out) + reader->buff_out_read_pos;
-    reader->buff_out_read_pos += n_byte;
+  block = _fetch_block(reader, pos);
+  if (block == NULL) {
+    return 0;
+  }
+  if (pos + n_byte <= block->start + block->size) {
+    *data_start = block->data + (pos - block->start);
+    reader->read_pos += n_byte;
+    return n_byte;
+  }
 
-    return sz;
-  } else {
-    ERROR("do not have enough bytes %zu < %zu\n", reader->output.pos - reader->buff_out_read_pos, n_byte);
+  /* the data spans blocks, copy the left over bytes */
+  _ensure_stitch_buff(reader, n_byte);
+  size_t copied = 0;
+  while (copied < n_byte) {
+    block = _fetch_block(reader, pos + copied);
+    if (block == NULL) {
+      ERROR("do not have enough bytes %zu < %zu\n", copied, n_byte);
+      return 0;
+    }
 
-    return sz;
+    size_t block_pos = pos + copied - block->start;
+    size_t sz = MIN(n_byte - copied, block->size - block_pos);
+    memcpy(reader->stitch_buff + copied, block->data + block_pos, sz);
+    copied += sz;
   }
-}
\ No newline at end of file
+
+  *data_start = reader->stitch_buff;
+  reader->read_pos += n_byte;
+  return n_byte;
+}
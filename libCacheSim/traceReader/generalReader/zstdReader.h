@@ -1,5 +1,8 @@
 #pragma once
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <zstd.h>
 
@@ -9,19 +12,120 @@
 extern "C" {
 #endif
 
+/**
+ * the zstd reader decompresses the trace in background threads into a ring of
+ * blocks, the reader thread only hands out pointers into the blocks
+ *
+ * if the file has a frame index, each frame is a block and up to
+ * ZSTD_READER_MAX_THREADS threads decompress different frames in parallel,
+ * the ring can start at any frame and move forward or backward, so the reader
+ * can seek to any offset and read the trace backward; the index comes from
+ * the seek table of the zstd seekable format (written by traceConv --zstd),
+ * or from scanning the frames if every frame records its size (e.g., zstd
+ * --block-size)
+ *
+ * otherwise, one thread streams the file into blocks, seeking forward
+ * decompresses the data in between, and seeking backward beyond the blocks
+ * that are still in memory decompresses from the start of the file
+ *
+ * the readers of a process share a budget of decompression threads (the
+ * number of CPUs minus one) and block memory (ZSTD_READER_PROCESS_MAX_MEM),
+ * so that the readers cloned for each simulation thread do not each start
+ * ZSTD_READER_MAX_THREADS threads, a reader gets fewer threads when the budget
+ * is used up, but always at least one
+ */
+#define ZSTD_READER_MAX_THREADS 4
+#define ZSTD_READER_MAX_BLOCKS (ZSTD_READER_MAX_THREADS * 2 + 2)
+/* the default size of a block in streaming mode */
+#define ZSTD_READER_STREAM_BLOCK_SIZE (4 * 1024 * 1024)
+/* frames larger than this are streamed instead of decompressed in parallel */
+#define ZSTD_READER_MAX_FRAME_SIZE (64 * 1024 * 1024)
+/* the block memory of all the zstd readers in the process */
+#define ZSTD_READER_PROCESS_MAX_MEM (1024L * 1024 * 1024)
+
+/* the zstd seekable format, see zstd/contrib/seekable_format */
+#define ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+#define ZSTD_SEEKABLE_SKIPPABLE_MAGIC 0x184D2A5E
+#define ZSTD_SEEKABLE_FOOTER_SIZE 9
+
+typedef enum {
+  ZSTD_BLOCK_EMPTY = 0,
+  ZSTD_BLOCK_READY,
+} zstd_block_state_e;
+
+typedef struct zstd_block {
+  char *data;
+  size_t size;
+  size_t capacity;
+  /* the sequence number of the data in the ring */
+  int64_t seq;
+  /* the offset of data[0] in the decompressed trace */
+  uint64_t start;
+  /* this is the last block in the direction of the ring */
+  bool last;
+  bool error;
+  zstd_block_state_e state;
+} zstd_block_t;
+
+typedef struct zstd_frame {
+  uint64_t offset;
+  uint64_t compressed_size;
+  /* the offset of the frame in the decompressed trace */
+  uint64_t content_offset;
+  uint64_t content_size;
+} zstd_frame_t;
+
 typedef struct zstd_reader {
   FILE *ifile;
   ZSTD_DStream *zds;
 
   size_t buff_in_sz;
   void *buff_in;
-  size_t buff_out_sz;
-  void *buff_out;
+  ZSTD_inBuffer input;
+  /* the decompressed offset of the next block in streaming mode */
+  uint64_t stream_offset;
+  /* the size of a block in streaming mode, it can be changed before the
+   * first read */
+  size_t stream_block_size;
 
-  size_t buff_out_read_pos;
+  /* the frame index, n_frame is -1 before the file is scanned and 0 if the
+   * file does not have an index */
+  char *mapped_file;
+  size_t file_size;
+  zstd_frame_t *frames;
+  int64_t n_frame;
+  uint64_t max_frame_size;
 
-  ZSTD_inBuffer input;
-  ZSTD_outBuffer output;
+  /* the decompressed blocks, block seq is at blocks[seq % n_block] and holds
+   * frame ring_start_frame + seq * ring_step */
+  zstd_block_t blocks[ZSTD_READER_MAX_BLOCKS];
+  int n_block;
+  int64_t ring_start_frame;
+  int ring_step;
+  /* the next block to fill by the background threads */
+  int64_t next_fill_seq;
+
+  pthread_t threads[ZSTD_READER_MAX_THREADS];
+  int n_thread;
+  /* the block memory taken from the process budget */
+  size_t budget_mem;
+  bool threads_started;
+  bool stop;
+  pthread_mutex_t mtx;
+  pthread_cond_t cond_ready;
+  pthread_cond_t cond_empty;
+
+  /* the reader holds the last two blocks of the ring, so that data spanning
+   * two blocks can be read in both directions */
+  int64_t curr_seq;
+  zstd_block_t *curr_block;
+  zstd_block_t *prev_block;
+  /* the offset of the next read in the decompressed trace */
+  uint64_t read_pos;
+
+  /* data that spans blocks is copied here */
+  char *stitch_buff;
+  size_t stitch_buff_sz;
 
   rstatus status;
 } zstd_reader_t;
@@ -32,11 +136,22 @@ void free_zstd_reader(zstd_reader_t *reader);
 
 void reset_zstd_reader(zstd_reader_t *reader);
 
+/* whether the file has a frame index, so that seeking is cheap */
+bool zstd_reader_is_seekable(zstd_reader_t *reader);
+
+/* the size of the decompressed trace, -1 if the file has no frame index */
+int64_t zstd_reader_content_size(zstd_reader_t *reader);
+
+/* move the next read to the given offset in the decompressed trace */
+static inline void zstd_reader_seek(zstd_reader_t *reader, uint64_t offset) {
+  reader->read_pos = offset;
+}
+
 size_t zstd_reader_read_line(zstd_reader_t *reader, char **line_start,
                              char **line_end);
 
 /* read n_byte from reader, decompress if needed, data_start points to the new
- * data */
+ * data, which is valid until the next read */
 size_t zstd_reader_read_bytes(zstd_reader_t *reader, size_t n_byte,
                               char **data_start);
 
@@ -8,6 +8,7 @@
 
 #include <ctype.h>
 
+#include "../dataStructure/hash/hash.h"
 #include "../include/libCacheSim/macro.h"
 #include "customizedReader/lcs.h"
 #include "customizedReader/oracle/oracleGeneralBin.h"
@@ -93,6 +94,7 @@ reader_t *setup_reader(const char *const trace_path, const trace_type_e trace_ty
     if (init_params->sampler != NULL) reader->sampler = init_params->sampler->clone(init_params->sampler);
   } else {
     memset(&reader->init_params, 0, sizeof(reader_init_param_t));
+    reader->init_params.compute_hv = true;
   }
 
   assert(trace_path != NULL);
@@ -184,7 +186,7 @@ reader_t *setup_reader(const char *const trace_path, const trace_type_e trace_ty
       abort();
   }
 
-  if (reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file) {
+  if (reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file && !lcs_is_block_trace(reader)) {
     ssize_t data_region_size = reader->file_size - reader->trace_start_offset;
     if (data_region_size % reader->item_size != 0) {
       WARN(
@@ -204,7 +206,7 @@ reader_t *setup_reader(const char *const trace_path, const trace_type_e trace_ty
     abort();
   }
 
-  if (reader->is_zstd_file) {
+  if (reader->is_zstd_file && !lcs_is_block_trace(reader)) {
     // we cannot get the total number requests
     // from compressed trace without reading the tracee
     reader->n_total_req = 0;
@@ -222,7 +224,8 @@ reader_t *setup_reader(const char *const trace_path, const trace_type_e trace_ty
  * @return 0 if success, 1 if end of file
  */
 int read_one_req(reader_t *const reader, request_t *const req) {
-  if (reader->mmap_offset >= reader->file_size) {
+  /* the end of a zstd trace is found when reading */
+  if (reader->mmap_offset >= reader->file_size && !reader->is_zstd_file) {
     DEBUG("read_one_req: end of file, current mmap_offset %zu, file size %zu\n", reader->mmap_offset,
           reader->file_size);
     req->valid = false;
@@ -249,11 +252,16 @@ int read_one_req(reader_t *const reader, request_t *const req) {
 
     switch (reader->trace_type) {
       case CSV_TRACE:
+#if LOGLEVEL <= VVERBOSE_LEVEL
+        /* ftell is a system call, it is only used in logging */
         offset_before_read = ftell(reader->file);
+#endif
         status = csv_read_one_req(reader, req);
         break;
       case PLAIN_TXT_TRACE:;
+#if LOGLEVEL <= VVERBOSE_LEVEL
         offset_before_read = ftell(reader->file);
+#endif
         status = txt_read_one_req(reader, req);
         break;
       case BIN_TRACE:
@@ -320,12 +328,170 @@ int read_one_req(reader_t *const reader, request_t *const req) {
     req->obj_size = 1;
   }
 
+  if (status == 0 && reader->init_params.compute_hv) {
+    /* the sampler may have computed the hash */
+    req->hv = get_req_hash_value(req);
+    req->hv_obj_id = req->obj_id;
+  }
+
   VVERBOSE("read one req: time %lu, obj_id %lu, size %lu at offset %zu\n", req->clock_time, req->obj_id, req->obj_size,
            offset_before_read);
 
   return status;
 }
 
+/* whether the trace has a specialized batch reader */
+static bool _has_batch_reader(const reader_t *const reader) {
+  switch (reader->trace_type) {
+    case ORACLE_GENERAL_TRACE:
+    case BIN_TRACE:
+      return true;
+    case LCS_TRACE:
+      return reader->lcs_ver == 1 || reader->lcs_ver == 2 || reader->lcs_ver == LCS_BLOCK_VER;
+    default:
+      return false;
+  }
+}
+
+/**
+ * read the requests using the batch reader of the trace, the requests are
+ * not sampled or capped
+ * @return the number of requests read, fewer than n at the end of the trace
+ */
+static int _batch_read_n_reqs(reader_t *const reader, request_t *const reqs, const int n) {
+  switch (reader->trace_type) {
+    case ORACLE_GENERAL_TRACE:
+      return oracleGeneralBin_read_n_reqs(reader, reqs, n);
+    case LCS_TRACE:
+      return lcs_read_n_reqs(reader, reqs, n);
+    case BIN_TRACE:
+      return binary_read_n_reqs(reader, reqs, n);
+    default:
+      ERROR("trace type %d does not have a batch reader\n", reader->trace_type);
+      abort();
+  }
+}
+
+int read_n_reqs(reader_t *const reader, request_t *const reqs, const int n) {
+  if (!_has_batch_reader(reader)) {
+    int n_read = 0;
+    while (n_read < n) {
+      request_t *req = &reqs[n_read];
+      if (reader->n_req_left > 0) {
+        /* the next request repeats the previous csv request */
+        csv_params_t *csv_params = reader->reader_params;
+        copy_request(req, &csv_params->repeated_req);
+      }
+      if (read_one_req(reader, req) != 0) break;
+      n_read++;
+    }
+    return n_read;
+  }
+
+  sampler_t *sampler = reader->sampler;
+  bool compute_hv = reader->init_params.compute_hv;
+  int n_read = 0;
+  while (n_read < n) {
+    int n_want = n - n_read;
+    if (reader->cap_at_n_req > 1) {
+      int64_t n_left = reader->cap_at_n_req - (int64_t)reader->n_read_req;
+      if (n_left <= 0) {
+        DEBUG("read_n_reqs: processed %ld requests capped by the user\n", (long)reader->n_read_req);
+        break;
+      }
+      n_want = (int)MIN(n_want, n_left);
+    }
+
+    request_t *batch = reqs + n_read;
+    int n_batch = _batch_read_n_reqs(reader, batch, n_want);
+    reader->n_read_req += n_batch;
+
+    /* sampled requests are compacted to the front of the batch */
+    int n_kept = 0;
+    for (int i = 0; i < n_batch; i++) {
+      request_t *req = &batch[i];
+      if (sampler != NULL && !sampler->sample(sampler, req)) {
+        continue;
+      }
+      if (reader->ignore_obj_size) {
+        req->obj_size = 1;
+      }
+      if (compute_hv) {
+        req->hv = get_req_hash_value(req);
+        req->hv_obj_id = req->obj_id;
+      }
+      if (n_kept != i) {
+        copy_request(&batch[n_kept], req);
+      }
+      n_kept++;
+    }
+    n_read += n_kept;
+
+    if (n_batch < n_want) {
+      /* end of trace */
+      break;
+    }
+  }
+
+  return n_read;
+}
+
+/* the number of requests decoded at a time by read_n_hot_reqs */
+#define READ_HOT_BATCH_SIZE 64
+
+/* decode the requests of an oracleGeneral trace without staging them in
+ * request_t, the requests are not sampled */
+static int _oracleGeneral_read_n_hot_reqs(reader_t *const reader, req_hot_t *const reqs, const int n) {
+  int n_want = n;
+  if (reader->cap_at_n_req > 1) {
+    int64_t n_left = reader->cap_at_n_req - (int64_t)reader->n_read_req;
+    n_want = (int)MAX(MIN(n_want, n_left), 0);
+  }
+
+  int n_read = oracleGeneralBin_read_n_hot_reqs(reader, reqs, n_want);
+  reader->n_read_req += n_read;
+  if (reader->ignore_obj_size || reader->init_params.compute_hv) {
+    for (int i = 0; i < n_read; i++) {
+      if (reader->ignore_obj_size) {
+        reqs[i].obj_size = 1;
+      }
+      if (reader->init_params.compute_hv) {
+        reqs[i].hv = get_hash_value_int_64(&reqs[i].obj_id);
+      }
+    }
+  }
+
+  return n_read;
+}
+
+int read_n_hot_reqs(reader_t *const reader, req_hot_t *const reqs, const int n) {
+  if (reader->trace_type == ORACLE_GENERAL_TRACE && reader->sampler == NULL) {
+    return _oracleGeneral_read_n_hot_reqs(reader, reqs, n);
+  }
+
+  /* the readers only set the fields in the trace, so the batch starts with
+   * the default values of the other fields */
+  request_t batch[READ_HOT_BATCH_SIZE];
+  request_t *default_req = new_request();
+  for (int i = 0; i < READ_HOT_BATCH_SIZE; i++) {
+    copy_request(&batch[i], default_req);
+  }
+  free_request(default_req);
+
+  int n_read = 0;
+  while (n_read < n) {
+    int n_want = MIN(n - n_read, READ_HOT_BATCH_SIZE);
+    int n_batch = read_n_reqs(reader, batch, n_want);
+    for (int i = 0; i < n_batch; i++) {
+      copy_request_to_hot(&reqs[n_read + i], &batch[i]);
+    }
+    n_read += n_batch;
+    if (n_batch < n_want) break;
+  }
+
+  return n_read;
+}
+
 /**
  * @brief from current line/request, go back one, the next read will
  * get the current request
@@ -381,6 +547,10 @@ int go_back_one_req(reader_t *const reader) {
       }
 
     case BINARY_TRACE_FORMAT:
+      if (lcs_is_block_trace(reader)) {
+        int64_t req_idx = lcs_block_tell_req(reader);
+        return req_idx == 0 ? 1 : lcs_block_seek_req(reader, req_idx - 1);
+      }
       if (reader->mmap_offset >= reader->trace_start_offset + reader->item_size) {
         reader->mmap_offset -= (reader->item_size);
         return 0;
@@ -430,6 +600,20 @@ int read_one_req_above(reader_t *const reader, request_t *req) {
   }
 }
 
+/**
+ * the end of the data of a binary trace, which is the size of the decompressed
+ * trace for zstd traces, SIZE_MAX if the zstd trace has no frame index
+ */
+static size_t _binary_data_end(reader_t *const reader) {
+#ifdef SUPPORT_ZSTD_TRACE
+  if (reader->is_zstd_file) {
+    int64_t content_size = zstd_reader_content_size(reader->zstd_reader_p);
+    return content_size >= 0 ? (size_t)content_size : SIZE_MAX;
+  }
+#endif
+  return reader->file_size;
+}
+
 /**
  * skip the next following N elements in the trace,
  * @param reader
@@ -448,12 +632,20 @@ int skip_n_req(reader_t *reader, const int N) {
         return i;
       }
     }
+  } else if (lcs_is_block_trace(reader)) {
+    int64_t req_idx = lcs_block_tell_req(reader);
+    count = (int)MIN((int64_t)N, (int64_t)reader->n_total_req - req_idx);
+    lcs_block_seek_req(reader, req_idx + count);
+    if (count < N) {
+      WARN("try to skip %d requests, but only %d requests left\n", N, count);
+    }
   } else if (reader->trace_format == BINARY_TRACE_FORMAT) {
-    if (reader->mmap_offset + N * reader->item_size <= reader->file_size) {
+    size_t data_end = _binary_data_end(reader);
+    if (reader->mmap_offset + N * reader->item_size <= data_end) {
       reader->mmap_offset = reader->mmap_offset + N * reader->item_size;
     } else {
-      count = (reader->file_size - reader->mmap_offset) / reader->item_size;
-      reader->mmap_offset = reader->file_size;
+      count = (data_end - reader->mmap_offset) / reader->item_size;
+      reader->mmap_offset = data_end;
       WARN("try to skip %d requests, but only %d requests left\n", N, count);
     }
   } else {
@@ -474,9 +666,6 @@ void reset_reader(reader_t *const reader) {
 #ifdef SUPPORT_ZSTD_TRACE
   if (reader->is_zstd_file) {
     reset_zstd_reader(reader->zstd_reader_p);
-    if (reader->trace_start_offset > 0) {
-      read_bytes(reader, reader->trace_start_offset);
-    }
   }
 #endif
 
@@ -489,6 +678,9 @@ void reset_reader(reader_t *const reader) {
   } else {
     reader->mmap_offset = reader->trace_start_offset;
     curr_offset = reader->mmap_offset;
+    if (lcs_is_block_trace(reader)) {
+      lcs_block_seek_req(reader, 0);
+    }
   }
 
   DEBUG("reset reader current offset %ld\n", curr_offset);
@@ -499,6 +691,23 @@ uint64_t get_num_of_req(reader_t *const reader) {
 
   uint64_t n_req = 0;
 
+  if (reader->is_zstd_file && reader->trace_format == BINARY_TRACE_FORMAT &&
+      _binary_data_end(reader) != SIZE_MAX) {
+    /* the size of the trace is known from the frame index */
+    reader->n_total_req =
+        (_binary_data_end(reader) - reader->trace_start_offset) /
+        reader->item_size;
+    return reader->n_total_req;
+  }
+
+  /* the number of requests in the trace metadata sidecar, which is written
+   * by the first reader that counts the requests */
+  const trace_meta_t *meta = get_trace_meta(reader);
+  if (meta != NULL) {
+    reader->n_total_req = meta->n_req;
+    return reader->n_total_req;
+  }
+
   if (reader->trace_format == TXT_TRACE_FORMAT || reader->is_zstd_file) {
     reader_t *reader_copy = clone_reader(reader);
     reader_copy->mmap_offset = 0;
@@ -506,6 +715,8 @@ uint64_t get_num_of_req(reader_t *const reader) {
     while (read_one_req(reader_copy, req) == 0) {
       n_req++;
     }
+    free_request(req);
+    close_reader(reader_copy);
   } else {
     ERROR("should not reach here\n");
     abort();
@@ -572,6 +783,8 @@ int close_reader(reader_t *const reader) {
     free(reader->reader_params);
   }
 
+  free_trace_meta(reader->meta);
+
   if (reader->sampler != NULL) {
     free(reader->sampler);
   }
@@ -607,27 +820,180 @@ void reader_set_read_pos(reader_t *const reader, double pos) {
         _v = fread(&c, 1, 1, reader->file);
       }
     }
+  } else if (lcs_is_block_trace(reader)) {
+    lcs_block_seek_req(reader, (int64_t)((double)reader->n_total_req * pos));
   } else {
+    size_t data_end = _binary_data_end(reader);
+    if (data_end == SIZE_MAX) {
+      ERROR(
+          "cannot set the read position of %s, the zstd trace has no frame "
+          "index, use traceConv --zstd to compress it in the seekable "
+          "format\n",
+          reader->trace_path);
+    }
+    /* align to the start of a request, the trace may have a header */
+    offset = (double)(data_end - reader->trace_start_offset) * pos;
+    reader->mmap_offset = reader->trace_start_offset + offset - offset % reader->item_size;
+  }
+}
+
+/**
+ * jump to the request at the given index (0-based), the next read returns the
+ * request, this is cheap for uncompressed and seekable zstd binary traces, and
+ * reads the trace from the start for text traces
+ *
+ * @return 0 on success, 1 if the index is beyond the end of the trace
+ */
+int reader_seek_req(reader_t *const reader, int64_t req_idx) {
+  if (lcs_is_block_trace(reader)) {
+    if (lcs_block_seek_req(reader, req_idx) != 0) {
+      return 1;
+    }
+  } else if (reader->trace_format == BINARY_TRACE_FORMAT) {
+    size_t offset = reader->trace_start_offset + req_idx * reader->item_size;
+    if (req_idx < 0 || offset > _binary_data_end(reader)) {
+      return 1;
+    }
     reader->mmap_offset = offset;
-    reader->mmap_offset -= reader->mmap_offset % reader->item_size;
+  } else {
+    reset_reader(reader);
+    for (int64_t n_left = req_idx; n_left > 0;) {
+      int n_skip = (int)MIN(n_left, INT32_MAX);
+      if (skip_n_req(reader, n_skip) != n_skip) {
+        return 1;
+      }
+      n_left -= n_skip;
+    }
+  }
+  reader->n_read_req = req_idx;
+  reader->n_req_left = 0;
+  return 0;
+}
+
+/* the clock time of the request at req_idx regardless of the sampler,
+ * INT64_MAX if the index is beyond the end of the trace */
+static int64_t _req_clock_time(reader_t *const reader, int64_t req_idx, request_t *req) {
+  if (reader_seek_req(reader, req_idx) != 0) {
+    return INT64_MAX;
   }
+  sampler_t *sampler = reader->sampler;
+  reader->sampler = NULL;
+  int status = read_one_req(reader, req);
+  reader->sampler = sampler;
+  return status == 0 ? req->clock_time : INT64_MAX;
+}
+
+/* read forward to the first request at or after clock_time, and move the
+ * reader back to the start of the request */
+static int _scan_to_time(reader_t *const reader, int64_t clock_time, request_t *req) {
+  while (true) {
+    int64_t n_read_req = reader->n_read_req;
+    int64_t pos = reader->trace_format == TXT_TRACE_FORMAT ? ftell(reader->file) : (int64_t)reader->mmap_offset;
+    if (read_one_req(reader, req) != 0) {
+      return 1;
+    }
+    /* the requests repeated by a count field have the time of the first one,
+     * so the request found always starts a line */
+    if (req->clock_time >= clock_time) {
+      if (reader->trace_format == TXT_TRACE_FORMAT) {
+        fseek(reader->file, pos, SEEK_SET);
+      } else {
+        reader->mmap_offset = pos;
+      }
+      reader->n_read_req = n_read_req;
+      reader->n_req_left = 0;
+      return 0;
+    }
+  }
+}
+
+int reader_seek_time(reader_t *const reader, int64_t clock_time) {
+  if (lcs_is_block_trace(reader)) {
+    int status = lcs_block_seek_time(reader, clock_time);
+    reader->n_read_req = lcs_block_tell_req(reader);
+    reader->n_req_left = 0;
+    return status;
+  }
+
+  /* a probe of the binary search in a zstd trace may decompress a frame, so
+   * the time index is preferred */
+  const trace_meta_t *meta = NULL;
+  if (reader->trace_format == TXT_TRACE_FORMAT || reader->is_zstd_file) {
+    meta = get_trace_meta(reader);
+  }
+
+  request_t *req = new_request();
+  int status = 0;
+  if (meta == NULL && reader->trace_format == BINARY_TRACE_FORMAT && _binary_data_end(reader) != SIZE_MAX) {
+    /* the index of the first request at or after clock_time */
+    int64_t lo = 0, hi = (int64_t)((_binary_data_end(reader) - reader->trace_start_offset) / reader->item_size);
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      if (_req_clock_time(reader, mid, req) < clock_time) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    reader_seek_req(reader, lo);
+    /* skip the requests that the sampler does not keep */
+    status = _scan_to_time(reader, clock_time, req);
+  } else {
+    /* start from the last indexed request before clock_time */
+    int64_t i = -1;
+    if (meta != NULL) {
+      int64_t lo = 0, hi = meta->n_index;
+      while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (meta->index[mid].clock_time < clock_time) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      i = lo - 1;
+    }
+
+    if (i >= 0 && reader->trace_format == BINARY_TRACE_FORMAT) {
+      reader_seek_req(reader, meta->index[i].req_idx);
+    } else {
+      reset_reader(reader);
+      if (i >= 0) {
+        fseek(reader->file, meta->index[i].offset, SEEK_SET);
+        reader->n_read_req = meta->index[i].req_idx;
+        reader->n_req_left = 0;
+      }
+    }
+    status = _scan_to_time(reader, clock_time, req);
+  }
+
+  free_request(req);
+  return status;
 }
 
 void read_first_req(reader_t *reader, request_t *req) {
   uint64_t offset = reader->mmap_offset;
+  int64_t req_idx = lcs_is_block_trace(reader) ? lcs_block_tell_req(reader) : 0;
   reset_reader(reader);
   read_one_req(reader, req);
   reader->mmap_offset = offset;
+  if (lcs_is_block_trace(reader)) {
+    lcs_block_seek_req(reader, req_idx);
+  }
 }
 
 void read_last_req(reader_t *reader, request_t *req) {
   uint64_t offset = reader->mmap_offset;
+  int64_t req_idx = lcs_is_block_trace(reader) ? lcs_block_tell_req(reader) : 0;
   reset_reader(reader);
   reader_set_read_pos(reader, 1.0);
   go_back_one_req(reader);
   read_one_req(reader, req);
 
   reader->mmap_offset = offset;
+  if (lcs_is_block_trace(reader)) {
+    lcs_block_seek_req(reader, req_idx);
+  }
 }
 
 bool is_str_num(const char *str, size_t len) {
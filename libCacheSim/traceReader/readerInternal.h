@@ -15,6 +15,32 @@ extern "C" {
 /**************** common ****************/
 bool is_str_num(const char *str, size_t len);
 
+/**
+ * parse a decimal number that has no sign and no leading zero, which is the
+ * common case in traces, the caller falls back to strtoull/strtod for other
+ * formats, e.g., hex and octal numbers, because strtoull with base 0 parses a
+ * leading zero as octal
+ * @param str
+ * @param len
+ * @param max_len the max number of digits, 19 fits in uint64_t
+ * @param val
+ * @return whether str is such a number
+ */
+static inline bool parse_dec_num(const char *str, size_t len, size_t max_len, uint64_t *val) {
+  if (len == 0 || len > max_len || (str[0] == '0' && len > 1)) {
+    return false;
+  }
+
+  uint64_t v = 0;
+  for (size_t i = 0; i < len; i++) {
+    unsigned d = (unsigned char)str[i] - '0';
+    if (d > 9) return false;
+    v = v * 10 + d;
+  }
+  *val = v;
+  return true;
+}
+
 /**************** csv ****************/
 typedef struct {
   struct csv_parser *csv_parser;
@@ -35,11 +61,18 @@ typedef struct {
 
   bool has_header;
   unsigned char delimiter;
+  /* the last field used, the fields after it are not parsed */
+  int max_field_idx;
+  /* split lines without quotes using SIMD instead of libcsv */
+  bool fast_parse;
 
   int n_obj_id_is_num;
   int n_obj_id_is_not_num;
 
   void *request;
+  /* the request repeated by cnt_field, read_one_req only sets the time of the
+   * repeated requests, so a batch read copies the rest from here */
+  request_t repeated_req;
 } csv_params_t;
 
 void csv_setup_reader(reader_t *const reader);
@@ -119,6 +152,12 @@ int binaryReader_setup(reader_t *const reader);
 
 int binary_read_one_req(reader_t *reader, request_t *req);
 
+/* read at most n requests, return the number of requests read */
+int binary_read_n_reqs(reader_t *reader, request_t *reqs, int n);
+
+/**************** trace metadata ****************/
+void free_trace_meta(trace_meta_t *meta);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,11 +11,9 @@ extern "C" {
 #endif
 
 bool spatial_sample(sampler_t *sampler, request_t *req) {
-  uint64_t hash_value = req->hv;
-  if (hash_value == 0) {
-    hash_value = get_hash_value_int_64(&(req->obj_id));
-    req->hv = hash_value;
-  }
+  uint64_t hash_value = get_req_hash_value(req);
+  req->hv = hash_value;
+  req->hv_obj_id = req->obj_id;
 
   return hash_value % sampler->sampling_ratio_inv == 0;
 }
@@ -0,0 +1,272 @@
+//
+// the metadata of a trace (number of requests, working set size and a sparse
+// time index) cached in a sidecar file next to the trace
+//
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../dataStructure/wssSketch.h"
+#include "../include/libCacheSim/reader.h"
+#include "customizedReader/lcs.h"
+#include "readerInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_META_MAGIC 0x4d45544154524352
+#define TRACE_META_VERSION 2
+
+/* the header of the sidecar file, followed by n_index trace_time_index_t,
+ * the fields are 8 bytes so that the header has no padding */
+typedef struct trace_meta_header {
+  uint64_t magic;
+  int64_t version;
+
+  /* the trace and the reader parameters the metadata is computed with */
+  int64_t trace_size;
+  int64_t trace_mtime_ns;
+  uint64_t param_hash;
+
+  int64_t n_req;
+  int64_t n_obj;
+  int64_t wss_byte;
+  int64_t n_index;
+} trace_meta_header_t;
+typedef char static_assert_trace_meta_header_size[(sizeof(trace_meta_header_t) == 9 * 8) ? 1 : -1];
+
+static inline uint64_t _fnv1a(uint64_t hash, const void *data, size_t len) {
+  const unsigned char *p = data;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/* the hash of the trace type and the reader parameters that change the
+ * requests read from the trace */
+static uint64_t _param_hash(const reader_t *reader) {
+  const reader_init_param_t *p = &reader->init_params;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+#define HASH_FIELD(x) hash = _fnv1a(hash, &(x), sizeof(x))
+  HASH_FIELD(reader->trace_type);
+  HASH_FIELD(reader->ignore_obj_size);
+  HASH_FIELD(reader->ignore_size_zero_req);
+  HASH_FIELD(reader->obj_id_is_num);
+  HASH_FIELD(p->time_field);
+  HASH_FIELD(p->obj_id_field);
+  HASH_FIELD(p->obj_size_field);
+  HASH_FIELD(p->op_field);
+  HASH_FIELD(p->ttl_field);
+  HASH_FIELD(p->cnt_field);
+  HASH_FIELD(p->tenant_field);
+  HASH_FIELD(p->next_access_vtime_field);
+  HASH_FIELD(p->block_size);
+  HASH_FIELD(p->has_header);
+  HASH_FIELD(p->has_header_set);
+  HASH_FIELD(p->delimiter);
+  HASH_FIELD(p->trace_start_offset);
+#undef HASH_FIELD
+  if (p->binary_fmt_str != NULL) {
+    hash = _fnv1a(hash, p->binary_fmt_str, strlen(p->binary_fmt_str));
+  }
+  return hash;
+}
+
+static bool _trace_file_stat(const reader_t *reader, int64_t *size, int64_t *mtime_ns) {
+  struct stat st;
+  if (stat(reader->trace_path, &st) != 0) {
+    return false;
+  }
+  *size = st.st_size;
+  *mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  return true;
+}
+
+static void _sidecar_path(const reader_t *reader, char *path, size_t len) {
+  snprintf(path, len, "%s.meta", reader->trace_path);
+}
+
+static trace_meta_t *_load_trace_meta(const reader_t *reader, const trace_meta_header_t *expected) {
+  char path[PATH_MAX + 8];
+  _sidecar_path(reader, path, sizeof(path));
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+
+  trace_meta_header_t header;
+  trace_meta_t *meta = NULL;
+  if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == TRACE_META_MAGIC &&
+      header.version == TRACE_META_VERSION && header.trace_size == expected->trace_size &&
+      header.trace_mtime_ns == expected->trace_mtime_ns && header.param_hash == expected->param_hash &&
+      header.n_index >= 0) {
+    meta = malloc(sizeof(trace_meta_t));
+    meta->n_req = header.n_req;
+    meta->n_obj = header.n_obj;
+    meta->wss_byte = header.wss_byte;
+    meta->n_index = header.n_index;
+    meta->index = malloc(sizeof(trace_time_index_t) * (header.n_index + 1));
+    if (fread(meta->index, sizeof(trace_time_index_t), header.n_index, file) != (size_t)header.n_index) {
+      free(meta->index);
+      free(meta);
+      meta = NULL;
+    }
+  }
+  fclose(file);
+
+  if (meta == NULL) {
+    DEBUG("%s is stale or corrupted\n", path);
+  }
+  return meta;
+}
+
+/* the sidecar is written to a temporary file and renamed, so that the readers
+ * of the trace running at the same time never see a partial sidecar */
+static void _write_trace_meta(const reader_t *reader, const trace_meta_header_t *header, const trace_meta_t *meta) {
+  char path[PATH_MAX + 8], tmp_path[PATH_MAX + 32];
+  _sidecar_path(reader, path, sizeof(path));
+  snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid());
+  FILE *file = fopen(tmp_path, "wb");
+  if (file == NULL) {
+    WARN("cannot write trace metadata %s, %s\n", path, strerror(errno));
+    return;
+  }
+
+  bool ok = fwrite(header, sizeof(*header), 1, file) == 1 &&
+            fwrite(meta->index, sizeof(trace_time_index_t), meta->n_index, file) == (size_t)meta->n_index;
+  ok = (fclose(file) == 0) && ok;
+  if (!ok || rename(tmp_path, path) != 0) {
+    WARN("cannot write trace metadata %s, %s\n", path, strerror(errno));
+    remove(tmp_path);
+  }
+}
+
+/* the position of the next request in the trace */
+static int64_t _reader_pos(reader_t *reader) {
+  if (reader->trace_format == TXT_TRACE_FORMAT) {
+    return ftell(reader->file);
+  } else if (lcs_is_block_trace(reader)) {
+    return lcs_block_tell_req(reader);
+  }
+  return (int64_t)reader->mmap_offset;
+}
+
+/* read the trace once to count the requests, estimate the working set size
+ * and build the time index */
+static trace_meta_t *_compute_trace_meta(reader_t *reader) {
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  wss_sketch_t *sketch = create_wss_sketch();
+
+  trace_meta_t *meta = malloc(sizeof(trace_meta_t));
+  memset(meta, 0, sizeof(trace_meta_t));
+  int64_t index_capacity = 1024;
+  meta->index = malloc(sizeof(trace_time_index_t) * index_capacity);
+
+  INFO("%s: computing trace metadata...\n", reader->trace_path);
+  int64_t pos = 0;
+  while (true) {
+    /* a request repeated by a count field does not start at a position */
+    bool at_index = meta->n_req % TRACE_META_INDEX_INTERVAL == 0 && cloned_reader->n_req_left == 0;
+    if (at_index) {
+      pos = _reader_pos(cloned_reader);
+    }
+    if (read_one_req(cloned_reader, req) != 0) {
+      break;
+    }
+
+    if (at_index) {
+      if (meta->n_index == index_capacity) {
+        index_capacity *= 2;
+        meta->index = realloc(meta->index, sizeof(trace_time_index_t) * index_capacity);
+      }
+      meta->index[meta->n_index++] = (trace_time_index_t){req->clock_time, meta->n_req, pos};
+    }
+    meta->n_req += 1;
+    wss_sketch_add(sketch, req->obj_id, req->obj_size);
+  }
+  wss_sketch_estimate(sketch, &meta->n_obj, &meta->wss_byte);
+
+  free_wss_sketch(sketch);
+  free_request(req);
+  close_reader(cloned_reader);
+  return meta;
+}
+
+/* the stat in the header of lcs traces has the number of requests and the
+ * working set size, old traces do not have the stat */
+static trace_meta_t *_lcs_trace_meta(reader_t *reader) {
+  lcs_trace_stat_t stat;
+  lcs_read_trace_stat(reader, &stat);
+  if (stat.n_req <= 0 || stat.n_obj <= 0 || stat.n_obj_byte <= 0) {
+    return NULL;
+  }
+
+  trace_meta_t *meta = malloc(sizeof(trace_meta_t));
+  meta->n_req = stat.n_req;
+  meta->n_obj = stat.n_obj;
+  meta->wss_byte = reader->ignore_obj_size ? stat.n_obj : stat.n_obj_byte;
+  meta->n_index = 0;
+  meta->index = NULL;
+  return meta;
+}
+
+const trace_meta_t *get_trace_meta(reader_t *reader) {
+  if (reader->meta != NULL) {
+    return reader->meta;
+  }
+
+  if (reader->sampler != NULL || reader->init_params.sampler != NULL || reader->cap_at_n_req > 1) {
+    return NULL;
+  }
+
+  if (reader->trace_type == LCS_TRACE) {
+    reader->meta = _lcs_trace_meta(reader);
+    if (reader->meta != NULL) {
+      return reader->meta;
+    }
+  }
+
+  trace_meta_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = TRACE_META_MAGIC;
+  header.version = TRACE_META_VERSION;
+  header.param_hash = _param_hash(reader);
+  if (!_trace_file_stat(reader, &header.trace_size, &header.trace_mtime_ns)) {
+    return NULL;
+  }
+
+  reader->meta = _load_trace_meta(reader, &header);
+  if (reader->meta != NULL) {
+    DEBUG("%s: load trace metadata from the sidecar\n", reader->trace_path);
+    return reader->meta;
+  }
+
+  reader->meta = _compute_trace_meta(reader);
+  header.n_req = reader->meta->n_req;
+  header.n_obj = reader->meta->n_obj;
+  header.wss_byte = reader->meta->wss_byte;
+  header.n_index = reader->meta->n_index;
+  _write_trace_meta(reader, &header, reader->meta);
+
+  return reader->meta;
+}
+
+void free_trace_meta(trace_meta_t *meta) {
+  if (meta == NULL) return;
+  free(meta->index);
+  free(meta);
+}
+
+#ifdef __cplusplus
+}
+#endif
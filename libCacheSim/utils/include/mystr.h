@@ -4,6 +4,11 @@
 //
 
 #include <inttypes.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /**
  * convert size to an appropriate string with unit, for example 1048576 will be
@@ -25,4 +30,18 @@ uint64_t str_to_u64(const char *start, size_t len);
 /* replace all matching char in a string */
 char *replace_char(char *str, char find, char replace);
 
-const char *mybasename(const char *path);
\ No newline at end of file
+const char *mybasename(const char *path);
+
+/**
+ * @brief convert a size string to byte, e.g., 100MB -> 100 * 1024 * 1024
+ * the size can be an integer or an integer with suffix K/M/G/T, the suffix is
+ * case insensitive and the characters after it are ignored (KB, KiB)
+ *
+ * @param size_str
+ * @return int64_t
+ */
+int64_t conv_size_str_to_byte(const char *size_str);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
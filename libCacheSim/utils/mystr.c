@@ -64,6 +64,36 @@ const char *mybasename(char const *path) {
     return s + 1;
 }
 
+/**
+ * @brief convert a size string to byte, e.g., 100MB -> 100 * 1024 * 1024
+ * the size can be an integer or an integer with suffix K/M/G/T, the suffix is
+ * case insensitive and the characters after it are ignored (KB, KiB)
+ *
+ * @param size_str
+ * @return int64_t
+ */
+int64_t conv_size_str_to_byte(const char *size_str) {
+  char *end;
+  int64_t size = strtoll(size_str, &end, 10);
+  while (*end == ' ') end++;
+  switch (*end) {
+    case 'k':
+    case 'K':
+      return size * KiB;
+    case 'm':
+    case 'M':
+      return size * MiB;
+    case 'g':
+    case 'G':
+      return size * GiB;
+    case 't':
+    case 'T':
+      return size * TiB;
+    default:
+      return size;
+  }
+}
+
 #ifdef __cplusplus
 }
 #endif
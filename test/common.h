@@ -80,6 +80,46 @@ static reader_t *setup_oracleGeneralBin_reader(void) {
   return reader_oracle;
 }
 
+/* the oracleGeneral trace in zstd frames of 256 KiB that do not record their
+ * sizes, so it is decompressed as a stream */
+static reader_t *setup_oracleGeneralZstd_reader(void) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.oracleGeneral.bin.zst");
+  reader_t *reader_oracle = setup_reader(data_path, ORACLE_GENERAL_TRACE, NULL);
+  return reader_oracle;
+}
+
+/* the oracleGeneral trace written by traceConv --zstd --zstd-frame-size=512KB,
+ * which has six frames and a seek table */
+static reader_t *setup_oracleGeneralSeekableZstd_reader(void) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.oracleGeneral.seekable.zst");
+  reader_t *reader_oracle = setup_reader(data_path, ORACLE_GENERAL_TRACE, NULL);
+  return reader_oracle;
+}
+
+/* the first 10000 requests of the trace in the lcs v1 and v2 formats */
+static reader_t *setup_lcs_v1_reader(void) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.10k.lcs_v1");
+  reader_t *reader_lcs = setup_reader(data_path, LCS_TRACE, NULL);
+  return reader_lcs;
+}
+
+static reader_t *setup_lcs_v2_reader(void) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.10k.lcs_v2");
+  reader_t *reader_lcs = setup_reader(data_path, LCS_TRACE, NULL);
+  return reader_lcs;
+}
+
+static reader_t *setup_lcs_v9_reader(void) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.lcs_v9");
+  reader_t *reader_lcs = setup_reader(data_path, LCS_TRACE, NULL);
+  return reader_lcs;
+}
+
 static reader_t *setup_GLCacheTestData_reader(void) {
   char *url =
       "https://ftp.pdl.cmu.edu/pub/datasets/twemcacheWorkload/"
@@ -158,6 +198,25 @@ static reader_t *setup_csv_reader_obj_num(void) {
   return reader_csv_l;
 }
 
+/* a small csv with quoted fields, CRLF line ends and non-decimal ids */
+static reader_t *setup_quoted_csv_reader(bool obj_id_is_num) {
+  char data_path[1024];
+  _detect_data_path(data_path, "quoted.csv");
+  reader_init_param_t *init_params_csv = g_new0(reader_init_param_t, 1);
+  init_params_csv->delimiter = ',';
+  init_params_csv->time_field = 1;
+  init_params_csv->obj_id_field = 2;
+  init_params_csv->obj_size_field = 3;
+  init_params_csv->op_field = 4;
+  init_params_csv->has_header = true;
+  init_params_csv->has_header_set = true;
+  init_params_csv->obj_id_is_num = obj_id_is_num;
+  init_params_csv->obj_id_is_num_set = true;
+  reader_t *reader = setup_reader(data_path, CSV_TRACE, init_params_csv);
+  g_free(init_params_csv);
+  return reader;
+}
+
 static reader_t *setup_plaintxt_reader_num(void) {
   char data_path[1024];
   _detect_data_path(data_path, "cloudPhysicsIO.txt");
@@ -188,6 +247,7 @@ static cache_t *create_test_cache(const char *alg_name, common_cache_params_t cc
     cache = FIFO_init(cc_params, NULL);
   } else if (strcasecmp(alg_name, "FIFO-Reinsertion") == 0 || strcasecmp(alg_name, "Clock") == 0) {
     cache = Clock_init(cc_params, NULL);
+#ifndef COMPACT_CACHE_OBJ
   } else if (strcasecmp(alg_name, "Belady") == 0) {
     cache = Belady_init(cc_params, NULL);
   } else if (strcasecmp(alg_name, "BeladySize") == 0) {
@@ -250,6 +310,7 @@ static cache_t *create_test_cache(const char *alg_name, common_cache_params_t cc
     cache = QDLP_init(cc_params, "fifo-size-ratio=0.10,main-cache=Clock2");
   } else if (strcasecmp(alg_name, "S3-FIFOv0") == 0) {
     cache = S3FIFOv0_init(cc_params, "move-to-main-threshold=2");
+#endif
   } else if (strcasecmp(alg_name, "S3-FIFO") == 0) {
     cache = S3FIFO_init(cc_params, "move-to-main-threshold=2");
   } else if (strcasecmp(alg_name, "Sieve") == 0) {
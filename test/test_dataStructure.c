@@ -2,7 +2,15 @@
 // Created by Juncheng Yang on 11/24/24.
 //
 
+#include <math.h>
+
+#include "../libCacheSim/dataStructure/hashtable/bulkChainingHashTable.h"
 #include "../libCacheSim/dataStructure/hashtable/chainedHashTableV2.h"
+#include "../libCacheSim/dataStructure/hashtable/cuckooHashTable.h"
+#include "../libCacheSim/dataStructure/hash/hash.h"
+#include "../libCacheSim/dataStructure/objPool.h"
+#include "../libCacheSim/dataStructure/objSampler.h"
+#include "../libCacheSim/dataStructure/wssSketch.h"
 #include "../libCacheSim/dataStructure/hashtable/hashtable.h"
 #include "common.h"
 
@@ -29,12 +37,479 @@ void test_chained_hashtable_v2(gconstpointer user_data) {
   // printf("random object %lu\n", obj->obj_id);
 }
 
+static void _count_obj(cache_obj_t *cache_obj, void *user_data) {
+  *(uint64_t *)user_data += 1;
+}
+
+void test_chained_hashtable_v2_incremental_expand(gconstpointer user_data) {
+  const int n_obj = 200000;
+  set_rand_seed(rand());
+  hashtable_t *hashtable = create_chained_hashtable_v2(2);
+  hashtable->incremental_expand = true;
+  request_t *req = new_request();
+  int n_insert_during_expansion = 0;
+  for (int i = 0; i < n_obj; i++) {
+    req->obj_id = i;
+    chained_hashtable_insert_v2(hashtable, req);
+    if (hashtable->old_ptr_table != NULL) {
+      n_insert_during_expansion += 1;
+      /* all objects can be found while the buckets are being migrated */
+      g_assert_nonnull(chained_hashtable_find_obj_id_v2(hashtable, i / 2));
+    }
+  }
+  g_assert_cmpint(n_insert_during_expansion, >, 0);
+  g_assert_cmpuint(hashtable->n_obj, ==, n_obj);
+  check_hashtable_integrity_v2(hashtable);
+
+  /* start another expansion and stop in the middle */
+  while (hashtable->old_ptr_table == NULL) {
+    req->obj_id = n_obj + hashtable->n_obj;
+    chained_hashtable_insert_v2(hashtable, req);
+  }
+  check_hashtable_integrity_v2(hashtable);
+
+  /* deletes do not migrate buckets */
+  for (int i = 0; i < n_obj; i += 2) {
+    g_assert_true(chained_hashtable_delete_obj_id_v2(hashtable, i));
+  }
+  g_assert_nonnull(hashtable->old_ptr_table);
+  check_hashtable_integrity_v2(hashtable);
+  for (int i = 0; i < n_obj; i++) {
+    cache_obj_t *obj = chained_hashtable_find_obj_id_v2(hashtable, i);
+    if (i % 2 == 0) {
+      g_assert_null(obj);
+    } else {
+      g_assert_nonnull(obj);
+    }
+  }
+
+  uint64_t n_iter = 0;
+  chained_hashtable_foreach_v2(hashtable, _count_obj, &n_iter);
+  g_assert_cmpuint(n_iter, ==, hashtable->n_obj);
+
+  for (int i = 0; i < 1000; i++) {
+    cache_obj_t *obj = chained_hashtable_rand_obj_v2(hashtable);
+    g_assert_true(obj->obj_id >= n_obj || obj->obj_id % 2 == 1);
+  }
+
+  free_request(req);
+  free_chained_hashtable_v2(hashtable);
+}
+
+/* the operations of a hash table that test_hashtable_ops tests */
+typedef struct {
+  hashtable_t *(*create)(const uint16_t hashpower_init);
+  cache_obj_t *(*insert)(hashtable_t *hashtable, const request_t *req);
+  cache_obj_t *(*find_obj_id)(const hashtable_t *hashtable, const obj_id_t obj_id);
+  bool (*delete_obj_id)(hashtable_t *hashtable, const obj_id_t obj_id);
+  cache_obj_t *(*rand_obj)(hashtable_t *hashtable);
+  void (*foreach)(hashtable_t *hashtable, hashtable_iter iter_func, void *user_data);
+  void (*check_integrity)(const hashtable_t *hashtable);
+  void (*free)(hashtable_t *hashtable);
+  /* optional, the number of overflow buckets after the inserts */
+  uint64_t (*n_overflow_bucket)(const hashtable_t *hashtable);
+} hashtable_ops_t;
+
+#ifndef COMPACT_CACHE_OBJ
+static const hashtable_ops_t cuckoo_hashtable_ops = {
+    .create = create_cuckoo_hashtable,
+    .insert = cuckoo_hashtable_insert,
+    .find_obj_id = cuckoo_hashtable_find_obj_id,
+    .delete_obj_id = cuckoo_hashtable_delete_obj_id,
+    .rand_obj = cuckoo_hashtable_rand_obj,
+    .foreach = cuckoo_hashtable_foreach,
+    .check_integrity = check_cuckoo_hashtable_integrity,
+    .free = free_cuckoo_hashtable,
+    .n_overflow_bucket = NULL,
+};
+
+static const hashtable_ops_t bulk_chaining_hashtable_ops = {
+    .create = create_bulk_chaining_hashtable,
+    .insert = bulk_chaining_hashtable_insert,
+    .find_obj_id = bulk_chaining_hashtable_find_obj_id,
+    .delete_obj_id = bulk_chaining_hashtable_delete_obj_id,
+    .rand_obj = bulk_chaining_hashtable_rand_obj,
+    .foreach = bulk_chaining_hashtable_foreach,
+    .check_integrity = check_bulk_chaining_hashtable_integrity,
+    .free = free_bulk_chaining_hashtable,
+    .n_overflow_bucket = bulk_chaining_hashtable_n_overflow_bucket,
+};
+#endif
+
+void test_hashtable_ops(gconstpointer user_data) {
+  const hashtable_ops_t *ops = user_data;
+  const int n_obj = 200000;
+  set_rand_seed(rand());
+  /* start from a small table to test expansion */
+  hashtable_t *hashtable = ops->create(2);
+  request_t *req = new_request();
+  for (int i = 0; i < n_obj; i++) {
+    req->obj_id = i;
+    cache_obj_t *obj = ops->insert(hashtable, req);
+    g_assert_true(obj->obj_id == (obj_id_t)i);
+  }
+  g_assert_cmpuint(hashtable->n_obj, ==, n_obj);
+  ops->check_integrity(hashtable);
+  if (ops->n_overflow_bucket != NULL) {
+    /* a few buckets overflow at the expansion load */
+    g_assert_cmpuint(ops->n_overflow_bucket(hashtable), >, 0);
+  }
+
+  for (int i = 0; i < n_obj; i++) {
+    cache_obj_t *obj = ops->find_obj_id(hashtable, i);
+    g_assert_nonnull(obj);
+    g_assert_true(obj->obj_id == (obj_id_t)i);
+  }
+  g_assert_null(ops->find_obj_id(hashtable, n_obj));
+
+  for (int i = 0; i < n_obj; i += 2) {
+    g_assert_true(ops->delete_obj_id(hashtable, i));
+  }
+  g_assert_false(ops->delete_obj_id(hashtable, 0));
+  g_assert_cmpuint(hashtable->n_obj, ==, n_obj / 2);
+  for (int i = 0; i < n_obj; i++) {
+    cache_obj_t *obj = ops->find_obj_id(hashtable, i);
+    if (i % 2 == 0) {
+      g_assert_null(obj);
+    } else {
+      g_assert_nonnull(obj);
+    }
+  }
+
+  /* deleted slots are reused */
+  for (int i = 0; i < n_obj; i += 2) {
+    req->obj_id = i;
+    ops->insert(hashtable, req);
+  }
+  for (int i = 0; i < n_obj; i += 2) {
+    g_assert_nonnull(ops->find_obj_id(hashtable, i));
+    g_assert_true(ops->delete_obj_id(hashtable, i));
+  }
+
+  uint64_t n_iter = 0;
+  ops->foreach(hashtable, _count_obj, &n_iter);
+  g_assert_cmpuint(n_iter, ==, n_obj / 2);
+
+  for (int i = 0; i < 1000; i++) {
+    cache_obj_t *obj = ops->rand_obj(hashtable);
+    g_assert_true(obj->obj_id % 2 == 1);
+  }
+
+  /* every object can be sampled from a mostly empty table */
+  for (int i = 1; i < n_obj - 16; i += 2) {
+    ops->delete_obj_id(hashtable, i);
+  }
+  bool seen_bit[16] = {false};
+  for (int i = 0; i < 320; i++) {
+    cache_obj_t *obj = ops->rand_obj(hashtable);
+    g_assert_cmpuint(obj->obj_id, >=, n_obj - 16);
+    seen_bit[obj->obj_id - (n_obj - 16)] = true;
+  }
+  for (int i = 1; i < 16; i += 2) g_assert_true(seen_bit[i]);
+  ops->check_integrity(hashtable);
+
+  free_request(req);
+  ops->free(hashtable);
+}
+
+/* the hash value computed by the reader is reused only for the same obj_id */
+void test_req_hash_value(gconstpointer user_data) {
+  hashtable_t *hashtable = create_chained_hashtable_v2(4);
+  request_t *req = new_request();
+  for (int i = 1; i <= 100; i++) {
+    req->obj_id = i;
+    cache_obj_t *obj = chained_hashtable_insert_v2(hashtable, req);
+    g_assert_true(obj->hv == (obj_hv_t)get_hash_value_int_64(&req->obj_id));
+  }
+
+  req->obj_id = 5;
+  req->hv = get_hash_value_int_64(&req->obj_id);
+  req->hv_obj_id = req->obj_id;
+  g_assert_true(get_req_hash_value(req) == req->hv);
+  g_assert_true(chained_hashtable_find_v2(hashtable, req)->obj_id == 5);
+
+  /* a copied request whose obj_id is changed */
+  req->obj_id = 6;
+  g_assert_true(get_req_hash_value(req) == get_hash_value_int_64(&req->obj_id));
+  g_assert_true(chained_hashtable_find_v2(hashtable, req)->obj_id == 6);
+
+  check_hashtable_integrity_v2(hashtable);
+  free_request(req);
+  free_chained_hashtable_v2(hashtable);
+}
+
+void test_chained_hashtable_v2_dense_obj_id(gconstpointer user_data) {
+  const int n_obj = 1000;
+  hashtable_t *hashtable = create_chained_hashtable_v2(4);
+  g_assert_true(chained_hashtable_use_dense_obj_id_v2(hashtable, n_obj));
+  g_assert_cmpuint(hashsize(hashtable->hashpower), >=, n_obj);
+
+  request_t *req = new_request();
+  for (int i = 0; i < n_obj; i++) {
+    req->obj_id = i;
+    req->obj_size = 1;
+    chained_hashtable_insert_v2(hashtable, req);
+  }
+  /* each object is in the bucket indexed by its id */
+  for (int i = 0; i < n_obj; i++) {
+    g_assert_nonnull(hashtable->ptr_table[i]);
+    g_assert_cmpuint(hashtable->ptr_table[i]->obj_id, ==, i);
+    g_assert_null(obj_hash_next(hashtable->ptr_table[i]));
+    req->obj_id = i;
+    g_assert_true(chained_hashtable_find_v2(hashtable, req) == hashtable->ptr_table[i]);
+  }
+  /* an id out of the range shares a bucket */
+  req->obj_id = hashsize(hashtable->hashpower) + 1;
+  chained_hashtable_insert_v2(hashtable, req);
+  g_assert_nonnull(chained_hashtable_find_obj_id_v2(hashtable, req->obj_id));
+  g_assert_true(chained_hashtable_delete_obj_id_v2(hashtable, req->obj_id));
+  g_assert_nonnull(chained_hashtable_find_obj_id_v2(hashtable, 1));
+  check_hashtable_integrity_v2(hashtable);
+
+  for (int i = 0; i < n_obj; i += 2) {
+    chained_hashtable_delete_v2(hashtable, chained_hashtable_find_obj_id_v2(hashtable, i));
+  }
+  g_assert_cmpuint(hashtable->n_obj, ==, n_obj / 2);
+  for (int i = 0; i < 100; i++) {
+    g_assert_cmpuint(chained_hashtable_rand_obj_v2(hashtable)->obj_id % 2, ==, 1);
+  }
+
+  /* the table must be empty */
+  g_assert_false(chained_hashtable_use_dense_obj_id_v2(hashtable, n_obj));
+  free_request(req);
+  free_chained_hashtable_v2(hashtable);
+}
+
+void test_obj_pool(gconstpointer user_data) {
+  const int n_obj = 100000;
+  obj_pool_t *pool = create_obj_pool();
+  cache_obj_t **objs = g_new(cache_obj_t *, n_obj);
+  for (int i = 0; i < n_obj; i++) {
+    objs[i] = obj_pool_alloc(pool);
+    objs[i]->obj_id = i;
+  }
+  g_assert_cmpint(pool->n_obj, ==, n_obj);
+#ifndef COMPACT_CACHE_OBJ
+  g_assert_cmpint(pool->n_slab, >, 1);
+#endif
+  for (int i = 0; i < n_obj; i++) {
+    g_assert_cmpuint(objs[i]->obj_id, ==, i);
+  }
+
+  /* freed objects are reused before carving new objects */
+  int64_t n_slab = pool->n_slab;
+  for (int i = 0; i < n_obj; i += 2) obj_pool_free(pool, objs[i]);
+  g_assert_cmpint(pool->n_obj, ==, n_obj / 2);
+  for (int i = 0; i < n_obj; i += 2) {
+    cache_obj_t *obj = obj_pool_alloc(pool);
+    g_assert_true(obj == objs[n_obj - 2 - i]);
+  }
+  g_assert_cmpint(pool->n_slab, ==, n_slab);
+  g_assert_cmpint(pool->n_obj, ==, n_obj);
+
+  g_free(objs);
+  free_obj_pool(pool);
+
+  /* objects without the metadata union */
+  pool = create_obj_pool();
+#ifndef COMPACT_CACHE_OBJ
+  g_assert_false(obj_pool_set_obj_size(pool, CACHE_OBJ_MD_OFFSET - 1));
+  g_assert_true(obj_pool_set_obj_size(pool, CACHE_OBJ_SIZE_WITH_MD(0)));
+  cache_obj_t *obj1 = obj_pool_alloc(pool);
+  cache_obj_t *obj2 = obj_pool_alloc(pool);
+  g_assert_cmpint((char *)obj2 - (char *)obj1, ==, CACHE_OBJ_MD_OFFSET);
+  g_assert_false(obj_pool_set_obj_size(pool, sizeof(cache_obj_t)));
+#else
+  /* the links are in number of cache_obj_t */
+  g_assert_false(obj_pool_set_obj_size(pool, CACHE_OBJ_SIZE_WITH_MD(0)));
+#endif
+  free_obj_pool(pool);
+}
+
+/* the links between objects are pointers, or 32-bit offsets relative to the
+ * object with COMPACT_CACHE_OBJ */
+void test_obj_link(gconstpointer user_data) {
+  const int n_obj = 1000;
+  obj_pool_t *pool = create_obj_pool();
+  cache_obj_t **objs = g_new(cache_obj_t *, n_obj);
+  for (int i = 0; i < n_obj; i++) {
+    objs[i] = obj_pool_alloc(pool);
+    memset(objs[i], 0, sizeof(cache_obj_t));
+  }
+  /* the links point both forward and backward in the pool */
+  for (int i = 0; i < n_obj; i++) {
+    set_obj_queue_next(objs[i], i == 0 ? NULL : objs[i - 1]);
+    set_obj_queue_prev(objs[i], i == n_obj - 1 ? NULL : objs[i + 1]);
+    set_obj_hash_next(objs[i], objs[n_obj - 1 - i]);
+  }
+  for (int i = 0; i < n_obj; i++) {
+    g_assert_true(obj_queue_next(objs[i]) == (i == 0 ? NULL : objs[i - 1]));
+    g_assert_true(obj_queue_prev(objs[i]) == (i == n_obj - 1 ? NULL : objs[i + 1]));
+    g_assert_true(obj_hash_next(objs[i]) == objs[n_obj - 1 - i]);
+  }
+  set_obj_hash_next(objs[0], NULL);
+  g_assert_null(obj_hash_next(objs[0]));
+
+  request_t *req = new_request();
+  req->obj_id = 42;
+  req->obj_size = UINT32_MAX;
+  copy_request_to_cache_obj(objs[0], req);
+  g_assert_cmpuint(objs[0]->obj_size, ==, UINT32_MAX);
+#ifdef COMPACT_CACHE_OBJ
+  g_assert_cmpuint(sizeof(obj_link_t), ==, 4);
+  g_assert_cmpuint(sizeof(obj_hv_t), ==, 4);
+  g_assert_cmpuint(sizeof(obj_size_t), ==, 4);
+  /* offsets are in number of objects, 0 is NULL */
+  g_assert_cmpint(objs[1]->queue.next, ==, objs[0] - objs[1]);
+  g_assert_cmpint(objs[0]->queue.next, ==, 0);
+  g_assert_cmpint(objs[0]->hash_next, ==, 0);
+  /* the hash value is truncated, the hash table only uses the low bits */
+  g_assert_cmpuint(objs[0]->hv, ==, (uint32_t)get_req_hash_value(req));
+#else
+  g_assert_true(objs[1]->queue.next == objs[0]);
+  g_assert_cmpuint(objs[0]->hv, ==, get_req_hash_value(req));
+#endif
+
+  free_request(req);
+  g_free(objs);
+  free_obj_pool(pool);
+}
+
+#ifndef COMPACT_CACHE_OBJ
+void test_obj_sampler(gconstpointer user_data) {
+  const int n_obj = 1000;
+  set_rand_seed(rand());
+  obj_sampler_t *sampler = create_obj_sampler(offsetof(cache_obj_t, Random.sample_pos));
+  cache_obj_t *objs = g_new0(cache_obj_t, n_obj);
+  for (int i = 0; i < n_obj; i++) {
+    objs[i].obj_id = i;
+    obj_sampler_add(sampler, &objs[i]);
+  }
+  g_assert_cmpint(sampler->n_obj, ==, n_obj);
+
+  /* the last object fills the hole left by a removed object */
+  for (int i = 0; i < n_obj; i += 2) obj_sampler_remove(sampler, &objs[i]);
+  g_assert_cmpint(sampler->n_obj, ==, n_obj / 2);
+  for (int i = 0; i < sampler->n_obj; i++) {
+    g_assert_cmpint(sampler->objs[i]->obj_id % 2, ==, 1);
+    g_assert_cmpint(obj_sampler_get_pos(sampler, sampler->objs[i]), ==, i);
+  }
+
+  /* every remaining object is sampled */
+  bool seen[n_obj];
+  memset(seen, 0, sizeof(seen));
+  for (int i = 0; i < n_obj * 20; i++) {
+    cache_obj_t *obj = obj_sampler_rand_obj(sampler);
+    g_assert_cmpint(obj->obj_id % 2, ==, 1);
+    seen[obj->obj_id] = true;
+  }
+  for (int i = 1; i < n_obj; i += 2) g_assert_true(seen[i]);
+
+  for (int i = 1; i < n_obj; i += 2) obj_sampler_remove(sampler, &objs[i]);
+  g_assert_null(obj_sampler_rand_obj(sampler));
+
+  g_free(objs);
+  free_obj_sampler(sampler);
+}
+
+#if HASHTABLE_TYPE == CHAINED_HASHTABLEV2
+/* a small cache with dense object ids has mostly empty buckets, so it is
+ * sampled through the obj_sampler */
+void test_dense_obj_id_rand_obj(gconstpointer user_data) {
+  const int n_obj = 16;
+  set_rand_seed(rand());
+  common_cache_params_t cc_params = {.cache_size = n_obj, .hashpower = 4, .default_ttl = 0};
+  cache_t *cache = Random_init(cc_params, NULL);
+  g_assert_true(cache_use_dense_obj_id(cache, 1 << 24));
+  g_assert_nonnull(cache->obj_sampler);
+
+  request_t *req = new_request();
+  req->obj_size = 1;
+  for (int i = 0; i < n_obj; i++) {
+    req->obj_id = (uint64_t)i << 20;
+    cache->get(cache, req);
+  }
+  g_assert_cmpint(cache->n_obj, ==, n_obj);
+
+  bool seen[n_obj];
+  memset(seen, 0, sizeof(seen));
+  for (int i = 0; i < n_obj * 100; i++) {
+    cache_obj_t *obj = cache_rand_obj(cache);
+    g_assert_cmpuint(obj->obj_id & ((1 << 20) - 1), ==, 0);
+    seen[obj->obj_id >> 20] = true;
+  }
+  for (int i = 0; i < n_obj; i++) g_assert_true(seen[i]);
+
+  /* evictions sample the cache too */
+  for (int i = n_obj; i < n_obj * 4; i++) {
+    req->obj_id = (uint64_t)i << 20;
+    cache->get(cache, req);
+  }
+  g_assert_cmpint(cache->n_obj, ==, n_obj);
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+#endif
+#endif
+
+void test_wss_sketch(gconstpointer user_data) {
+  wss_sketch_t *sketch = create_wss_sketch();
+  int64_t n_obj, n_byte;
+
+  /* the working set size is exact when every object is in the sample */
+  for (int i = 0; i < 1000; i++) {
+    wss_sketch_add(sketch, i % 100, 10 + i % 100);
+  }
+  wss_sketch_estimate(sketch, &n_obj, &n_byte);
+  g_assert_cmpint(n_obj, ==, 100);
+  g_assert_cmpint(n_byte, ==, 100 * 10 + 99 * 100 / 2);
+
+  /* an object keeps the size of its first request */
+  wss_sketch_add(sketch, 0, 1000000);
+  wss_sketch_estimate(sketch, &n_obj, &n_byte);
+  g_assert_cmpint(n_byte, ==, 100 * 10 + 99 * 100 / 2);
+  free_wss_sketch(sketch);
+
+  /* the estimate of a large working set is within a few standard errors */
+  const int64_t n_large = 2000000;
+  sketch = create_wss_sketch();
+  for (int round = 0; round < 2; round++) {
+    for (int64_t i = 0; i < n_large; i++) {
+      wss_sketch_add(sketch, i * 7 + 1, 100 + i % 101);
+    }
+  }
+  wss_sketch_estimate(sketch, &n_obj, &n_byte);
+  g_assert_cmpfloat(fabs((double)n_obj / n_large - 1), <, 0.02);
+  g_assert_cmpfloat(fabs((double)n_byte / (n_large * 150) - 1), <, 0.03);
+  free_wss_sketch(sketch);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
 
   reader = setup_plaintxt_reader_num();
   g_test_add_data_func("/libCacheSim/test_chained_hashtable_v2", NULL, test_chained_hashtable_v2);
+  g_test_add_data_func("/libCacheSim/test_chained_hashtable_v2_incremental_expand", NULL,
+                       test_chained_hashtable_v2_incremental_expand);
+  g_test_add_data_func("/libCacheSim/test_chained_hashtable_v2_dense_obj_id", NULL,
+                       test_chained_hashtable_v2_dense_obj_id);
+  g_test_add_data_func("/libCacheSim/test_obj_pool", NULL, test_obj_pool);
+  g_test_add_data_func("/libCacheSim/test_obj_link", NULL, test_obj_link);
+  g_test_add_data_func("/libCacheSim/test_wss_sketch", NULL, test_wss_sketch);
+  g_test_add_data_func("/libCacheSim/test_req_hash_value", NULL, test_req_hash_value);
+#ifndef COMPACT_CACHE_OBJ
+  /* the compact object layout only supports chainedHashTableV2 and the
+   * algorithms that do not use the obj_sampler */
+  g_test_add_data_func("/libCacheSim/test_obj_sampler", NULL, test_obj_sampler);
+#if HASHTABLE_TYPE == CHAINED_HASHTABLEV2
+  /* only chainedHashTableV2 supports dense object ids */
+  g_test_add_data_func("/libCacheSim/test_dense_obj_id_rand_obj", NULL, test_dense_obj_id_rand_obj);
+#endif
+  g_test_add_data_func("/libCacheSim/test_cuckoo_hashtable", &cuckoo_hashtable_ops, test_hashtable_ops);
+  g_test_add_data_func("/libCacheSim/test_bulk_chaining_hashtable", &bulk_chaining_hashtable_ops, test_hashtable_ops);
+#endif
 
   return g_test_run();
 }
@@ -51,14 +51,25 @@ void test_distUtils_more1(gconstpointer user_data) {
     g_assert_cmpint(rd[i], ==, rd_true[j]);
   }
 
-  save_dist(reader, rd, array_size, "rd.save", STACK_DIST);
+  /* save_dist appends the dist type to the path, the unique prefix is
+   * reserved with mkstemp so that parallel runs do not share the file */
+  char prefix[] = "/tmp/libCacheSim_rd_XXXXXX";
+  int fd = mkstemp(prefix);
+  g_assert_true(fd != -1);
+  close(fd);
+  char dist_path[sizeof(prefix) + 32];
+  snprintf(dist_path, sizeof(dist_path), "%s.STACK_DIST", prefix);
+
+  save_dist(reader, rd, array_size, prefix, STACK_DIST);
   g_free(rd);
-  rd = load_dist(reader, "rd.save.STACK_DIST", &array_size);
+  rd = load_dist(reader, dist_path, &array_size);
   g_assert_cmpint(array_size, ==, get_num_of_req(reader));
   for (i = (long)get_num_of_req(reader) - 1, j = 0; j < N_TEST; i--, j++) {
     g_assert_cmpint(rd[i], ==, rd_true[j]);
   }
   g_free(rd);
+  remove(dist_path);
+  remove(prefix);
 }
 
 int main(int argc, char* argv[]) {
@@ -50,7 +50,7 @@ static void test_LRU(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LRU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -67,7 +67,7 @@ static void test_Clock(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("Clock", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -84,7 +84,7 @@ static void test_FIFO(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("FIFO", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -105,7 +105,7 @@ static void test_Belady(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("Belady", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -126,7 +126,7 @@ static void test_BeladySize(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("BeladySize", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -135,15 +135,15 @@ static void test_BeladySize(gconstpointer user_data) {
 }
 
 static void test_Random(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92457, 88582, 84459, 80277, 76132, 72134, 68230, 64225};
-  uint64_t miss_byte_true[] = {4170166272, 3975292416, 3757524992, 3539850752,
-                               3321110016, 3113551360, 2917275648, 2725705216};
+  uint64_t miss_cnt_true[] = {92644, 88557, 84444, 80461, 76411, 72498, 68615, 64342};
+  uint64_t miss_byte_true[] = {4180113920, 3980830208, 3764096512, 3544998400,
+                               3333765632, 3124005888, 2928898048, 2724442624};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 12, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("Random", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -160,7 +160,7 @@ static void test_LFU(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LFU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -177,7 +177,7 @@ static void test_LFUCpp(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LFU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -194,7 +194,7 @@ static void test_GDSF(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("GDSF", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -211,7 +211,7 @@ static void test_LHD(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LHD", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -220,15 +220,15 @@ static void test_LHD(gconstpointer user_data) {
 }
 
 static void test_Hyperbolic(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92924, 89470, 83452, 81234, 74544, 71234, 69356, 65338};
-  uint64_t miss_byte_true[] = {4213586432, 4064826368, 3766646272, 3644941824,
-                               3245021184, 3035783168, 2939981312, 2754100224};
+  uint64_t miss_cnt_true[] = {92919, 89490, 83402, 81260, 74557, 71195, 69280, 65264};
+  uint64_t miss_byte_true[] = {4213233664, 4066689024, 3764336128, 3646453760,
+                               3246876672, 3033270784, 2936896512, 2749701632};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 18, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("Hyperbolic", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -245,7 +245,7 @@ static void test_LeCaR(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LeCaR", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -262,7 +262,7 @@ static void test_Cacheus(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("Cacheus", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -279,7 +279,7 @@ static void test_SR_LRU(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("SR_LRU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -296,7 +296,7 @@ static void test_CR_LFU(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("CR_LFU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -313,7 +313,7 @@ static void test_LFUDA(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LFUDA", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -330,7 +330,7 @@ static void test_MRU(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("MRU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -347,7 +347,7 @@ static void test_ARC(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("ARC", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -364,7 +364,7 @@ static void test_SLRU(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("SLRU", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -381,7 +381,7 @@ static void test_QDLP_FIFO(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("QDLP-FIFO", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -398,7 +398,7 @@ static void test_S3FIFOv0(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("S3-FIFOv0", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -415,7 +415,7 @@ static void test_S3FIFO(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("S3-FIFO", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -432,7 +432,7 @@ static void test_Sieve(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("Sieve", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -453,7 +453,7 @@ static void test_LIRS(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
   cache_t *cache = create_test_cache("LIRS", cc_params, reader, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   print_results(cache, res);
   _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true, miss_cnt_true, g_req_byte_true, miss_byte_true);
@@ -461,6 +461,55 @@ static void test_LIRS(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+/* checkpoint a cache in the middle of the trace, restore it into a new cache
+ * and a new reader, both caches should produce the same results afterwards */
+static void test_checkpoint(gconstpointer user_data) {
+  const char *algos[] = {"FIFO", "LRU", "Clock", "Sieve", "S3-FIFO"};
+  const int64_t n_req_before_checkpoint = 40000;
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 2, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  request_t *req = new_request();
+  request_t *req_restored = new_request();
+
+  for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+    reset_reader(reader);
+    cache_t *cache = create_test_cache(algos[i], cc_params, reader, NULL);
+    for (int64_t n = 0; n < n_req_before_checkpoint; n++) {
+      read_one_req(reader, req);
+      cache->get(cache, req);
+    }
+
+    FILE *ckpt = tmpfile();
+    g_assert_true(cache_dump_state(cache, reader, ckpt));
+    rewind(ckpt);
+
+    reader_t *reader_restored = clone_reader(reader);
+    cache_t *cache_restored = create_test_cache(algos[i], cc_params, reader, NULL);
+    g_assert_true(cache_load_state(cache_restored, reader_restored, ckpt));
+    fclose(ckpt);
+    g_assert_cmpint(cache_restored->get_n_obj(cache_restored), ==, cache->get_n_obj(cache));
+    g_assert_cmpint(cache_restored->get_occupied_byte(cache_restored), ==, cache->get_occupied_byte(cache));
+
+    int64_t n_miss = 0, n_miss_restored = 0;
+    while (read_one_req(reader, req) == 0) {
+      g_assert_cmpint(read_one_req(reader_restored, req_restored), ==, 0);
+      g_assert_cmpuint(req->obj_id, ==, req_restored->obj_id);
+      n_miss += !cache->get(cache, req);
+      n_miss_restored += !cache_restored->get(cache_restored, req_restored);
+    }
+    g_assert_cmpint(n_miss, >, 0);
+    g_assert_cmpint(n_miss_restored, ==, n_miss);
+
+    cache->cache_free(cache);
+    cache_restored->cache_free(cache_restored);
+    close_reader(reader_restored);
+  }
+
+  free_request(req);
+  free_request(req_restored);
+}
+
 static void empty_test(gconstpointer user_data) { ; }
 
 int main(int argc, char *argv[]) {
@@ -479,10 +528,15 @@ int main(int argc, char *argv[]) {
 
   g_test_add_data_func("/libCacheSim/cacheAlgo_Sieve", reader, test_Sieve);
   g_test_add_data_func("/libCacheSim/cacheAlgo_S3FIFO", reader, test_S3FIFO);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRU", reader, test_LRU);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_Clock", reader, test_Clock);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_FIFO", reader, test_FIFO);
+
+  /* the compact object layout only supports the algorithms above */
+#ifndef COMPACT_CACHE_OBJ
   g_test_add_data_func("/libCacheSim/cacheAlgo_S3FIFOv0", reader, test_S3FIFOv0);
   g_test_add_data_func("/libCacheSim/cacheAlgo_QDLP_FIFO", reader, test_QDLP_FIFO);
 
-  g_test_add_data_func("/libCacheSim/cacheAlgo_LRU", reader, test_LRU);
   g_test_add_data_func("/libCacheSim/cacheAlgo_SLRU", reader, test_SLRU);
   g_test_add_data_func("/libCacheSim/cacheAlgo_ARC", reader, test_ARC);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LeCaR", reader, test_LeCaR);
@@ -492,8 +546,6 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/cacheAlgo_Hyperbolic", reader, test_Hyperbolic);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LIRS", reader, test_LIRS);
 
-  g_test_add_data_func("/libCacheSim/cacheAlgo_Clock", reader, test_Clock);
-  g_test_add_data_func("/libCacheSim/cacheAlgo_FIFO", reader, test_FIFO);
   g_test_add_data_func("/libCacheSim/cacheAlgo_MRU", reader, test_MRU);
   g_test_add_data_func("/libCacheSim/cacheAlgo_Random", reader, test_Random);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LFU", reader, test_LFU);
@@ -502,6 +554,9 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/cacheAlgo_LFUCpp", reader, test_LFUCpp);
   g_test_add_data_func("/libCacheSim/cacheAlgo_GDSF", reader, test_GDSF);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LHD", reader, test_LHD);
+#endif
+
+  g_test_add_data_func("/libCacheSim/cacheAlgo_checkpoint", reader, test_checkpoint);
 
   // /* Belady requires reader that has next access information and can only use
   //  * oracleGeneral trace */
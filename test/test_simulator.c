@@ -2,6 +2,8 @@
 // Created by Juncheng Yang on 11/21/19.
 //
 
+#include "../libCacheSim/profiler/scheduler.h"
+#include "../libCacheSim/utils/include/mymath.h"
 #include "common.h"
 
 /**
@@ -20,7 +22,7 @@ static void test_simulator_no_size(gconstpointer user_data) {
   common_cache_params_t cc_params = {.cache_size = cache_size, .default_ttl = 0};
   cache_t *cache = LRU_init(cc_params, NULL);
   g_assert_true(cache != NULL);
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, step_size, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, step_size, NULL, 0, 0, _n_cores(), false, false);
 
   //  uint64_t* mc = _get_lru_miss_cnt(reader, get_num_of_req(reader));
 
@@ -61,7 +63,7 @@ static void test_simulator(gconstpointer user_data) {
   cache_t *cache = LRU_init(cc_params, NULL);
   g_assert_true(cache != NULL);
 
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
   // for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
   //   printf(
   //       "cache size: %lu, n_req: %lu, n_req_byte: %lu, n_miss: %8lu %16lu\n
@@ -79,7 +81,7 @@ static void test_simulator(gconstpointer user_data) {
   g_free(res);
 
   uint64_t cache_sizes[] = {STEP_SIZE, STEP_SIZE * 2, STEP_SIZE * 4, STEP_SIZE * 7};
-  res = simulate_at_multi_sizes(reader, cache, 4, cache_sizes, NULL, 0, 0, _n_cores(), false);
+  res = simulate_at_multi_sizes(reader, cache, 4, cache_sizes, NULL, 0, 0, _n_cores(), false, false);
   g_assert_cmpuint(res[0].cache_size, ==, STEP_SIZE);
   g_assert_cmpuint(res[1].n_req_byte, ==, req_byte_true);
   g_assert_cmpuint(res[3].n_req, ==, req_cnt_true);
@@ -97,7 +99,7 @@ static void test_simulator(gconstpointer user_data) {
     g_assert_true(caches[i] != NULL);
   }
 
-  res = simulate_with_multi_caches(reader, caches, 4, NULL, 0, 0, _n_cores(), false, false);
+  res = simulate_with_multi_caches(reader, caches, 4, NULL, 0, 0, _n_cores(), false, false, false);
   g_assert_cmpuint(res[0].cache_size, ==, STEP_SIZE);
   g_assert_cmpuint(res[1].n_req_byte, ==, req_byte_true);
   g_assert_cmpuint(res[3].n_req, ==, req_cnt_true);
@@ -126,7 +128,7 @@ static void test_simulator_with_warmup1(gconstpointer user_data) {
   cache_t *cache = LRU_init(cc_params, NULL);
   g_assert_true(cache != NULL);
 
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, reader, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, reader, 0, 0, _n_cores(), false, false);
 
   for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
     // printf("cache size: %lu, n_req: %lu, n_req_byte: %lu, n_miss: %8lu
@@ -155,7 +157,7 @@ static void test_simulator_with_warmup2(gconstpointer user_data) {
   cache_t *cache = LRU_init(cc_params, NULL);
   g_assert_true(cache != NULL);
 
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0.2, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0.2, 0, _n_cores(), false, false);
 
   for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
     // printf("cache size: %lu, n_req: %lu, n_req_byte: %lu, n_miss: %8lu
@@ -184,7 +186,7 @@ static void test_simulator_with_ttl(gconstpointer user_data) {
   cache_t *cache = LRU_init(cc_params, NULL);
   g_assert_true(cache != NULL);
 
-  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores(), false, false);
 
   for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
     printf("cache size: %lu, n_req: %ld, n_req_byte: %ld, n_miss: %8ld %16ld\n", (unsigned long)res[i].cache_size,
@@ -200,6 +202,216 @@ static void test_simulator_with_ttl(gconstpointer user_data) {
   cache->cache_free(cache);
 }
 
+/**
+ * shared decode should give the same result as decoding the trace per cache
+ * @param user_data
+ */
+static void test_simulator_shared_decode(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .default_ttl = 0};
+  cache_t *lru = LRU_init(cc_params, NULL);
+#ifndef COMPACT_CACHE_OBJ
+  cache_t *caches[] = {lru, Random_init(cc_params, NULL)};
+#else
+  cache_t *caches[] = {lru, Sieve_init(cc_params, NULL)};
+#endif
+  g_assert_true(lru != NULL && caches[1] != NULL);
+
+  /* no warmup, warmup using a reader, warmup using a fraction */
+  reader_t *warmup_readers[] = {NULL, reader, NULL};
+  double warmup_fracs[] = {0, 0, 0.2};
+  for (int c = 0; c < 2; c++) {
+    for (int w = 0; w < 3; w++) {
+      cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, caches[c], STEP_SIZE, warmup_readers[w],
+                                                                 warmup_fracs[w], 0, _n_cores(), false, false);
+      cache_stat_t *res_shared = simulate_at_multi_sizes_with_step_size(
+          reader, caches[c], STEP_SIZE, warmup_readers[w], warmup_fracs[w], 0, _n_cores(), false, true);
+      for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
+        g_assert_cmpuint(res_shared[i].cache_size, ==, res[i].cache_size);
+        g_assert_cmpuint(res_shared[i].n_warmup_req, ==, res[i].n_warmup_req);
+        g_assert_cmpuint(res_shared[i].n_req, ==, res[i].n_req);
+        g_assert_cmpuint(res_shared[i].n_req_byte, ==, res[i].n_req_byte);
+        g_assert_cmpuint(res_shared[i].n_miss, ==, res[i].n_miss);
+        g_assert_cmpuint(res_shared[i].n_miss_byte, ==, res[i].n_miss_byte);
+      }
+      g_free(res);
+      g_free(res_shared);
+    }
+  }
+
+  /* fewer threads than caches */
+  cache_t *multi_caches[4];
+  for (int i = 0; i < 4; i++) {
+    cc_params.cache_size = STEP_SIZE * (i + 1);
+    multi_caches[i] = LRU_init(cc_params, NULL);
+  }
+  cache_stat_t *res = simulate_with_multi_caches(reader, multi_caches, 4, NULL, 0, 0, 1, true, false, true);
+  cache_stat_t *res_lru = simulate_at_multi_sizes_with_step_size(reader, lru, STEP_SIZE, NULL, 0, 0, _n_cores(),
+                                                                 false, false);
+  for (int i = 0; i < 4; i++) {
+    g_assert_cmpuint(res[i].n_req, ==, res_lru[i].n_req);
+    g_assert_cmpuint(res[i].n_miss, ==, res_lru[i].n_miss);
+    g_assert_cmpuint(res[i].n_miss_byte, ==, res_lru[i].n_miss_byte);
+  }
+  g_free(res);
+  g_free(res_lru);
+
+  lru->cache_free(lru);
+  caches[1]->cache_free(caches[1]);
+}
+
+/**
+ * get_batch should return the same results as calling get on each request
+ * @param user_data
+ */
+static void test_cache_get_batch(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = STEP_SIZE * 2, .default_ttl = 0, .hashpower = 12};
+#ifndef COMPACT_CACHE_OBJ
+  const char *algos[] = {"LRU", "S3-FIFO", "Random"};
+#else
+  const char *algos[] = {"LRU", "S3-FIFO", "Sieve"};
+#endif
+  const int batch_size = 100;
+  request_t *reqs = my_malloc_n(request_t, batch_size);
+  bool hits[batch_size];
+
+  for (int a = 0; a < 3; a++) {
+    cache_t *cache = create_test_cache(algos[a], cc_params, reader, NULL);
+    cache_t *cache_batch = create_test_cache(algos[a], cc_params, reader, NULL);
+    set_rand_seed(1);
+    __uint128_t rand_state = g_lehmer64_state, rand_state_batch = g_lehmer64_state;
+
+    reset_reader(reader);
+    request_t *req = new_request();
+    read_one_req(reader, req);
+    int64_t n_hit = 0, n_hit_batch = 0;
+    while (req->valid) {
+      int n_req = 0;
+      while (req->valid && n_req < batch_size) {
+        copy_request(&reqs[n_req++], req);
+        read_one_req(reader, req);
+      }
+
+      g_lehmer64_state = rand_state;
+      for (int i = 0; i < n_req; i++) {
+        n_hit += cache->get(cache, &reqs[i]);
+      }
+      rand_state = g_lehmer64_state;
+
+      g_lehmer64_state = rand_state_batch;
+      n_hit_batch += cache_batch->get_batch(cache_batch, reqs, n_req, hits);
+      rand_state_batch = g_lehmer64_state;
+    }
+    g_assert_cmpint(n_hit, ==, n_hit_batch);
+    g_assert_cmpint(cache->get_occupied_byte(cache), ==, cache_batch->get_occupied_byte(cache_batch));
+    g_assert_cmpint(cache->get_n_obj(cache), ==, cache_batch->get_n_obj(cache_batch));
+
+    free_request(req);
+    cache->cache_free(cache);
+    cache_batch->cache_free(cache_batch);
+  }
+  my_free(sizeof(request_t) * batch_size, reqs);
+}
+
+/**
+ * a branch that does not change the parameters should have the same result
+ * as the normal simulation, and without warmup, each branch should have the
+ * same result as simulating a cache with the variant parameters from scratch
+ * @param user_data
+ */
+static void test_simulator_warm_cache_branching(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = STEP_SIZE * 2, .default_ttl = 0};
+  cache_t *clock = Clock_init(cc_params, NULL);
+  const char *variants[] = {NULL, "n-bit-counter=2", "n-bit-counter=3,init-freq=1"};
+
+  cache_stat_t *res = simulate_with_warm_cache_branching(reader, clock, 3, variants, NULL, 0, 0, 2, false);
+  cache_t *caches[] = {Clock_init(cc_params, NULL), Clock_init(cc_params, "n-bit-counter=2"),
+                       Clock_init(cc_params, "n-bit-counter=3,init-freq=1")};
+  cache_stat_t *res_ref = simulate_with_multi_caches(reader, caches, 3, NULL, 0, 0, 1, true, false, false);
+  for (int i = 0; i < 3; i++) {
+    g_assert_cmpstr(res[i].cache_name, ==, res_ref[i].cache_name);
+    g_assert_cmpint(res[i].n_warmup_req, ==, 0);
+    g_assert_cmpint(res[i].n_req, ==, res_ref[i].n_req);
+    g_assert_cmpint(res[i].n_miss, ==, res_ref[i].n_miss);
+    g_assert_cmpint(res[i].n_miss_byte, ==, res_ref[i].n_miss_byte);
+  }
+  g_free(res);
+  g_free(res_ref);
+
+  res = simulate_with_warm_cache_branching(reader, clock, 3, variants, NULL, 0.2, 0, 2, false);
+  caches[0] = Clock_init(cc_params, NULL);
+  res_ref = simulate_with_multi_caches(reader, caches, 1, NULL, 0.2, 0, 1, true, false, false);
+  g_assert_cmpint(res[0].n_warmup_req, ==, res_ref[0].n_warmup_req);
+  g_assert_cmpint(res[0].n_req, ==, res_ref[0].n_req);
+  g_assert_cmpint(res[0].n_miss, ==, res_ref[0].n_miss);
+  g_assert_cmpint(res[0].n_miss_byte, ==, res_ref[0].n_miss_byte);
+  for (int i = 1; i < 3; i++) {
+    g_assert_cmpint(res[i].n_warmup_req, ==, res[0].n_warmup_req);
+    g_assert_cmpint(res[i].n_req, ==, res[0].n_req);
+  }
+  g_assert_cmpstr(res[2].cache_name, ==, "Clock-3-1");
+  g_free(res);
+  g_free(res_ref);
+
+  clock->cache_free(clock);
+}
+
+typedef struct {
+  gint n_run[64];
+  int start_order[64];
+  gint n_started;
+} sched_test_data_t;
+
+static void _sched_test_job(int job_idx, void *user_data) {
+  sched_test_data_t *data = (sched_test_data_t *)user_data;
+  data->start_order[g_atomic_int_add(&data->n_started, 1)] = job_idx;
+  g_atomic_int_inc(&data->n_run[job_idx]);
+}
+
+/**
+ * every job should run exactly once, and with one worker the jobs should
+ * start in descending order of cost
+ */
+static void test_work_stealing_scheduler(void) {
+  const int n_job = 64;
+  double costs[64];
+  for (int i = 0; i < n_job; i++) {
+    costs[i] = (double)((i * 37) % n_job);
+  }
+
+  int n_threads[] = {1, 3, 8, 100};
+  for (int t = 0; t < 4; t++) {
+    sched_test_data_t data;
+    memset(&data, 0, sizeof(data));
+    run_jobs_with_work_stealing(n_job, costs, n_threads[t], _sched_test_job, &data);
+    g_assert_cmpint(data.n_started, ==, n_job);
+    for (int i = 0; i < n_job; i++) {
+      g_assert_cmpint(data.n_run[i], ==, 1);
+    }
+    if (n_threads[t] == 1) {
+      for (int i = 1; i < n_job; i++) {
+        g_assert_cmpfloat(costs[data.start_order[i - 1]], >=, costs[data.start_order[i]]);
+      }
+    }
+  }
+
+  common_cache_params_t cc_params = {.cache_size = STEP_SIZE, .default_ttl = 0};
+  cache_t *lru_small = LRU_init(cc_params, NULL);
+  cc_params.cache_size = STEP_SIZE * 8;
+  cache_t *lru_large = LRU_init(cc_params, NULL);
+  g_assert_cmpfloat(estimate_sim_job_cost(lru_large), >, estimate_sim_job_cost(lru_small));
+#ifndef COMPACT_CACHE_OBJ
+  cc_params.cache_size = STEP_SIZE;
+  cache_t *lhd_small = LHD_init(cc_params, NULL);
+  g_assert_cmpfloat(estimate_sim_job_cost(lhd_small), >, estimate_sim_job_cost(lru_small));
+  lhd_small->cache_free(lhd_small);
+#endif
+  lru_small->cache_free(lru_small);
+  lru_large->cache_free(lru_large);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
@@ -228,6 +440,29 @@ int main(int argc, char *argv[]) {
   reader = setup_vscsi_reader();
   g_test_add_data_func_full("/libCacheSim/simulator_warmup2", reader, test_simulator_with_warmup2, test_teardown);
 
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_shared_decode", reader, test_simulator_shared_decode,
+                            test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/cache_get_batch", reader, test_cache_get_batch, test_teardown);
+
+  g_test_add_func("/libCacheSim/work_stealing_scheduler", test_work_stealing_scheduler);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_warm_cache_branching_vscsi", reader,
+                            test_simulator_warm_cache_branching, test_teardown);
+
+  reader = setup_csv_reader_obj_num();
+  g_test_add_data_func_full("/libCacheSim/simulator_warm_cache_branching_csv", reader,
+                            test_simulator_warm_cache_branching, test_teardown);
+
+#ifdef SUPPORT_ZSTD_TRACE
+  reader = setup_oracleGeneralZstd_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_warm_cache_branching_zstd", reader,
+                            test_simulator_warm_cache_branching, test_teardown);
+#endif
+
 #ifdef SUPPORT_TTL
   reader = setup_vscsi_reader();
   g_test_add_data_func_full("/libCacheSim/simulator_with_ttl", reader, test_simulator_with_ttl, test_teardown);
@@ -0,0 +1,99 @@
+//
+// traceConv parses csv/txt traces in chunks on several threads, the output
+// should be the same as reading the trace backward on one thread
+//
+
+#include <string>
+#include <vector>
+
+#include "../libCacheSim/bin/traceUtils/internal.hpp"
+#include "common.h"
+
+typedef reader_t *(*setup_reader_func)(void);
+
+/* the thread counts to compare with the backward reader (0 threads) */
+static const int n_threads[] = {1, 2, 3, 7, 16};
+
+static std::string _read_file(const std::string &path) {
+  char *content = NULL;
+  gsize length = 0;
+  g_assert_true(g_file_get_contents(path.c_str(), &content, &length, NULL));
+  std::string data(content, length);
+  g_free(content);
+  return data;
+}
+
+/* whether a chunk of the trace parsed on n_thread threads starts in the middle
+ * of a line, so that the chunk has to be moved to the next line */
+static bool _has_mid_line_chunk(const std::string &trace, size_t data_start, int n_thread) {
+  for (int i = 1; i < n_thread; i++) {
+    size_t pos = data_start + (trace.size() - data_start) / n_thread * i;
+    if (trace[pos - 1] != '\n') return true;
+  }
+  return false;
+}
+
+static std::string _convert(setup_reader_func setup_reader, const std::string &ofilepath, bool lcs, int n_thread) {
+  reader_t *reader = setup_reader();
+  if (lcs) {
+    traceConv::convert_to_lcs(reader, ofilepath, false, false, 1, false, n_thread, 0);
+  } else {
+    traceConv::convert_to_oracleGeneral(reader, ofilepath, false, false, n_thread, 0);
+  }
+  close_reader(reader);
+
+  std::string output = _read_file(ofilepath);
+  remove(ofilepath.c_str());
+  return output;
+}
+
+static void _test_parallel_conv(setup_reader_func setup_reader, bool lcs) {
+  char prefix[] = "/tmp/libCacheSim_traceConv_XXXXXX";
+  int fd = mkstemp(prefix);
+  g_assert_true(fd != -1);
+  close(fd);
+  std::string ofilepath = std::string(prefix) + (lcs ? ".lcs" : ".oracleGeneral");
+
+  reader_t *reader = setup_reader();
+  std::string trace = _read_file(reader->trace_path);
+  size_t data_start = reader->trace_type == CSV_TRACE ? reader->trace_start_offset : 0;
+  close_reader(reader);
+
+  std::string expected = _convert(setup_reader, ofilepath, lcs, 0);
+  g_assert_cmpuint(expected.size(), >, 0);
+  for (int n_thread : n_threads) {
+    if (n_thread >= 7) {
+      g_assert_true(_has_mid_line_chunk(trace, data_start, n_thread));
+    }
+    std::string output = _convert(setup_reader, ofilepath, lcs, n_thread);
+    g_assert_cmpuint(output.size(), ==, expected.size());
+    g_assert_true(output == expected);
+  }
+
+  remove(prefix);
+}
+
+static void test_parallel_conv_csv_oracleGeneral(gconstpointer user_data) {
+  _test_parallel_conv(setup_csv_reader_obj_num, false);
+}
+
+static void test_parallel_conv_csv_lcs(gconstpointer user_data) { _test_parallel_conv(setup_csv_reader_obj_num, true); }
+
+static void test_parallel_conv_txt_oracleGeneral(gconstpointer user_data) {
+  _test_parallel_conv(setup_plaintxt_reader_num, false);
+}
+
+static void test_parallel_conv_txt_lcs(gconstpointer user_data) { _test_parallel_conv(setup_plaintxt_reader_num, true); }
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/traceConv_parallel_csv_oracleGeneral", NULL,
+                       test_parallel_conv_csv_oracleGeneral);
+  g_test_add_data_func("/libCacheSim/traceConv_parallel_csv_lcs", NULL, test_parallel_conv_csv_lcs);
+  g_test_add_data_func("/libCacheSim/traceConv_parallel_txt_oracleGeneral", NULL,
+                       test_parallel_conv_txt_oracleGeneral);
+  g_test_add_data_func("/libCacheSim/traceConv_parallel_txt_lcs", NULL, test_parallel_conv_txt_lcs);
+
+  return g_test_run();
+}
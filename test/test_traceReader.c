@@ -2,8 +2,17 @@
 // Created by Juncheng Yang on 11/19/19.
 //
 
+#include "../libCacheSim/dataStructure/hash/hash.h"
+#include "../libCacheSim/traceReader/readerInternal.h"
 #include "common.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef SUPPORT_ZSTD_TRACE
+#include "../libCacheSim/traceReader/generalReader/zstdReader.h"
+#endif
+
 // defined in reader.c file, not in public interface
 int go_back_two_req(reader_t *const reader);
 
@@ -128,6 +137,457 @@ void test_reader_more2(gconstpointer user_data) {
   close_reader(cloned_reader);
 }
 
+void test_reader_seek(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request();
+
+  for (int i = N_TEST_REQ - 1; i >= 0; i--) {
+    g_assert_true(reader_seek_req(reader, i) == 0);
+    read_one_req(reader, req);
+    verify_req(reader, req, i);
+  }
+
+  g_assert_true(reader_seek_req(reader, trace_length - 1) == 0);
+  read_one_req(reader, req);
+  verify_req(reader, req, -1);
+  g_assert_true(reader_seek_req(reader, trace_length + 1) != 0);
+
+  reset_reader(reader);
+  free_request(req);
+}
+
+void test_reader_seek_time(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  reset_reader(reader);
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  request_t *expected_req = new_request();
+
+  /* the first request of every few timestamps is found by its time and by a
+   * time after the previous timestamp */
+  int64_t prev_time = INT64_MIN;
+  int64_t n_time = 0;
+  while (read_one_req(cloned_reader, expected_req) == 0) {
+    int64_t curr_time = expected_req->clock_time;
+    g_assert_true(curr_time >= prev_time);
+    if (curr_time != prev_time && n_time++ % 97 == 0) {
+      g_assert_true(reader_seek_time(reader, curr_time) == 0);
+      g_assert_true(read_one_req(reader, req) == 0);
+      g_assert_true(req->clock_time == curr_time);
+      g_assert_true(req->obj_id == expected_req->obj_id);
+
+      if (prev_time != INT64_MIN && prev_time + 1 < curr_time) {
+        g_assert_true(reader_seek_time(reader, prev_time + 1) == 0);
+        g_assert_true(read_one_req(reader, req) == 0);
+        g_assert_true(req->obj_id == expected_req->obj_id);
+      }
+    }
+    prev_time = curr_time;
+  }
+
+  g_assert_true(reader_seek_time(reader, INT64_MIN) == 0);
+  read_one_req(reader, req);
+  verify_req(reader, req, 0);
+
+  g_assert_true(reader_seek_time(reader, prev_time + 1) != 0);
+  g_assert_true(read_one_req(reader, req) != 0);
+
+  reset_reader(reader);
+  close_reader(cloned_reader);
+  free_request(expected_req);
+  free_request(req);
+}
+
+void test_reader_batch(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  reset_reader(reader);
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  request_t reqs[7];
+  memset(reqs, 0, sizeof(reqs));
+
+  int n_read, n_total = 0;
+  while ((n_read = read_n_reqs(reader, reqs, 7)) > 0) {
+    for (int i = 0; i < n_read; i++) {
+      g_assert_true(read_one_req(cloned_reader, req) == 0);
+      g_assert_true(reqs[i].obj_id == req->obj_id);
+      g_assert_true(reqs[i].clock_time == req->clock_time);
+      g_assert_true(reqs[i].obj_size == req->obj_size);
+      if (get_trace_type(reader) == LCS_TRACE) {
+        g_assert_true(reqs[i].next_access_vtime == req->next_access_vtime);
+        g_assert_true(reqs[i].tenant_id == req->tenant_id);
+      }
+    }
+    n_total += n_read;
+  }
+  /* some fixtures only have the first part of the trace */
+  g_assert_true(n_total == get_num_of_req(reader));
+  g_assert_true(read_one_req(cloned_reader, req) != 0);
+
+  reset_reader(reader);
+  close_reader(cloned_reader);
+  free_request(req);
+}
+
+/* a compressed trace reads the same requests as the uncompressed trace */
+void test_reader_zstd(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  reader_t *reader_uncompressed = setup_oracleGeneralBin_reader();
+  g_assert_true(reader->is_zstd_file);
+  reset_reader(reader);
+  request_t *req = new_request();
+  request_t *expected_req = new_request();
+
+  for (int n_pass = 0; n_pass < 2; n_pass++) {
+    int64_t n_req = 0;
+    while (read_one_req(reader_uncompressed, expected_req) == 0) {
+      g_assert_true(read_one_req(reader, req) == 0);
+      g_assert_true(req->obj_id == expected_req->obj_id);
+      g_assert_true(req->clock_time == expected_req->clock_time);
+      g_assert_true(req->obj_size == expected_req->obj_size);
+      g_assert_true(req->next_access_vtime == expected_req->next_access_vtime);
+      n_req++;
+    }
+    g_assert_true(n_req == trace_length);
+    /* the trace ends at the end of the last frame */
+    g_assert_true(read_one_req(reader, req) != 0);
+    g_assert_false(req->valid);
+    g_assert_true(read_one_req(reader, req) != 0);
+
+    reset_reader(reader);
+    reset_reader(reader_uncompressed);
+  }
+
+  close_reader(reader_uncompressed);
+  free_request(expected_req);
+  free_request(req);
+}
+
+#ifdef SUPPORT_ZSTD_TRACE
+/* the size of a seekable zstd trace is known from the seek table without
+ * decompressing it */
+void test_reader_zstd_seekable(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  zstd_reader_t *zstd_reader = reader->zstd_reader_p;
+  g_assert_true(zstd_reader_is_seekable(zstd_reader));
+  g_assert_true(zstd_reader->n_frame > 1);
+  g_assert_true(get_num_of_req(reader) == trace_length);
+  g_assert_false(zstd_reader->threads_started);
+
+  reader_t *cloned_reader = clone_reader(reader);
+  g_assert_true(get_num_of_req(cloned_reader) == trace_length);
+  g_assert_false(cloned_reader->zstd_reader_p->threads_started);
+  close_reader(cloned_reader);
+
+  /* the requests around each frame boundary, visited backward */
+  reader_t *reader_uncompressed = setup_oracleGeneralBin_reader();
+  request_t *req = new_request();
+  request_t *expected_req = new_request();
+  for (int64_t i = zstd_reader->n_frame - 1; i > 0; i--) {
+    int64_t boundary_req = zstd_reader->frames[i].content_offset / reader->item_size;
+    for (int64_t req_idx = boundary_req + 1; req_idx >= boundary_req - 1; req_idx--) {
+      g_assert_true(reader_seek_req(reader, req_idx) == 0);
+      g_assert_true(reader_seek_req(reader_uncompressed, req_idx) == 0);
+      g_assert_true(read_one_req(reader, req) == 0);
+      g_assert_true(read_one_req(reader_uncompressed, expected_req) == 0);
+      g_assert_true(req->obj_id == expected_req->obj_id);
+      g_assert_true(req->clock_time == expected_req->clock_time);
+    }
+  }
+
+  reset_reader(reader);
+  close_reader(reader_uncompressed);
+  free_request(expected_req);
+  free_request(req);
+}
+
+/* the readers cloned for the simulation threads share the decompression
+ * threads of the process, each reader still gets one thread */
+void test_reader_zstd_budget(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const int n_clone = 8;
+  int max_n_thread = (int)MAX(sysconf(_SC_NPROCESSORS_ONLN) - 1, 1);
+  request_t *req = new_request();
+  reset_reader(reader);
+  g_assert_true(read_one_req(reader, req) == 0);
+  int full_n_thread = reader->zstd_reader_p->n_thread;
+  reset_reader(reader);
+
+  reader_t *cloned_readers[n_clone];
+  int n_thread = 0;
+  for (int i = 0; i < n_clone; i++) {
+    cloned_readers[i] = clone_reader(reader);
+    g_assert_true(read_one_req(cloned_readers[i], req) == 0);
+    verify_req(cloned_readers[i], req, 0);
+    g_assert_cmpint(cloned_readers[i]->zstd_reader_p->n_thread, >=, 1);
+    n_thread += cloned_readers[i]->zstd_reader_p->n_thread;
+  }
+  /* the readers after the budget is used up get one thread each */
+  g_assert_cmpint(n_thread, <=, max_n_thread + n_clone - 1);
+  for (int i = 0; i < n_clone; i++) {
+    close_reader(cloned_readers[i]);
+  }
+
+  /* the threads are returned when the readers are closed */
+  g_assert_true(read_one_req(reader, req) == 0);
+  g_assert_cmpint(reader->zstd_reader_p->n_thread, ==, full_n_thread);
+
+  reset_reader(reader);
+  free_request(req);
+}
+
+/* a zstd trace without a frame index is decompressed again from the start to
+ * move backward beyond the blocks in memory */
+void test_reader_zstd_restart(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  zstd_reader_t *zstd_reader = reader->zstd_reader_p;
+  g_assert_false(zstd_reader_is_seekable(zstd_reader));
+  reset_reader(reader);
+  /* the trace spans many blocks */
+  zstd_reader->stream_block_size = 64 * KiB;
+
+  reader_t *reader_uncompressed = setup_oracleGeneralBin_reader();
+  request_t *req = new_request();
+  request_t *expected_req = new_request();
+  for (int64_t req_idx = trace_length - 1; req_idx >= 0; req_idx -= 9973) {
+    g_assert_true(reader_seek_req(reader, req_idx) == 0);
+    g_assert_true(reader_seek_req(reader_uncompressed, req_idx) == 0);
+    g_assert_true(read_one_req(reader, req) == 0);
+    g_assert_true(read_one_req(reader_uncompressed, expected_req) == 0);
+    g_assert_true(req->obj_id == expected_req->obj_id);
+    g_assert_true(req->clock_time == expected_req->clock_time);
+
+    /* read backward across the start of the block */
+    for (int i = 0; i < 3000 && go_back_two_req(reader) == 0; i++) {
+      g_assert_true(go_back_two_req(reader_uncompressed) == 0);
+      g_assert_true(read_one_req(reader, req) == 0);
+      g_assert_true(read_one_req(reader_uncompressed, expected_req) == 0);
+      g_assert_true(req->obj_id == expected_req->obj_id);
+    }
+  }
+
+  reset_reader(reader);
+  g_assert_true(read_one_req(reader, req) == 0);
+  verify_req(reader, req, 0);
+
+  zstd_reader->stream_block_size = ZSTD_READER_STREAM_BLOCK_SIZE;
+  reset_reader(reader);
+  close_reader(reader_uncompressed);
+  free_request(expected_req);
+  free_request(req);
+}
+#endif
+
+/* the simulation fields survive a round trip through req_hot_t */
+void test_req_hot_copy(gconstpointer user_data) {
+  request_t *req = new_request();
+  req->clock_time = 5633898368802;
+  req->obj_id = 42932745;
+  req->obj_size = 6656;
+  req->next_access_vtime = 17;
+  req->ttl = 3600;
+  req->op = OP_SET;
+  req->tenant_id = 3;
+  req->hv = get_req_hash_value(req);
+  req->hv_obj_id = req->obj_id;
+  req->n_features = 2;
+
+  req_hot_t hot;
+  copy_request_to_hot(&hot, req);
+  g_assert_true(hot.hv == req->hv);
+
+  request_t *copied_req = new_request();
+  copied_req->n_features = 2;
+  copy_hot_to_request(copied_req, &hot);
+  g_assert_true(copied_req->clock_time == req->clock_time);
+  g_assert_true(copied_req->obj_id == req->obj_id);
+  g_assert_true(copied_req->obj_size == req->obj_size);
+  g_assert_true(copied_req->next_access_vtime == req->next_access_vtime);
+  g_assert_true(copied_req->ttl == req->ttl);
+  g_assert_true(copied_req->op == req->op);
+  g_assert_true(copied_req->tenant_id == req->tenant_id);
+  g_assert_true(copied_req->valid);
+  g_assert_true(get_req_hash_value(copied_req) == req->hv);
+  /* the other fields are not changed */
+  g_assert_true(copied_req->n_features == 2);
+
+  /* a hash value of another object is not copied */
+  req->obj_id += 1;
+  copy_request_to_hot(&hot, req);
+  g_assert_true(hot.hv == 0);
+  copy_hot_to_request(copied_req, &hot);
+  g_assert_true(get_req_hash_value(copied_req) == get_req_hash_value(req));
+
+  free_request(copied_req);
+  free_request(req);
+}
+
+/* read_n_hot_reqs reads the same requests as read_one_req */
+void test_reader_hot_batch(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  reset_reader(reader);
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  req_hot_t reqs[100];
+
+  int n_read, n_total = 0;
+  while ((n_read = read_n_hot_reqs(reader, reqs, 100)) > 0) {
+    for (int i = 0; i < n_read; i++) {
+      g_assert_true(read_one_req(cloned_reader, req) == 0);
+      g_assert_true(reqs[i].obj_id == req->obj_id);
+      g_assert_true(reqs[i].clock_time == req->clock_time);
+      g_assert_true(reqs[i].obj_size == req->obj_size);
+      g_assert_true(reqs[i].next_access_vtime == req->next_access_vtime);
+      g_assert_true(reqs[i].op == req->op);
+      g_assert_true(reqs[i].ttl == req->ttl);
+    }
+    n_total += n_read;
+  }
+  g_assert_true(n_total == get_num_of_req(reader));
+  g_assert_true(read_one_req(cloned_reader, req) != 0);
+
+  reset_reader(reader);
+  close_reader(cloned_reader);
+  free_request(req);
+}
+
+/* the number of requests of a txt trace and the inode of its sidecar, which
+ * changes when the sidecar is written again */
+static int64_t _trace_meta_n_req(const char *trace_path, bool ignore_obj_size, ino_t *sidecar_ino) {
+  reader_init_param_t init_params = {.obj_id_is_num = true, .ignore_obj_size = ignore_obj_size};
+  reader_t *reader = setup_reader(trace_path, PLAIN_TXT_TRACE, &init_params);
+  const trace_meta_t *meta = get_trace_meta(reader);
+  g_assert_nonnull(meta);
+  int64_t n_req = meta->n_req;
+  close_reader(reader);
+
+  char sidecar_path[1024];
+  snprintf(sidecar_path, sizeof(sidecar_path), "%s.meta", trace_path);
+  struct stat st;
+  g_assert_true(stat(sidecar_path, &st) == 0);
+  *sidecar_ino = st.st_ino;
+  return n_req;
+}
+
+/* the metadata sidecar is reused until the trace or the reader parameters
+ * change, and a damaged sidecar is ignored */
+void test_trace_meta_sidecar(gconstpointer user_data) {
+  char data_path[1024];
+  _detect_data_path(data_path, "cloudPhysicsIO.txt");
+  gchar *trace;
+  gsize trace_len;
+  g_assert_true(g_file_get_contents(data_path, &trace, &trace_len, NULL));
+
+  const char *trace_path = "trace_meta_test.txt";
+  const char *sidecar_path = "trace_meta_test.txt.meta";
+  remove(sidecar_path);
+  g_assert_true(g_file_set_contents(trace_path, trace, trace_len, NULL));
+
+  ino_t ino, prev_ino;
+  g_assert_true(_trace_meta_n_req(trace_path, false, &ino) == trace_length);
+  prev_ino = ino;
+  g_assert_true(_trace_meta_n_req(trace_path, false, &ino) == trace_length);
+  g_assert_true(ino == prev_ino);
+
+  /* a different modification time */
+  struct timespec times[2] = {{.tv_sec = 0, .tv_nsec = UTIME_OMIT}, {.tv_sec = 1000000000, .tv_nsec = 0}};
+  g_assert_true(utimensat(AT_FDCWD, trace_path, times, 0) == 0);
+  g_assert_true(_trace_meta_n_req(trace_path, false, &ino) == trace_length);
+  g_assert_true(ino != prev_ino);
+  prev_ino = ino;
+
+  /* a different size, the trace does not end with a newline */
+  FILE *file = fopen(trace_path, "a");
+  fprintf(file, "\n%zu", trace_end_req_d);
+  fclose(file);
+  g_assert_true(_trace_meta_n_req(trace_path, false, &ino) == trace_length + 1);
+  g_assert_true(ino != prev_ino);
+  prev_ino = ino;
+
+  /* different reader parameters */
+  g_assert_true(_trace_meta_n_req(trace_path, true, &ino) == trace_length + 1);
+  g_assert_true(ino != prev_ino);
+  prev_ino = ino;
+  g_assert_true(_trace_meta_n_req(trace_path, true, &ino) == trace_length + 1);
+  g_assert_true(ino == prev_ino);
+
+  /* a truncated sidecar, and a sidecar with a corrupted header */
+  gchar *sidecar;
+  gsize sidecar_len;
+  g_assert_true(g_file_get_contents(sidecar_path, &sidecar, &sidecar_len, NULL));
+  g_assert_true(sidecar_len > 64);
+  g_assert_true(g_file_set_contents(sidecar_path, sidecar, sidecar_len - 8, NULL));
+  g_assert_true(_trace_meta_n_req(trace_path, true, &ino) == trace_length + 1);
+  g_assert_true(g_file_set_contents(sidecar_path, sidecar, 16, NULL));
+  g_assert_true(_trace_meta_n_req(trace_path, true, &ino) == trace_length + 1);
+  sidecar[0] ^= 0xff;
+  g_assert_true(g_file_set_contents(sidecar_path, sidecar, sidecar_len, NULL));
+  g_assert_true(_trace_meta_n_req(trace_path, true, &ino) == trace_length + 1);
+
+  /* the sidecar is written again after each damaged one */
+  gchar *new_sidecar;
+  gsize new_sidecar_len;
+  g_assert_true(g_file_get_contents(sidecar_path, &new_sidecar, &new_sidecar_len, NULL));
+  sidecar[0] ^= 0xff;
+  g_assert_true(new_sidecar_len == sidecar_len && memcmp(new_sidecar, sidecar, sidecar_len) == 0);
+
+  remove(trace_path);
+  remove(sidecar_path);
+  g_free(new_sidecar);
+  g_free(sidecar);
+  g_free(trace);
+}
+
+/* the csv fast path parses the same requests as libcsv, lines with a quote
+ * fall back to libcsv, and the fields are trimmed the same way */
+void test_csv_fast_parse(gconstpointer user_data) {
+  const int n_req = 13;
+  for (int is_num = 0; is_num <= 1; is_num++) {
+    reader_t *reader_fast = setup_quoted_csv_reader(is_num);
+    reader_t *reader_libcsv = setup_quoted_csv_reader(is_num);
+    g_assert_true(((csv_params_t *)reader_fast->reader_params)->fast_parse);
+    ((csv_params_t *)reader_libcsv->reader_params)->fast_parse = false;
+
+    request_t *req_fast = new_request();
+    request_t *req_libcsv = new_request();
+    obj_id_t obj_ids[n_req];
+    int n = 0;
+    while (read_one_req(reader_fast, req_fast) == 0) {
+      g_assert_true(read_one_req(reader_libcsv, req_libcsv) == 0);
+      g_assert_true(req_fast->clock_time == req_libcsv->clock_time);
+      g_assert_true(req_fast->obj_id == req_libcsv->obj_id);
+      g_assert_true(req_fast->obj_size == req_libcsv->obj_size);
+      g_assert_true(req_fast->op == req_libcsv->op);
+      g_assert_true(req_fast->obj_size == (n + 1) * 100);
+      g_assert_cmpint(n, <, n_req);
+      obj_ids[n++] = req_fast->obj_id;
+    }
+    g_assert_true(read_one_req(reader_libcsv, req_libcsv) != 0);
+    g_assert_cmpint(n, ==, n_req);
+
+    /* "00042" quoted and " 00042 " with spaces are the same id */
+    g_assert_true(obj_ids[3] == obj_ids[4]);
+    if (is_num) {
+      g_assert_true(obj_ids[0] == 42);
+      g_assert_true(obj_ids[1] == 7);
+      g_assert_true(obj_ids[2] == 0x1f);
+      /* like strtoull, an id with a leading 0 is octal */
+      g_assert_true(obj_ids[3] == 042);
+      g_assert_true(obj_ids[10] == 043);
+      g_assert_true(obj_ids[7] == 1234567890123456789ULL);
+    } else {
+      g_assert_true(obj_ids[0] != obj_ids[3]);
+      g_assert_true(obj_ids[3] == get_hash_value_str("00042", 5));
+      g_assert_true(obj_ids[9] == get_hash_value_str("1,1", 3));
+    }
+
+    free_request(req_fast);
+    free_request(req_libcsv);
+    close_reader(reader_fast);
+    close_reader(reader_libcsv);
+  }
+}
+
 void test_twr(gconstpointer user_data) {
   reader_t *reader = setup_reader("/Users/junchengy/twr.sbin", TWR_TRACE, NULL);
   gint64 n_req = get_num_of_req(reader);
@@ -146,6 +606,9 @@ void test_twr(gconstpointer user_data) {
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
+  g_test_add_data_func("/libCacheSim/req_hot_copy", NULL, test_req_hot_copy);
+  g_test_add_data_func("/libCacheSim/trace_meta_sidecar", NULL, test_trace_meta_sidecar);
+  g_test_add_data_func("/libCacheSim/csv_fast_parse", NULL, test_csv_fast_parse);
 
   reader = setup_plaintxt_reader_num();
   g_test_add_data_func("/libCacheSim/reader_basic_plain_num", reader, test_reader_basic);
@@ -160,6 +623,9 @@ int main(int argc, char *argv[]) {
   reader = setup_csv_reader_obj_num();
   g_test_add_data_func("/libCacheSim/reader_basic_csv_num", reader, test_reader_basic);
   g_test_add_data_func("/libCacheSim/reader_more1_csv_num", reader, test_reader_more1);
+  g_test_add_data_func("/libCacheSim/reader_batch_csv_num", reader, test_reader_batch);
+  g_test_add_data_func("/libCacheSim/reader_hot_batch_csv_num", reader, test_reader_hot_batch);
+  g_test_add_data_func("/libCacheSim/reader_seek_time_csv_num", reader, test_reader_seek_time);
   g_test_add_data_func_full("/libCacheSim/reader_more2_csv_num", reader, test_reader_more2, test_teardown);
 
   reader = setup_csv_reader_obj_str();
@@ -170,6 +636,10 @@ int main(int argc, char *argv[]) {
   reader = setup_binary_reader();
   g_test_add_data_func("/libCacheSim/reader_basic_binary", reader, test_reader_basic);
   g_test_add_data_func("/libCacheSim/reader_more1_binary", reader, test_reader_more1);
+  g_test_add_data_func("/libCacheSim/reader_batch_binary", reader, test_reader_batch);
+  g_test_add_data_func("/libCacheSim/reader_hot_batch_binary", reader, test_reader_hot_batch);
+  g_test_add_data_func("/libCacheSim/reader_seek_binary", reader, test_reader_seek);
+  g_test_add_data_func("/libCacheSim/reader_seek_time_binary", reader, test_reader_seek_time);
   g_test_add_data_func_full("/libCacheSim/reader_more2_binary", reader, test_reader_more2, test_teardown);
 
   reader = setup_vscsi_reader();
@@ -180,8 +650,50 @@ int main(int argc, char *argv[]) {
   reader = setup_oracleGeneralBin_reader();
   g_test_add_data_func("/libCacheSim/reader_basic_oracleGeneral", reader, test_reader_basic);
   g_test_add_data_func("/libCacheSim/reader_more1_oracleGeneral", reader, test_reader_more1);
+  g_test_add_data_func("/libCacheSim/reader_batch_oracleGeneral", reader, test_reader_batch);
+  g_test_add_data_func("/libCacheSim/reader_hot_batch_oracleGeneral", reader, test_reader_hot_batch);
+  g_test_add_data_func("/libCacheSim/reader_seek_oracleGeneral", reader, test_reader_seek);
+  g_test_add_data_func("/libCacheSim/reader_seek_time_oracleGeneral", reader, test_reader_seek_time);
   g_test_add_data_func_full("/libCacheSim/reader_more2_oracleGeneral", reader, test_reader_more2, test_teardown);
 
+#ifdef SUPPORT_ZSTD_TRACE
+  reader = setup_oracleGeneralZstd_reader();
+  g_test_add_data_func("/libCacheSim/reader_zstd_oracleGeneral", reader, test_reader_zstd);
+  g_test_add_data_func("/libCacheSim/reader_basic_zstd_oracleGeneral", reader, test_reader_basic);
+  g_test_add_data_func_full("/libCacheSim/reader_restart_zstd_oracleGeneral", reader, test_reader_zstd_restart,
+                            test_teardown);
+
+  reader = setup_oracleGeneralSeekableZstd_reader();
+  g_test_add_data_func("/libCacheSim/reader_seekable_zstd_oracleGeneral", reader, test_reader_zstd_seekable);
+  g_test_add_data_func("/libCacheSim/reader_budget_seekable_zstd_oracleGeneral", reader, test_reader_zstd_budget);
+  g_test_add_data_func("/libCacheSim/reader_zstd_seekable_zstd_oracleGeneral", reader, test_reader_zstd);
+  g_test_add_data_func("/libCacheSim/reader_basic_seekable_zstd_oracleGeneral", reader, test_reader_basic);
+  g_test_add_data_func("/libCacheSim/reader_more1_seekable_zstd_oracleGeneral", reader, test_reader_more1);
+  g_test_add_data_func("/libCacheSim/reader_batch_seekable_zstd_oracleGeneral", reader, test_reader_batch);
+  g_test_add_data_func("/libCacheSim/reader_hot_batch_seekable_zstd_oracleGeneral", reader, test_reader_hot_batch);
+  g_test_add_data_func("/libCacheSim/reader_seek_seekable_zstd_oracleGeneral", reader, test_reader_seek);
+  g_test_add_data_func("/libCacheSim/reader_seek_time_seekable_zstd_oracleGeneral", reader, test_reader_seek_time);
+  g_test_add_data_func_full("/libCacheSim/reader_more2_seekable_zstd_oracleGeneral", reader, test_reader_more2,
+                            test_teardown);
+#endif
+
+  reader = setup_lcs_v1_reader();
+  g_test_add_data_func("/libCacheSim/reader_batch_lcs_v1", reader, test_reader_batch);
+  g_test_add_data_func_full("/libCacheSim/reader_hot_batch_lcs_v1", reader, test_reader_hot_batch, test_teardown);
+
+  reader = setup_lcs_v2_reader();
+  g_test_add_data_func("/libCacheSim/reader_batch_lcs_v2", reader, test_reader_batch);
+  g_test_add_data_func_full("/libCacheSim/reader_hot_batch_lcs_v2", reader, test_reader_hot_batch, test_teardown);
+
+  reader = setup_lcs_v9_reader();
+  g_test_add_data_func("/libCacheSim/reader_basic_lcs_v9", reader, test_reader_basic);
+  g_test_add_data_func("/libCacheSim/reader_more1_lcs_v9", reader, test_reader_more1);
+  g_test_add_data_func("/libCacheSim/reader_batch_lcs_v9", reader, test_reader_batch);
+  g_test_add_data_func("/libCacheSim/reader_hot_batch_lcs_v9", reader, test_reader_hot_batch);
+  g_test_add_data_func("/libCacheSim/reader_seek_lcs_v9", reader, test_reader_seek);
+  g_test_add_data_func("/libCacheSim/reader_seek_time_lcs_v9", reader, test_reader_seek_time);
+  g_test_add_data_func_full("/libCacheSim/reader_more2_lcs_v9", reader, test_reader_more2, test_teardown);
+
   // g_test_add_data_func("/libCacheSim/test_twr", NULL, test_twr);
   return g_test_run();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 // Created by Haocheng on 01/14/25.
 //
 
+#include "../libCacheSim/utils/include/mystr.h"
 #include "../libCacheSim/utils/include/mysys.h"
 #include "common.h"
 
@@ -45,8 +46,20 @@ void test_create_dir(gconstpointer user_data) {
     // printf("All create_dir tests passed!\n");
 }
 
+void test_conv_size_str_to_byte(gconstpointer user_data) {
+    g_assert_cmpint(conv_size_str_to_byte("1024"), ==, 1024);
+    g_assert_cmpint(conv_size_str_to_byte("-1"), ==, -1);
+    g_assert_cmpint(conv_size_str_to_byte("4k"), ==, 4 * KiB);
+    g_assert_cmpint(conv_size_str_to_byte("4KB"), ==, 4 * KiB);
+    g_assert_cmpint(conv_size_str_to_byte("100MB"), ==, 100 * MiB);
+    g_assert_cmpint(conv_size_str_to_byte("100 MiB"), ==, 100 * MiB);
+    g_assert_cmpint(conv_size_str_to_byte("2gb"), ==, 2 * GiB);
+    g_assert_cmpint(conv_size_str_to_byte("3T"), ==, 3 * TiB);
+}
+
 int main(int argc, char *argv[]) {
     g_test_init(&argc, &argv, NULL);
     g_test_add_data_func("/test_create_dir", NULL, test_create_dir);
+    g_test_add_data_func("/test_conv_size_str_to_byte", NULL, test_conv_size_str_to_byte);
     return g_test_run();
 }